@@ -0,0 +1,1038 @@
+#include "SEBenchmark.h"
+#include "SEJobSystem.h"
+#include "SEPipelineCache.h"
+#include "SEBlockCompress.h"
+#include "SERenderGraph.h"
+#include "SEFrustumCull.h"
+#include "SEOcclusionCull.h"
+#include "SEBvh.h"
+#include "SEMeshLod.h"
+#include "SEMeshlet.h"
+#include "SESpriteBatch.h"
+#include "SETilemap.h"
+#include "SETextRenderer.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ScoobzEngine {
+
+	typedef std::chrono::high_resolution_clock BenchClock;
+
+	static double ElapsedMs(BenchClock::time_point start){
+		return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+	}
+
+	// best of a few runs, the first one usually pays for page faults and thread wakeups
+	static double BestOf(int runs, const std::function<void()>& body){
+		double best = 1e30;
+		for (int i = 0; i < runs; i++){
+			auto start = BenchClock::now();
+			body();
+			best = std::min(best, ElapsedMs(start));
+		}
+		return best;
+	}
+
+	static void BenchJobSpawn(){
+		const uint32_t jobCount = 200000;
+		SEJobSystem jobs;
+
+		// spawn and run on the main thread alone, this is the raw push/pop/execute cost
+		SEJobSystem single(0);
+		double singleMs = BestOf(5, [&] {
+			SEJobCounter counter;
+			for (uint32_t i = 0; i < jobCount; i++){
+				single.Run([] {}, &counter);
+				if ((i & 1023) == 1023){
+					single.WaitForCounter(&counter); // keep the job ring from wrapping
+				}
+			}
+			single.WaitForCounter(&counter);
+		});
+
+		double multiMs = BestOf(5, [&] {
+			SEJobCounter counter;
+			for (uint32_t i = 0; i < jobCount; i++){
+				jobs.Run([] {}, &counter);
+				if ((i & 1023) == 1023){
+					jobs.WaitForCounter(&counter);
+				}
+			}
+			jobs.WaitForCounter(&counter);
+		});
+
+		std::cout << "jobs.spawn: " << jobCount << " empty jobs, 1 thread " << singleMs * 1e6 / jobCount << " ns/job, "
+			<< jobs.GetThreadCount() << " threads " << multiMs * 1e6 / jobCount << " ns/job" << std::endl;
+	}
+
+	static void BenchJobSteal(){
+		const uint32_t jobCount = 2048;
+		SEJobSystem jobs;
+		if (jobs.GetThreadCount() < 2){
+			std::cout << "jobs.steal: skipped, needs at least 2 threads" << std::endl;
+			return;
+		}
+
+		// the main thread only spawns and never helps, so every job has to be stolen
+		double totalMs = 0.0;
+		uint64_t stolen = 0;
+		const int rounds = 50;
+		for (int round = 0; round < rounds; round++){
+			jobs.ResetStats();
+			SEJobCounter counter;
+			auto start = BenchClock::now();
+			for (uint32_t i = 0; i < jobCount; i++){
+				jobs.Run([] {}, &counter);
+			}
+			while (counter.GetValue() > 0){
+				std::this_thread::yield();
+			}
+			jobs.WaitForCounter(&counter);
+			totalMs += ElapsedMs(start);
+			stolen += jobs.GetStats().jobsStolen;
+		}
+
+		std::cout << "jobs.steal: " << stolen << " steals, " << totalMs * 1e6 / stolen << " ns per stolen job" << std::endl;
+	}
+
+	static void BenchParallelFor(){
+		const uint32_t elementCount = 1 << 22;
+		std::vector<float> values(elementCount);
+
+		auto kernel = [&values](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++){
+				float x = static_cast<float>(i);
+				values[i] = std::sqrt(x) * std::sin(x) + std::cos(x * 0.5f);
+			}
+		};
+
+		unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+		double baseMs = 0.0;
+		std::cout << "jobs.parallel_for: " << elementCount << " elements" << std::endl;
+		for (unsigned int threads = 1; threads <= maxThreads; threads *= 2){
+			SEJobSystem jobs(static_cast<int>(threads) - 1);
+			double ms = BestOf(5, [&] { jobs.ParallelFor(elementCount, 4096, kernel); });
+			if (threads == 1){
+				baseMs = ms;
+			}
+			std::cout << "  " << std::setw(3) << threads << " threads: " << std::fixed << std::setprecision(2) << ms
+				<< " ms, speedup " << baseMs / ms << "x" << std::defaultfloat << std::endl;
+
+			if (threads < maxThreads && threads * 2 > maxThreads){
+				threads = maxThreads / 2; // always finish on the full core count
+			}
+		}
+	}
+
+	// many materials over a handful of distinct states, only the distinct ones should reach the compiler
+	static void BenchPipelineDedup(){
+		const uint32_t materialCount = 100000;
+		const uint32_t shaderCount = 8;
+
+		std::vector<SEPipelineDesc> materials(materialCount);
+		for (uint32_t i = 0; i < materialCount; i++){
+			SEPipelineDesc& desc = materials[i];
+			desc.vertShader = (VkShaderModule)(uintptr_t)(1 + i % shaderCount);
+			desc.fragShader = (VkShaderModule)(uintptr_t)(100 + (i / shaderCount) % shaderCount);
+			desc.cullMode = (i % 3 == 0) ? VK_CULL_MODE_NONE : VK_CULL_MODE_BACK_BIT;
+			desc.blendEnable = (i % 5 == 0) ? VK_TRUE : VK_FALSE;
+			desc.vertexBindings.resize(1);
+			desc.vertexBindings[0].stride = 20;
+		}
+
+		std::unordered_map<SEPipelineKey, uint32_t, SEPipelineKeyHash> registry;
+		auto start = BenchClock::now();
+		for (const auto& desc : materials){
+			registry.emplace(SEPipelineCache::MakeKey(desc), static_cast<uint32_t>(registry.size()));
+		}
+		double ms = ElapsedMs(start);
+
+		std::cout << "pipelines.dedup: " << materialCount << " materials -> " << registry.size() << " unique pipelines, "
+			<< ms * 1e6 / materialCount << " ns per key+lookup" << std::endl;
+	}
+
+	// something like a photo: smooth gradients, a few hard edges and some grain, with an alpha ramp
+	static std::vector<uint8_t> MakeTestImage(uint32_t width, uint32_t height){
+		std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+		uint32_t seed = 1234567;
+		for (uint32_t y = 0; y < height; y++){
+			for (uint32_t x = 0; x < width; x++){
+				seed = seed * 1664525u + 1013904223u;
+				int grain = static_cast<int>(seed >> 28) - 8;
+				float u = static_cast<float>(x) / width;
+				float v = static_cast<float>(y) / height;
+				bool edge = ((x / 96) + (y / 64)) % 5 == 0;
+
+				float channels[4] = {
+					128.0f + 100.0f * std::sin(u * 9.0f + v * 3.0f),
+					edge ? 40.0f : 200.0f * v,
+					128.0f + 120.0f * std::cos(u * v * 20.0f),
+					255.0f * u
+				};
+				uint8_t* texel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+				for (uint32_t c = 0; c < 4; c++){
+					int value = static_cast<int>(channels[c]) + (c < 3 ? grain : 0);
+					texel[c] = static_cast<uint8_t>(std::min(std::max(value, 0), 255));
+				}
+			}
+		}
+		return pixels;
+	}
+
+	// tangent space normals from a bumpy height field, what BC5 is for
+	static std::vector<uint8_t> MakeTestNormals(uint32_t width, uint32_t height){
+		std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+		for (uint32_t y = 0; y < height; y++){
+			for (uint32_t x = 0; x < width; x++){
+				float dx = 0.6f * std::cos(x * 0.05f) * std::cos(y * 0.08f);
+				float dy = -0.6f * std::sin(x * 0.05f) * std::sin(y * 0.08f);
+				float length = std::sqrt(dx * dx + dy * dy + 1.0f);
+				uint8_t* texel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+				texel[0] = static_cast<uint8_t>((dx / length * 0.5f + 0.5f) * 255.0f + 0.5f);
+				texel[1] = static_cast<uint8_t>((dy / length * 0.5f + 0.5f) * 255.0f + 0.5f);
+				texel[2] = static_cast<uint8_t>((1.0f / length * 0.5f + 0.5f) * 255.0f + 0.5f);
+				texel[3] = 255;
+			}
+		}
+		return pixels;
+	}
+
+	// over the channels the format actually stores
+	static double PSNR(const std::vector<uint8_t>& original, const std::vector<uint8_t>& decoded, uint32_t channelMask){
+		double error = 0.0;
+		uint64_t samples = 0;
+		for (size_t i = 0; i < original.size(); i++){
+			if (channelMask & (1 << (i & 3))){
+				double difference = static_cast<double>(original[i]) - decoded[i];
+				error += difference * difference;
+				samples++;
+			}
+		}
+		double mse = error / samples;
+		return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0;
+	}
+
+	static const SEBlockFormat benchFormats[] = { SE_BLOCK_BC1, SE_BLOCK_BC3, SE_BLOCK_BC5, SE_BLOCK_BC7 };
+
+	static void BenchBlockEncode(){
+		const uint32_t size = 1024;
+		std::vector<uint8_t> pixels = MakeTestImage(size, size);
+		double megapixels = size * size / 1e6;
+		SEJobSystem jobs;
+
+		std::cout << "textures.bc_encode: " << size << "x" << size << std::endl;
+		for (SEBlockFormat format : benchFormats){
+			double singleMs = BestOf(3, [&] { CompressImage(format, pixels.data(), size, size); });
+			double multiMs = BestOf(3, [&] { CompressImage(format, pixels.data(), size, size, &jobs); });
+			std::cout << "  " << GetBlockFormatName(format) << ": 1 thread " << std::fixed << std::setprecision(1)
+				<< megapixels / (singleMs / 1000.0) << " MPix/s, " << jobs.GetThreadCount() << " threads "
+				<< megapixels / (multiMs / 1000.0) << " MPix/s" << std::defaultfloat << std::endl;
+		}
+	}
+
+	static void BenchBlockQuality(){
+		const uint32_t size = 512;
+		std::vector<uint8_t> image = MakeTestImage(size, size);
+		std::vector<uint8_t> normals = MakeTestNormals(size, size);
+
+		std::cout << "textures.bc_quality: PSNR in dB, " << size << "x" << size << std::endl;
+		for (SEBlockFormat format : benchFormats){
+			// each format is measured on what it stores, colour without alpha for BC1 and two channels for BC5
+			uint32_t channelMask = format == SE_BLOCK_BC1 ? 0x7 : (format == SE_BLOCK_BC5 ? 0x3 : 0xf);
+			std::cout << "  " << GetBlockFormatName(format) << ":" << std::fixed << std::setprecision(2);
+			for (const auto* source : { &image, &normals }){
+				std::vector<uint8_t> compressed = CompressImage(format, source->data(), size, size);
+				std::vector<uint8_t> decoded = DecompressImage(format, compressed.data(), size, size);
+				std::cout << (source == &image ? " image " : ", normals ") << PSNR(*source, decoded, channelMask);
+			}
+			std::cout << std::defaultfloat << std::endl;
+		}
+	}
+
+	// a deferred frame at 1080p: shadows, pre-pass, gbuffer, ssao, lighting, a bloom chain and tonemapping into the
+	// backbuffer. the debug overlay is never read so it should be culled
+	static void BuildDeferredFrame(SERenderGraph& graph){
+		const VkExtent2D full = { 1920, 1080 };
+		const VkExtent2D half = { 960, 540 };
+		const VkExtent2D quarter = { 480, 270 };
+		VkClearValue clear = {};
+
+		graph.BeginFrame(0);
+		SEGraphResource backbuffer = graph.ImportImage("Backbuffer", VK_NULL_HANDLE, VK_NULL_HANDLE, VK_FORMAT_B8G8R8A8_UNORM, full,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		SEGraphResource shadowMap = graph.CreateImage("ShadowMap", VK_FORMAT_D32_SFLOAT, { 2048, 2048 });
+		SEGraphResource depth = graph.CreateImage("Depth", VK_FORMAT_D32_SFLOAT, full);
+		SEGraphResource albedo = graph.CreateImage("Albedo", VK_FORMAT_R8G8B8A8_UNORM, full);
+		SEGraphResource normals = graph.CreateImage("Normals", VK_FORMAT_R16G16B16A16_SFLOAT, full);
+		SEGraphResource material = graph.CreateImage("Material", VK_FORMAT_R8G8B8A8_UNORM, full);
+		SEGraphResource ao = graph.CreateImage("AO", VK_FORMAT_R8_UNORM, half);
+		SEGraphResource hdr = graph.CreateImage("HDR", VK_FORMAT_R16G16B16A16_SFLOAT, full);
+		SEGraphResource bloomHalf = graph.CreateImage("BloomHalf", VK_FORMAT_R16G16B16A16_SFLOAT, half);
+		SEGraphResource bloomQuarter = graph.CreateImage("BloomQuarter", VK_FORMAT_R16G16B16A16_SFLOAT, quarter);
+		SEGraphResource bloomUp = graph.CreateImage("BloomUp", VK_FORMAT_R16G16B16A16_SFLOAT, half);
+		SEGraphResource overlay = graph.CreateImage("DebugOverlay", VK_FORMAT_R8G8B8A8_UNORM, full);
+
+		SEGraphPass pass = graph.AddPass("Shadows", nullptr);
+		graph.Write(pass, shadowMap, SE_GRAPH_DEPTH_WRITE, &clear);
+		pass = graph.AddPass("DepthPrepass", nullptr);
+		graph.Write(pass, depth, SE_GRAPH_DEPTH_WRITE, &clear);
+		pass = graph.AddPass("GBuffer", nullptr);
+		graph.Write(pass, albedo, SE_GRAPH_COLOR_WRITE, &clear);
+		graph.Write(pass, normals, SE_GRAPH_COLOR_WRITE, &clear);
+		graph.Write(pass, material, SE_GRAPH_COLOR_WRITE, &clear);
+		graph.Read(pass, depth, SE_GRAPH_DEPTH_READ);
+		pass = graph.AddPass("SSAO", nullptr);
+		graph.Read(pass, depth, SE_GRAPH_SAMPLED);
+		graph.Read(pass, normals, SE_GRAPH_SAMPLED);
+		graph.Write(pass, ao, SE_GRAPH_COLOR_WRITE);
+		pass = graph.AddPass("Lighting", nullptr);
+		graph.Read(pass, albedo, SE_GRAPH_SAMPLED);
+		graph.Read(pass, normals, SE_GRAPH_SAMPLED);
+		graph.Read(pass, material, SE_GRAPH_SAMPLED);
+		graph.Read(pass, ao, SE_GRAPH_SAMPLED);
+		graph.Read(pass, shadowMap, SE_GRAPH_SAMPLED);
+		graph.Write(pass, hdr, SE_GRAPH_COLOR_WRITE);
+		pass = graph.AddPass("DebugOverlay", nullptr);
+		graph.Read(pass, normals, SE_GRAPH_SAMPLED);
+		graph.Write(pass, overlay, SE_GRAPH_COLOR_WRITE, &clear);
+		pass = graph.AddPass("BloomDownHalf", nullptr);
+		graph.Read(pass, hdr, SE_GRAPH_SAMPLED);
+		graph.Write(pass, bloomHalf, SE_GRAPH_COLOR_WRITE);
+		pass = graph.AddPass("BloomDownQuarter", nullptr);
+		graph.Read(pass, bloomHalf, SE_GRAPH_SAMPLED);
+		graph.Write(pass, bloomQuarter, SE_GRAPH_COLOR_WRITE);
+		pass = graph.AddPass("BloomUp", nullptr);
+		graph.Read(pass, bloomQuarter, SE_GRAPH_SAMPLED);
+		graph.Write(pass, bloomUp, SE_GRAPH_COLOR_WRITE);
+		pass = graph.AddPass("Tonemap", nullptr);
+		graph.Read(pass, hdr, SE_GRAPH_SAMPLED);
+		graph.Read(pass, bloomUp, SE_GRAPH_SAMPLED);
+		graph.Write(pass, backbuffer, SE_GRAPH_COLOR_WRITE);
+	}
+
+	// compiled without a device, so image sizes are estimates
+	static void BenchRenderGraph(){
+		const uint32_t frames = 10000;
+		SERenderGraph graph;
+
+		std::cout << "rendergraph.compile: deferred frame, 1920x1080" << std::endl;
+		std::cout << "  ";
+		BuildDeferredFrame(graph);
+		graph.Compile();
+
+		double ms = BestOf(3, [&] {
+			for (uint32_t i = 0; i < frames; i++){
+				BuildDeferredFrame(graph);
+				graph.Compile();
+			}
+		});
+		std::cout << "  " << std::fixed << std::setprecision(2) << ms * 1000.0 / frames << " us per frame to build and compile"
+			<< std::defaultfloat << std::endl;
+	}
+
+	// a million boxes of mixed sizes, some turned, scattered around a camera so about a quarter are in view
+	static void MakeCullScene(SEObjectStore& store, uint32_t objectCount){
+		uint32_t seed = 7654321;
+		auto random = [&seed]{
+			seed = seed * 1664525u + 1013904223u;
+			return static_cast<float>(seed >> 8) / 16777216.0f;
+		};
+		for (uint32_t i = 0; i < objectCount; i++){
+			float scale = 0.5f + random() * 4.0f;
+			float angle = random() * 6.2831853f;
+			glm::mat4 model(1.0f);
+			model[0][0] = std::cos(angle) * scale;
+			model[0][2] = -std::sin(angle) * scale;
+			model[2][0] = std::sin(angle) * scale;
+			model[2][2] = std::cos(angle) * scale;
+			model[1][1] = scale;
+			model[3] = glm::vec4(random() * 2000.0f - 1000.0f, random() * 200.0f - 100.0f, random() * 2000.0f - 1000.0f, 1.0f);
+			store.Add(model, glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(0.5f, 0.5f, 0.5f), 0);
+		}
+	}
+
+	// single threaded per path, then the widest path split over the job system. every path has to agree
+	static void BenchFrustumCull(){
+		const uint32_t objectCount = 1000000;
+		SEObjectStore store;
+		MakeCullScene(store, objectCount);
+
+		glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+		SEFrustum frustum = ExtractFrustum(projection * view);
+
+		SECullPath bestPath = GetBestCullPath();
+		std::vector<uint32_t> reference;
+		uint32_t referenceCount = CullObjects(store, frustum, SE_CULL_SCALAR, reference);
+		reference.resize(referenceCount);
+		std::cout << "culling.frustum: " << objectCount << " objects, " << referenceCount << " visible" << std::endl;
+
+		std::vector<uint32_t> visible;
+		double scalarMs = 0.0;
+		for (int path = SE_CULL_SCALAR; path <= bestPath; path++){
+			uint32_t visibleCount = 0;
+			double ms = BestOf(10, [&] {
+				visibleCount = CullObjects(store, frustum, static_cast<SECullPath>(path), visible);
+			});
+			if (path == SE_CULL_SCALAR){
+				scalarMs = ms;
+			}
+			bool matches = visibleCount == referenceCount && std::equal(reference.begin(), reference.end(), visible.begin());
+			std::cout << "  " << std::setw(6) << GetCullPathName(static_cast<SECullPath>(path)) << " 1 thread " << std::fixed << std::setprecision(2)
+				<< ms << " ms, " << ms * 1e6 / objectCount << " ns/object, " << scalarMs / ms << "x scalar"
+				<< std::defaultfloat << (matches ? "" : " MISMATCH") << std::endl;
+		}
+
+		SEJobSystem jobs;
+		uint32_t visibleCount = 0;
+		double ms = BestOf(10, [&] {
+			visibleCount = CullObjects(store, frustum, bestPath, visible, &jobs);
+		});
+		bool matches = visibleCount == referenceCount && std::equal(reference.begin(), reference.end(), visible.begin());
+		std::cout << "  " << std::setw(6) << GetCullPathName(bestPath) << " " << jobs.GetThreadCount() << " threads " << std::fixed << std::setprecision(2)
+			<< ms << " ms, " << ms * 1e6 / objectCount << " ns/object, " << scalarMs / ms << "x scalar"
+			<< std::defaultfloat << (matches ? "" : " MISMATCH") << std::endl;
+	}
+
+	// the same scene with a wall in front of the camera. every object the wall hides has to be entirely inside its
+	// screen rectangle and behind it, anything else is a false rejection
+	static void BenchOcclusionCull(){
+		const uint32_t objectCount = 1000000;
+		SEObjectStore store;
+		MakeCullScene(store, objectCount);
+
+		const float wallDistance = 30.0f;
+		glm::mat4 wallModel(1.0f);
+		wallModel[0][0] = 30.0f;
+		wallModel[1][1] = 15.0f;
+		wallModel[3] = glm::vec4(0.0f, 0.0f, -wallDistance, 1.0f);
+		SEObjectHandle wall = store.Add(wallModel, glm::vec3(-0.5f, -0.5f, 0.0f), glm::vec3(0.5f, 0.5f, 0.0f), 0);
+		store.SetOccluder(wall, true);
+
+		glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+		glm::mat4 viewProjection = projection * view;
+		SEFrustum frustum = ExtractFrustum(viewProjection);
+
+		std::vector<uint32_t> frustumVisible;
+		uint32_t frustumCount = CullObjects(store, frustum, GetBestCullPath(), frustumVisible);
+		frustumVisible.resize(frustumCount);
+
+		SEOcclusionBuffer occlusion;
+		occlusion.Create(256, 128);
+		double drawMs = BestOf(10, [&] {
+			occlusion.Begin(viewProjection);
+			occlusion.DrawOccluders(store);
+			occlusion.BuildHiZ();
+		});
+
+		std::vector<uint32_t> visible;
+		uint32_t visibleCount = 0;
+		double testMs = BestOf(10, [&] {
+			visible = frustumVisible;
+			visibleCount = CullOccluded(store, occlusion, visible, frustumCount);
+		});
+		visible.resize(visibleCount);
+
+		// the wall on screen, in NDC
+		glm::vec4 wallMin = viewProjection * glm::vec4(-15.0f, -7.5f, -wallDistance, 1.0f);
+		glm::vec4 wallMax = viewProjection * glm::vec4(15.0f, 7.5f, -wallDistance, 1.0f);
+		glm::vec2 screenMin = glm::min(glm::vec2(wallMin) / wallMin.w, glm::vec2(wallMax) / wallMax.w);
+		glm::vec2 screenMax = glm::max(glm::vec2(wallMin) / wallMin.w, glm::vec2(wallMax) / wallMax.w);
+
+		uint32_t wrong = 0;
+		size_t next = 0;
+		for (uint32_t index : frustumVisible){
+			if (next < visible.size() && visible[next] == index){
+				next++;
+				continue;
+			}
+			glm::vec3 center(store.GetCenterX()[index], store.GetCenterY()[index], store.GetCenterZ()[index]);
+			glm::vec3 extent(store.GetExtentX()[index], store.GetExtentY()[index], store.GetExtentZ()[index]);
+			for (int i = 0; i < 8; i++){
+				glm::vec3 corner = center + extent * glm::vec3((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+				glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+				glm::vec2 screen = glm::vec2(clip) / clip.w;
+				if (corner.z > -wallDistance || screen.x < screenMin.x || screen.y < screenMin.y || screen.x > screenMax.x || screen.y > screenMax.y){
+					wrong++;
+					break;
+				}
+			}
+		}
+
+		std::cout << "culling.occlusion: " << frustumCount << " objects in the frustum, " << frustumCount - visibleCount << " occluded by "
+			<< occlusion.GetStats().occludersDrawn << " occluder" << std::endl;
+		std::cout << "  draw + pyramid " << std::fixed << std::setprecision(3) << drawMs << " ms, test " << testMs << " ms, "
+			<< testMs * 1e6 / frustumCount << " ns/object" << std::defaultfloat << (wrong ? " MISMATCH" : "") << std::endl;
+	}
+
+	// the culling scene at a few sizes. the SAH cost is in root box tests, refit moves a tenth of the objects
+	static void BenchBvhBuild(){
+		std::cout << "bvh.build:" << std::endl;
+		for (uint32_t objectCount : { 10000u, 100000u, 1000000u }){
+			SEObjectStore store;
+			MakeCullScene(store, objectCount);
+
+			SEBvh bvh;
+			double buildMs = BestOf(3, [&] { bvh.Build(store); });
+			float builtCost = bvh.GetSahCost();
+
+			// every tenth object slides along x, the tree keeps its shape and gets a little looser
+			double refitMs = BestOf(3, [&] {
+				for (uint32_t i = 0; i < objectCount; i += 10){
+					glm::vec3 center(store.GetCenterX()[i] + 5.0f, store.GetCenterY()[i], store.GetCenterZ()[i]);
+					glm::vec3 extent(store.GetExtentX()[i], store.GetExtentY()[i], store.GetExtentZ()[i]);
+					bvh.UpdatePrimitive(i, center - extent, center + extent);
+				}
+				bvh.Refit();
+			});
+
+			std::cout << "  " << std::setw(7) << objectCount << " objects " << std::fixed << std::setprecision(2) << std::setw(8) << buildMs << " ms build, "
+				<< buildMs * 1e6 / objectCount << " ns/object, " << bvh.GetNodeCount() << " nodes, SAH cost " << builtCost << ", "
+				<< refitMs << " ms refit a tenth, SAH cost " << bvh.GetSahCost() << std::defaultfloat << std::endl;
+		}
+	}
+
+	// frustum queries against the flat SIMD culler, then rays from the camera. every answer is checked by brute force
+	static void BenchBvhQuery(){
+		glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+		SEFrustum frustum = ExtractFrustum(projection * view);
+		// a narrow view, like a picking or spotlight query
+		SEFrustum narrowFrustum = ExtractFrustum(glm::perspectiveRH_ZO(glm::radians(5.0f), 1.0f, 0.1f, 1000.0f) * view);
+
+		std::cout << "bvh.query:" << std::endl;
+		for (uint32_t objectCount : { 10000u, 100000u, 1000000u }){
+			SEObjectStore store;
+			MakeCullScene(store, objectCount);
+			SEBvh bvh;
+			bvh.Build(store);
+
+			// the BVH tests boxes only, so the brute force does too
+			auto bruteForce = [&](const SEFrustum& testFrustum){
+				uint32_t touching = 0;
+				for (uint32_t i = 0; i < objectCount; i++){
+					bool touches = true;
+					for (int p = 0; p < 6 && touches; p++){
+						const glm::vec4& plane = testFrustum.planes[p];
+						float distance = plane.x * store.GetCenterX()[i] + plane.y * store.GetCenterY()[i] + plane.z * store.GetCenterZ()[i] + plane.w;
+						float reach = std::abs(plane.x) * store.GetExtentX()[i] + std::abs(plane.y) * store.GetExtentY()[i] + std::abs(plane.z) * store.GetExtentZ()[i];
+						touches = distance + reach >= 0.0f;
+					}
+					touching += touches ? 1 : 0;
+				}
+				return touching;
+			};
+
+			std::vector<uint32_t> results;
+			std::vector<uint32_t> flatVisible;
+			const SEFrustum* frustums[] = { &frustum, &narrowFrustum };
+			const char* frustumNames[] = { "60 degree", "5 degree" };
+			for (int f = 0; f < 2; f++){
+				double bvhMs = BestOf(5, [&] {
+					results.clear();
+					bvh.QueryFrustum(*frustums[f], results);
+				});
+				double flatMs = BestOf(5, [&] { CullObjects(store, *frustums[f], GetBestCullPath(), flatVisible); });
+				bool matches = results.size() == bruteForce(*frustums[f]);
+				std::cout << "  " << std::setw(7) << objectCount << " objects, " << std::setw(9) << frustumNames[f] << " frustum " << std::fixed << std::setprecision(3)
+					<< bvhMs << " ms (" << results.size() << " found), flat " << GetCullPathName(GetBestCullPath()) << " " << flatMs << " ms"
+					<< std::defaultfloat << (matches ? "" : " MISMATCH") << std::endl;
+			}
+
+			// rays from the camera through random points on screen
+			const uint32_t rayCount = 100000;
+			std::vector<glm::vec3> directions(rayCount);
+			uint32_t seed = 1234567;
+			for (auto& direction : directions){
+				seed = seed * 1664525u + 1013904223u;
+				float x = static_cast<float>(seed >> 8) / 16777216.0f * 2.0f - 1.0f;
+				seed = seed * 1664525u + 1013904223u;
+				float y = static_cast<float>(seed >> 8) / 16777216.0f * 2.0f - 1.0f;
+				direction = glm::normalize(glm::vec3(x * 0.577f * 16.0f / 9.0f, y * 0.577f, -1.0f));
+			}
+			uint32_t hits = 0;
+			double rayMs = BestOf(3, [&] {
+				hits = 0;
+				SEBvhHit hit;
+				for (const auto& direction : directions){
+					hits += bvh.Raycast(glm::vec3(0.0f), direction, 1000.0f, hit) ? 1 : 0;
+				}
+			});
+
+			// the nearest box for a few rays, the slow way
+			bool raysMatch = true;
+			for (uint32_t r = 0; r < 20; r++){
+				glm::vec3 inverseDirection = 1.0f / directions[r];
+				float nearest = 1000.0f;
+				bool found = false;
+				for (uint32_t i = 0; i < objectCount; i++){
+					glm::vec3 center(store.GetCenterX()[i], store.GetCenterY()[i], store.GetCenterZ()[i]);
+					glm::vec3 extent(store.GetExtentX()[i], store.GetExtentY()[i], store.GetExtentZ()[i]);
+					glm::vec3 t0 = (center - extent) * inverseDirection;
+					glm::vec3 t1 = (center + extent) * inverseDirection;
+					float enter = std::max(std::max(std::min(t0.x, t1.x), std::min(t0.y, t1.y)), std::max(std::min(t0.z, t1.z), 0.0f));
+					float exit = std::min(std::min(std::max(t0.x, t1.x), std::max(t0.y, t1.y)), std::min(std::max(t0.z, t1.z), nearest));
+					if (enter <= exit){
+						nearest = enter;
+						found = true;
+					}
+				}
+				SEBvhHit hit;
+				bool bvhFound = bvh.Raycast(glm::vec3(0.0f), directions[r], 1000.0f, hit);
+				raysMatch &= bvhFound == found && (!found || hit.distance == nearest);
+			}
+
+			std::cout << "  " << std::setw(7) << objectCount << " objects, " << rayCount << " rays " << std::fixed << std::setprecision(2) << rayMs << " ms, "
+				<< rayCount / rayMs / 1000.0 << " M rays/s, " << hits << " hit" << std::defaultfloat << (raysMatch ? "" : " MISMATCH") << std::endl;
+		}
+	}
+
+	// a bumpy torus, with seams where the texture coordinates wrap both ways round. 65536 triangles
+	static void MakeTorus(std::vector<glm::vec3>& positions, std::vector<float>& uvs, std::vector<uint32_t>& indices){
+		const uint32_t rings = 256;
+		const uint32_t sides = 128;
+		for (uint32_t r = 0; r <= rings; r++){
+			for (uint32_t s = 0; s <= sides; s++){
+				float u = static_cast<float>(r) / rings;
+				float v = static_cast<float>(s) / sides;
+				// the last row and column land exactly on the first, so the seam vertices share their positions
+				float theta = (r == rings ? 0.0f : u) * 6.2831853f;
+				float phi = (s == sides ? 0.0f : v) * 6.2831853f;
+				float tube = 0.3f + 0.02f * std::sin(theta * 12.0f) * std::sin(phi * 6.0f);
+				positions.push_back(glm::vec3((1.0f + tube * std::cos(phi)) * std::cos(theta), tube * std::sin(phi), (1.0f + tube * std::cos(phi)) * std::sin(theta)));
+				uvs.push_back(u);
+				uvs.push_back(v);
+			}
+		}
+		for (uint32_t r = 0; r < rings; r++){
+			for (uint32_t s = 0; s < sides; s++){
+				uint32_t a = r * (sides + 1) + s;
+				uint32_t b = a + sides + 1;
+				indices.insert(indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+			}
+		}
+	}
+
+	// the torus and its LOD chain. every level has to stay closed between positions, a seam that came apart would
+	// leave open edges. then how many triangles the culling scene draws once each object picks its level
+	static void BenchMeshLod(){
+		std::vector<glm::vec3> positions;
+		std::vector<float> uvs;
+		std::vector<uint32_t> indices;
+		MakeTorus(positions, uvs, indices);
+
+		std::vector<uint32_t> lodIndices;
+		std::vector<SEMeshLod> lods;
+		SEMeshLodDesc desc;
+		double buildMs = BestOf(1, [&] { GenerateLods(positions, uvs.data(), 2, indices, desc, lodIndices, lods); });
+
+		// first position of every vertex, to check the levels are closed between positions
+		std::unordered_map<uint64_t, uint32_t> firstAt;
+		std::vector<uint32_t> remap(positions.size());
+		for (uint32_t i = 0; i < positions.size(); i++){
+			glm::ivec3 key = glm::ivec3(glm::round(positions[i] * 1e5f));
+			uint64_t hash = (static_cast<uint64_t>(key.x & 0x1fffff) << 42) | (static_cast<uint64_t>(key.y & 0x1fffff) << 21) | static_cast<uint64_t>(key.z & 0x1fffff);
+			remap[i] = firstAt.emplace(hash, i).first->second;
+		}
+
+		std::cout << "mesh.lod: " << indices.size() / 3 << " triangles, " << lods.size() << " levels in " << std::fixed << std::setprecision(2) << buildMs << " ms" << std::endl;
+		for (uint32_t level = 0; level < lods.size(); level++){
+			std::unordered_map<uint64_t, int> edges;
+			for (uint32_t i = 0; i < lods[level].indexCount; i += 3){
+				for (int e = 0; e < 3; e++){
+					uint64_t a = remap[lodIndices[lods[level].firstIndex + i + e]];
+					uint64_t b = remap[lodIndices[lods[level].firstIndex + i + (e + 1) % 3]];
+					edges[a << 32 | b]++;
+				}
+			}
+			uint32_t openEdges = 0;
+			for (const auto& edge : edges){
+				openEdges += edges.count((edge.first & 0xffffffffull) << 32 | edge.first >> 32) ? 0 : 1;
+			}
+			std::cout << "  level " << level << ": " << std::setw(6) << lods[level].indexCount / 3 << " triangles, error " << std::setprecision(4)
+				<< lods[level].error << std::defaultfloat << (openEdges ? " OPEN EDGES: " + std::to_string(openEdges) : std::string()) << std::endl;
+			std::cout << std::fixed << std::setprecision(2);
+		}
+
+		// the culling scene with every object drawing the torus, at 1080p allowing a pixel of error
+		SEObjectStore store;
+		MakeCullScene(store, 1000000);
+		glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 viewProjection = glm::perspectiveRH_ZO(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f) * view;
+		std::vector<uint32_t> visible;
+		uint32_t visibleCount = CullObjects(store, ExtractFrustum(viewProjection), GetBestCullPath(), visible);
+		SELodView lodView = MakeLodView(viewProjection, 1080.0f, 1.0f);
+
+		uint64_t fullTriangles = 0;
+		uint64_t lodTriangles = 0;
+		std::vector<uint32_t> perLevel(lods.size());
+		double selectMs = BestOf(5, [&] {
+			fullTriangles = 0;
+			lodTriangles = 0;
+			std::fill(perLevel.begin(), perLevel.end(), 0);
+			for (uint32_t i = 0; i < visibleCount; i++){
+				uint32_t index = visible[i];
+				glm::vec3 center(store.GetCenterX()[index], store.GetCenterY()[index], store.GetCenterZ()[index]);
+				uint32_t level = SelectLod(lods, lodView, center, store.GetRadius()[index]);
+				perLevel[level]++;
+				fullTriangles += lods[0].indexCount / 3;
+				lodTriangles += lods[level].indexCount / 3;
+			}
+		});
+		std::cout << "  " << visibleCount << " visible objects, " << fullTriangles / 1000000.0 << " M triangles at full detail, "
+			<< lodTriangles / 1000000.0 << " M with LODs (" << 100.0 * lodTriangles / fullTriangles << "%), selected in " << selectMs << " ms" << std::endl;
+		std::cout << "  objects per level:";
+		for (uint32_t count : perLevel){
+			std::cout << " " << count;
+		}
+		std::cout << std::defaultfloat << std::endl;
+	}
+
+	// the torus split into meshlets, then culled per meshlet from views all round it. every triangle facing a view
+	// and in its frustum has to be in a meshlet that survived
+	static void BenchMeshlets(){
+		std::vector<glm::vec3> positions;
+		std::vector<float> uvs;
+		std::vector<uint32_t> indices;
+		MakeTorus(positions, uvs, indices);
+
+		std::vector<SEMeshlet> meshlets;
+		std::vector<uint32_t> meshletIndices;
+		double buildMs = BestOf(3, [&] {
+			meshletIndices = indices;
+			BuildMeshlets(positions, meshletIndices, 0, static_cast<uint32_t>(meshletIndices.size()), meshlets);
+		});
+		uint32_t vertexSum = 0;
+		uint32_t conesUsable = 0;
+		for (const auto& meshlet : meshlets){
+			vertexSum += meshlet.vertexCount;
+			conesUsable += meshlet.coneCutoff < SE_MESHLET_NO_CONE ? 1 : 0;
+		}
+		std::cout << "mesh.meshlets: " << indices.size() / 3 << " triangles into " << meshlets.size() << " meshlets in " << std::fixed << std::setprecision(2)
+			<< buildMs << " ms, " << static_cast<double>(indices.size()) / 3 / meshlets.size() << " triangles and "
+			<< static_cast<double>(vertexSum) / meshlets.size() << " vertices each, " << conesUsable << " with a cone" << std::endl;
+
+		// a model matrix that scales unevenly, to be sure the tests hold in local space
+		glm::mat4 model = glm::scale(glm::rotate(glm::mat4(1.0f), 0.4f, glm::vec3(1.0f, 0.0f, 0.0f)), glm::vec3(2.0f, 1.0f, 1.5f));
+		glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+		std::vector<uint32_t> visible;
+		uint64_t meshletsKept = 0;
+		uint64_t trianglesKept = 0;
+		uint64_t trianglesFacing = 0;
+		uint32_t missing = 0;
+		const int views = 16;
+		double cullMs = 0.0;
+		for (int v = 0; v < views; v++){
+			float angle = v * 6.2831853f / views;
+			glm::vec3 eye(std::cos(angle) * 3.0f, 1.0f + std::sin(angle * 3.0f), std::sin(angle) * 3.0f);
+			glm::mat4 viewProjection = projection * glm::lookAt(eye, glm::vec3(0.5f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+			SEFrustum frustum = ExtractFrustum(viewProjection);
+			glm::vec4 viewpoint = GetViewpoint(viewProjection);
+
+			uint32_t visibleCount = 0;
+			cullMs += BestOf(5, [&] { visibleCount = CullMeshlets(meshlets, model, frustum, viewpoint, visible); });
+			std::vector<uint8_t> kept(meshlets.size(), 0);
+			for (uint32_t i = 0; i < visibleCount; i++){
+				kept[visible[i]] = 1;
+				trianglesKept += meshlets[visible[i]].indexCount / 3;
+			}
+			meshletsKept += visibleCount;
+
+			for (uint32_t m = 0; m < meshlets.size(); m++){
+				for (uint32_t i = meshlets[m].firstIndex; i < meshlets[m].firstIndex + meshlets[m].indexCount; i += 3){
+					glm::vec3 p0 = glm::vec3(model * glm::vec4(positions[meshletIndices[i]], 1.0f));
+					glm::vec3 p1 = glm::vec3(model * glm::vec4(positions[meshletIndices[i + 1]], 1.0f));
+					glm::vec3 p2 = glm::vec3(model * glm::vec4(positions[meshletIndices[i + 2]], 1.0f));
+					bool facing = glm::dot(glm::cross(p1 - p0, p2 - p0), eye - p0) > 0.0f;
+					bool inside = true;
+					for (int p = 0; p < 6 && inside; p++){
+						const glm::vec4& plane = frustum.planes[p];
+						inside = std::max(std::max(glm::dot(glm::vec3(plane), p0), glm::dot(glm::vec3(plane), p1)), glm::dot(glm::vec3(plane), p2)) + plane.w >= 0.0f;
+					}
+					if (facing && inside){
+						trianglesFacing++;
+						missing += kept[m] ? 0 : 1;
+					}
+				}
+			}
+		}
+		std::cout << "  " << views << " views: " << 100.0 * meshletsKept / (static_cast<double>(meshlets.size()) * views) << "% of meshlets kept, "
+			<< 100.0 * trianglesKept / (indices.size() / 3.0 * views) << "% of triangles drawn, "
+			<< 100.0 * trianglesFacing / (indices.size() / 3.0 * views) << "% actually facing and in view, "
+			<< cullMs * 1000.0 / views << " us per cull" << std::defaultfloat << (missing ? " MISSING TRIANGLES: " + std::to_string(missing) : std::string()) << std::endl;
+	}
+
+	struct Benchmark{
+		const char* name;
+		void (*function)();
+	};
+
+	// a frame of 2D sprites, no Vulkan, the vertices go into plain memory. a few layers and a few dozen textures
+	// drawn in a random order, the worst case for batching, then the same number all on one texture
+	static void BenchSpriteBatch(){
+		const uint32_t spriteCount = 200000;
+		const uint32_t textureCount = 64;
+		const uint32_t layerCount = 3;
+
+		std::vector<SESprite> frame(spriteCount);
+		uint32_t seed = 1;
+		auto next = [&seed] { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+		for (auto& sprite : frame){
+			sprite.position = glm::vec2(next() % 1920, next() % 1080);
+			sprite.size = glm::vec2(8.0f + next() % 56, 8.0f + next() % 56);
+			sprite.rotation = next() % 4 == 0 ? (next() % 628) * 0.01f : 0.0f;
+			sprite.uvRect = glm::vec4(0.0f, 0.0f, 0.5f, 0.5f);
+			sprite.color = 0xff000000 | next();
+			sprite.texture = next() % textureCount;
+			sprite.layer = static_cast<uint8_t>(next() % layerCount);
+		}
+
+		SESpriteBatch batch;
+		std::vector<SESpriteVertex> vertices(spriteCount * 4);
+		const char* caseNames[] = { "64 textures, 3 layers", "1 texture" };
+		for (int c = 0; c < 2; c++){
+			if (c == 1){
+				for (auto& sprite : frame){
+					sprite.texture = 0;
+					sprite.layer = 0;
+				}
+			}
+
+			double drawMs = 1e30;
+			double buildMs = 1e30;
+			for (int run = 0; run < 5; run++){
+				auto start = BenchClock::now();
+				for (const auto& sprite : frame){
+					batch.Draw(sprite);
+				}
+				drawMs = std::min(drawMs, ElapsedMs(start));
+				start = BenchClock::now();
+				batch.Build(vertices.data(), spriteCount);
+				buildMs = std::min(buildMs, ElapsedMs(start));
+			}
+
+			// the batches have to come out in layer, then texture order, with each texture in the order it was drawn
+			std::vector<uint32_t> expected(spriteCount);
+			for (uint32_t i = 0; i < spriteCount; i++){
+				expected[i] = i;
+			}
+			std::stable_sort(expected.begin(), expected.end(), [&frame](uint32_t a, uint32_t b) {
+				return frame[a].layer != frame[b].layer ? frame[a].layer < frame[b].layer : frame[a].texture < frame[b].texture;
+			});
+			uint32_t wrong = 0;
+			for (uint32_t i = 0; i < spriteCount; i++){
+				const SESprite& sprite = frame[expected[i]];
+				glm::vec2 center = (vertices[i * 4].pos + vertices[i * 4 + 2].pos) * 0.5f;
+				wrong += glm::length(center - sprite.position) > 0.01f || vertices[i * 4].color != sprite.color ? 1 : 0;
+			}
+
+			std::cout << "sprites.batch, " << caseNames[c] << ": " << spriteCount << " sprites in " << batch.GetBatchCount() << " draws, "
+				<< std::fixed << std::setprecision(2) << drawMs << " ms drawing, " << buildMs << " ms sorting and writing "
+				<< spriteCount * 4 * sizeof(SESpriteVertex) / (1024.0 * 1024.0) << " MB" << std::defaultfloat
+				<< (wrong ? " OUT OF ORDER: " + std::to_string(wrong) : std::string()) << std::endl;
+		}
+	}
+
+	// a 4096 by 4096 map of patchy regions with some single odd tiles in them. meshes every chunk, then rebuilds
+	// only the ones a thousand scattered edits touched, then culls a 1080p view panned around at two zoom levels
+	static void BenchTilemap(){
+		const uint32_t mapSize = 4096;
+		const uint32_t editCount = 1000;
+
+		SETilemap tilemap;
+		tilemap.Create(mapSize, mapSize);
+		uint32_t seed = 1;
+		auto next = [&seed] { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+		uint64_t filledTiles = 0;
+		for (uint32_t y = 0; y < mapSize; y++){
+			for (uint32_t x = 0; x < mapSize; x++){
+				uint32_t region = ((x >> 3) * 73856093u) ^ ((y >> 3) * 19349663u);
+				uint16_t tile = static_cast<uint16_t>((region >> 4) % 5);
+				if (tile != SE_TILE_EMPTY && next() % 16 == 0){
+					tile = static_cast<uint16_t>(5 + next() % 3);
+				}
+				tilemap.SetTile(x, y, tile);
+				filledTiles += tile != SE_TILE_EMPTY ? 1 : 0;
+			}
+		}
+
+		uint32_t chunkCount = tilemap.GetChunkCount();
+		std::vector<Vertex> vertices(SE_TILEMAP_CHUNK_QUADS * 4);
+		std::vector<uint32_t> builtVersions(chunkCount);
+		uint64_t quadCount = 0;
+		uint64_t coveredTiles = 0;
+		auto start = BenchClock::now();
+		for (uint32_t chunk = 0; chunk < chunkCount; chunk++){
+			uint32_t quads = tilemap.BuildChunk(chunk, vertices.data());
+			builtVersions[chunk] = tilemap.GetChunkVersion(chunk);
+			quadCount += quads;
+			for (uint32_t i = 0; i < quads; i++){
+				glm::vec2 size = vertices[i * 4 + 2].pos - vertices[i * 4].pos;
+				coveredTiles += static_cast<uint64_t>(size.x * size.y);
+			}
+		}
+		double fullMs = ElapsedMs(start);
+
+		for (uint32_t i = 0; i < editCount; i++){
+			tilemap.SetTile(next() % mapSize, next() % mapSize, static_cast<uint16_t>(next() % 8));
+		}
+		uint32_t rebuilt = 0;
+		start = BenchClock::now();
+		for (uint32_t chunk = 0; chunk < chunkCount; chunk++){
+			if (builtVersions[chunk] != tilemap.GetChunkVersion(chunk)){
+				tilemap.BuildChunk(chunk, vertices.data());
+				builtVersions[chunk] = tilemap.GetChunkVersion(chunk);
+				rebuilt++;
+			}
+		}
+		double dirtyMs = ElapsedMs(start);
+
+		std::cout << "tilemap.chunks: " << mapSize << "x" << mapSize << " tiles, " << chunkCount << " chunks meshed to " << quadCount
+			<< " quads in " << std::fixed << std::setprecision(2) << fullMs << " ms, " << editCount << " edits rebuilt " << rebuilt
+			<< " chunks in " << dirtyMs << " ms" << std::defaultfloat
+			<< (coveredTiles != filledTiles ? " WRONG COVERAGE: " + std::to_string(coveredTiles) + " of " + std::to_string(filledTiles) : std::string()) << std::endl;
+
+		const float tilePixels[] = { 32.0f, 4.0f };
+		for (float pixels : tilePixels){
+			const int views = 10000;
+			std::vector<uint32_t> visible;
+			uint64_t visibleTotal = 0;
+			glm::vec2 viewSize(1920.0f / pixels, 1080.0f / pixels);
+			double cullMs = BestOf(5, [&] {
+				visibleTotal = 0;
+				for (int i = 0; i < views; i++){
+					glm::vec2 min(static_cast<float>(next() % mapSize), static_cast<float>(next() % mapSize));
+					tilemap.GetChunksInRect(min, min + viewSize, visible);
+					visibleTotal += visible.size();
+				}
+			});
+			std::cout << "tilemap.chunks, 1080p at " << pixels << " px a tile: " << std::fixed << std::setprecision(2)
+				<< visibleTotal / static_cast<double>(views) << " chunks in view, " << std::setprecision(3) << cullMs * 1000.0 / views
+				<< " us a cull" << std::defaultfloat << std::endl;
+		}
+	}
+
+	// the first of these that exists, the benchmarks have no font of their own
+	static const char* benchFonts[] = {
+		"C:/Windows/Fonts/consola.ttf",
+		"C:/Windows/Fonts/arial.ttf",
+		"/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+	};
+
+	// rasterizing and packing the atlas at a small and a large size, then a frame of a thousand different strings
+	// laid out from scratch and the same frame again out of the cache, into a sprite batch with no Vulkan behind it
+	static void BenchText(){
+		const uint32_t stringCount = 1000;
+		const float pixelHeights[] = { 16.0f, 48.0f };
+
+		SETextRenderer text;
+		const char* fontPath = nullptr;
+		for (const char* path : benchFonts){
+			try{
+				text.Load(path, pixelHeights[0]);
+				fontPath = path;
+				break;
+			}
+			catch (const std::runtime_error&){
+			}
+		}
+		if (!fontPath){
+			std::cout << "text.layout: no font found, skipped" << std::endl;
+			return;
+		}
+
+		for (float pixelHeight : pixelHeights){
+			double loadMs = BestOf(5, [&] { text.Load(fontPath, pixelHeight); });
+			const SEGlyphAtlas& atlas = text.GetAtlas();
+			float occupancy = 0.0f;
+			for (uint32_t page = 0; page < atlas.GetPageCount(); page++){
+				occupancy += atlas.GetPageOccupancy(page) / atlas.GetPageCount();
+			}
+			std::cout << "text.layout, " << pixelHeight << " px atlas: " << atlas.GetGlyphCount() << " glyphs rasterized and packed into "
+				<< atlas.GetPageCount() << " pages in " << std::fixed << std::setprecision(2) << loadMs << " ms, " << occupancy * 100.0f
+				<< "% packed" << std::defaultfloat << std::endl;
+		}
+
+		text.Load(fontPath, pixelHeights[0]);
+		std::vector<std::string> strings(stringCount);
+		uint32_t seed = 1;
+		auto next = [&seed] { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+		for (auto& string : strings){
+			uint32_t length = 20 + next() % 40;
+			for (uint32_t i = 0; i < length; i++){
+				string += next() % 6 == 0 ? ' ' : static_cast<char>('!' + next() % 94);
+			}
+		}
+
+		SESpriteBatch batch;
+		std::vector<SESpriteVertex> vertices(stringCount * 60 * 4);
+		double missMs = 0.0;
+		double hitMs = 1e30;
+		for (int run = 0; run < 6; run++){
+			// the first run misses on every string, the rest hit
+			auto start = BenchClock::now();
+			for (uint32_t i = 0; i < stringCount; i++){
+				text.Draw(&batch, strings[i], glm::vec2(0.0f, i * 16.0f));
+			}
+			double ms = ElapsedMs(start);
+			if (run == 0){
+				missMs = ms;
+			}
+			else{
+				hitMs = std::min(hitMs, ms);
+			}
+			text.EndFrame();
+			batch.Build(vertices.data(), stringCount * 60);
+		}
+		uint64_t glyphCount = text.GetStats().glyphs / text.GetStats().frames;
+
+		std::cout << "text.layout, " << stringCount << " strings of " << glyphCount << " glyphs: " << std::fixed << std::setprecision(2)
+			<< missMs << " ms laid out, " << hitMs << " ms cached, " << batch.GetBatchCount() << " draws for "
+			<< text.GetAtlas().GetPageCount() << " pages" << std::defaultfloat << std::endl;
+	}
+
+	static const Benchmark benchmarks[] = {
+		{ "jobs.spawn", BenchJobSpawn },
+		{ "jobs.steal", BenchJobSteal },
+		{ "jobs.parallel_for", BenchParallelFor },
+		{ "pipelines.dedup", BenchPipelineDedup },
+		{ "textures.bc_encode", BenchBlockEncode },
+		{ "textures.bc_quality", BenchBlockQuality },
+		{ "rendergraph.compile", BenchRenderGraph },
+		{ "culling.frustum", BenchFrustumCull },
+		{ "culling.occlusion", BenchOcclusionCull },
+		{ "bvh.build", BenchBvhBuild },
+		{ "bvh.query", BenchBvhQuery },
+		{ "mesh.lod", BenchMeshLod },
+		{ "mesh.meshlets", BenchMeshlets },
+		{ "sprites.batch", BenchSpriteBatch },
+		{ "tilemap.chunks", BenchTilemap },
+		{ "text.layout", BenchText },
+	};
+
+	int RunBenchmarks(const std::string& filter){
+		int ran = 0;
+		for (const auto& benchmark : benchmarks){
+			if (std::string(benchmark.name).compare(0, filter.size(), filter) == 0){
+				benchmark.function();
+				ran++;
+			}
+		}
+
+		if (ran == 0){
+			std::cerr << "No benchmarks match '" << filter << "'" << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+}
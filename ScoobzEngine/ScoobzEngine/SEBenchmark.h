@@ -0,0 +1,9 @@
+#pragma once
+#include <string>
+
+namespace ScoobzEngine {
+
+	// CPU micro benchmarks for engine systems, TombGame runs these with --bench [filter].
+	// a benchmark runs if its name starts with the filter, an empty filter runs everything
+	int RunBenchmarks(const std::string&);
+}
@@ -0,0 +1,260 @@
+#include "SEBindlessTable.h"
+#include <algorithm>
+
+namespace ScoobzEngine {
+
+	SEBindlessTable::SEBindlessTable(){}
+	SEBindlessTable::~SEBindlessTable(){}
+
+	void SEBindlessTable::Slots::Create(uint32_t capacity, uint32_t framesInFlight){
+		free.clear();
+		for (uint32_t i = capacity; i > 0; i--){
+			free.push_back(i - 1);
+		}
+		retired.assign(framesInFlight, std::vector<uint32_t>());
+		used.assign(capacity, false);
+	}
+
+	uint32_t SEBindlessTable::Slots::Allocate(){
+		if (free.empty()){
+			throw std::runtime_error("Bindless table is full");
+		}
+		uint32_t index = free.back();
+		free.pop_back();
+		used[index] = true;
+		return index;
+	}
+
+	void SEBindlessTable::Slots::Retire(uint32_t index, uint32_t frame){
+		if (index >= used.size() || !used[index]){
+			throw std::runtime_error("Bindless index " + std::to_string(index) + " isnt in use");
+		}
+		used[index] = false;
+		retired[frame].push_back(index);
+	}
+
+	void SEBindlessTable::Slots::Release(uint32_t frame){
+		free.insert(free.end(), retired[frame].begin(), retired[frame].end());
+		retired[frame].clear();
+	}
+
+	void SEBindlessTable::Create(const VkDevice* logicalDevice, const VkPhysicalDevice* physicalDevice, uint32_t imageCapacity,
+		uint32_t bufferCapacity, uint32_t framesInFlight, bool descriptorIndexing){
+		device = logicalDevice;
+
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(*physicalDevice, &deviceProperties);
+		const VkPhysicalDeviceLimits& limits = deviceProperties.limits;
+
+		// the per-draw object buffer is a storage buffer too, leave room for it
+		imageCapacity = std::min({ imageCapacity, limits.maxPerStageDescriptorSampledImages, limits.maxDescriptorSetSampledImages });
+		bufferCapacity = std::min({ bufferCapacity, limits.maxPerStageDescriptorStorageBuffers - 1, limits.maxDescriptorSetStorageBuffers - 1 });
+
+		images.assign(imageCapacity, VkDescriptorImageInfo());
+		buffers.assign(bufferCapacity, VkDescriptorBufferInfo());
+		imageSlots.Create(imageCapacity, framesInFlight);
+		bufferSlots.Create(bufferCapacity, framesInFlight);
+
+		VkDescriptorSetLayoutBinding bindings[2] = {};
+		bindings[0].binding = IMAGE_BINDING;
+		bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		bindings[0].descriptorCount = imageCapacity;
+		bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		bindings[1].binding = BUFFER_BINDING;
+		bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[1].descriptorCount = bufferCapacity;
+		bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = 2;
+		layoutInfo.pBindings = bindings;
+
+#ifdef VK_EXT_descriptor_indexing
+		// slots nobody has filled yet are fine as long as no shader reads them
+		VkDescriptorBindingFlagsEXT bindingFlags[2] = { VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT, VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT };
+		VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo = {};
+		bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+		bindingFlagsInfo.bindingCount = 2;
+		bindingFlagsInfo.pBindingFlags = bindingFlags;
+		if (descriptorIndexing){
+			layoutInfo.pNext = &bindingFlagsInfo;
+			partiallyBound = true;
+		}
+#else
+		(void)descriptorIndexing;
+#endif
+
+		if (vkCreateDescriptorSetLayout(*device, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS){
+			throw std::runtime_error("Failed to create bindless descriptor set layout");
+		}
+
+		VkDescriptorPoolSize poolSizes[2] = {};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		poolSizes[0].descriptorCount = imageCapacity * framesInFlight;
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSizes[1].descriptorCount = bufferCapacity * framesInFlight;
+
+		VkDescriptorPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.maxSets = framesInFlight;
+		poolInfo.poolSizeCount = 2;
+		poolInfo.pPoolSizes = poolSizes;
+
+		if (vkCreateDescriptorPool(*device, &poolInfo, nullptr, &pool) != VK_SUCCESS){
+			throw std::runtime_error("Failed to create bindless descriptor pool");
+		}
+
+		frames.resize(framesInFlight);
+		for (auto& frame : frames){
+			VkDescriptorSetAllocateInfo allocInfo = {};
+			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			allocInfo.descriptorPool = pool;
+			allocInfo.descriptorSetCount = 1;
+			allocInfo.pSetLayouts = &setLayout;
+
+			if (vkAllocateDescriptorSets(*device, &allocInfo, &frame.set) != VK_SUCCESS){
+				throw std::runtime_error("Failed to allocate bindless descriptor set");
+			}
+		}
+
+		std::cout << "Bindless Table Creation: SUCCESSFUL! (" << imageCapacity << " images, " << bufferCapacity << " buffers"
+			<< (partiallyBound ? ", descriptor indexing)" : ")") << std::endl;
+	}
+
+	void SEBindlessTable::Cleanup(){
+		vkDestroyDescriptorPool(*device, pool, VK_NULL_HANDLE);
+		vkDestroyDescriptorSetLayout(*device, setLayout, VK_NULL_HANDLE);
+		frames.clear();
+	}
+
+	uint32_t SEBindlessTable::AddImage(VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout){
+		uint32_t index = imageSlots.Allocate();
+		images[index].imageView = imageView;
+		images[index].sampler = sampler;
+		images[index].imageLayout = imageLayout;
+		MarkImage(index);
+		return index;
+	}
+
+	uint32_t SEBindlessTable::AddBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range){
+		uint32_t index = bufferSlots.Allocate();
+		buffers[index].buffer = buffer;
+		buffers[index].offset = offset;
+		buffers[index].range = range;
+		MarkBuffer(index);
+		return index;
+	}
+
+	void SEBindlessTable::UpdateImage(uint32_t index, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout){
+		if (index >= images.size() || !imageSlots.used[index]){
+			throw std::runtime_error("Bindless index " + std::to_string(index) + " isnt in use");
+		}
+		images[index].imageView = imageView;
+		images[index].sampler = sampler;
+		images[index].imageLayout = imageLayout;
+		MarkImage(index);
+	}
+
+	void SEBindlessTable::RemoveImage(uint32_t index){
+		imageSlots.Retire(index, currentSlot);
+	}
+
+	void SEBindlessTable::RemoveBuffer(uint32_t index){
+		bufferSlots.Retire(index, currentSlot);
+	}
+
+	void SEBindlessTable::SetDefaultImage(VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout){
+		defaultImage.imageView = imageView;
+		defaultImage.sampler = sampler;
+		defaultImage.imageLayout = imageLayout;
+		for (uint32_t i = 0; i < images.size(); i++){
+			if (!imageSlots.used[i]){
+				MarkImage(i);
+			}
+		}
+	}
+
+	void SEBindlessTable::SetDefaultBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range){
+		defaultBuffer.buffer = buffer;
+		defaultBuffer.offset = offset;
+		defaultBuffer.range = range;
+		for (uint32_t i = 0; i < buffers.size(); i++){
+			if (!bufferSlots.used[i]){
+				MarkBuffer(i);
+			}
+		}
+	}
+
+	void SEBindlessTable::MarkImage(uint32_t index){
+		for (auto& frame : frames){
+			frame.dirtyImages.push_back(index);
+		}
+	}
+
+	void SEBindlessTable::MarkBuffer(uint32_t index){
+		for (auto& frame : frames){
+			frame.dirtyBuffers.push_back(index);
+		}
+	}
+
+	void SEBindlessTable::BeginFrame(uint32_t slot){
+		currentSlot = slot;
+
+		// slots this frame retired last time round now have no frame in flight reading them
+		for (uint32_t index : imageSlots.retired[slot]){
+			if (!partiallyBound){
+				MarkImage(index);
+			}
+		}
+		for (uint32_t index : bufferSlots.retired[slot]){
+			if (!partiallyBound){
+				MarkBuffer(index);
+			}
+		}
+		imageSlots.Release(slot);
+		bufferSlots.Release(slot);
+
+		// this frames copy of the set isnt in use anymore, bring it up to date
+		Frame& frame = frames[slot];
+		std::vector<VkWriteDescriptorSet> writes;
+		writes.reserve(frame.dirtyImages.size() + frame.dirtyBuffers.size());
+
+		for (uint32_t index : frame.dirtyImages){
+			const VkDescriptorImageInfo* info = imageSlots.used[index] ? &images[index] : &defaultImage;
+			if (info->imageView == VK_NULL_HANDLE){
+				continue;
+			}
+			VkWriteDescriptorSet write = {};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = frame.set;
+			write.dstBinding = IMAGE_BINDING;
+			write.dstArrayElement = index;
+			write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			write.descriptorCount = 1;
+			write.pImageInfo = info;
+			writes.push_back(write);
+		}
+		for (uint32_t index : frame.dirtyBuffers){
+			const VkDescriptorBufferInfo* info = bufferSlots.used[index] ? &buffers[index] : &defaultBuffer;
+			if (info->buffer == VK_NULL_HANDLE){
+				continue;
+			}
+			VkWriteDescriptorSet write = {};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = frame.set;
+			write.dstBinding = BUFFER_BINDING;
+			write.dstArrayElement = index;
+			write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			write.descriptorCount = 1;
+			write.pBufferInfo = info;
+			writes.push_back(write);
+		}
+
+		if (!writes.empty()){
+			vkUpdateDescriptorSets(*device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+		}
+		frame.dirtyImages.clear();
+		frame.dirtyBuffers.clear();
+	}
+}
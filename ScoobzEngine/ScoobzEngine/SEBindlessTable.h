@@ -0,0 +1,88 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ScoobzEngine {
+
+	// one big array of sampled images and one of storage buffers, bound once per frame. materials hold indices
+	// into them instead of descriptor sets, so draws only push an index.
+	// indices are stable until removed, and a removed index isnt handed out again until every frame in flight that
+	// could still read it has finished. each frame in flight has its own copy of the set and changes reach it at
+	// its BeginFrame, so nothing is ever written while the GPU might be reading it.
+	// with descriptor indexing unused slots can stay empty, without it every slot a shader can reach has to hold
+	// something valid, so unused slots point at the defaults
+	class SEBindlessTable{
+
+	public:
+		SEBindlessTable();~SEBindlessTable();
+
+		//FUNCTIONS :: PUBLIC
+		// image and buffer capacity are clamped to the device limits. the bool is whether descriptor indexing was enabled
+		void Create(const VkDevice*, const VkPhysicalDevice*, uint32_t, uint32_t, uint32_t, bool);
+		void Cleanup();
+		// a new index can be drawn with from the next frame on
+		uint32_t AddImage(VkImageView, VkSampler, VkImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		uint32_t AddBuffer(VkBuffer, VkDeviceSize = 0, VkDeviceSize = VK_WHOLE_SIZE);
+		// points a used index at a different image, each frame picks it up at its BeginFrame so the old view has to
+		// outlive the frames in flight too
+		void UpdateImage(uint32_t, VkImageView, VkSampler, VkImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		// the resource itself has to outlive the frames in flight, push its destruction to the deletion queue
+		void RemoveImage(uint32_t);
+		void RemoveBuffer(uint32_t);
+		// what empty slots point at, only needed without descriptor indexing
+		void SetDefaultImage(VkImageView, VkSampler, VkImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		void SetDefaultBuffer(VkBuffer, VkDeviceSize = 0, VkDeviceSize = VK_WHOLE_SIZE);
+		// call right after waiting on the slots fence
+		void BeginFrame(uint32_t);
+
+		//Getters
+		VkDescriptorSetLayout GetLayout() { return setLayout; }
+		VkDescriptorSet GetSet(uint32_t slot) { return frames[slot].set; }
+		uint32_t GetImageCapacity() { return static_cast<uint32_t>(images.size()); }
+		uint32_t GetBufferCapacity() { return static_cast<uint32_t>(buffers.size()); }
+
+		static const uint32_t IMAGE_BINDING = 0;
+		static const uint32_t BUFFER_BINDING = 1;
+
+	private:
+		// a slot allocator with deferred frees, shared by the image and buffer arrays
+		struct Slots{
+			std::vector<uint32_t> free; // popped from the back, so low indices go first
+			std::vector<std::vector<uint32_t>> retired; // per frame in flight, freed at that frames next BeginFrame
+			std::vector<bool> used;
+
+			void Create(uint32_t, uint32_t);
+			uint32_t Allocate();
+			void Retire(uint32_t, uint32_t);
+			void Release(uint32_t);
+		};
+
+		struct Frame{
+			VkDescriptorSet set = VK_NULL_HANDLE;
+			std::vector<uint32_t> dirtyImages;
+			std::vector<uint32_t> dirtyBuffers;
+		};
+
+		void MarkImage(uint32_t);
+		void MarkBuffer(uint32_t);
+
+		const VkDevice* device = nullptr;
+		bool partiallyBound = false;
+		VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+		VkDescriptorPool pool = VK_NULL_HANDLE;
+
+		std::vector<VkDescriptorImageInfo> images; // what each slot holds now, the frames copies catch up at BeginFrame
+		std::vector<VkDescriptorBufferInfo> buffers;
+		VkDescriptorImageInfo defaultImage = {};
+		VkDescriptorBufferInfo defaultBuffer = {};
+		Slots imageSlots;
+		Slots bufferSlots;
+
+		std::vector<Frame> frames;
+		uint32_t currentSlot = 0;
+	};
+}
@@ -0,0 +1,862 @@
+#include "SEBlockCompress.h"
+#include "SEJobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+// x64 always has SSE2, 32 bit MSVC only with /arch:SSE2 or above
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define SE_BLOCK_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace ScoobzEngine {
+
+	// a block is 16 rgba8 texels, row by row, 64 bytes
+	static const uint32_t BLOCK_TEXELS = 16;
+
+	// BC7 4 bit index weights out of 64
+	static const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	const char* GetBlockFormatName(SEBlockFormat format){
+		switch (format){
+		case SE_BLOCK_BC1: return "BC1";
+		case SE_BLOCK_BC3: return "BC3";
+		case SE_BLOCK_BC5: return "BC5";
+		case SE_BLOCK_BC7: return "BC7";
+		default: return "RGBA8";
+		}
+	}
+
+	VkFormat GetBlockVkFormat(SEBlockFormat format, bool srgb){
+		switch (format){
+		case SE_BLOCK_BC1: return srgb ? VK_FORMAT_BC1_RGBA_SRGB_BLOCK : VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+		case SE_BLOCK_BC3: return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+		case SE_BLOCK_BC5: return srgb ? VK_FORMAT_UNDEFINED : VK_FORMAT_BC5_UNORM_BLOCK;
+		case SE_BLOCK_BC7: return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+		default: return srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+		}
+	}
+
+	uint32_t GetBlockBytes(SEBlockFormat format){
+		switch (format){
+		case SE_BLOCK_BC1: return 8;
+		case SE_BLOCK_BC3:
+		case SE_BLOCK_BC5:
+		case SE_BLOCK_BC7: return 16;
+		default: return 4;
+		}
+	}
+
+	size_t GetLevelSize(SEBlockFormat format, uint32_t width, uint32_t height){
+		if (format == SE_BLOCK_RGBA8){
+			return static_cast<size_t>(width) * height * 4;
+		}
+		return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * GetBlockBytes(format);
+	}
+
+	bool IsBlockFormatSupported(VkPhysicalDevice physicalDevice, SEBlockFormat format, bool srgb){
+		VkFormat vkFormat = GetBlockVkFormat(format, srgb);
+		if (vkFormat == VK_FORMAT_UNDEFINED){
+			return false;
+		}
+
+		// every BC format hangs off the one feature, the engine enables it whenever its there
+		if (format != SE_BLOCK_RGBA8){
+			VkPhysicalDeviceFeatures features;
+			vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+			if (!features.textureCompressionBC){
+				return false;
+			}
+		}
+
+		VkFormatProperties formatProperties;
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, vkFormat, &formatProperties);
+		return (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+	}
+
+	SEBlockFormat SelectBlockFormat(VkPhysicalDevice physicalDevice, SETextureUsage usage, bool srgb){
+		std::vector<SEBlockFormat> candidates;
+		switch (usage){
+		case SE_TEXTURE_NORMAL:
+			candidates = { SE_BLOCK_BC5, SE_BLOCK_BC7 };
+			srgb = false;
+			break;
+		case SE_TEXTURE_COLOR_ALPHA:
+			candidates = { SE_BLOCK_BC7, SE_BLOCK_BC3 };
+			break;
+		default:
+			candidates = { SE_BLOCK_BC7, SE_BLOCK_BC1 };
+			break;
+		}
+
+		for (SEBlockFormat format : candidates){
+			if (IsBlockFormatSupported(physicalDevice, format, srgb)){
+				return format;
+			}
+		}
+		return SE_BLOCK_RGBA8;
+	}
+
+	//BLOCK HELPERS
+
+	// edge blocks repeat the last row and column so they dont pull the endpoints towards black
+	static void LoadBlock(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t* block){
+		for (uint32_t y = 0; y < 4; y++){
+			uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+			for (uint32_t x = 0; x < 4; x++){
+				uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+				memcpy(block + (y * 4 + x) * 4, pixels + (static_cast<size_t>(sourceY) * width + sourceX) * 4, 4);
+			}
+		}
+	}
+
+	static void StoreBlock(const uint8_t* block, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t* pixels){
+		for (uint32_t y = 0; y < 4 && blockY * 4 + y < height; y++){
+			for (uint32_t x = 0; x < 4 && blockX * 4 + x < width; x++){
+				memcpy(pixels + (static_cast<size_t>(blockY * 4 + y) * width + blockX * 4 + x) * 4, block + (y * 4 + x) * 4, 4);
+			}
+		}
+	}
+
+	// per channel min and max over the block
+	static void BlockBounds(const uint8_t* block, uint8_t* low, uint8_t* high){
+#ifdef SE_BLOCK_SSE2
+		__m128i row0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+		__m128i row1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16));
+		__m128i row2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 32));
+		__m128i row3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 48));
+		__m128i minimum = _mm_min_epu8(_mm_min_epu8(row0, row1), _mm_min_epu8(row2, row3));
+		__m128i maximum = _mm_max_epu8(_mm_max_epu8(row0, row1), _mm_max_epu8(row2, row3));
+		// fold the four texels in a register down to one
+		minimum = _mm_min_epu8(minimum, _mm_shuffle_epi32(minimum, _MM_SHUFFLE(1, 0, 3, 2)));
+		maximum = _mm_max_epu8(maximum, _mm_shuffle_epi32(maximum, _MM_SHUFFLE(1, 0, 3, 2)));
+		minimum = _mm_min_epu8(minimum, _mm_shuffle_epi32(minimum, _MM_SHUFFLE(2, 3, 0, 1)));
+		maximum = _mm_max_epu8(maximum, _mm_shuffle_epi32(maximum, _MM_SHUFFLE(2, 3, 0, 1)));
+		uint32_t packedLow = static_cast<uint32_t>(_mm_cvtsi128_si32(minimum));
+		uint32_t packedHigh = static_cast<uint32_t>(_mm_cvtsi128_si32(maximum));
+		memcpy(low, &packedLow, 4);
+		memcpy(high, &packedHigh, 4);
+#else
+		for (uint32_t c = 0; c < 4; c++){
+			low[c] = 255;
+			high[c] = 0;
+		}
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+			for (uint32_t c = 0; c < 4; c++){
+				low[c] = std::min(low[c], block[i * 4 + c]);
+				high[c] = std::max(high[c], block[i * 4 + c]);
+			}
+		}
+#endif
+	}
+
+	// dot((texel - origin), direction) for every texel, the position of each along the endpoint line
+	static void ProjectBlock(const uint8_t* block, const int* origin, const int* direction, int32_t* dots){
+#ifdef SE_BLOCK_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i originWide = _mm_setr_epi16(
+			static_cast<short>(origin[0]), static_cast<short>(origin[1]), static_cast<short>(origin[2]), static_cast<short>(origin[3]),
+			static_cast<short>(origin[0]), static_cast<short>(origin[1]), static_cast<short>(origin[2]), static_cast<short>(origin[3]));
+		const __m128i directionWide = _mm_setr_epi16(
+			static_cast<short>(direction[0]), static_cast<short>(direction[1]), static_cast<short>(direction[2]), static_cast<short>(direction[3]),
+			static_cast<short>(direction[0]), static_cast<short>(direction[1]), static_cast<short>(direction[2]), static_cast<short>(direction[3]));
+
+		for (uint32_t i = 0; i < 4; i++){
+			__m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+			// widen to 16 bits, two texels per register, and multiply-add channel pairs: [t0 rg, t0 ba, t1 rg, t1 ba]
+			__m128i front = _mm_madd_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(texels, zero), originWide), directionWide);
+			__m128i back = _mm_madd_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(texels, zero), originWide), directionWide);
+			// regroup so the halves of each texel line up and add them
+			front = _mm_shuffle_epi32(front, _MM_SHUFFLE(3, 1, 2, 0));
+			back = _mm_shuffle_epi32(back, _MM_SHUFFLE(3, 1, 2, 0));
+			__m128i sum = _mm_add_epi32(_mm_unpacklo_epi64(front, back), _mm_unpackhi_epi64(front, back));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dots + i * 4), sum);
+		}
+#else
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+			int32_t dot = 0;
+			for (uint32_t c = 0; c < 4; c++){
+				dot += (block[i * 4 + c] - origin[c]) * direction[c];
+			}
+			dots[i] = dot;
+		}
+#endif
+	}
+
+	// squared error over the channels in the mask
+	static uint32_t BlockError(const uint8_t* block, const uint8_t* decoded, uint32_t channelMask){
+		uint32_t error = 0;
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+			for (uint32_t c = 0; c < 4; c++){
+				if (channelMask & (1 << c)){
+					int difference = block[i * 4 + c] - decoded[i * 4 + c];
+					error += difference * difference;
+				}
+			}
+		}
+		return error;
+	}
+
+	// least squares endpoints for a fixed set of weights, weights[i] is how far texel i sits from the first
+	// endpoint towards the second. false when every texel has the same weight and theres nothing to solve
+	static bool RefineEndpoints(const uint8_t* block, uint32_t channels, const float* weights, int* first, int* second){
+		float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		float ax[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float bx[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+			float b = weights[i];
+			float a = 1.0f - b;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for (uint32_t c = 0; c < channels; c++){
+				ax[c] += a * block[i * 4 + c];
+				bx[c] += b * block[i * 4 + c];
+			}
+		}
+
+		float determinant = aa * bb - ab * ab;
+		if (std::fabs(determinant) < 1e-6f){
+			return false;
+		}
+		for (uint32_t c = 0; c < channels; c++){
+			float e0 = (ax[c] * bb - bx[c] * ab) / determinant;
+			float e1 = (bx[c] * aa - ax[c] * ab) / determinant;
+			first[c] = std::min(std::max(static_cast<int>(e0 + 0.5f), 0), 255);
+			second[c] = std::min(std::max(static_cast<int>(e1 + 0.5f), 0), 255);
+		}
+		return true;
+	}
+
+	// the bounding box pulled in by a sixteenth of its size, most texels sit well inside it
+	static void InsetBounds(const uint8_t* low8, const uint8_t* high8, uint32_t channels, int* low, int* high){
+		for (uint32_t c = 0; c < channels; c++){
+			int inset = (high8[c] - low8[c]) >> 4;
+			low[c] = low8[c] + inset;
+			high[c] = high8[c] - inset;
+		}
+	}
+
+	// 128 bits written least significant first, for BC7
+	struct BitStream{
+		uint64_t bits[2] = { 0, 0 };
+		uint32_t position = 0;
+
+		void Write(uint64_t value, uint32_t count){
+			if (position < 64){
+				bits[0] |= value << position;
+				if (position + count > 64){
+					bits[1] |= value >> (64 - position);
+				}
+			}
+			else{
+				bits[1] |= value << (position - 64);
+			}
+			position += count;
+		}
+
+		uint32_t Read(uint32_t count){
+			uint64_t value;
+			if (position >= 64){
+				value = bits[1] >> (position - 64);
+			}
+			else{
+				value = bits[0] >> position;
+				if (position + count > 64){
+					value |= bits[1] << (64 - position);
+				}
+			}
+			position += count;
+			return static_cast<uint32_t>(value & ((1ull << count) - 1));
+		}
+	};
+
+	//BC1
+
+	static uint16_t To565(const int* color){
+		return static_cast<uint16_t>(((color[0] * 31 + 127) / 255) << 11 | ((color[1] * 63 + 127) / 255) << 5 | ((color[2] * 31 + 127) / 255));
+	}
+
+	static void From565(uint16_t packed, int* color){
+		int r = packed >> 11, g = (packed >> 5) & 63, b = packed & 31;
+		color[0] = (r << 3) | (r >> 2);
+		color[1] = (g << 2) | (g >> 4);
+		color[2] = (b << 3) | (b >> 2);
+		color[3] = 0;
+	}
+
+	// BC3 ignores the endpoint order and always interpolates, so fourColour is set for it
+	static void DecodeBC1Block(const uint8_t* in, uint8_t* block, bool fourColour){
+		uint16_t c0 = static_cast<uint16_t>(in[0] | in[1] << 8);
+		uint16_t c1 = static_cast<uint16_t>(in[2] | in[3] << 8);
+		uint32_t indices = in[4] | in[5] << 8 | in[6] << 16 | static_cast<uint32_t>(in[7]) << 24;
+
+		int palette[4][4];
+		From565(c0, palette[0]);
+		From565(c1, palette[1]);
+		palette[0][3] = palette[1][3] = 255;
+		for (uint32_t c = 0; c < 3; c++){
+			if (c0 > c1 || fourColour){
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+			else{
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+		palette[2][3] = 255;
+		palette[3][3] = (c0 > c1 || fourColour) ? 255 : 0;
+
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+			const int* colour = palette[(indices >> (i * 2)) & 3];
+			for (uint32_t c = 0; c < 4; c++){
+				block[i * 4 + c] = static_cast<uint8_t>(colour[c]);
+			}
+		}
+	}
+
+	// always the four colour mode, c0 > c1, so it means the same inside BC3
+	static void EncodeBC1(const uint8_t* block, const int* high, const int* low, uint8_t* out){
+		uint16_t c0 = To565(high);
+		uint16_t c1 = To565(low);
+		if (c0 < c1){
+			std::swap(c0, c1);
+		}
+
+		uint32_t indices = 0;
+		if (c0 != c1){
+			int e0[4], e1[4];
+			From565(c0, e0);
+			From565(c1, e1);
+			int direction[4] = { e1[0] - e0[0], e1[1] - e0[1], e1[2] - e0[2], 0 };
+			int32_t lengthSquared = direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2];
+
+			int32_t dots[BLOCK_TEXELS];
+			ProjectBlock(block, e0, direction, dots);
+
+			// thirds along the line from c0, in the order BC1 stores them
+			static const uint32_t order[4] = { 0, 2, 3, 1 };
+			for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+				int32_t step = lengthSquared > 0 ? (dots[i] * 3 + lengthSquared / 2) / lengthSquared : 0;
+				step = std::min(std::max(step, 0), 3);
+				indices |= order[step] << (i * 2);
+			}
+		}
+
+		out[0] = static_cast<uint8_t>(c0);
+		out[1] = static_cast<uint8_t>(c0 >> 8);
+		out[2] = static_cast<uint8_t>(c1);
+		out[3] = static_cast<uint8_t>(c1 >> 8);
+		out[4] = static_cast<uint8_t>(indices);
+		out[5] = static_cast<uint8_t>(indices >> 8);
+		out[6] = static_cast<uint8_t>(indices >> 16);
+		out[7] = static_cast<uint8_t>(indices >> 24);
+	}
+
+	static void CompressBC1Block(const uint8_t* block, uint8_t* out){
+		uint8_t low8[4], high8[4];
+		BlockBounds(block, low8, high8);
+		int low[4], high[4];
+		InsetBounds(low8, high8, 3, low, high);
+		EncodeBC1(block, high, low, out);
+
+		// one least squares pass over the indices the bounding box picked, kept if it helps
+		static const float weightOf[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+		uint32_t indices = out[4] | out[5] << 8 | out[6] << 16 | static_cast<uint32_t>(out[7]) << 24;
+		float weights[BLOCK_TEXELS];
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+			weights[i] = weightOf[(indices >> (i * 2)) & 3];
+		}
+
+		int refinedHigh[4], refinedLow[4];
+		if (RefineEndpoints(block, 3, weights, refinedHigh, refinedLow)){
+			uint8_t candidate[8];
+			EncodeBC1(block, refinedHigh, refinedLow, candidate);
+
+			uint8_t decoded[64], decodedCandidate[64];
+			DecodeBC1Block(out, decoded, true);
+			DecodeBC1Block(candidate, decodedCandidate, true);
+			if (BlockError(block, decodedCandidate, 0x7) < BlockError(block, decoded, 0x7)){
+				memcpy(out, candidate, 8);
+			}
+		}
+	}
+
+	//BC4, one channel
+
+	static void CompressBC4Block(const uint8_t* block, uint32_t channel, uint8_t* out){
+		int low = 255, high = 0;
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+			low = std::min(low, static_cast<int>(block[i * 4 + channel]));
+			high = std::max(high, static_cast<int>(block[i * 4 + channel]));
+		}
+
+		// high first puts it in the eight value mode
+		out[0] = static_cast<uint8_t>(high);
+		out[1] = static_cast<uint8_t>(low);
+		uint64_t indices = 0;
+		if (high > low){
+			int range = high - low;
+			for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+				int step = ((high - block[i * 4 + channel]) * 7 + range / 2) / range;
+				uint64_t index = step == 0 ? 0 : (step == 7 ? 1 : step + 1);
+				indices |= index << (i * 3);
+			}
+		}
+		for (uint32_t i = 0; i < 6; i++){
+			out[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+		}
+	}
+
+	static void DecodeBC4Block(const uint8_t* in, uint32_t channel, uint8_t* block){
+		int a0 = in[0], a1 = in[1];
+		int palette[8] = { a0, a1 };
+		if (a0 > a1){
+			for (int i = 1; i < 7; i++){
+				palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+			}
+		}
+		else{
+			for (int i = 1; i < 5; i++){
+				palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		uint64_t indices = 0;
+		for (uint32_t i = 0; i < 6; i++){
+			indices |= static_cast<uint64_t>(in[2 + i]) << (i * 8);
+		}
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+			block[i * 4 + channel] = static_cast<uint8_t>(palette[(indices >> (i * 3)) & 7]);
+		}
+	}
+
+	//BC7 compression, mode 6 only: one subset, rgba endpoints with 7 bits and a p-bit each, 4 bit indices.
+	// the mode that suits smooth content best and the only one that needs no partition search
+
+	static void EncodeBC7Mode6(const uint8_t* block, const int* first, const int* second, uint8_t* out){
+		// each endpoint takes whichever p-bit rebuilds it closest
+		int quantized[2][4], pBits[2], endpoints[2][4];
+		const int* sources[2] = { first, second };
+		for (uint32_t e = 0; e < 2; e++){
+			int bestError = -1;
+			for (int p = 0; p < 2; p++){
+				int candidate[4];
+				int error = 0;
+				for (uint32_t c = 0; c < 4; c++){
+					candidate[c] = std::min(std::max((sources[e][c] - p + 1) >> 1, 0), 127);
+					int difference = ((candidate[c] << 1) | p) - sources[e][c];
+					error += difference * difference;
+				}
+				if (bestError < 0 || error < bestError){
+					bestError = error;
+					pBits[e] = p;
+					memcpy(quantized[e], candidate, sizeof(candidate));
+				}
+			}
+			for (uint32_t c = 0; c < 4; c++){
+				endpoints[e][c] = (quantized[e][c] << 1) | pBits[e];
+			}
+		}
+
+		int direction[4];
+		int64_t lengthSquared = 0;
+		for (uint32_t c = 0; c < 4; c++){
+			direction[c] = endpoints[1][c] - endpoints[0][c];
+			lengthSquared += direction[c] * direction[c];
+		}
+
+		int32_t dots[BLOCK_TEXELS];
+		ProjectBlock(block, endpoints[0], direction, dots);
+
+		uint32_t indices[BLOCK_TEXELS];
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+			if (lengthSquared == 0){
+				indices[i] = 0;
+				continue;
+			}
+			// the weights are nearly even, so round to the nearest sixteenth and check the neighbours
+			int64_t target = static_cast<int64_t>(dots[i]) * 64;
+			int guess = static_cast<int>((static_cast<int64_t>(dots[i]) * 15 + lengthSquared / 2) / lengthSquared);
+			guess = std::min(std::max(guess, 0), 15);
+			int best = guess;
+			int64_t bestError = -1;
+			for (int candidate = std::max(guess - 1, 0); candidate <= std::min(guess + 1, 15); candidate++){
+				int64_t error = BC7_WEIGHTS[candidate] * lengthSquared - target;
+				error = error < 0 ? -error : error;
+				if (bestError < 0 || error < bestError){
+					bestError = error;
+					best = candidate;
+				}
+			}
+			indices[i] = static_cast<uint32_t>(best);
+		}
+
+		// the first texels index is stored without its top bit, so it has to be below 8. swapping the endpoints
+		// flips every index, the weights are symmetric so the block decodes the same
+		if (indices[0] & 8){
+			for (uint32_t c = 0; c < 4; c++){
+				std::swap(quantized[0][c], quantized[1][c]);
+			}
+			std::swap(pBits[0], pBits[1]);
+			for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+				indices[i] = 15 - indices[i];
+			}
+		}
+
+		BitStream stream;
+		stream.Write(1 << 6, 7);
+		for (uint32_t c = 0; c < 4; c++){
+			stream.Write(static_cast<uint64_t>(quantized[0][c]), 7);
+			stream.Write(static_cast<uint64_t>(quantized[1][c]), 7);
+		}
+		stream.Write(static_cast<uint64_t>(pBits[0]), 1);
+		stream.Write(static_cast<uint64_t>(pBits[1]), 1);
+		stream.Write(indices[0], 3);
+		for (uint32_t i = 1; i < BLOCK_TEXELS; i++){
+			stream.Write(indices[i], 4);
+		}
+		memcpy(out, stream.bits, 16);
+	}
+
+	static void DecodeBC7Mode6(const uint8_t* in, uint8_t* block){
+		BitStream stream;
+		memcpy(stream.bits, in, 16);
+		stream.position = 7;
+
+		int quantized[2][4];
+		for (uint32_t c = 0; c < 4; c++){
+			quantized[0][c] = static_cast<int>(stream.Read(7));
+			quantized[1][c] = static_cast<int>(stream.Read(7));
+		}
+		int pBits[2];
+		pBits[0] = static_cast<int>(stream.Read(1));
+		pBits[1] = static_cast<int>(stream.Read(1));
+
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+			int weight = BC7_WEIGHTS[stream.Read(i == 0 ? 3 : 4)];
+			for (uint32_t c = 0; c < 4; c++){
+				int e0 = (quantized[0][c] << 1) | pBits[0];
+				int e1 = (quantized[1][c] << 1) | pBits[1];
+				block[i * 4 + c] = static_cast<uint8_t>(((64 - weight) * e0 + weight * e1 + 32) >> 6);
+			}
+		}
+	}
+
+	//BC7, every mode, for files from other encoders. the tables are the ones in the format spec
+
+	// what each mode stores, in the order it stores it
+	struct BC7Mode{
+		uint32_t subsets;
+		uint32_t partitionBits;
+		uint32_t rotationBits;
+		uint32_t indexSelectionBits;
+		uint32_t colorBits;
+		uint32_t alphaBits; // 0 for opaque
+		uint32_t endpointPBits; // one per endpoint
+		uint32_t sharedPBits; // one per subset
+		uint32_t indexBits;
+		uint32_t secondIndexBits; // alpha gets its own indices when theres any
+	};
+
+	static const BC7Mode BC7_MODES[8] = {
+		{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+		{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+		{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+		{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+		{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+		{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+		{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+		{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+	};
+
+	// 2 and 3 bit index weights out of 64
+	static const int BC7_WEIGHTS2[4] = { 0, 21, 43, 64 };
+	static const int BC7_WEIGHTS3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+
+	// which subset each texel is in, a bit per texel for two subsets and two bits for three
+	static const uint16_t BC7_PARTITIONS2[64] = {
+		0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80,
+		0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+		0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce,
+		0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+		0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a,
+		0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+		0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c,
+		0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22
+	};
+
+	static const uint32_t BC7_PARTITIONS3[64] = {
+		0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8, 0xa5a50000, 0xa0a05050, 0x5555a0a0, 0x5a5a5050,
+		0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090, 0x94949494, 0xa4a4a4a4, 0xa9a59450, 0x2a0a4250,
+		0xa5945040, 0x0a425054, 0xa5a5a500, 0x55a0a0a0, 0xa8a85454, 0x6a6a4040, 0xa4a45000, 0x1a1a0500,
+		0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400, 0xa08585a0, 0xaa821414, 0x50a4a450, 0x6a5a0200,
+		0xa9a58000, 0x5090a0a8, 0xa8a09050, 0x24242424, 0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50,
+		0x500aa550, 0xaaaa4444, 0x66660000, 0xa5a0a5a0, 0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600,
+		0xaa444444, 0x54a854a8, 0x95809580, 0x96969600, 0xa85454a8, 0x80959580, 0xaa141414, 0x96960000,
+		0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000, 0x40804080, 0xa9a8a9a8, 0xaaaaaa44, 0x2a4a5254
+	};
+
+	// the texel each subset after the first stores its index one bit short at, texel 0 is the first subsets
+	static const uint8_t BC7_ANCHORS2[64] = {
+		15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+		15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+		15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+		6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15
+	};
+
+	static const uint8_t BC7_ANCHORS3_SECOND[64] = {
+		3, 3, 15, 15, 8, 3, 15, 15, 8, 8, 6, 6, 6, 5, 3, 3,
+		3, 3, 8, 15, 3, 3, 6, 10, 5, 8, 8, 6, 8, 5, 15, 15,
+		8, 15, 3, 5, 6, 10, 8, 15, 15, 3, 15, 5, 15, 15, 15, 15,
+		3, 15, 5, 5, 5, 8, 5, 10, 5, 10, 8, 13, 15, 12, 3, 3
+	};
+
+	static const uint8_t BC7_ANCHORS3_THIRD[64] = {
+		15, 8, 8, 3, 15, 15, 3, 8, 15, 15, 15, 15, 15, 15, 15, 8,
+		15, 8, 15, 3, 15, 8, 15, 8, 3, 15, 6, 10, 15, 15, 10, 8,
+		15, 3, 15, 10, 10, 8, 9, 10, 6, 15, 8, 15, 3, 6, 6, 8,
+		15, 3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3, 15, 15, 8
+	};
+
+	static int BC7Weight(uint32_t bits, uint32_t index){
+		return bits == 2 ? BC7_WEIGHTS2[index] : bits == 3 ? BC7_WEIGHTS3[index] : BC7_WEIGHTS[index];
+	}
+
+	static void DecodeBC7Block(const uint8_t* in, uint8_t* block){
+		uint32_t mode = 0;
+		while (mode < 8 && !(in[0] & (1 << mode))){
+			mode++;
+		}
+		// the encoders own mode has a quicker path
+		if (mode == 6){
+			DecodeBC7Mode6(in, block);
+			return;
+		}
+		// no mode bit is reserved, it decodes to transparent black like on the GPU
+		if (mode == 8){
+			memset(block, 0, 64);
+			return;
+		}
+		const BC7Mode& info = BC7_MODES[mode];
+
+		BitStream stream;
+		memcpy(stream.bits, in, 16);
+		stream.position = mode + 1;
+		uint32_t partition = stream.Read(info.partitionBits);
+		uint32_t rotation = stream.Read(info.rotationBits);
+		uint32_t indexSelection = stream.Read(info.indexSelectionBits);
+
+		// every endpoints red, then green, then blue, then alpha
+		uint32_t endpointCount = info.subsets * 2;
+		int endpoints[6][4];
+		for (uint32_t c = 0; c < 3; c++){
+			for (uint32_t e = 0; e < endpointCount; e++){
+				endpoints[e][c] = static_cast<int>(stream.Read(info.colorBits));
+			}
+		}
+		for (uint32_t e = 0; e < endpointCount; e++){
+			endpoints[e][3] = info.alphaBits ? static_cast<int>(stream.Read(info.alphaBits)) : 255;
+		}
+
+		// a p-bit is the lowest bit of every channel of its endpoint, then each channel is widened to 8 bits by
+		// repeating its top bits
+		int pBits[6] = {};
+		for (uint32_t e = 0; e < endpointCount && info.endpointPBits; e++){
+			pBits[e] = static_cast<int>(stream.Read(1));
+		}
+		for (uint32_t subset = 0; subset < info.subsets && info.sharedPBits; subset++){
+			pBits[subset * 2] = pBits[subset * 2 + 1] = static_cast<int>(stream.Read(1));
+		}
+		uint32_t pBitCount = info.endpointPBits + info.sharedPBits;
+		for (uint32_t e = 0; e < endpointCount; e++){
+			for (uint32_t c = 0; c < 4; c++){
+				if (c == 3 && !info.alphaBits){
+					continue;
+				}
+				uint32_t bits = (c == 3 ? info.alphaBits : info.colorBits) + pBitCount;
+				int value = (endpoints[e][c] << pBitCount) | (pBitCount ? pBits[e] : 0);
+				endpoints[e][c] = (value << (8 - bits)) | (value >> (2 * bits - 8));
+			}
+		}
+
+		uint32_t subsets[BLOCK_TEXELS];
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+			if (info.subsets == 2){
+				subsets[i] = (BC7_PARTITIONS2[partition] >> i) & 1;
+			}
+			else if (info.subsets == 3){
+				subsets[i] = (BC7_PARTITIONS3[partition] >> (i * 2)) & 3;
+			}
+			else{
+				subsets[i] = 0;
+			}
+		}
+
+		// each subsets anchor texel has its indices top bit left out, its always 0
+		uint32_t indices[BLOCK_TEXELS], secondIndices[BLOCK_TEXELS];
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+			bool anchor = i == 0 || (info.subsets == 2 && i == BC7_ANCHORS2[partition]) ||
+				(info.subsets == 3 && (i == BC7_ANCHORS3_SECOND[partition] || i == BC7_ANCHORS3_THIRD[partition]));
+			indices[i] = stream.Read(info.indexBits - (anchor ? 1 : 0));
+		}
+		for (uint32_t i = 0; i < BLOCK_TEXELS && info.secondIndexBits; i++){
+			secondIndices[i] = stream.Read(info.secondIndexBits - (i == 0 ? 1 : 0));
+		}
+
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+			const int* e0 = endpoints[subsets[i] * 2];
+			const int* e1 = endpoints[subsets[i] * 2 + 1];
+			int colorWeight = BC7Weight(info.indexBits, indices[i]);
+			int alphaWeight = colorWeight;
+			if (info.secondIndexBits){
+				// the index selection bit swaps which set of indices the colour uses
+				alphaWeight = BC7Weight(info.secondIndexBits, secondIndices[i]);
+				if (indexSelection){
+					std::swap(colorWeight, alphaWeight);
+				}
+			}
+			for (uint32_t c = 0; c < 4; c++){
+				int weight = c == 3 ? alphaWeight : colorWeight;
+				block[i * 4 + c] = static_cast<uint8_t>(((64 - weight) * e0[c] + weight * e1[c] + 32) >> 6);
+			}
+			// the rotation swaps alpha with red, green or blue, so the channel that varies most gets its own indices
+			if (rotation){
+				std::swap(block[i * 4 + 3], block[i * 4 + rotation - 1]);
+			}
+		}
+	}
+
+	static void CompressBC7Block(const uint8_t* block, uint8_t* out){
+		uint8_t low8[4], high8[4];
+		BlockBounds(block, low8, high8);
+		int low[4], high[4];
+		InsetBounds(low8, high8, 4, low, high);
+		EncodeBC7Mode6(block, low, high, out);
+
+		// same least squares pass as BC1, against the decoded weights
+		BitStream stream;
+		memcpy(stream.bits, out, 16);
+		stream.position = 65;
+		float weights[BLOCK_TEXELS];
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+			weights[i] = BC7_WEIGHTS[stream.Read(i == 0 ? 3 : 4)] / 64.0f;
+		}
+
+		int refinedFirst[4], refinedSecond[4];
+		if (RefineEndpoints(block, 4, weights, refinedFirst, refinedSecond)){
+			uint8_t candidate[16];
+			EncodeBC7Mode6(block, refinedFirst, refinedSecond, candidate);
+
+			uint8_t decoded[64], decodedCandidate[64];
+			DecodeBC7Mode6(out, decoded);
+			DecodeBC7Mode6(candidate, decodedCandidate);
+			if (BlockError(block, decodedCandidate, 0xf) < BlockError(block, decoded, 0xf)){
+				memcpy(out, candidate, 16);
+			}
+		}
+	}
+
+	//IMAGES
+
+	static void CompressBlock(SEBlockFormat format, const uint8_t* block, uint8_t* out){
+		switch (format){
+		case SE_BLOCK_BC1:
+			CompressBC1Block(block, out);
+			break;
+		case SE_BLOCK_BC3:
+			CompressBC4Block(block, 3, out);
+			CompressBC1Block(block, out + 8);
+			break;
+		case SE_BLOCK_BC5:
+			CompressBC4Block(block, 0, out);
+			CompressBC4Block(block, 1, out + 8);
+			break;
+		case SE_BLOCK_BC7:
+			CompressBC7Block(block, out);
+			break;
+		default:
+			throw std::runtime_error("Not a block format");
+		}
+	}
+
+	static void DecompressBlock(SEBlockFormat format, const uint8_t* in, uint8_t* block){
+		switch (format){
+		case SE_BLOCK_BC1:
+			DecodeBC1Block(in, block, false);
+			break;
+		case SE_BLOCK_BC3:
+			DecodeBC1Block(in + 8, block, true);
+			DecodeBC4Block(in, 3, block);
+			break;
+		case SE_BLOCK_BC5:
+			memset(block, 0, 64);
+			DecodeBC4Block(in, 0, block);
+			DecodeBC4Block(in + 8, 1, block);
+			for (uint32_t i = 0; i < BLOCK_TEXELS; i++){
+				block[i * 4 + 3] = 255;
+			}
+			break;
+		case SE_BLOCK_BC7:
+			DecodeBC7Block(in, block);
+			break;
+		default:
+			throw std::runtime_error("Not a block format");
+		}
+	}
+
+	std::vector<uint8_t> CompressImage(SEBlockFormat format, const uint8_t* pixels, uint32_t width, uint32_t height, SEJobSystem* jobSystem){
+		if (format == SE_BLOCK_RGBA8){
+			return std::vector<uint8_t>(pixels, pixels + static_cast<size_t>(width) * height * 4);
+		}
+
+		uint32_t blocksX = (width + 3) / 4;
+		uint32_t blocksY = (height + 3) / 4;
+		uint32_t blockBytes = GetBlockBytes(format);
+		std::vector<uint8_t> compressed(GetLevelSize(format, width, height));
+
+		// blocks are independent, every job takes a run of block rows
+		auto compressRows = [&](uint32_t begin, uint32_t end) {
+			uint8_t block[64];
+			for (uint32_t blockY = begin; blockY < end; blockY++){
+				for (uint32_t blockX = 0; blockX < blocksX; blockX++){
+					LoadBlock(pixels, width, height, blockX, blockY, block);
+					CompressBlock(format, block, &compressed[(static_cast<size_t>(blockY) * blocksX + blockX) * blockBytes]);
+				}
+			}
+		};
+
+		if (jobSystem){
+			jobSystem->ParallelFor(blocksY, 4, compressRows);
+		}
+		else{
+			compressRows(0, blocksY);
+		}
+		return compressed;
+	}
+
+	std::vector<uint8_t> DecompressImage(SEBlockFormat format, const uint8_t* data, uint32_t width, uint32_t height){
+		if (format == SE_BLOCK_RGBA8){
+			return std::vector<uint8_t>(data, data + static_cast<size_t>(width) * height * 4);
+		}
+
+		uint32_t blocksX = (width + 3) / 4;
+		uint32_t blocksY = (height + 3) / 4;
+		uint32_t blockBytes = GetBlockBytes(format);
+		std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+
+		uint8_t block[64];
+		for (uint32_t blockY = 0; blockY < blocksY; blockY++){
+			for (uint32_t blockX = 0; blockX < blocksX; blockX++){
+				DecompressBlock(format, data + (static_cast<size_t>(blockY) * blocksX + blockX) * blockBytes, block);
+				StoreBlock(block, width, height, blockX, blockY, pixels.data());
+			}
+		}
+		return pixels;
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+namespace ScoobzEngine {
+
+	class SEJobSystem;
+
+	// how a textures texels are stored. everything but RGBA8 is 4x4 blocks
+	enum SEBlockFormat{
+		SE_BLOCK_RGBA8,
+		SE_BLOCK_BC1, // rgb, 8 bytes a block
+		SE_BLOCK_BC3, // rgba, BC1 colour plus a BC4 alpha, 16 bytes
+		SE_BLOCK_BC5, // two BC4 channels, for tangent space normals, 16 bytes
+		SE_BLOCK_BC7 // rgba, 16 bytes. compressed to mode 6 only, every mode decodes
+	};
+
+	// what a texture is used for, decides which format it gets
+	enum SETextureUsage{
+		SE_TEXTURE_COLOR,
+		SE_TEXTURE_COLOR_ALPHA,
+		SE_TEXTURE_NORMAL
+	};
+
+	const char* GetBlockFormatName(SEBlockFormat);
+	// 0 for a format that isnt a Vulkan format on its own, like BC5 in srgb
+	VkFormat GetBlockVkFormat(SEBlockFormat, bool);
+	// bytes per block, or per texel for RGBA8
+	uint32_t GetBlockBytes(SEBlockFormat);
+	// bytes one level this size takes
+	size_t GetLevelSize(SEBlockFormat, uint32_t, uint32_t);
+
+	// the best format the device can sample for the usage, falling back to RGBA8 without textureCompressionBC.
+	// call with the device picked in GetPhysicalDevices
+	SEBlockFormat SelectBlockFormat(VkPhysicalDevice, SETextureUsage, bool);
+	bool IsBlockFormatSupported(VkPhysicalDevice, SEBlockFormat, bool);
+
+	// rgba8 pixels into blocks. edge blocks repeat the last row and column. block rows are split across the job
+	// system when theres one, otherwise it all runs on the calling thread
+	std::vector<uint8_t> CompressImage(SEBlockFormat, const uint8_t*, uint32_t, uint32_t, SEJobSystem* = nullptr);
+	// back to rgba8, for devices without BC support and for measuring quality. BC5 decodes to red and green with
+	// blue 0
+	std::vector<uint8_t> DecompressImage(SEBlockFormat, const uint8_t*, uint32_t, uint32_t);
+}
@@ -1,8 +1,19 @@
 #include "SEBuffer.h"
 #include "SEQueueFamily.h"
+#include <mutex>
+#include <unordered_map>
 
 namespace ScoobzEngine {
 
+	// vkFreeMemory isnt told the size, so each live allocation remembers its own
+	struct TrackedAllocation{
+		VkDeviceSize size;
+		uint32_t memoryType;
+	};
+	static std::mutex memoryMutex;
+	static std::unordered_map<VkDeviceMemory, TrackedAllocation> liveMemory;
+	static SEMemoryStats memoryStats = {};
+
 	SEBuffer::SEBuffer(){}
 	SEBuffer::~SEBuffer(){}
 
@@ -36,7 +47,7 @@ namespace ScoobzEngine {
 		allocateInfo.allocationSize = memRequirements.size;
 		allocateInfo.memoryTypeIndex = findMemoryType(*physicalDevice, memRequirements.memoryTypeBits, properties);
 
-		if (vkAllocateMemory(*logicalDevice, &allocateInfo, nullptr, &bufferMemory) != VK_SUCCESS){
+		if (AllocateMemory(*logicalDevice, &allocateInfo, &bufferMemory) != VK_SUCCESS){
 			throw std::runtime_error("Failed to allocate buffer memory");
 		}
 		else{
@@ -48,7 +59,39 @@ namespace ScoobzEngine {
 
 	void SEBuffer::CleanupBuffer(const VkDevice* logicalDevice, VkBuffer& buffer, VkDeviceMemory& bufferMemory){
 		vkDestroyBuffer(*logicalDevice, buffer, nullptr);
-		vkFreeMemory(*logicalDevice, bufferMemory, nullptr);
+		FreeMemory(*logicalDevice, bufferMemory);
+	}
+
+	VkResult SEBuffer::AllocateMemory(VkDevice logicalDevice, const VkMemoryAllocateInfo* allocateInfo, VkDeviceMemory* memory){
+		VkResult result = vkAllocateMemory(logicalDevice, allocateInfo, nullptr, memory);
+		if (result == VK_SUCCESS){
+			std::lock_guard<std::mutex> lock(memoryMutex);
+			liveMemory[*memory] = { allocateInfo->allocationSize, allocateInfo->memoryTypeIndex };
+			memoryStats.liveAllocations++;
+			memoryStats.totalAllocations++;
+			memoryStats.bytesByType[allocateInfo->memoryTypeIndex] += allocateInfo->allocationSize;
+		}
+		return result;
+	}
+
+	void SEBuffer::FreeMemory(VkDevice logicalDevice, VkDeviceMemory memory){
+		if (memory == VK_NULL_HANDLE){
+			return;
+		}
+		vkFreeMemory(logicalDevice, memory, nullptr);
+
+		std::lock_guard<std::mutex> lock(memoryMutex);
+		auto found = liveMemory.find(memory);
+		if (found != liveMemory.end()){
+			memoryStats.liveAllocations--;
+			memoryStats.bytesByType[found->second.memoryType] -= found->second.size;
+			liveMemory.erase(found);
+		}
+	}
+
+	SEMemoryStats SEBuffer::GetMemoryStats(){
+		std::lock_guard<std::mutex> lock(memoryMutex);
+		return memoryStats;
 	}
 
 	uint32_t SEBuffer::findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties){
@@ -6,19 +6,32 @@
 
 namespace ScoobzEngine {
 
+	// every device memory allocation the engine has made through SEBuffer
+	struct SEMemoryStats{
+		uint64_t liveAllocations;
+		uint64_t totalAllocations; // ever made, the difference between two reads is how many were made in between
+		VkDeviceSize bytesByType[VK_MAX_MEMORY_TYPES]; // live bytes in each memory type
+	};
+
 	class SEBuffer{
 
 	public:
 		SEBuffer();~SEBuffer();
 
+		// also used for image memory by classes that arent buffers
+		static uint32_t findMemoryType(VkPhysicalDevice, uint32_t, VkMemoryPropertyFlags);
+		// vkAllocateMemory and vkFreeMemory, counted. anything that allocates device memory goes through these so
+		// the totals cover images and transient attachments as well as buffers. safe from any thread
+		static VkResult AllocateMemory(VkDevice, const VkMemoryAllocateInfo*, VkDeviceMemory*);
+		static void FreeMemory(VkDevice, VkDeviceMemory);
+		static SEMemoryStats GetMemoryStats();
+
 	protected:
 		void CreateBuffer(const VkDevice*, const VkPhysicalDevice*,	const VkSurfaceKHR*, VkDeviceSize, VkBufferUsageFlags, 
 			VkMemoryPropertyFlags, VkBuffer&, VkDeviceMemory&);
 
 		void CleanupBuffer(const VkDevice*, VkBuffer&, VkDeviceMemory&);
 
-		uint32_t findMemoryType(VkPhysicalDevice, uint32_t, VkMemoryPropertyFlags);
-
 		void CopyBuffer(const VkDevice*, const VkCommandPool*, VkBuffer, VkBuffer, VkDeviceSize, const VkQueue*);
 	};
 }
@@ -0,0 +1,539 @@
+#include "SEBvh.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ScoobzEngine {
+
+	// queries keep their stack on the stack, so the tree is never allowed deeper than this
+	static const uint32_t MAX_DEPTH = 96;
+	// past this depth nodes are split in half by count, which reaches single primitives well before MAX_DEPTH
+	static const uint32_t MEDIAN_SPLIT_DEPTH = 64;
+	static const uint32_t NO_PARENT = ~0u;
+
+	static float HalfArea(const glm::vec3& boundsMin, const glm::vec3& boundsMax){
+		glm::vec3 size = glm::max(boundsMax - boundsMin, glm::vec3(0.0f));
+		return size.x * size.y + size.y * size.z + size.z * size.x;
+	}
+
+	SEBvh::SEBvh(){}
+	SEBvh::~SEBvh(){}
+
+	void SEBvh::Clear(){
+		nodes.clear();
+		parents.clear();
+		primitiveMin.clear();
+		primitiveMax.clear();
+		primitiveIds.clear();
+		primitiveLeaves.clear();
+		slots.clear();
+		dirtyNodes.clear();
+		dirtyFlags.clear();
+		storeVersion = ~0ull;
+	}
+
+	void SEBvh::Build(const std::vector<SEBvhPrimitive>& primitives){
+		Clear();
+		uint32_t count = static_cast<uint32_t>(primitives.size());
+		if (count == 0){
+			return;
+		}
+
+		primitiveMin.resize(count);
+		primitiveMax.resize(count);
+		primitiveIds.resize(count);
+		centroids.resize(count);
+		uint32_t idCount = 0;
+		for (uint32_t i = 0; i < count; i++){
+			primitiveMin[i] = primitives[i].boundsMin;
+			primitiveMax[i] = primitives[i].boundsMax;
+			primitiveIds[i] = primitives[i].id;
+			centroids[i] = (primitives[i].boundsMin + primitives[i].boundsMax) * 0.5f;
+			idCount = std::max(idCount, primitives[i].id + 1);
+		}
+
+		// a binary tree with leaves of at least one primitive never needs more than this
+		nodes.reserve(count * 2);
+		parents.reserve(count * 2);
+		SEBvhNode root;
+		root.first = 0;
+		root.count = count;
+		nodes.push_back(root);
+		parents.push_back(NO_PARENT);
+		RefitNode(0);
+		Subdivide(0);
+
+		centroids.clear();
+		centroids.shrink_to_fit();
+
+		// refits go from a primitive to its leaf and from a leaf up through its parents
+		primitiveLeaves.resize(count);
+		slots.assign(idCount, ~0u);
+		for (uint32_t node = 0; node < nodes.size(); node++){
+			for (uint32_t i = 0; i < nodes[node].count; i++){
+				primitiveLeaves[nodes[node].first + i] = node;
+			}
+		}
+		for (uint32_t slot = 0; slot < count; slot++){
+			slots[primitiveIds[slot]] = slot;
+		}
+		dirtyFlags.assign(nodes.size(), 0);
+	}
+
+	void SEBvh::Build(const SEObjectStore& store){
+		std::vector<SEBvhPrimitive> primitives(store.GetCount());
+		for (uint32_t i = 0; i < store.GetCount(); i++){
+			glm::vec3 center(store.GetCenterX()[i], store.GetCenterY()[i], store.GetCenterZ()[i]);
+			glm::vec3 extent(store.GetExtentX()[i], store.GetExtentY()[i], store.GetExtentZ()[i]);
+			primitives[i].boundsMin = center - extent;
+			primitives[i].boundsMax = center + extent;
+			primitives[i].id = i;
+		}
+		Build(primitives);
+		storeVersion = store.GetVersion();
+	}
+
+	// splits wherever the surface area heuristic says a query will test the fewest boxes, trying SE_BVH_BINS evenly
+	// spaced planes along each axis of the centroids. a node becomes a leaf when no split is cheaper than testing
+	// everything in it, as long as that fits in a leaf
+	void SEBvh::Subdivide(uint32_t rootNode){
+		struct Pending{
+			uint32_t node;
+			uint32_t depth;
+		};
+		std::vector<Pending> pending = { { rootNode, 0 } };
+
+		while (!pending.empty()){
+			Pending current = pending.back();
+			pending.pop_back();
+			uint32_t first = nodes[current.node].first;
+			uint32_t count = nodes[current.node].count;
+			if (count <= 1){
+				continue;
+			}
+
+			glm::vec3 centroidMin(1e30f), centroidMax(-1e30f);
+			for (uint32_t i = first; i < first + count; i++){
+				centroidMin = glm::min(centroidMin, centroids[i]);
+				centroidMax = glm::max(centroidMax, centroids[i]);
+			}
+
+			int bestAxis = -1;
+			uint32_t bestSplit = 0;
+			float bestCost = 1e30f;
+			if (current.depth < MEDIAN_SPLIT_DEPTH){
+				for (int axis = 0; axis < 3; axis++){
+					float extent = centroidMax[axis] - centroidMin[axis];
+					if (extent <= 0.0f){
+						continue;
+					}
+					float scale = SE_BVH_BINS / extent;
+
+					uint32_t binCounts[SE_BVH_BINS] = {};
+					glm::vec3 binMin[SE_BVH_BINS], binMax[SE_BVH_BINS];
+					for (uint32_t bin = 0; bin < SE_BVH_BINS; bin++){
+						binMin[bin] = glm::vec3(1e30f);
+						binMax[bin] = glm::vec3(-1e30f);
+					}
+					for (uint32_t i = first; i < first + count; i++){
+						uint32_t bin = std::min(SE_BVH_BINS - 1, static_cast<uint32_t>((centroids[i][axis] - centroidMin[axis]) * scale));
+						binCounts[bin]++;
+						binMin[bin] = glm::min(binMin[bin], primitiveMin[i]);
+						binMax[bin] = glm::max(binMax[bin], primitiveMax[i]);
+					}
+
+					// the cost of splitting after each bin, swept in from both ends
+					float leftArea[SE_BVH_BINS - 1], rightArea[SE_BVH_BINS - 1];
+					uint32_t leftCount[SE_BVH_BINS - 1], rightCount[SE_BVH_BINS - 1];
+					glm::vec3 sweepMin(1e30f), sweepMax(-1e30f);
+					uint32_t sweepCount = 0;
+					for (uint32_t bin = 0; bin < SE_BVH_BINS - 1; bin++){
+						sweepCount += binCounts[bin];
+						sweepMin = glm::min(sweepMin, binMin[bin]);
+						sweepMax = glm::max(sweepMax, binMax[bin]);
+						leftCount[bin] = sweepCount;
+						leftArea[bin] = HalfArea(sweepMin, sweepMax);
+					}
+					sweepMin = glm::vec3(1e30f);
+					sweepMax = glm::vec3(-1e30f);
+					sweepCount = 0;
+					for (uint32_t bin = SE_BVH_BINS - 1; bin > 0; bin--){
+						sweepCount += binCounts[bin];
+						sweepMin = glm::min(sweepMin, binMin[bin]);
+						sweepMax = glm::max(sweepMax, binMax[bin]);
+						rightCount[bin - 1] = sweepCount;
+						rightArea[bin - 1] = HalfArea(sweepMin, sweepMax);
+					}
+
+					for (uint32_t split = 0; split < SE_BVH_BINS - 1; split++){
+						if (leftCount[split] == 0 || rightCount[split] == 0){
+							continue;
+						}
+						float cost = leftCount[split] * leftArea[split] + rightCount[split] * rightArea[split];
+						if (cost < bestCost){
+							bestCost = cost;
+							bestAxis = axis;
+							bestSplit = split;
+						}
+					}
+				}
+
+				float leafCost = count * HalfArea(nodes[current.node].boundsMin, nodes[current.node].boundsMax);
+				if (count <= SE_BVH_MAX_LEAF_SIZE && (bestAxis < 0 || bestCost >= leafCost)){
+					continue;
+				}
+			}
+
+			uint32_t leftCount = 0;
+			if (bestAxis >= 0){
+				float scale = SE_BVH_BINS / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+				uint32_t i = first;
+				uint32_t j = first + count;
+				while (i < j){
+					uint32_t bin = std::min(SE_BVH_BINS - 1, static_cast<uint32_t>((centroids[i][bestAxis] - centroidMin[bestAxis]) * scale));
+					if (bin <= bestSplit){
+						i++;
+					}
+					else{
+						j--;
+						std::swap(primitiveMin[i], primitiveMin[j]);
+						std::swap(primitiveMax[i], primitiveMax[j]);
+						std::swap(primitiveIds[i], primitiveIds[j]);
+						std::swap(centroids[i], centroids[j]);
+					}
+				}
+				leftCount = i - first;
+			}
+			// every centroid in the same place, or too deep to keep trusting the heuristic. half and half by count,
+			// along the longest axis so deep trees still make some spatial sense
+			if (leftCount == 0 || leftCount == count){
+				glm::vec3 size = centroidMax - centroidMin;
+				int axis = size.x >= size.y && size.x >= size.z ? 0 : (size.y >= size.z ? 1 : 2);
+				std::vector<uint32_t> order(count);
+				for (uint32_t i = 0; i < count; i++){
+					order[i] = first + i;
+				}
+				std::nth_element(order.begin(), order.begin() + count / 2, order.end(), [&](uint32_t a, uint32_t b){
+					return centroids[a][axis] < centroids[b][axis];
+				});
+				std::vector<glm::vec3> sortedMin(count), sortedMax(count), sortedCentroids(count);
+				std::vector<uint32_t> sortedIds(count);
+				for (uint32_t i = 0; i < count; i++){
+					sortedMin[i] = primitiveMin[order[i]];
+					sortedMax[i] = primitiveMax[order[i]];
+					sortedIds[i] = primitiveIds[order[i]];
+					sortedCentroids[i] = centroids[order[i]];
+				}
+				std::copy(sortedMin.begin(), sortedMin.end(), primitiveMin.begin() + first);
+				std::copy(sortedMax.begin(), sortedMax.end(), primitiveMax.begin() + first);
+				std::copy(sortedIds.begin(), sortedIds.end(), primitiveIds.begin() + first);
+				std::copy(sortedCentroids.begin(), sortedCentroids.end(), centroids.begin() + first);
+				leftCount = count / 2;
+			}
+
+			uint32_t left = static_cast<uint32_t>(nodes.size());
+			SEBvhNode child;
+			child.first = first;
+			child.count = leftCount;
+			nodes.push_back(child);
+			child.first = first + leftCount;
+			child.count = count - leftCount;
+			nodes.push_back(child);
+			parents.push_back(current.node);
+			parents.push_back(current.node);
+			nodes[current.node].first = left;
+			nodes[current.node].count = 0;
+			RefitNode(left);
+			RefitNode(left + 1);
+
+			pending.push_back({ left + 1, current.depth + 1 });
+			pending.push_back({ left, current.depth + 1 });
+		}
+	}
+
+	void SEBvh::RefitNode(uint32_t index){
+		SEBvhNode& node = nodes[index];
+		if (node.count > 0){
+			glm::vec3 boundsMin(1e30f), boundsMax(-1e30f);
+			for (uint32_t i = node.first; i < node.first + node.count; i++){
+				boundsMin = glm::min(boundsMin, primitiveMin[i]);
+				boundsMax = glm::max(boundsMax, primitiveMax[i]);
+			}
+			node.boundsMin = boundsMin;
+			node.boundsMax = boundsMax;
+		}
+		else{
+			const SEBvhNode& left = nodes[node.first];
+			const SEBvhNode& right = nodes[node.first + 1];
+			node.boundsMin = glm::min(left.boundsMin, right.boundsMin);
+			node.boundsMax = glm::max(left.boundsMax, right.boundsMax);
+		}
+	}
+
+	void SEBvh::UpdatePrimitive(uint32_t id, const glm::vec3& boundsMin, const glm::vec3& boundsMax){
+		uint32_t slot = slots[id];
+		primitiveMin[slot] = boundsMin;
+		primitiveMax[slot] = boundsMax;
+
+		uint32_t leaf = primitiveLeaves[slot];
+		if (!dirtyFlags[leaf]){
+			dirtyFlags[leaf] = 1;
+			dirtyNodes.push_back(leaf);
+		}
+	}
+
+	// children always come after their parent, so going from the highest dirty node down means every node is
+	// refit after its children and only once. with most of the tree dirty a straight sweep is cheaper
+	void SEBvh::Refit(){
+		if (dirtyNodes.empty()){
+			return;
+		}
+
+		if (dirtyNodes.size() * 4 > nodes.size()){
+			for (uint32_t node = static_cast<uint32_t>(nodes.size()); node-- > 0;){
+				RefitNode(node);
+				dirtyFlags[node] = 0;
+			}
+			dirtyNodes.clear();
+			return;
+		}
+
+		std::make_heap(dirtyNodes.begin(), dirtyNodes.end());
+		while (!dirtyNodes.empty()){
+			std::pop_heap(dirtyNodes.begin(), dirtyNodes.end());
+			uint32_t node = dirtyNodes.back();
+			dirtyNodes.pop_back();
+			dirtyFlags[node] = 0;
+			RefitNode(node);
+
+			uint32_t parent = parents[node];
+			if (parent != NO_PARENT && !dirtyFlags[parent]){
+				dirtyFlags[parent] = 1;
+				dirtyNodes.push_back(parent);
+				std::push_heap(dirtyNodes.begin(), dirtyNodes.end());
+			}
+		}
+	}
+
+	void SEBvh::Update(const SEObjectStore& store){
+		if (store.GetVersion() != storeVersion){
+			Build(store);
+			return;
+		}
+
+		for (uint32_t index : store.GetChanges()){
+			if (index < store.GetCount()){
+				glm::vec3 center(store.GetCenterX()[index], store.GetCenterY()[index], store.GetCenterZ()[index]);
+				glm::vec3 extent(store.GetExtentX()[index], store.GetExtentY()[index], store.GetExtentZ()[index]);
+				UpdatePrimitive(index, center - extent, center + extent);
+			}
+		}
+		Refit();
+	}
+
+	void SEBvh::QueryFrustum(const SEFrustum& frustum, std::vector<uint32_t>& results) const{
+		if (nodes.empty()){
+			return;
+		}
+
+		glm::vec3 absNormals[6];
+		for (int p = 0; p < 6; p++){
+			absNormals[p] = glm::abs(glm::vec3(frustum.planes[p]));
+		}
+
+		// the top bit says the node is already known to be entirely inside
+		const uint32_t INSIDE = 0x80000000u;
+		uint32_t stack[MAX_DEPTH * 2];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0){
+			uint32_t entry = stack[--stackSize];
+			const SEBvhNode& node = nodes[entry & ~INSIDE];
+			bool inside = (entry & INSIDE) != 0;
+
+			if (!inside){
+				glm::vec3 center = (node.boundsMin + node.boundsMax) * 0.5f;
+				glm::vec3 extent = (node.boundsMax - node.boundsMin) * 0.5f;
+				bool outside = false;
+				inside = true;
+				for (int p = 0; p < 6; p++){
+					float distance = glm::dot(glm::vec3(frustum.planes[p]), center) + frustum.planes[p].w;
+					float reach = glm::dot(absNormals[p], extent);
+					if (distance + reach < 0.0f){
+						outside = true;
+						break;
+					}
+					inside &= distance - reach >= 0.0f;
+				}
+				if (outside){
+					continue;
+				}
+			}
+
+			if (node.count > 0){
+				// a leaf only partly inside still tests each of its primitives
+				for (uint32_t i = node.first; i < node.first + node.count; i++){
+					bool touches = true;
+					if (!inside){
+						glm::vec3 center = (primitiveMin[i] + primitiveMax[i]) * 0.5f;
+						glm::vec3 extent = (primitiveMax[i] - primitiveMin[i]) * 0.5f;
+						for (int p = 0; p < 6 && touches; p++){
+							touches = glm::dot(glm::vec3(frustum.planes[p]), center) + frustum.planes[p].w + glm::dot(absNormals[p], extent) >= 0.0f;
+						}
+					}
+					if (touches){
+						results.push_back(primitiveIds[i]);
+					}
+				}
+			}
+			else{
+				uint32_t flag = inside ? INSIDE : 0;
+				stack[stackSize++] = (node.first + 1) | flag;
+				stack[stackSize++] = node.first | flag;
+			}
+		}
+	}
+
+	void SEBvh::QueryBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax, std::vector<uint32_t>& results) const{
+		if (nodes.empty()){
+			return;
+		}
+
+		uint32_t stack[MAX_DEPTH * 2];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0){
+			const SEBvhNode& node = nodes[stack[--stackSize]];
+			if (glm::any(glm::lessThan(node.boundsMax, boundsMin)) || glm::any(glm::greaterThan(node.boundsMin, boundsMax))){
+				continue;
+			}
+
+			if (node.count > 0){
+				for (uint32_t i = node.first; i < node.first + node.count; i++){
+					if (!glm::any(glm::lessThan(primitiveMax[i], boundsMin)) && !glm::any(glm::greaterThan(primitiveMin[i], boundsMax))){
+						results.push_back(primitiveIds[i]);
+					}
+				}
+			}
+			else{
+				stack[stackSize++] = node.first + 1;
+				stack[stackSize++] = node.first;
+			}
+		}
+	}
+
+	// where the ray enters the box, or a value past max distance when it misses
+	static float RayBox(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, const glm::vec3& boundsMin, const glm::vec3& boundsMax){
+		glm::vec3 t0 = (boundsMin - origin) * inverseDirection;
+		glm::vec3 t1 = (boundsMax - origin) * inverseDirection;
+		glm::vec3 nearT = glm::min(t0, t1);
+		glm::vec3 farT = glm::max(t0, t1);
+		float enter = std::max(std::max(nearT.x, nearT.y), std::max(nearT.z, 0.0f));
+		float exit = std::min(std::min(farT.x, farT.y), std::min(farT.z, maxDistance));
+		return enter <= exit ? enter : 1e30f;
+	}
+
+	// the nearer child goes first, and anything that starts behind the best hit so far is skipped
+	bool SEBvh::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, SEBvhHit& hit) const{
+		if (nodes.empty()){
+			return false;
+		}
+
+		glm::vec3 inverseDirection = 1.0f / direction;
+		float best = maxDistance;
+		bool found = false;
+
+		uint32_t stack[MAX_DEPTH * 2];
+		uint32_t stackSize = 0;
+		if (RayBox(origin, inverseDirection, best, nodes[0].boundsMin, nodes[0].boundsMax) <= best){
+			stack[stackSize++] = 0;
+		}
+		while (stackSize > 0){
+			const SEBvhNode& node = nodes[stack[--stackSize]];
+
+			if (node.count > 0){
+				for (uint32_t i = node.first; i < node.first + node.count; i++){
+					float distance = RayBox(origin, inverseDirection, best, primitiveMin[i], primitiveMax[i]);
+					if (distance <= best){
+						best = distance;
+						hit.id = primitiveIds[i];
+						hit.distance = distance;
+						found = true;
+					}
+				}
+				continue;
+			}
+
+			const SEBvhNode& left = nodes[node.first];
+			const SEBvhNode& right = nodes[node.first + 1];
+			float leftDistance = RayBox(origin, inverseDirection, best, left.boundsMin, left.boundsMax);
+			float rightDistance = RayBox(origin, inverseDirection, best, right.boundsMin, right.boundsMax);
+			if (leftDistance <= rightDistance){
+				if (rightDistance <= best){
+					stack[stackSize++] = node.first + 1;
+				}
+				if (leftDistance <= best){
+					stack[stackSize++] = node.first;
+				}
+			}
+			else{
+				if (leftDistance <= best){
+					stack[stackSize++] = node.first;
+				}
+				if (rightDistance <= best){
+					stack[stackSize++] = node.first + 1;
+				}
+			}
+		}
+		return found;
+	}
+
+	void SEBvh::QueryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<SEBvhHit>& results) const{
+		if (nodes.empty()){
+			return;
+		}
+
+		glm::vec3 inverseDirection = 1.0f / direction;
+		size_t firstResult = results.size();
+
+		uint32_t stack[MAX_DEPTH * 2];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0){
+			const SEBvhNode& node = nodes[stack[--stackSize]];
+			if (RayBox(origin, inverseDirection, maxDistance, node.boundsMin, node.boundsMax) > maxDistance){
+				continue;
+			}
+
+			if (node.count > 0){
+				for (uint32_t i = node.first; i < node.first + node.count; i++){
+					float distance = RayBox(origin, inverseDirection, maxDistance, primitiveMin[i], primitiveMax[i]);
+					if (distance <= maxDistance){
+						results.push_back({ primitiveIds[i], distance });
+					}
+				}
+			}
+			else{
+				stack[stackSize++] = node.first + 1;
+				stack[stackSize++] = node.first;
+			}
+		}
+
+		std::sort(results.begin() + firstResult, results.end(), [](const SEBvhHit& a, const SEBvhHit& b){
+			return a.distance < b.distance;
+		});
+	}
+
+	// an inner node costs one box test for each of its two children, a leaf one per primitive, each weighted by how
+	// likely a query is to reach it. the area of a box is a good stand in for that
+	float SEBvh::GetSahCost() const{
+		if (nodes.empty()){
+			return 0.0f;
+		}
+		float cost = 0.0f;
+		for (const SEBvhNode& node : nodes){
+			cost += HalfArea(node.boundsMin, node.boundsMax) * (node.count > 0 ? node.count : 2);
+		}
+		float rootArea = HalfArea(nodes[0].boundsMin, nodes[0].boundsMax);
+		return rootArea > 0.0f ? cost / rootArea : 0.0f;
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "SEObjectStore.h"
+#include "SEFrustumCull.h"
+
+namespace ScoobzEngine {
+
+	// leaves hold at most this many primitives
+	const uint32_t SE_BVH_MAX_LEAF_SIZE = 4;
+	// split candidates tried per axis when building
+	const uint32_t SE_BVH_BINS = 16;
+
+	// two to a cache line, and the two children of a node are always next to each other so one line holds both
+	struct SEBvhNode{
+		glm::vec3 boundsMin;
+		uint32_t first; // left child, the right one follows it. the first primitive for a leaf
+		glm::vec3 boundsMax;
+		uint32_t count; // primitives in a leaf, 0 for an inner node
+	};
+
+	struct SEBvhPrimitive{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		uint32_t id; // handed back by queries
+	};
+
+	struct SEBvhHit{
+		uint32_t id;
+		float distance; // along the ray, in units of its direction
+	};
+
+	// a bounding volume hierarchy over boxes, for culling, picking and ray queries. built top down with the surface
+	// area heuristic over binned centroids. primitives that move are refit in place, only the nodes above them are
+	// touched, the tree keeps its shape so it slowly gets looser until the next build. queries are const and can
+	// run from any number of threads at once, as long as nothing builds or refits at the same time
+	class SEBvh{
+
+	public:
+		SEBvh();~SEBvh();
+
+		//FUNCTIONS :: PUBLIC
+		void Build(const std::vector<SEBvhPrimitive>&);
+		// every object in the store, their ids are store indices
+		void Build(const SEObjectStore&);
+		// new bounds for a primitive, the tree only catches up on Refit
+		void UpdatePrimitive(uint32_t, const glm::vec3&, const glm::vec3&);
+		void Refit();
+		// rebuilds when objects were added or removed since the last build, otherwise refits what moved. call
+		// before the stores changes are cleared
+		void Update(const SEObjectStore&);
+		void Clear();
+
+		// appends the ids of primitives whose bounds touch the frustum. subtrees entirely inside are taken whole
+		void QueryFrustum(const SEFrustum&, std::vector<uint32_t>&) const;
+		// appends the ids of primitives whose bounds overlap the box
+		void QueryBox(const glm::vec3&, const glm::vec3&, std::vector<uint32_t>&) const;
+		// the nearest primitive bounds the ray enters within max distance. origin, direction (needs no normalising),
+		// max distance. for picking, exact hits against geometry can be tested on the ids QueryRay hands back
+		bool Raycast(const glm::vec3&, const glm::vec3&, float, SEBvhHit&) const;
+		// appends every primitive the ray passes through within max distance, nearest nodes first
+		void QueryRay(const glm::vec3&, const glm::vec3&, float, std::vector<SEBvhHit>&) const;
+
+		//Getters
+		uint32_t GetPrimitiveCount() const { return static_cast<uint32_t>(primitiveIds.size()); }
+		uint32_t GetNodeCount() const { return static_cast<uint32_t>(nodes.size()); }
+		const std::vector<SEBvhNode>& GetNodes() const { return nodes; }
+		// expected cost of a query relative to testing the root, lower is a better tree. grows as refits loosen it
+		float GetSahCost() const;
+
+	private:
+		void Subdivide(uint32_t);
+		void RefitNode(uint32_t);
+
+		std::vector<SEBvhNode> nodes;
+		std::vector<uint32_t> parents; // by node, the root has none
+		// by slot, in leaf order so a leaf reads its primitives in one run
+		std::vector<glm::vec3> primitiveMin;
+		std::vector<glm::vec3> primitiveMax;
+		std::vector<uint32_t> primitiveIds;
+		std::vector<uint32_t> primitiveLeaves;
+		std::vector<uint32_t> slots; // by id, where its bounds are. ids dont have to be dense, gaps are ~0u
+
+		std::vector<glm::vec3> centroids; // only while building
+		std::vector<uint32_t> dirtyNodes;
+		std::vector<uint8_t> dirtyFlags; // by node
+		uint64_t storeVersion = ~0ull; // the store layout this was built from
+	};
+}
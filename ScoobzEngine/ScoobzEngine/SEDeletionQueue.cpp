@@ -0,0 +1,33 @@
+#include "SEDeletionQueue.h"
+
+namespace ScoobzEngine {
+
+	SEDeletionQueue::SEDeletionQueue(){}
+	SEDeletionQueue::~SEDeletionQueue(){}
+
+	void SEDeletionQueue::Create(uint32_t framesInFlight){
+		slots.resize(framesInFlight);
+	}
+
+	void SEDeletionQueue::Push(std::function<void()> deleter){
+		slots[currentSlot].push_back(std::move(deleter));
+	}
+
+	void SEDeletionQueue::BeginFrame(uint32_t slot){
+		currentSlot = slot;
+
+		// swap out first so a deleter can push more work without invalidating the loop
+		std::vector<std::function<void()>> ready;
+		ready.swap(slots[slot]);
+		for (auto& deleter : ready){
+			deleter();
+		}
+	}
+
+	void SEDeletionQueue::Flush(){
+		for (uint32_t slot = 0; slot < slots.size(); slot++){
+			BeginFrame(slot);
+		}
+		currentSlot = 0;
+	}
+}
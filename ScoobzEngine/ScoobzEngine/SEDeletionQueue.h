@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace ScoobzEngine {
+
+	// holds back destroying GPU objects until no frame in flight can still be using them.
+	// anything pushed while recording frame slot N runs the next time slot N begins, which is after
+	// its fence was waited on, so every command buffer recorded before it has finished
+	class SEDeletionQueue{
+
+	public:
+		SEDeletionQueue();~SEDeletionQueue();
+
+		//FUNCTIONS :: PUBLIC
+		void Create(uint32_t);
+		void Push(std::function<void()>);
+		// call right after waiting on the slots fence
+		void BeginFrame(uint32_t);
+		// runs everything, only safe once the device is idle
+		void Flush();
+
+	private:
+		std::vector<std::vector<std::function<void()>>> slots;
+		uint32_t currentSlot = 0;
+	};
+}
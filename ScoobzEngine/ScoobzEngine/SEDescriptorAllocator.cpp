@@ -0,0 +1,117 @@
+#include "SEDescriptorAllocator.h"
+#include <algorithm>
+
+namespace ScoobzEngine {
+
+	SEDescriptorAllocator::SEDescriptorAllocator(){}
+	SEDescriptorAllocator::~SEDescriptorAllocator(){}
+
+	void SEDescriptorAllocator::Create(const VkDevice* logicalDevice, uint32_t framesInFlight){
+		device = logicalDevice;
+		frames.resize(framesInFlight);
+	}
+
+	void SEDescriptorAllocator::Cleanup(){
+		for (auto& frame : frames){
+			for (VkDescriptorPool pool : frame.used){
+				vkDestroyDescriptorPool(*device, pool, VK_NULL_HANDLE);
+			}
+			frame.used.clear();
+		}
+		for (VkDescriptorPool pool : freePools){
+			vkDestroyDescriptorPool(*device, pool, VK_NULL_HANDLE);
+		}
+		freePools.clear();
+	}
+
+	void SEDescriptorAllocator::BeginFrame(uint32_t slot){
+		currentSlot = slot;
+		stats.framesSincePoolCreated++;
+
+		// one reset frees every set in the pool, far cheaper than freeing them individually
+		for (VkDescriptorPool pool : frames[slot].used){
+			vkResetDescriptorPool(*device, pool, 0);
+			freePools.push_back(pool);
+			stats.poolResets++;
+		}
+		frames[slot].used.clear();
+	}
+
+	VkDescriptorSet SEDescriptorAllocator::Allocate(VkDescriptorSetLayout layout){
+		FramePools& frame = frames[currentSlot];
+		if (frame.used.empty()){
+			frame.used.push_back(GrabPool());
+		}
+
+		VkDescriptorSetAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = frame.used.back();
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &layout;
+
+		// a full pool reports out of pool memory or fragmentation depending on the driver, either way move on to
+		// another one. a fresh pool failing too means the layout can never fit
+		VkDescriptorSet set;
+		if (vkAllocateDescriptorSets(*device, &allocInfo, &set) != VK_SUCCESS){
+			frame.used.push_back(GrabPool());
+			allocInfo.descriptorPool = frame.used.back();
+			if (vkAllocateDescriptorSets(*device, &allocInfo, &set) != VK_SUCCESS){
+				throw std::runtime_error("Failed to allocate descriptor set");
+			}
+		}
+
+		stats.setsAllocated++;
+		return set;
+	}
+
+	VkDescriptorPool SEDescriptorAllocator::GrabPool(){
+		if (!freePools.empty()){
+			VkDescriptorPool pool = freePools.back();
+			freePools.pop_back();
+			return pool;
+		}
+
+		VkDescriptorPool pool = CreatePool(nextPoolSets);
+		nextPoolSets = std::min(nextPoolSets * 2, 4096u);
+		return pool;
+	}
+
+	VkDescriptorPool SEDescriptorAllocator::CreatePool(uint32_t maxSets){
+		// descriptors per set of each type, roughly what a material or per-draw set uses
+		static const struct { VkDescriptorType type; uint32_t perSet; } sizes[] = {
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 },
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1 },
+			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4 },
+			{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2 },
+			{ VK_DESCRIPTOR_TYPE_SAMPLER, 1 },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1 }
+		};
+
+		std::vector<VkDescriptorPoolSize> poolSizes;
+		for (const auto& size : sizes){
+			poolSizes.push_back({ size.type, size.perSet * maxSets });
+		}
+
+		VkDescriptorPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.maxSets = maxSets;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+
+		VkDescriptorPool pool;
+		if (vkCreateDescriptorPool(*device, &poolInfo, nullptr, &pool) != VK_SUCCESS){
+			throw std::runtime_error("Failed to create descriptor pool");
+		}
+
+		stats.poolsCreated++;
+		stats.framesSincePoolCreated = 0;
+		return pool;
+	}
+
+	void SEDescriptorAllocator::PrintStats(){
+		std::cout << "Descriptor Allocator: " << stats.setsAllocated << " sets, " << stats.poolsCreated << " pools created, "
+			<< stats.poolResets << " pool resets, last pool created " << stats.framesSincePoolCreated << " frames ago" << std::endl;
+	}
+}
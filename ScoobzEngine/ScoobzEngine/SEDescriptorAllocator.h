@@ -0,0 +1,51 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace ScoobzEngine {
+
+	struct SEDescriptorAllocatorStats{
+		uint32_t setsAllocated;
+		uint32_t poolsCreated;
+		uint32_t poolResets;
+		uint32_t framesSincePoolCreated; // stays climbing once the pools have grown to what a frame needs
+	};
+
+	// hands out descriptor sets that only live for one frame. each frame in flight has its own pools, and instead of
+	// freeing sets one at a time the whole frames pools are reset when its slot comes round again.
+	// pools are created on demand and kept, so once a frame has seen its peak nothing new is created
+	class SEDescriptorAllocator{
+
+	public:
+		SEDescriptorAllocator();~SEDescriptorAllocator();
+
+		//FUNCTIONS :: PUBLIC
+		void Create(const VkDevice*, uint32_t);
+		void Cleanup();
+		// call right after waiting on the slots fence, every set allocated for that slot last time is invalid after this
+		void BeginFrame(uint32_t);
+		VkDescriptorSet Allocate(VkDescriptorSetLayout);
+		void PrintStats();
+
+		//Getters
+		SEDescriptorAllocatorStats GetStats() { return stats; }
+
+	private:
+		struct FramePools{
+			std::vector<VkDescriptorPool> used; // the last one is the one being allocated from
+		};
+
+		VkDescriptorPool GrabPool();
+		VkDescriptorPool CreatePool(uint32_t);
+
+		const VkDevice* device = nullptr;
+		std::vector<FramePools> frames;
+		std::vector<VkDescriptorPool> freePools; // reset and ready, shared by every frame
+		uint32_t currentSlot = 0;
+		uint32_t nextPoolSets = 64; // each new pool is twice the last, up to a cap
+		SEDescriptorAllocatorStats stats = {};
+	};
+}
@@ -0,0 +1,200 @@
+#include "SEDescriptorLayoutCache.h"
+#include <algorithm>
+
+namespace ScoobzEngine {
+
+	SEDescriptorLayoutCache::SEDescriptorLayoutCache(){}
+	SEDescriptorLayoutCache::~SEDescriptorLayoutCache(){}
+
+	void SEDescriptorLayoutCache::Create(const VkDevice* logicalDevice){
+		device = logicalDevice;
+	}
+
+	void SEDescriptorLayoutCache::Cleanup(){
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		for (auto& pipelineLayout : pipelineLayouts){
+			vkDestroyPipelineLayout(*device, pipelineLayout.second, VK_NULL_HANDLE);
+		}
+		for (auto& setLayout : setLayouts){
+			vkDestroyDescriptorSetLayout(*device, setLayout.second, VK_NULL_HANDLE);
+		}
+		pipelineLayouts.clear();
+		setLayouts.clear();
+	}
+
+	VkDescriptorType SEDescriptorLayoutCache::DynamicVariant(VkDescriptorType type){
+		switch (type){
+		case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+			return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+		default:
+			return type;
+		}
+	}
+
+	VkDescriptorSetLayout SEDescriptorLayoutCache::GetSetLayout(std::vector<VkDescriptorSetLayoutBinding> bindings, bool* created){
+		std::sort(bindings.begin(), bindings.end(),
+			[](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) { return a.binding < b.binding; });
+
+		// immutable samplers arent part of the key, layouts that use them shouldnt come through the cache
+		std::vector<uint32_t> key;
+		key.reserve(bindings.size() * 4);
+		for (const auto& binding : bindings){
+			key.push_back(binding.binding);
+			key.push_back(static_cast<uint32_t>(binding.descriptorType));
+			key.push_back(binding.descriptorCount);
+			key.push_back(binding.stageFlags);
+		}
+
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		auto found = setLayouts.find(key);
+		if (found != setLayouts.end()){
+			return found->second;
+		}
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+		layoutInfo.pBindings = bindings.data();
+
+		VkDescriptorSetLayout setLayout;
+		if (vkCreateDescriptorSetLayout(*device, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS){
+			throw std::runtime_error("Failed to create descriptor set layout");
+		}
+
+		setLayouts.emplace(key, setLayout);
+		if (created){
+			*created = true;
+		}
+		return setLayout;
+	}
+
+	VkPipelineLayout SEDescriptorLayoutCache::GetPipelineLayout(const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts,
+		const std::vector<VkPushConstantRange>& pushConstantRanges, bool* created){
+		// set layouts are already unique per contents, so their handles are a fine key
+		std::vector<uint64_t> key;
+		for (VkDescriptorSetLayout setLayout : descriptorSetLayouts){
+			key.push_back((uint64_t)setLayout);
+		}
+		key.push_back(~0ull);
+		for (const auto& range : pushConstantRanges){
+			key.push_back(range.stageFlags);
+			key.push_back(range.offset);
+			key.push_back(range.size);
+		}
+
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		auto found = pipelineLayouts.find(key);
+		if (found != pipelineLayouts.end()){
+			return found->second;
+		}
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+		pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+		pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+
+		VkPipelineLayout pipelineLayout;
+		if (vkCreatePipelineLayout(*device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS){
+			throw std::runtime_error("Failed to create pipeline layout");
+		}
+
+		pipelineLayouts.emplace(key, pipelineLayout);
+		if (created){
+			*created = true;
+		}
+		return pipelineLayout;
+	}
+
+	SEPipelineLayoutInfo SEDescriptorLayoutCache::GetPipelineLayout(const std::vector<const SEShaderReflection*>& stages,
+		const std::map<uint32_t, VkDescriptorSetLayout>& fixedSets){
+		// set -> bindings, stage flags merged for bindings more than one stage declares
+		std::map<uint32_t, std::vector<VkDescriptorSetLayoutBinding>> sets;
+		VkPushConstantRange pushConstants = {};
+
+		for (const SEShaderReflection* stage : stages){
+			for (const auto& binding : stage->bindings){
+				auto& setBindings = sets[binding.set];
+				auto existing = std::find_if(setBindings.begin(), setBindings.end(),
+					[&binding](const VkDescriptorSetLayoutBinding& b) { return b.binding == binding.binding; });
+
+				if (existing != setBindings.end()){
+					// SPIR-V cant say whether a buffer is bound with a dynamic offset, so whoever asks for dynamic wins
+					bool sameType = DynamicVariant(existing->descriptorType) == DynamicVariant(binding.type);
+					if (!sameType || existing->descriptorCount != binding.count){
+						throw std::runtime_error("Shader stages disagree on set " + std::to_string(binding.set)
+							+ " binding " + std::to_string(binding.binding) + " (" + binding.name + ")");
+					}
+					if (binding.type == DynamicVariant(binding.type)){
+						existing->descriptorType = binding.type;
+					}
+					existing->stageFlags |= stage->stage;
+					continue;
+				}
+
+				VkDescriptorSetLayoutBinding layoutBinding = {};
+				layoutBinding.binding = binding.binding;
+				layoutBinding.descriptorType = binding.type;
+				layoutBinding.descriptorCount = binding.count;
+				layoutBinding.stageFlags = stage->stage;
+				setBindings.push_back(layoutBinding);
+			}
+
+			// one range covering every stages block keeps the layout valid whatever each stage declares
+			if (stage->pushConstantSize > 0){
+				pushConstants.stageFlags |= stage->stage;
+				pushConstants.size = std::max(pushConstants.size, stage->pushConstantSize);
+			}
+		}
+
+		SEPipelineLayoutInfo info = {};
+
+		// sets have to be contiguous in the layout, gaps get an empty set layout
+		uint32_t setCount = sets.empty() ? 0 : sets.rbegin()->first + 1;
+		if (!fixedSets.empty()){
+			setCount = std::max(setCount, fixedSets.rbegin()->first + 1);
+		}
+		for (uint32_t set = 0; set < setCount; set++){
+			auto fixed = fixedSets.find(set);
+			if (fixed != fixedSets.end()){
+				info.setLayouts.push_back(fixed->second);
+				continue;
+			}
+			auto found = sets.find(set);
+			bool created = false;
+			info.setLayouts.push_back(GetSetLayout(found != sets.end() ? found->second : std::vector<VkDescriptorSetLayoutBinding>(), &created));
+			if (created){
+				info.createdSetLayouts.push_back(info.setLayouts.back());
+			}
+		}
+		if (pushConstants.size > 0){
+			info.pushConstantRanges.push_back(pushConstants);
+		}
+
+		info.layout = GetPipelineLayout(info.setLayouts, info.pushConstantRanges, &info.createdLayout);
+		return info;
+	}
+
+	void SEDescriptorLayoutCache::Discard(const SEPipelineLayoutInfo& info){
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		if (info.createdLayout){
+			auto found = std::find_if(pipelineLayouts.begin(), pipelineLayouts.end(),
+				[&info](const std::pair<const std::vector<uint64_t>, VkPipelineLayout>& entry) { return entry.second == info.layout; });
+			if (found != pipelineLayouts.end()){
+				vkDestroyPipelineLayout(*device, found->second, VK_NULL_HANDLE);
+				pipelineLayouts.erase(found);
+			}
+		}
+		for (VkDescriptorSetLayout setLayout : info.createdSetLayouts){
+			auto found = std::find_if(setLayouts.begin(), setLayouts.end(),
+				[setLayout](const std::pair<const std::vector<uint32_t>, VkDescriptorSetLayout>& entry) { return entry.second == setLayout; });
+			if (found != setLayouts.end()){
+				vkDestroyDescriptorSetLayout(*device, found->second, VK_NULL_HANDLE);
+				setLayouts.erase(found);
+			}
+		}
+	}
+}
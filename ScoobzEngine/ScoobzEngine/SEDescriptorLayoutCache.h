@@ -0,0 +1,57 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "SESpirvReflect.h"
+
+namespace ScoobzEngine {
+
+	// what a pipeline layout built from reflection ended up with, callers need the set layouts to allocate descriptor sets
+	struct SEPipelineLayoutInfo{
+		VkPipelineLayout layout;
+		std::vector<VkDescriptorSetLayout> setLayouts; // indexed by set number
+		std::vector<VkPushConstantRange> pushConstantRanges;
+		// what this call had to create rather than find, see Discard
+		bool createdLayout;
+		std::vector<VkDescriptorSetLayout> createdSetLayouts;
+	};
+
+	// descriptor set layouts and pipeline layouts keyed by their contents, so shaders that declare the same
+	// resources share one layout object. everything lives until Cleanup, unless its discarded
+	class SEDescriptorLayoutCache{
+
+	public:
+		SEDescriptorLayoutCache();~SEDescriptorLayoutCache();
+
+		//FUNCTIONS :: PUBLIC
+		void Create(const VkDevice*);
+		void Cleanup();
+		// the flag, when given, is set if the layout wasnt cached yet
+		VkDescriptorSetLayout GetSetLayout(std::vector<VkDescriptorSetLayoutBinding>, bool* = nullptr);
+		VkPipelineLayout GetPipelineLayout(const std::vector<VkDescriptorSetLayout>&, const std::vector<VkPushConstantRange>&, bool* = nullptr);
+		// merges every stages resources, a binding used by several stages is visible to all of them.
+		// sets in the map use the given layout whatever the stages declare for them, for layouts that need
+		// creation flags the cache cant key on, like the bindless table
+		SEPipelineLayoutInfo GetPipelineLayout(const std::vector<const SEShaderReflection*>&,
+			const std::map<uint32_t, VkDescriptorSetLayout>& = std::map<uint32_t, VkDescriptorSetLayout>());
+		// destroys whatever a GetPipelineLayout only made to be compared and thrown away. call straight after it,
+		// before anything else can have been handed the same layouts
+		void Discard(const SEPipelineLayoutInfo&);
+
+		//Getters
+		size_t GetSetLayoutCount() { return setLayouts.size(); }
+		size_t GetPipelineLayoutCount() { return pipelineLayouts.size(); }
+
+	private:
+		static VkDescriptorType DynamicVariant(VkDescriptorType);
+
+		const VkDevice* device = nullptr;
+
+		std::mutex cacheMutex;
+		std::map<std::vector<uint32_t>, VkDescriptorSetLayout> setLayouts;
+		std::map<std::vector<uint64_t>, VkPipelineLayout> pipelineLayouts;
+	};
+}
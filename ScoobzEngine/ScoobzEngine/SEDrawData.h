@@ -0,0 +1,53 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include "SESpirvReflect.h"
+
+namespace ScoobzEngine{
+
+	// per object data. every objects block is packed into the uniform ring once a frame and read as an array
+	// out of set 0 binding 0, a storage buffer whose dynamic offset is the start of this frames array
+	struct SEObjectUniforms{
+		glm::mat4 model;
+	};
+
+	// one draw of the frame, a range of the index buffer for one visible object
+	struct SEMeshDraw{
+		uint32_t object; // into this frames object array
+		uint32_t firstIndex;
+		uint32_t indexCount;
+	};
+
+	// the bindless table is bound as set 1, see SEBindlessTable
+	const uint32_t SE_BINDLESS_SET = 1;
+
+	// everything that changes between draws, pushed per draw so the descriptor sets are only bound once a frame
+	struct SEDrawConstants{
+		uint32_t objectIndex; // into the object array
+		uint32_t materialIndex; // into the bindless tables
+		uint32_t padding[2];
+		glm::vec4 tint;
+	};
+
+	// what the engine binds for every draw, merged into the reflected pipeline layout like an extra shader stage
+	// so the layout is the same whether or not a shader actually reads it. visible to both stages
+	inline const SEShaderReflection& GetDrawInterface(){
+		static const SEShaderReflection drawInterface = []{
+			SEShaderReflection reflection = {};
+			reflection.stage = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+			reflection.entryPoint = "main";
+
+			SEShaderBinding objectBinding;
+			objectBinding.set = 0;
+			objectBinding.binding = 0;
+			objectBinding.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+			objectBinding.count = 1;
+			objectBinding.name = "Objects";
+			reflection.bindings.push_back(objectBinding);
+
+			reflection.pushConstantSize = sizeof(SEDrawConstants);
+			return reflection;
+		}();
+		return drawInterface;
+	}
+}
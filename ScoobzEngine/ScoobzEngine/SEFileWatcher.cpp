@@ -0,0 +1,143 @@
+#include "SEFileWatcher.h"
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace ScoobzEngine {
+
+	SEFileWatcher::SEFileWatcher(){}
+	SEFileWatcher::~SEFileWatcher(){}
+
+	bool SEFileWatcher::Matches(const std::string& name){
+		return name.size() >= extension.size() && name.compare(name.size() - extension.size(), extension.size(), extension) == 0;
+	}
+
+#ifdef __linux__
+
+	void SEFileWatcher::Create(const std::string& watchDirectory, const std::string& watchExtension){
+		directory = watchDirectory;
+		extension = watchExtension;
+
+		inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (inotifyFd < 0){
+			std::cerr << "File watcher: inotify unavailable, " << directory << " wont be watched" << std::endl;
+			return;
+		}
+
+		// close after write and renames into the directory, editors and compilers that write a temp file then
+		// rename it show up as the rename
+		watchDescriptor = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (watchDescriptor < 0){
+			std::cerr << "File watcher: cant watch " << directory << std::endl;
+			return;
+		}
+		std::cout << "File Watcher Creation: SUCCESSFUL! (" << directory << ")" << std::endl;
+	}
+
+	void SEFileWatcher::Cleanup(){
+		if (inotifyFd >= 0){
+			close(inotifyFd);
+			inotifyFd = -1;
+			watchDescriptor = -1;
+		}
+	}
+
+	std::vector<std::string> SEFileWatcher::Poll(){
+		std::vector<std::string> changed;
+		if (watchDescriptor < 0){
+			return changed;
+		}
+
+		alignas(inotify_event) char buffer[4096];
+		for (;;){
+			ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+			if (length <= 0){
+				break; // EAGAIN, nothing left
+			}
+
+			for (char* cursor = buffer; cursor < buffer + length;){
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(cursor);
+				if (event->len > 0 && Matches(event->name)){
+					std::string path = directory + "/" + event->name;
+					if (std::find(changed.begin(), changed.end(), path) == changed.end()){
+						changed.push_back(path);
+					}
+				}
+				cursor += sizeof(inotify_event) + event->len;
+			}
+		}
+		return changed;
+	}
+
+#else
+
+	void SEFileWatcher::Create(const std::string& watchDirectory, const std::string& watchExtension){
+		directory = watchDirectory;
+		extension = watchExtension;
+
+		// the first scan only records whats there
+		Scan(nullptr);
+		lastScan = std::chrono::steady_clock::now();
+		std::cout << "File Watcher Creation: SUCCESSFUL! (" << directory << ", polling)" << std::endl;
+	}
+
+	void SEFileWatcher::Cleanup(){
+		writeTimes.clear();
+	}
+
+	std::vector<std::string> SEFileWatcher::Poll(){
+		std::vector<std::string> changed;
+
+		auto now = std::chrono::steady_clock::now();
+		if (now - lastScan < std::chrono::milliseconds(250)){
+			return changed;
+		}
+		lastScan = now;
+
+		Scan(&changed);
+		return changed;
+	}
+
+	void SEFileWatcher::Scan(std::vector<std::string>* changed){
+#ifdef _WIN32
+		WIN32_FIND_DATAA findData;
+		HANDLE find = FindFirstFileA((directory + "/*").c_str(), &findData);
+		if (find == INVALID_HANDLE_VALUE){
+			return;
+		}
+
+		do{
+			if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) || !Matches(findData.cFileName)){
+				continue;
+			}
+
+			uint64_t writeTime = (static_cast<uint64_t>(findData.ftLastWriteTime.dwHighDateTime) << 32) | findData.ftLastWriteTime.dwLowDateTime;
+			std::string path = directory + "/" + findData.cFileName;
+
+			auto found = writeTimes.find(path);
+			if (found != writeTimes.end() && found->second == writeTime){
+				continue;
+			}
+			writeTimes[path] = writeTime;
+
+			if (changed){
+				changed->push_back(path);
+			}
+		} while (FindNextFileA(find, &findData));
+
+		FindClose(find);
+#else
+		(void)changed;
+#endif
+	}
+
+#endif
+}
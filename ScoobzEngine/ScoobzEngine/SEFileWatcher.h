@@ -0,0 +1,41 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ScoobzEngine {
+
+	// reports files in one directory that finished changing. uses inotify on Linux, everywhere else it
+	// compares last write times a few times a second. Poll never blocks
+	class SEFileWatcher{
+
+	public:
+		SEFileWatcher();~SEFileWatcher();
+
+		//FUNCTIONS :: PUBLIC
+		// only files ending in the extension are reported, an empty extension reports everything
+		void Create(const std::string&, const std::string&);
+		void Cleanup();
+		// paths come back as directory/name, each at most once per call
+		std::vector<std::string> Poll();
+
+	private:
+		bool Matches(const std::string&);
+
+		std::string directory;
+		std::string extension;
+
+#ifdef __linux__
+		int inotifyFd = -1;
+		int watchDescriptor = -1;
+#else
+		void Scan(std::vector<std::string>*);
+
+		std::map<std::string, uint64_t> writeTimes;
+		std::chrono::steady_clock::time_point lastScan;
+#endif
+	};
+}
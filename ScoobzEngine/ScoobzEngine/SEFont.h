@@ -0,0 +1,78 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ScoobzEngine {
+
+	// a glyph as 8 bit coverage, one byte a pixel, rows top down. there is always an empty pixel all the way round
+	// the outline, so bitmaps can sit right next to each other in an atlas without bleeding under linear filtering
+	struct SEGlyphBitmap{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		int32_t left = 0; // from the pen to the bitmaps left edge, in pixels
+		int32_t top = 0; // from the baseline to the bitmaps top edge, negative is above it
+		std::vector<uint8_t> coverage;
+	};
+
+	// reads TrueType fonts with glyf outlines and rasterizes their glyphs. the quadratic outlines are flattened into
+	// lines and the signed area each line sweeps is accumulated per pixel, so the coverage is exact for straight edges
+	// and antialiased without supersampling. hinting is ignored and kerning only comes from the kern table, GPOS isnt read
+	class SEFont{
+
+	public:
+		SEFont();~SEFont();
+
+		//FUNCTIONS :: PUBLIC
+		// throws if the file cant be read or isnt a TrueType font with outlines
+		void Load(const std::string&);
+		void LoadFromMemory(std::vector<uint8_t>);
+		// 0, the missing glyph, when the font has nothing for the codepoint
+		uint32_t GetGlyphIndex(uint32_t) const;
+		// pixels per font unit for lines this many pixels from ascent to descent
+		float GetScale(float) const;
+		// glyph, pixels per font unit
+		SEGlyphBitmap Rasterize(uint32_t, float) const;
+		// in font units
+		int32_t GetAdvance(uint32_t) const;
+		// in font units, added to the advance between the left and the right glyph
+		int32_t GetKerning(uint32_t, uint32_t) const;
+
+		//Getters
+		// in font units, descent is negative
+		int32_t GetAscent() const { return ascent; }
+		int32_t GetDescent() const { return descent; }
+		int32_t GetLineGap() const { return lineGap; }
+		uint32_t GetGlyphCount() const { return glyphCount; }
+
+	private:
+		struct OutlinePoint{
+			glm::vec2 position;
+			bool onCurve;
+		};
+
+		uint32_t FindTable(const char*, uint32_t* = nullptr) const;
+		void ReadCharacterMap();
+		// appends the glyphs points, transformed, with the index one past each contours last point
+		void AppendOutline(uint32_t, const glm::mat2&, const glm::vec2&, int, std::vector<OutlinePoint>&, std::vector<uint32_t>&) const;
+		bool GetGlyphRange(uint32_t, uint32_t&, uint32_t&) const;
+
+		std::vector<uint8_t> data;
+		uint32_t glyphCount = 0;
+		uint32_t unitsPerEm = 0;
+		int32_t ascent = 0;
+		int32_t descent = 0;
+		int32_t lineGap = 0;
+		uint32_t horizontalMetricCount = 0;
+		bool longLocations = false;
+		uint32_t locaOffset = 0;
+		uint32_t glyfOffset = 0;
+		uint32_t glyfLength = 0;
+		uint32_t hmtxOffset = 0;
+		uint32_t characterMapOffset = 0; // the subtable that was picked, 0 when the font has none that can be read
+		uint32_t characterMapFormat = 0;
+		uint32_t kerningPairsOffset = 0; // the pairs of the first horizontal format 0 kern subtable
+		uint32_t kerningPairCount = 0;
+	};
+}
@@ -0,0 +1,246 @@
+#include "SEFrustumCull.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// the SSE kernel only needs what x64 always has. the AVX2 one is compiled alongside it and only picked when the cpu
+// reports AVX2 and the OS saves the wide registers, so the rest of the engine doesnt need /arch:AVX2
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define SE_CULL_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SE_TARGET_AVX2
+#else
+#define SE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace ScoobzEngine {
+
+	// raw arrays for the kernels so nothing goes through the store in the inner loop
+	struct CullInput{
+		const float* centerX;
+		const float* centerY;
+		const float* centerZ;
+		const float* extentX;
+		const float* extentY;
+		const float* extentZ;
+		const float* radius;
+		SEFrustum frustum;
+	};
+
+	typedef uint32_t(*CullKernel)(const CullInput&, uint32_t, uint32_t, uint32_t*);
+
+	SEFrustum ExtractFrustum(const glm::mat4& viewProjection){
+		// glm is column major, row i is the ith component of every column
+		glm::vec4 rows[4];
+		for (int i = 0; i < 4; i++){
+			rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+		}
+
+		SEFrustum frustum;
+		frustum.planes[0] = rows[3] + rows[0]; // left, x >= -w
+		frustum.planes[1] = rows[3] - rows[0]; // right, x <= w
+		frustum.planes[2] = rows[3] + rows[1]; // top, y >= -w
+		frustum.planes[3] = rows[3] - rows[1]; // bottom, y <= w
+		frustum.planes[4] = rows[2]; // near, z >= 0
+		frustum.planes[5] = rows[3] - rows[2]; // far, z <= w
+		for (auto& plane : frustum.planes){
+			plane /= glm::length(glm::vec3(plane));
+		}
+		return frustum;
+	}
+
+	const char* GetCullPathName(SECullPath path){
+		switch (path){
+		case SE_CULL_SSE: return "SSE";
+		case SE_CULL_AVX2: return "AVX2";
+		default: return "scalar";
+		}
+	}
+
+	SECullPath GetBestCullPath(){
+#ifdef SE_CULL_SIMD
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] >= 7){
+			__cpuid(info, 1);
+			// the OS has to save the ymm registers too, not just the cpu support them
+			bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+			__cpuidex(info, 7, 0);
+			if (osSavesYmm && (info[1] & (1 << 5))){
+				return SE_CULL_AVX2;
+			}
+		}
+#else
+		if (__builtin_cpu_supports("avx2")){
+			return SE_CULL_AVX2;
+		}
+#endif
+		return SE_CULL_SSE;
+#else
+		return SE_CULL_SCALAR;
+#endif
+	}
+
+	// an object is outside when its centre is further behind any plane than its bounds reach. the box reaches
+	// along the plane normal as far as its extents projected onto it, the sphere by its radius, the smaller wins
+	static uint32_t CullScalar(const CullInput& input, uint32_t begin, uint32_t end, uint32_t* visible){
+		uint32_t visibleCount = 0;
+		for (uint32_t i = begin; i < end; i++){
+			bool inside = true;
+			for (const auto& plane : input.frustum.planes){
+				float distance = plane.x * input.centerX[i] + plane.y * input.centerY[i] + plane.z * input.centerZ[i] + plane.w;
+				float boxReach = std::abs(plane.x) * input.extentX[i] + std::abs(plane.y) * input.extentY[i] + std::abs(plane.z) * input.extentZ[i];
+				if (distance + std::min(input.radius[i], boxReach) < 0.0f){
+					inside = false;
+					break;
+				}
+			}
+			visible[visibleCount] = i;
+			visibleCount += inside ? 1 : 0;
+		}
+		return visibleCount;
+	}
+
+#ifdef SE_CULL_SIMD
+	// every index is written, the count only moves past the visible ones. no branch on the mask so a mix of
+	// visible and culled objects doesnt cost mispredicts
+	static uint32_t CullSSE(const CullInput& input, uint32_t begin, uint32_t end, uint32_t* visible){
+		__m128 planeX[6], planeY[6], planeZ[6], planeW[6], absX[6], absY[6], absZ[6];
+		for (int p = 0; p < 6; p++){
+			const glm::vec4& plane = input.frustum.planes[p];
+			planeX[p] = _mm_set1_ps(plane.x);
+			planeY[p] = _mm_set1_ps(plane.y);
+			planeZ[p] = _mm_set1_ps(plane.z);
+			planeW[p] = _mm_set1_ps(plane.w);
+			absX[p] = _mm_set1_ps(std::abs(plane.x));
+			absY[p] = _mm_set1_ps(std::abs(plane.y));
+			absZ[p] = _mm_set1_ps(std::abs(plane.z));
+		}
+		const __m128 zero = _mm_setzero_ps();
+
+		uint32_t visibleCount = 0;
+		for (uint32_t i = begin; i < end; i += 4){
+			__m128 centerX = _mm_loadu_ps(input.centerX + i);
+			__m128 centerY = _mm_loadu_ps(input.centerY + i);
+			__m128 centerZ = _mm_loadu_ps(input.centerZ + i);
+			__m128 extentX = _mm_loadu_ps(input.extentX + i);
+			__m128 extentY = _mm_loadu_ps(input.extentY + i);
+			__m128 extentZ = _mm_loadu_ps(input.extentZ + i);
+			__m128 radius = _mm_loadu_ps(input.radius + i);
+
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (int p = 0; p < 6; p++){
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], centerX), _mm_mul_ps(planeY[p], centerY)),
+					_mm_add_ps(_mm_mul_ps(planeZ[p], centerZ), planeW[p]));
+				__m128 boxReach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absX[p], extentX), _mm_mul_ps(absY[p], extentY)), _mm_mul_ps(absZ[p], extentZ));
+				__m128 reach = _mm_min_ps(radius, boxReach);
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, reach), zero));
+			}
+
+			uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(inside));
+			for (uint32_t lane = 0; lane < 4; lane++){
+				visible[visibleCount] = i + lane;
+				visibleCount += (mask >> lane) & 1;
+			}
+		}
+		return visibleCount;
+	}
+
+	SE_TARGET_AVX2 static uint32_t CullAVX2(const CullInput& input, uint32_t begin, uint32_t end, uint32_t* visible){
+		__m256 planeX[6], planeY[6], planeZ[6], planeW[6], absX[6], absY[6], absZ[6];
+		for (int p = 0; p < 6; p++){
+			const glm::vec4& plane = input.frustum.planes[p];
+			planeX[p] = _mm256_set1_ps(plane.x);
+			planeY[p] = _mm256_set1_ps(plane.y);
+			planeZ[p] = _mm256_set1_ps(plane.z);
+			planeW[p] = _mm256_set1_ps(plane.w);
+			absX[p] = _mm256_set1_ps(std::abs(plane.x));
+			absY[p] = _mm256_set1_ps(std::abs(plane.y));
+			absZ[p] = _mm256_set1_ps(std::abs(plane.z));
+		}
+		const __m256 zero = _mm256_setzero_ps();
+
+		uint32_t visibleCount = 0;
+		for (uint32_t i = begin; i < end; i += 8){
+			__m256 centerX = _mm256_loadu_ps(input.centerX + i);
+			__m256 centerY = _mm256_loadu_ps(input.centerY + i);
+			__m256 centerZ = _mm256_loadu_ps(input.centerZ + i);
+			__m256 extentX = _mm256_loadu_ps(input.extentX + i);
+			__m256 extentY = _mm256_loadu_ps(input.extentY + i);
+			__m256 extentZ = _mm256_loadu_ps(input.extentZ + i);
+			__m256 radius = _mm256_loadu_ps(input.radius + i);
+
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (int p = 0; p < 6; p++){
+				__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planeX[p], centerX), _mm256_mul_ps(planeY[p], centerY)),
+					_mm256_add_ps(_mm256_mul_ps(planeZ[p], centerZ), planeW[p]));
+				__m256 boxReach = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(absX[p], extentX), _mm256_mul_ps(absY[p], extentY)), _mm256_mul_ps(absZ[p], extentZ));
+				__m256 reach = _mm256_min_ps(radius, boxReach);
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, reach), zero, _CMP_GE_OQ));
+			}
+
+			uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+			for (uint32_t lane = 0; lane < 8; lane++){
+				visible[visibleCount] = i + lane;
+				visibleCount += (mask >> lane) & 1;
+			}
+		}
+		return visibleCount;
+	}
+#endif
+
+	static CullKernel GetKernel(SECullPath path){
+#ifdef SE_CULL_SIMD
+		switch (path){
+		case SE_CULL_SSE: return CullSSE;
+		case SE_CULL_AVX2: return CullAVX2;
+		default: return CullScalar;
+		}
+#else
+		return CullScalar;
+#endif
+	}
+
+	uint32_t CullObjects(const SEObjectStore& store, const SEFrustum& frustum, SECullPath path, std::vector<uint32_t>& visible, SEJobSystem* jobSystem){
+		CullInput input;
+		input.centerX = store.GetCenterX();
+		input.centerY = store.GetCenterY();
+		input.centerZ = store.GetCenterZ();
+		input.extentX = store.GetExtentX();
+		input.extentY = store.GetExtentY();
+		input.extentZ = store.GetExtentZ();
+		input.radius = store.GetRadius();
+		input.frustum = frustum;
+
+		// the padding is always culled, so the kernels just run to the end of it
+		uint32_t paddedCount = store.GetPaddedCount();
+		visible.resize(paddedCount);
+		CullKernel kernel = GetKernel(path);
+		if (jobSystem == nullptr || paddedCount <= SE_CULL_CHUNK_SIZE){
+			return kernel(input, 0, paddedCount, visible.data());
+		}
+
+		// each chunk writes its indices where the chunk starts, then they are closed up in order
+		uint32_t chunkCount = (paddedCount + SE_CULL_CHUNK_SIZE - 1) / SE_CULL_CHUNK_SIZE;
+		std::vector<uint32_t> chunkVisible(chunkCount);
+		uint32_t* output = visible.data();
+		jobSystem->ParallelFor(chunkCount, 1, [&](uint32_t firstChunk, uint32_t lastChunk){
+			for (uint32_t chunk = firstChunk; chunk < lastChunk; chunk++){
+				uint32_t begin = chunk * SE_CULL_CHUNK_SIZE;
+				uint32_t end = std::min(paddedCount, begin + SE_CULL_CHUNK_SIZE);
+				chunkVisible[chunk] = kernel(input, begin, end, output + begin);
+			}
+		});
+
+		uint32_t visibleCount = chunkVisible[0];
+		for (uint32_t chunk = 1; chunk < chunkCount; chunk++){
+			memmove(output + visibleCount, output + chunk * SE_CULL_CHUNK_SIZE, chunkVisible[chunk] * sizeof(uint32_t));
+			visibleCount += chunkVisible[chunk];
+		}
+		return visibleCount;
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include "SEObjectStore.h"
+#include "SEJobSystem.h"
+
+namespace ScoobzEngine {
+
+	// widest first is fastest, all of them give the same answer
+	enum SECullPath{
+		SE_CULL_SCALAR,
+		SE_CULL_SSE, // 4 objects per instruction
+		SE_CULL_AVX2, // 8 objects per instruction
+	};
+
+	// objects per job when culling is split across threads, a multiple of SE_OBJECT_STORE_PAD
+	const uint32_t SE_CULL_CHUNK_SIZE = 16384;
+
+	// plane xyz is the normal pointing inwards, w the distance. normalised, so a point is inside by its distance
+	struct SEFrustum{
+		glm::vec4 planes[6];
+	};
+
+	// the planes of a view projection matrix in Vulkan clip space, depth 0 to 1
+	SEFrustum ExtractFrustum(const glm::mat4&);
+
+	// the widest path this build and cpu can run
+	SECullPath GetBestCullPath();
+	const char* GetCullPathName(SECullPath);
+
+	// writes the indices of every object whose bounds touch the frustum into visible, in store order, and returns
+	// how many there are. visible is resized to the stores padded count so the kernels can write without checks.
+	// with a job system and more than one chunk of objects the chunks are culled in parallel
+	uint32_t CullObjects(const SEObjectStore&, const SEFrustum&, SECullPath, std::vector<uint32_t>&, SEJobSystem* = nullptr);
+}
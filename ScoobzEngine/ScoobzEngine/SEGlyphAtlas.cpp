@@ -0,0 +1,97 @@
+#include "SEGlyphAtlas.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ScoobzEngine {
+
+	SEGlyphAtlas::SEGlyphAtlas(){}
+	SEGlyphAtlas::~SEGlyphAtlas(){}
+
+	void SEGlyphAtlas::Build(const SEFont* fontIn, float pixelHeight, const std::vector<uint32_t>& codepoints, uint32_t pageSizeIn){
+		font = fontIn;
+		pageSize = pageSizeIn;
+		scale = font->GetScale(pixelHeight);
+		ascent = font->GetAscent() * scale;
+		lineHeight = (font->GetAscent() - font->GetDescent() + font->GetLineGap()) * scale;
+		pages.clear();
+		glyphs.clear();
+
+		const uint32_t solidSize = 4;
+		uint32_t solidX, solidY;
+		pages.emplace_back();
+		pages[0].packer.Create(pageSize, pageSize);
+		pages[0].coverage.assign(static_cast<size_t>(pageSize) * pageSize, 0);
+		pages[0].packer.Pack(solidSize, solidSize, solidX, solidY);
+		for (uint32_t row = 0; row < solidSize; row++){
+			std::fill_n(&pages[0].coverage[(solidY + row) * pageSize + solidX], solidSize, static_cast<uint8_t>(0xff));
+		}
+		solidUvRect = glm::vec4(solidX + 1.5f, solidY + 1.5f, solidX + 2.5f, solidY + 2.5f) / static_cast<float>(pageSize);
+
+		struct Pending{
+			uint32_t codepoint;
+			uint32_t glyphIndex;
+			SEGlyphBitmap bitmap;
+		};
+		std::vector<Pending> pending;
+		pending.reserve(codepoints.size());
+		for (uint32_t codepoint : codepoints){
+			uint32_t glyphIndex = font->GetGlyphIndex(codepoint);
+			if (glyphIndex != 0 && glyphs.find(codepoint) == glyphs.end()){
+				pending.push_back({ codepoint, glyphIndex, font->Rasterize(glyphIndex, scale) });
+				glyphs[codepoint] = {};
+			}
+		}
+
+		// tallest first keeps the skyline flat, so little space is lost under overhangs
+		std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) {
+			return a.bitmap.height != b.bitmap.height ? a.bitmap.height > b.bitmap.height : a.bitmap.width > b.bitmap.width;
+		});
+
+		for (const auto& entry : pending){
+			const SEGlyphBitmap& bitmap = entry.bitmap;
+			SEGlyph glyph = {};
+			glyph.glyphIndex = entry.glyphIndex;
+			glyph.left = static_cast<int16_t>(bitmap.left);
+			glyph.top = static_cast<int16_t>(bitmap.top);
+			glyph.advance = font->GetAdvance(entry.glyphIndex) * scale;
+
+			if (bitmap.width > 0){
+				if (bitmap.width > pageSize || bitmap.height > pageSize){
+					throw std::runtime_error("Glyph is bigger than an atlas page");
+				}
+				uint32_t x = 0;
+				uint32_t y = 0;
+				uint32_t page = 0;
+				while (page < pages.size() && !pages[page].packer.Pack(bitmap.width, bitmap.height, x, y)){
+					page++;
+				}
+				if (page == pages.size()){
+					pages.emplace_back();
+					pages[page].packer.Create(pageSize, pageSize);
+					pages[page].coverage.assign(static_cast<size_t>(pageSize) * pageSize, 0);
+					pages[page].packer.Pack(bitmap.width, bitmap.height, x, y);
+				}
+
+				for (uint32_t row = 0; row < bitmap.height; row++){
+					std::copy_n(&bitmap.coverage[row * bitmap.width], bitmap.width, &pages[page].coverage[(y + row) * pageSize + x]);
+				}
+				glyph.page = page;
+				glyph.x = static_cast<uint16_t>(x);
+				glyph.y = static_cast<uint16_t>(y);
+				glyph.width = static_cast<uint16_t>(bitmap.width);
+				glyph.height = static_cast<uint16_t>(bitmap.height);
+			}
+			glyphs[entry.codepoint] = glyph;
+		}
+	}
+
+	const SEGlyph* SEGlyphAtlas::GetGlyph(uint32_t codepoint) const {
+		auto found = glyphs.find(codepoint);
+		return found != glyphs.end() ? &found->second : nullptr;
+	}
+
+	float SEGlyphAtlas::GetKerning(const SEGlyph& left, const SEGlyph& right) const {
+		return font->GetKerning(left.glyphIndex, right.glyphIndex) * scale;
+	}
+}
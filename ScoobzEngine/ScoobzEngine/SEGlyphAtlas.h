@@ -0,0 +1,71 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "SEFont.h"
+#include "SESkylinePacker.h"
+
+namespace ScoobzEngine {
+
+	// width and height of an atlas page in pixels
+	const uint32_t SE_GLYPH_ATLAS_PAGE_SIZE = 512;
+
+	struct SEGlyph{
+		uint32_t glyphIndex; // in the font, for kerning
+		uint32_t page;
+		uint16_t x; // in the page, width and height are 0 for glyphs without an outline like the space
+		uint16_t y;
+		uint16_t width;
+		uint16_t height;
+		int16_t left; // from the pen on the baseline to the bitmaps top left
+		int16_t top;
+		float advance; // pixels
+	};
+
+	// a set of glyphs rasterized once at one size and packed into pages of 8 bit coverage. glyphs go in tallest
+	// first, each into the first page with room, so pages fill up before a new one is started. the first page also
+	// has a small fully covered block, so solid rectangles can be drawn out of the same texture as the text
+	class SEGlyphAtlas{
+
+	public:
+		SEGlyphAtlas();~SEGlyphAtlas();
+
+		//FUNCTIONS :: PUBLIC
+		// font, pixels from ascent to descent, codepoints and page size. codepoints the font has no glyph for are left
+		// out. the font has to outlive the atlas, kerning is read from it. throws if a glyph is bigger than a page
+		void Build(const SEFont*, float, const std::vector<uint32_t>&, uint32_t = SE_GLYPH_ATLAS_PAGE_SIZE);
+		// null when the codepoint wasnt built
+		const SEGlyph* GetGlyph(uint32_t) const;
+		// pixels between two glyphs on top of the lefts advance
+		float GetKerning(const SEGlyph&, const SEGlyph&) const;
+
+		//Getters
+		uint32_t GetPageCount() const { return static_cast<uint32_t>(pages.size()); }
+		uint32_t GetPageSize() const { return pageSize; }
+		// row by row, one byte a pixel
+		const std::vector<uint8_t>& GetPage(uint32_t page) const { return pages[page].coverage; }
+		float GetPageOccupancy(uint32_t page) const { return pages[page].packer.GetOccupancy(); }
+		// texels well inside the solid block on page 0, linear filtering never reaches its edge
+		const glm::vec4& GetSolidUvRect() const { return solidUvRect; }
+		uint32_t GetGlyphCount() const { return static_cast<uint32_t>(glyphs.size()); }
+		// pixels from the top of a line to its baseline, and from one baseline to the next
+		float GetAscent() const { return ascent; }
+		float GetLineHeight() const { return lineHeight; }
+
+	private:
+		struct Page{
+			SESkylinePacker packer;
+			std::vector<uint8_t> coverage;
+		};
+
+		const SEFont* font = nullptr;
+		float scale = 0.0f; // pixels per font unit
+		float ascent = 0.0f;
+		float lineHeight = 0.0f;
+		uint32_t pageSize = 0;
+		glm::vec4 solidUvRect = glm::vec4(0.0f);
+		std::vector<Page> pages;
+		std::unordered_map<uint32_t, SEGlyph> glyphs; // by codepoint
+	};
+}
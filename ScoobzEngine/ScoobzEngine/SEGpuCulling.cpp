@@ -0,0 +1,376 @@
+#include "SEGpuCulling.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+namespace ScoobzEngine {
+
+	// objects the buffers start with room for, they double from there
+	static const uint32_t MIN_CAPACITY = 1024;
+	// matches local_size_x in cull.comp
+	static const uint32_t CULL_GROUP_SIZE = 64;
+	// the draw count, then how many were occluded, then the triangles drawn
+	static const uint32_t COUNTERS = 3;
+	// room for draws on top of one per object, for objects culled meshlet by meshlet
+	static const uint32_t MESHLET_DRAWS = 65536;
+
+	SEGpuCulling::SEGpuCulling(){}
+	SEGpuCulling::~SEGpuCulling(){}
+
+	void SEGpuCulling::Create(const VkDevice* logicalDevice, const VkPhysicalDevice* physicalDeviceIn, const VkSurfaceKHR* surfaceIn,
+		uint32_t framesInFlight, uint32_t occlusionTexels, SEDrawIndexedIndirectCount drawIndexedIndirectCountFn){
+
+		device = logicalDevice;
+		physicalDevice = physicalDeviceIn;
+		surface = surfaceIn;
+		drawIndexedIndirectCount = drawIndexedIndirectCountFn;
+		occlusionBytes = sizeof(SEGpuOcclusionHeader) + occlusionTexels * sizeof(float);
+
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(*physicalDevice, &deviceProperties);
+		maxDrawCount = std::max(deviceProperties.limits.maxDrawIndirectCount, 1u);
+
+		capacity = MIN_CAPACITY;
+		slots.resize(framesInFlight);
+		for (auto& slot : slots){
+			CreateSlot(slot);
+			CreateOcclusion(slot);
+			CreateMesh(slot);
+		}
+		SetMeshlets({});
+
+		std::cout << "GPU Culling Creation: SUCCESSFUL! (" << framesInFlight << " x " << capacity << " objects, "
+			<< (drawIndexedIndirectCount ? "draw count from the GPU" : "one indirect draw per object") << ")" << std::endl;
+	}
+
+	void SEGpuCulling::Cleanup(){
+		for (auto& slot : slots){
+			DestroySlot(slot);
+			vkUnmapMemory(*device, slot.occlusionMemory);
+			CleanupBuffer(device, slot.occlusion, slot.occlusionMemory);
+			vkUnmapMemory(*device, slot.meshMemory);
+			CleanupBuffer(device, slot.mesh, slot.meshMemory);
+		}
+		slots.clear();
+		CleanupBuffer(device, meshlets, meshletMemory);
+	}
+
+	void SEGpuCulling::SetMeshlets(const std::vector<SEMeshlet>& meshletData){
+		if (meshlets != VK_NULL_HANDLE){
+			CleanupBuffer(device, meshlets, meshletMemory);
+		}
+
+		// the shader binds it either way, so theres always at least one
+		VkDeviceSize bytes = std::max<size_t>(meshletData.size(), 1) * sizeof(SEMeshlet);
+		CreateBuffer(device, physicalDevice, surface, bytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, meshlets, meshletMemory);
+		if (!meshletData.empty()){
+			void* data;
+			if (vkMapMemory(*device, meshletMemory, 0, bytes, 0, &data) != VK_SUCCESS){
+				throw std::runtime_error("Failed to map GPU culling meshlets");
+			}
+			memcpy(data, meshletData.data(), meshletData.size() * sizeof(SEMeshlet));
+			vkUnmapMemory(*device, meshletMemory);
+		}
+
+		// without the draw count every draw slot past the objects would have to be cleared and walked
+		meshletCount = drawIndexedIndirectCount && meshletData.size() > 1 ? static_cast<uint32_t>(meshletData.size()) : 0;
+	}
+
+	uint32_t SEGpuCulling::GetDrawCapacity(){
+		return capacity + MESHLET_DRAWS;
+	}
+
+	// bounds and transforms are written by the CPU every frame something moves, so they stay host visible. the
+	// draws are only ever touched by the GPU
+	void SEGpuCulling::CreateSlot(Slot& slot){
+		void* data;
+
+		CreateBuffer(device, physicalDevice, surface, capacity * sizeof(glm::mat4), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, slot.transforms, slot.transformMemory);
+		if (vkMapMemory(*device, slot.transformMemory, 0, capacity * sizeof(glm::mat4), 0, &data) != VK_SUCCESS){
+			throw std::runtime_error("Failed to map GPU culling transforms");
+		}
+		slot.mappedTransforms = static_cast<glm::mat4*>(data);
+
+		CreateBuffer(device, physicalDevice, surface, capacity * sizeof(SEGpuObjectBounds), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, slot.bounds, slot.boundsMemory);
+		if (vkMapMemory(*device, slot.boundsMemory, 0, capacity * sizeof(SEGpuObjectBounds), 0, &data) != VK_SUCCESS){
+			throw std::runtime_error("Failed to map GPU culling bounds");
+		}
+		slot.mappedBounds = static_cast<SEGpuObjectBounds*>(data);
+
+		CreateBuffer(device, physicalDevice, surface, GetDrawCapacity() * sizeof(VkDrawIndexedIndirectCommand),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, slot.commands, slot.commandMemory);
+
+		CreateBuffer(device, physicalDevice, surface, COUNTERS * sizeof(uint32_t),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, slot.count, slot.countMemory);
+		if (vkMapMemory(*device, slot.countMemory, 0, COUNTERS * sizeof(uint32_t), 0, &data) != VK_SUCCESS){
+			throw std::runtime_error("Failed to map GPU culling draw count");
+		}
+		slot.mappedCount = static_cast<uint32_t*>(data);
+
+		slot.pending.clear();
+		slot.pendingFlags.clear();
+		slot.uploadAll = true;
+		slot.culled = false;
+	}
+
+	void SEGpuCulling::CreateOcclusion(Slot& slot){
+		CreateBuffer(device, physicalDevice, surface, occlusionBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, slot.occlusion, slot.occlusionMemory);
+		void* data;
+		if (vkMapMemory(*device, slot.occlusionMemory, 0, occlusionBytes, 0, &data) != VK_SUCCESS){
+			throw std::runtime_error("Failed to map GPU culling occlusion buffer");
+		}
+		slot.mappedOcclusion = static_cast<uint8_t*>(data);
+		// nothing is occluded until the first upload
+		memset(slot.mappedOcclusion, 0, sizeof(SEGpuOcclusionHeader));
+	}
+
+	void SEGpuCulling::CreateMesh(Slot& slot){
+		CreateBuffer(device, physicalDevice, surface, sizeof(SEGpuMesh), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, slot.mesh, slot.meshMemory);
+		void* data;
+		if (vkMapMemory(*device, slot.meshMemory, 0, sizeof(SEGpuMesh), 0, &data) != VK_SUCCESS){
+			throw std::runtime_error("Failed to map GPU culling mesh buffer");
+		}
+		slot.mappedMesh = static_cast<SEGpuMesh*>(data);
+		memset(slot.mappedMesh, 0, sizeof(SEGpuMesh));
+	}
+
+	void SEGpuCulling::DestroySlot(Slot& slot){
+		vkUnmapMemory(*device, slot.transformMemory);
+		vkUnmapMemory(*device, slot.boundsMemory);
+		vkUnmapMemory(*device, slot.countMemory);
+		CleanupBuffer(device, slot.transforms, slot.transformMemory);
+		CleanupBuffer(device, slot.bounds, slot.boundsMemory);
+		CleanupBuffer(device, slot.commands, slot.commandMemory);
+		CleanupBuffer(device, slot.count, slot.countMemory);
+	}
+
+	// every slot grows at once, the other slots frame may still be reading its old buffers so they wait in the
+	// deletion queue. the new buffers are empty so everything is uploaded again
+	void SEGpuCulling::Grow(uint32_t objects, SEDeletionQueue* deletionQueue){
+		while (capacity < objects){
+			capacity *= 2;
+		}
+
+		for (auto& slot : slots){
+			Slot* retired = new Slot(slot);
+			deletionQueue->Push([this, retired]{
+				DestroySlot(*retired);
+				delete retired;
+			});
+			CreateSlot(slot);
+		}
+		std::cout << "GPU culling grown to " << capacity << " objects" << std::endl;
+	}
+
+	void SEGpuCulling::BeginFrame(uint32_t slotIndex, SEObjectStore& store, SEDeletionQueue* deletionQueue){
+		currentSlot = slotIndex;
+		Slot& slot = slots[currentSlot];
+
+		// this slots fence has signalled, so the count it culled last time round is final
+		if (slot.culled){
+			stats.objectsVisible += slot.mappedCount[0];
+			stats.objectsOccluded += slot.mappedCount[1];
+			stats.trianglesDrawn += slot.mappedCount[2];
+			lastTriangleCount = slot.mappedCount[2];
+			slot.culled = false;
+		}
+
+		objectCount = store.GetCount();
+		if (objectCount > capacity){
+			Grow(objectCount, deletionQueue);
+		}
+
+		// every slot needs every change, but only this one can be written now, the others may still be in flight
+		for (uint32_t index : store.GetChanges()){
+			for (auto& other : slots){
+				if (other.uploadAll){
+					continue;
+				}
+				if (index >= other.pendingFlags.size()){
+					other.pendingFlags.resize(index + 1);
+				}
+				if (!other.pendingFlags[index]){
+					other.pendingFlags[index] = 1;
+					other.pending.push_back(index);
+				}
+			}
+		}
+
+		if (slot.uploadAll){
+			for (uint32_t i = 0; i < objectCount; i++){
+				Upload(slot, store, i);
+			}
+			stats.objectsUploaded += objectCount;
+			slot.uploadAll = false;
+		}
+		else{
+			for (uint32_t index : slot.pending){
+				slot.pendingFlags[index] = 0;
+				// past the count means it was removed after it changed, nothing to upload
+				if (index < objectCount){
+					Upload(slot, store, index);
+					stats.objectsUploaded++;
+				}
+			}
+		}
+		slot.pending.clear();
+	}
+
+	void SEGpuCulling::UploadOcclusion(const SEOcclusionBuffer& occlusion){
+		Slot& slot = slots[currentSlot];
+		SEGpuOcclusionHeader header = {};
+		header.enabled = occlusion.IsEmpty() ? 0 : 1;
+		if (header.enabled){
+			header.viewProjection = occlusion.GetViewProjection();
+			header.width = occlusion.GetWidth();
+			header.height = occlusion.GetHeight();
+			header.levelCount = occlusion.GetLevelCount();
+			for (uint32_t level = 0; level < header.levelCount; level++){
+				header.levelOffsets[level] = occlusion.GetLevelOffset(level);
+			}
+			const std::vector<float>& pyramid = occlusion.GetPyramid();
+			if (sizeof(SEGpuOcclusionHeader) + pyramid.size() * sizeof(float) > occlusionBytes){
+				throw std::runtime_error("Occlusion pyramid is bigger than the GPU culling buffer");
+			}
+			memcpy(slot.mappedOcclusion + sizeof(SEGpuOcclusionHeader), pyramid.data(), pyramid.size() * sizeof(float));
+		}
+		memcpy(slot.mappedOcclusion, &header, sizeof(header));
+	}
+
+	void SEGpuCulling::Upload(Slot& slot, const SEObjectStore& store, uint32_t index){
+		slot.mappedTransforms[index] = store.GetTransform(index);
+		slot.mappedBounds[index].centerRadius = glm::vec4(store.GetCenterX()[index], store.GetCenterY()[index], store.GetCenterZ()[index], store.GetRadius()[index]);
+		slot.mappedBounds[index].extent = glm::vec4(store.GetExtentX()[index], store.GetExtentY()[index], store.GetExtentZ()[index], 0.0f);
+	}
+
+	void SEGpuCulling::WriteDescriptorSet(VkDescriptorSet descriptorSet){
+		const Slot& slot = slots[currentSlot];
+
+		VkDescriptorBufferInfo bufferInfos[7] = {};
+		bufferInfos[0].buffer = slot.bounds;
+		bufferInfos[0].range = capacity * sizeof(SEGpuObjectBounds);
+		bufferInfos[1].buffer = slot.commands;
+		bufferInfos[1].range = GetDrawCapacity() * sizeof(VkDrawIndexedIndirectCommand);
+		bufferInfos[2].buffer = slot.count;
+		bufferInfos[2].range = COUNTERS * sizeof(uint32_t);
+		bufferInfos[3].buffer = slot.occlusion;
+		bufferInfos[3].range = occlusionBytes;
+		bufferInfos[4].buffer = slot.mesh;
+		bufferInfos[4].range = sizeof(SEGpuMesh);
+		bufferInfos[5].buffer = slot.transforms;
+		bufferInfos[5].range = capacity * sizeof(glm::mat4);
+		bufferInfos[6].buffer = meshlets;
+		bufferInfos[6].range = VK_WHOLE_SIZE;
+
+		VkWriteDescriptorSet descriptorWrites[7] = {};
+		for (uint32_t i = 0; i < 7; i++){
+			descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[i].dstSet = descriptorSet;
+			descriptorWrites[i].dstBinding = i;
+			descriptorWrites[i].dstArrayElement = 0;
+			descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrites[i].descriptorCount = 1;
+			descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+		}
+		vkUpdateDescriptorSets(*device, 7, descriptorWrites, 0, nullptr);
+	}
+
+	void SEGpuCulling::RecordCull(VkCommandBuffer commandBuffer, VkPipeline pipeline, VkPipelineLayout layout, VkDescriptorSet descriptorSet,
+		const SEFrustum& frustum, const SELodView& lodView, const std::vector<SEMeshLod>& lods, const glm::vec4& viewpoint){
+
+		Slot& slot = slots[currentSlot];
+
+		// this slots fence has signalled, so the shader isnt reading the last frames view any more
+		SEGpuMesh* mesh = slot.mappedMesh;
+		mesh->viewpoint = viewpoint;
+		mesh->lodCount = std::min(static_cast<uint32_t>(lods.size()), SE_MESH_MAX_LODS);
+		mesh->meshletCount = meshletCount;
+		mesh->maxDraws = GetDrawCapacity();
+		for (uint32_t i = 0; i < mesh->lodCount; i++){
+			mesh->lods[i].firstIndex = lods[i].firstIndex;
+			mesh->lods[i].indexCount = lods[i].indexCount;
+			mesh->lods[i].error = lods[i].error;
+		}
+
+		// the shader appends from 0. without a draw count every slot up to the object count is drawn, so the ones
+		// the shader doesnt write have to be empty draws
+		vkCmdFillBuffer(commandBuffer, slot.count, 0, COUNTERS * sizeof(uint32_t), 0);
+		if (!drawIndexedIndirectCount && objectCount > 0){
+			vkCmdFillBuffer(commandBuffer, slot.commands, 0, objectCount * sizeof(VkDrawIndexedIndirectCommand), 0);
+		}
+
+		VkMemoryBarrier clearBarrier = {};
+		clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+			1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+		if (objectCount > 0){
+			SEGpuCullConstants constants;
+			for (int i = 0; i < 6; i++){
+				constants.planes[i] = frustum.planes[i];
+			}
+			constants.lodDepthRow = lodView.depthRow;
+			constants.objectCount = objectCount;
+			constants.lodScale = lodView.scale;
+
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &descriptorSet, 0, nullptr);
+			vkCmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(SEGpuCullConstants), &constants);
+			vkCmdDispatch(commandBuffer, (objectCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+		}
+
+		// the draws read what the shader wrote, and the count is read back once the fence signals
+		VkMemoryBarrier cullBarrier = {};
+		cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0,
+			1, &cullBarrier, 0, nullptr, 0, nullptr);
+
+		slot.culled = true;
+		stats.framesCulled++;
+		stats.objectsCulled += objectCount;
+	}
+
+	// with a draw count the GPU stops at the last visible object. without one every slot is walked, culled ones
+	// are zero instance draws. either way its at most the devices indirect draw limit per call
+	void SEGpuCulling::RecordDraws(VkCommandBuffer commandBuffer){
+		const Slot& slot = slots[currentSlot];
+		const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+
+		if (drawIndexedIndirectCount){
+			// the count cant be split across calls, anything past the limit isnt drawn
+			uint32_t drawSlots = meshletCount > 0 ? GetDrawCapacity() : objectCount;
+			drawIndexedIndirectCount(commandBuffer, slot.commands, 0, slot.count, 0, std::min(drawSlots, maxDrawCount), stride);
+			return;
+		}
+
+		for (uint32_t first = 0; first < objectCount; first += maxDrawCount){
+			uint32_t draws = std::min(maxDrawCount, objectCount - first);
+			vkCmdDrawIndexedIndirect(commandBuffer, slot.commands, static_cast<VkDeviceSize>(first) * stride, draws, stride);
+		}
+	}
+
+	void SEGpuCulling::PrintStats(){
+		if (stats.framesCulled == 0){
+			return;
+		}
+		std::cout << "---- GPU culling ----" << std::endl;
+		std::cout << std::fixed << std::setprecision(2);
+		std::cout << "Objects: " << static_cast<double>(stats.objectsCulled) / stats.framesCulled << " culled, "
+			<< static_cast<double>(stats.objectsOccluded) / stats.framesCulled << " occluded, "
+			<< static_cast<double>(stats.objectsVisible) / stats.framesCulled << " visible per frame" << std::endl;
+		std::cout << "Triangles: " << static_cast<double>(stats.trianglesDrawn) / stats.framesCulled << " per frame" << std::endl;
+		std::cout << "Uploads: " << static_cast<double>(stats.objectsUploaded) / stats.framesCulled << " objects per frame" << std::endl;
+		std::cout << std::defaultfloat;
+	}
+}
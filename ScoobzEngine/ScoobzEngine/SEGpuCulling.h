@@ -0,0 +1,164 @@
+#pragma once
+#include <glm/glm.hpp>
+#include "SEBuffer.h"
+#include "SEObjectStore.h"
+#include "SEFrustumCull.h"
+#include "SEOcclusionCull.h"
+#include "SEMeshLod.h"
+#include "SEMeshlet.h"
+#include "SEDeletionQueue.h"
+
+namespace ScoobzEngine {
+
+	// vkCmdDrawIndexedIndirectCountKHR or its AMD twin, same signature, loaded when the device has either extension
+	typedef void (VKAPI_PTR *SEDrawIndexedIndirectCount)(VkCommandBuffer, VkBuffer, VkDeviceSize, VkBuffer, VkDeviceSize, uint32_t, uint32_t);
+
+	// one object for the culling shader, matches ObjectBounds in cull.comp
+	struct SEGpuObjectBounds{
+		glm::vec4 centerRadius;
+		glm::vec4 extent;
+	};
+
+	// matches the push constants in cull.comp
+	struct SEGpuCullConstants{
+		glm::vec4 planes[6];
+		glm::vec4 lodDepthRow;
+		uint32_t objectCount;
+		float lodScale;
+	};
+
+	// matches the Lods buffer in cull.comp
+	struct SEGpuMeshLod{
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		float error;
+		uint32_t padding;
+	};
+
+	// matches the Mesh buffer in cull.comp, written every cull
+	struct SEGpuMesh{
+		glm::vec4 viewpoint; // see GetViewpoint
+		uint32_t lodCount;
+		uint32_t meshletCount; // 0 when objects are always drawn whole
+		uint32_t maxDraws; // room in the draws buffer
+		uint32_t padding;
+		SEGpuMeshLod lods[SE_MESH_MAX_LODS];
+	};
+
+	// matches the start of the Occlusion buffer in cull.comp, the pyramid follows it
+	struct SEGpuOcclusionHeader{
+		glm::mat4 viewProjection;
+		uint32_t width;
+		uint32_t height;
+		uint32_t levelCount;
+		uint32_t enabled;
+		uint32_t levelOffsets[SE_OCCLUSION_MAX_LEVELS];
+	};
+
+	struct SEGpuCullingStats{
+		uint64_t framesCulled;
+		uint64_t objectsCulled; // summed over every frame
+		uint64_t objectsVisible; // read back a frame or two late, once each frames fence has signalled
+		uint64_t objectsOccluded; // in the frustum but behind an occluder, read back with the visible count
+		uint64_t trianglesDrawn; // at whichever level each object picked, read back with the visible count
+		uint64_t objectsUploaded; // only objects that changed are uploaded
+	};
+
+	// the scene lives on the GPU and a compute shader culls it every frame, writing a compacted list of indirect
+	// draws. every frame in flight has its own copy of the objects, brought up to date with only what changed since
+	// that slot was last used, so the CPU cost of a frame doesnt grow with the number of objects. the transforms
+	// buffer has the same layout as the objects array in the uniform ring, so the vertex shader reads either
+	class SEGpuCulling : public SEBuffer{
+
+	public:
+		SEGpuCulling();~SEGpuCulling();
+
+		//FUNCTIONS :: PUBLIC
+		// frames in flight, texels in the occlusion pyramid, the draw count command if the device has one (nullptr
+		// walks every draw slot instead)
+		void Create(const VkDevice*, const VkPhysicalDevice*, const VkSurfaceKHR*, uint32_t, uint32_t, SEDrawIndexedIndirectCount);
+		void Cleanup();
+		// the meshes meshlets, once before the first frame. objects drawing the full mesh are then culled meshlet by
+		// meshlet, neighbouring meshlets that survive going out as one draw. needs the draw count command, without it
+		// objects are always drawn whole
+		void SetMeshlets(const std::vector<SEMeshlet>&);
+		// call right after waiting on the slots fence, before the stores changes are cleared. uploads what changed
+		// in the store since this slot last ran, buffers outgrown by the store go to the deletion queue
+		void BeginFrame(uint32_t, SEObjectStore&, SEDeletionQueue*);
+		// copies this frames occlusion pyramid in, only when it has any occluders
+		void UploadOcclusion(const SEOcclusionBuffer&);
+		// points the culling shaders set at this slots bounds, draws, count, occlusion pyramid, mesh levels,
+		// transforms and the meshlets
+		void WriteDescriptorSet(VkDescriptorSet);
+		// outside a render pass. resets the draws, culls and makes the result visible to indirect draws. the set is
+		// the culling shaders, every visible object draws the level of the mesh its size on screen calls for. the
+		// viewpoint, from GetViewpoint, is what meshlets are backface culled against
+		void RecordCull(VkCommandBuffer, VkPipeline, VkPipelineLayout, VkDescriptorSet, const SEFrustum&, const SELodView&, const std::vector<SEMeshLod>&,
+			const glm::vec4&);
+		// inside a render pass, with a pipeline that takes the object index from the instance index
+		void RecordDraws(VkCommandBuffer);
+		void PrintStats();
+
+		//Getters
+		// this slots transforms, bound in place of the uniform ring
+		VkBuffer GetTransformBuffer() { return slots[currentSlot].transforms; }
+		VkDeviceSize GetTransformBytes() { return capacity * sizeof(glm::mat4); }
+		uint32_t GetObjectCount() { return objectCount; }
+		// what the slot culled the last time it ran, known once its fence signalled, so a few frames behind
+		uint32_t GetLastTriangleCount() { return lastTriangleCount; }
+		SEGpuCullingStats GetStats() { return stats; }
+
+	private:
+		struct Slot{
+			VkBuffer transforms = VK_NULL_HANDLE;
+			VkDeviceMemory transformMemory = VK_NULL_HANDLE;
+			glm::mat4* mappedTransforms = nullptr;
+			VkBuffer bounds = VK_NULL_HANDLE;
+			VkDeviceMemory boundsMemory = VK_NULL_HANDLE;
+			SEGpuObjectBounds* mappedBounds = nullptr;
+			VkBuffer commands = VK_NULL_HANDLE; // device local, only the GPU writes and reads them
+			VkDeviceMemory commandMemory = VK_NULL_HANDLE;
+			VkBuffer count = VK_NULL_HANDLE; // host visible so the visible, occluded and triangle counts can be read back
+			VkDeviceMemory countMemory = VK_NULL_HANDLE;
+			uint32_t* mappedCount = nullptr;
+			VkBuffer occlusion = VK_NULL_HANDLE; // doesnt grow with the scene, so its kept when the rest is
+			VkDeviceMemory occlusionMemory = VK_NULL_HANDLE;
+			uint8_t* mappedOcclusion = nullptr;
+			VkBuffer mesh = VK_NULL_HANDLE; // written every cull, its only the view and a few levels
+			VkDeviceMemory meshMemory = VK_NULL_HANDLE;
+			SEGpuMesh* mappedMesh = nullptr;
+
+			// indices changed since this slot last uploaded, flagged so each is only listed once
+			std::vector<uint32_t> pending;
+			std::vector<uint8_t> pendingFlags;
+			bool uploadAll = true;
+			bool culled = false; // the count holds a result that hasnt been read back
+		};
+
+		void CreateSlot(Slot&);
+		void DestroySlot(Slot&);
+		void CreateOcclusion(Slot&);
+		void CreateMesh(Slot&);
+		uint32_t GetDrawCapacity();
+		void Grow(uint32_t, SEDeletionQueue*);
+		void Upload(Slot&, const SEObjectStore&, uint32_t);
+
+		const VkDevice* device = nullptr;
+		const VkPhysicalDevice* physicalDevice = nullptr;
+		const VkSurfaceKHR* surface = nullptr;
+		SEDrawIndexedIndirectCount drawIndexedIndirectCount = nullptr;
+		uint32_t maxDrawCount = 0;
+		VkDeviceSize occlusionBytes = 0;
+		VkBuffer meshlets = VK_NULL_HANDLE; // never changes once set, so theres one for every slot
+		VkDeviceMemory meshletMemory = VK_NULL_HANDLE;
+		uint32_t meshletCount = 0;
+
+		std::vector<Slot> slots;
+		uint32_t currentSlot = 0;
+		uint32_t capacity = 0; // objects every slots buffers have room for
+		uint32_t objectCount = 0; // this frames
+		uint32_t lastTriangleCount = 0;
+
+		SEGpuCullingStats stats = {};
+	};
+}
@@ -0,0 +1,242 @@
+#include "SEJobSystem.h"
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace ScoobzEngine {
+
+	static const unsigned int INVALID_WORKER = ~0u;
+	static thread_local unsigned int currentWorkerIndex = INVALID_WORKER;
+
+	SEJobSystem::SEJobSystem(int workerCount){
+		// leave one core for the main thread
+		if (workerCount < 0){
+			unsigned int cores = std::thread::hardware_concurrency();
+			workerCount = cores > 1 ? static_cast<int>(cores) - 1 : 0;
+		}
+
+		unsigned int threadCount = static_cast<unsigned int>(workerCount) + 1;
+		workerStates.reset(new WorkerState[threadCount]);
+		for (unsigned int i = 0; i < threadCount; i++){
+			queues.emplace_back(new SEWorkStealingDeque<SEJob*, QUEUE_SIZE>());
+			workerStates[i].jobs.reset(new SEJob[JOB_POOL_SIZE]);
+			for (uint32_t j = 0; j < JOB_POOL_SIZE; j++){
+				workerStates[i].jobs[j].inUse.store(false, std::memory_order_relaxed);
+			}
+		}
+
+		// whoever creates the job system is the main thread
+		currentWorkerIndex = 0;
+		for (unsigned int i = 1; i < threadCount; i++){
+			workers.emplace_back(&SEJobSystem::WorkerLoop, this, i);
+		}
+
+		std::cout << "Job System started with " << threadCount << " threads" << std::endl;
+	}
+
+	SEJobSystem::~SEJobSystem(){
+		stopping.store(true);
+		{
+			std::lock_guard<std::mutex> lock(idleMutex);
+		}
+		idleCondition.notify_all();
+
+		for (auto& worker : workers){
+			worker.join();
+		}
+	}
+
+	unsigned int SEJobSystem::GetCurrentWorkerIndex(){
+		return currentWorkerIndex;
+	}
+
+	SEJob* SEJobSystem::AllocateJob(){
+		unsigned int index = currentWorkerIndex;
+		if (index >= GetThreadCount()){
+			throw std::runtime_error("Jobs can only be spawned from the main thread or a job worker");
+		}
+
+		WorkerState& state = workerStates[index];
+		SEJob* job = &state.jobs[state.nextJob++ & (JOB_POOL_SIZE - 1)];
+
+		// the ring wrapped onto a job that hasnt run yet, help out until it has
+		while (job->inUse.load(std::memory_order_acquire)){
+			if (!TryRunJob()){
+				std::this_thread::yield();
+			}
+		}
+		job->inUse.store(true, std::memory_order_relaxed);
+
+		return job;
+	}
+
+	void SEJobSystem::Submit(SEJob* job, SEJobCounter* dependency){
+		if (dependency){
+			// checked under the lock so we cant miss the counter hitting zero
+			std::lock_guard<std::mutex> lock(dependency->waiterMutex);
+			if (dependency->value.load(std::memory_order_acquire) > 0){
+				dependency->waiters.push_back(job);
+				return;
+			}
+		}
+		Push(job);
+	}
+
+	void SEJobSystem::Push(SEJob* job){
+		unsigned int index = currentWorkerIndex;
+
+		if (!queues[index]->Push(job)){
+			workerStates[index].jobsRunInline.fetch_add(1, std::memory_order_relaxed);
+			Execute(job);
+			return;
+		}
+
+		if (sleepingWorkers.load(std::memory_order_relaxed) > 0){
+			idleCondition.notify_one();
+		}
+	}
+
+	bool SEJobSystem::TryRunJob(){
+		unsigned int index = currentWorkerIndex;
+		SEJob* job = nullptr;
+
+		if (index == 0 && mainThreadJobCount.load(std::memory_order_acquire) > 0){
+			std::lock_guard<std::mutex> lock(mainThreadMutex);
+			if (!mainThreadJobs.empty()){
+				job = mainThreadJobs.front();
+				mainThreadJobs.pop_front();
+				mainThreadJobCount.fetch_sub(1, std::memory_order_relaxed);
+			}
+		}
+
+		if (!job && !queues[index]->Pop(job)){
+			job = nullptr;
+
+			// own deque is dry, go steal. start somewhere different per thread so thieves spread out
+			unsigned int threadCount = GetThreadCount();
+			for (unsigned int i = 1; i < threadCount; i++){
+				unsigned int victim = (index + i) % threadCount;
+				if (queues[victim]->Steal(job)){
+					workerStates[index].jobsStolen.fetch_add(1, std::memory_order_relaxed);
+					break;
+				}
+				job = nullptr;
+			}
+		}
+
+		if (!job){
+			return false;
+		}
+
+		Execute(job);
+		return true;
+	}
+
+	void SEJobSystem::Execute(SEJob* job){
+		job->function(job);
+		workerStates[currentWorkerIndex].jobsExecuted.fetch_add(1, std::memory_order_relaxed);
+
+		SEJobCounter* counter = job->counter;
+		job->inUse.store(false, std::memory_order_release);
+
+		if (!counter){
+			return;
+		}
+
+		// only what might be the last decrement takes the lock, the rest stay lock free
+		int current = counter->value.load(std::memory_order_relaxed);
+		while (current > 1 && !counter->value.compare_exchange_weak(current, current - 1, std::memory_order_acq_rel, std::memory_order_relaxed)){}
+		if (current > 1){
+			return;
+		}
+
+		// the counter can be freed as soon as a waiter sees zero and gets the lock, so zero is only ever stored under
+		// it and the counter isnt touched once its let go
+		std::vector<SEJob*> released;
+		{
+			std::lock_guard<std::mutex> lock(counter->waiterMutex);
+			if (counter->value.fetch_sub(1, std::memory_order_acq_rel) == 1){
+				// last job on this counter, release anything that was waiting on it
+				released.swap(counter->waiters);
+			}
+		}
+		for (SEJob* waiter : released){
+			Push(waiter);
+		}
+	}
+
+	void SEJobSystem::WaitForCounter(SEJobCounter* counter){
+		if (currentWorkerIndex >= GetThreadCount()){
+			throw std::runtime_error("WaitForCounter called from a thread the job system doesnt own");
+		}
+
+		while (counter->value.load(std::memory_order_acquire) > 0){
+			if (!TryRunJob()){
+				std::this_thread::yield();
+			}
+		}
+		// whoever stored the zero still holds the lock until its done with the counter, after this it can go
+		std::lock_guard<std::mutex> lock(counter->waiterMutex);
+	}
+
+	void SEJobSystem::PumpMainThread(){
+		if (currentWorkerIndex != 0){
+			throw std::runtime_error("PumpMainThread called off the main thread");
+		}
+
+		while (mainThreadJobCount.load(std::memory_order_acquire) > 0){
+			SEJob* job = nullptr;
+			{
+				std::lock_guard<std::mutex> lock(mainThreadMutex);
+				if (mainThreadJobs.empty()){
+					break;
+				}
+				job = mainThreadJobs.front();
+				mainThreadJobs.pop_front();
+				mainThreadJobCount.fetch_sub(1, std::memory_order_relaxed);
+			}
+			Execute(job);
+		}
+	}
+
+	SEJobStats SEJobSystem::GetStats(){
+		SEJobStats stats = {};
+		for (unsigned int i = 0; i < GetThreadCount(); i++){
+			stats.jobsExecuted += workerStates[i].jobsExecuted.load(std::memory_order_relaxed);
+			stats.jobsStolen += workerStates[i].jobsStolen.load(std::memory_order_relaxed);
+			stats.jobsRunInline += workerStates[i].jobsRunInline.load(std::memory_order_relaxed);
+		}
+		return stats;
+	}
+
+	void SEJobSystem::ResetStats(){
+		for (unsigned int i = 0; i < GetThreadCount(); i++){
+			workerStates[i].jobsExecuted.store(0, std::memory_order_relaxed);
+			workerStates[i].jobsStolen.store(0, std::memory_order_relaxed);
+			workerStates[i].jobsRunInline.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void SEJobSystem::WorkerLoop(unsigned int workerIndex){
+		currentWorkerIndex = workerIndex;
+		int idleSpins = 0;
+
+		while (!stopping.load(std::memory_order_relaxed)){
+			if (TryRunJob()){
+				idleSpins = 0;
+				continue;
+			}
+
+			// spin a little before going to sleep, pushes wake us up early
+			if (++idleSpins < 64){
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(idleMutex);
+			sleepingWorkers.fetch_add(1, std::memory_order_relaxed);
+			idleCondition.wait_for(lock, std::chrono::milliseconds(1));
+			sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+}
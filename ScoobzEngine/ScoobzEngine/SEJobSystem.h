@@ -0,0 +1,164 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "SEWorkStealingDeque.h"
+
+namespace ScoobzEngine {
+
+	class SEJobCounter;
+
+	// a job is one cache line, the callable is stored inline so spawning never touches the heap
+	struct alignas(64) SEJob{
+		void (*function)(SEJob*);
+		SEJobCounter* counter;
+		std::atomic<bool> inUse;
+		alignas(16) unsigned char payload[32];
+	};
+
+	// counts unfinished jobs. waiting on a counter (or making a job depend on one) is how jobs are chained
+	class SEJobCounter{
+
+	public:
+		SEJobCounter(){}
+		~SEJobCounter(){}
+		SEJobCounter(const SEJobCounter&) = delete;
+		SEJobCounter& operator=(const SEJobCounter&) = delete;
+
+		// zero doesnt mean the last job is done with the counter yet, wait on it before freeing it
+		int GetValue() { return value.load(std::memory_order_acquire); }
+
+	private:
+		friend class SEJobSystem;
+
+		std::atomic<int> value{ 0 };
+		std::mutex waiterMutex;
+		std::vector<SEJob*> waiters; // jobs held back until value reaches zero
+	};
+
+	struct SEJobStats{
+		uint64_t jobsExecuted;
+		uint64_t jobsStolen;
+		uint64_t jobsRunInline; // deque was full
+	};
+
+	// work stealing job scheduler. every worker owns a Chase-Lev deque and steals from the others when it runs dry.
+	// the thread that creates the job system is worker 0 (the main thread), it only runs jobs while waiting on a counter
+	// or pumping, and is the only thread that runs RunOnMainThread jobs (anything touching GLFW)
+	class SEJobSystem{
+
+	public:
+		// -1 uses one worker per core, minus the main thread
+		SEJobSystem(int = -1);~SEJobSystem();
+
+		//FUNCTIONS :: PUBLIC
+		template <typename F>
+		void Run(F&& function, SEJobCounter* counter = nullptr, SEJobCounter* dependency = nullptr){
+			SEJob* job = AllocateJob();
+			Bind(job, std::forward<F>(function), counter);
+			Submit(job, dependency);
+		}
+
+		template <typename F>
+		void RunOnMainThread(F&& function, SEJobCounter* counter = nullptr){
+			SEJob* job = AllocateJob();
+			Bind(job, std::forward<F>(function), counter);
+			{
+				std::lock_guard<std::mutex> lock(mainThreadMutex);
+				mainThreadJobs.push_back(job);
+			}
+			mainThreadJobCount.fetch_add(1, std::memory_order_release);
+		}
+
+		// body(begin, end) is called over [0, count) in chunks of at least grainSize
+		template <typename F>
+		void ParallelFor(uint32_t count, uint32_t grainSize, const F& body){
+			if (count == 0){
+				return;
+			}
+			// cap the chunk count so a huge loop cant wrap a threads job ring
+			const uint32_t maxChunks = JOB_POOL_SIZE / 4;
+			grainSize = std::max(std::max(grainSize, 1u), (count + maxChunks - 1) / maxChunks);
+
+			SEJobCounter counter;
+			const F* bodyPointer = &body;
+			for (uint32_t begin = 0; begin < count; begin += grainSize){
+				uint32_t end = std::min(count, begin + grainSize);
+				Run([bodyPointer, begin, end] { (*bodyPointer)(begin, end); }, &counter);
+			}
+			WaitForCounter(&counter);
+		}
+
+		// runs other jobs while it waits, so its fine to call from inside a job. once it returns the counter can be freed
+		void WaitForCounter(SEJobCounter*);
+		// runs queued main thread jobs, called once a frame from the game loop
+		void PumpMainThread();
+
+		//Getters
+		unsigned int GetThreadCount() { return static_cast<unsigned int>(queues.size()); }
+		SEJobStats GetStats();
+		void ResetStats();
+		// 0 is the main thread, workers are numbered from 1, ~0u for threads the job system doesnt own
+		static unsigned int GetCurrentWorkerIndex();
+
+	private:
+		static const uint32_t JOB_POOL_SIZE = 4096;
+		static const int64_t QUEUE_SIZE = 4096;
+
+		// everything only the owning thread writes, padded so workers dont share cache lines
+		struct alignas(64) WorkerState{
+			std::unique_ptr<SEJob[]> jobs; // ring of job storage
+			uint32_t nextJob = 0;
+			std::atomic<uint64_t> jobsExecuted{ 0 };
+			std::atomic<uint64_t> jobsStolen{ 0 };
+			std::atomic<uint64_t> jobsRunInline{ 0 };
+		};
+
+		template <typename F>
+		static void Bind(SEJob* job, F&& function, SEJobCounter* counter){
+			typedef typename std::decay<F>::type Function;
+			static_assert(sizeof(Function) <= sizeof(job->payload), "Job captures too much, capture a pointer instead");
+			static_assert(alignof(Function) <= 16, "Job callable is over aligned");
+
+			new (job->payload) Function(std::forward<F>(function));
+			job->function = [](SEJob* self) {
+				Function* stored = reinterpret_cast<Function*>(self->payload);
+				(*stored)();
+				stored->~Function();
+			};
+			job->counter = counter;
+			if (counter){
+				counter->value.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		SEJob* AllocateJob();
+		void Submit(SEJob*, SEJobCounter*);
+		void Push(SEJob*);
+		bool TryRunJob();
+		void Execute(SEJob*);
+		void WorkerLoop(unsigned int);
+
+		std::vector<std::unique_ptr<SEWorkStealingDeque<SEJob*, QUEUE_SIZE>>> queues;
+		std::unique_ptr<WorkerState[]> workerStates;
+		std::vector<std::thread> workers;
+
+		std::mutex mainThreadMutex;
+		std::deque<SEJob*> mainThreadJobs;
+		std::atomic<int> mainThreadJobCount{ 0 };
+
+		std::mutex idleMutex;
+		std::condition_variable idleCondition;
+		std::atomic<int> sleepingWorkers{ 0 };
+		std::atomic<bool> stopping{ false };
+	};
+}
@@ -0,0 +1,495 @@
+#include "SEMeshLod.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+namespace ScoobzEngine {
+
+	// open borders hold their shape much harder than the surface does, seams only a little
+	static const double BORDER_WEIGHT = 10.0;
+	static const double SEAM_WEIGHT = 1.0;
+	// a level has to be at most this much of the one before it to be worth keeping
+	static const float MIN_LOD_REDUCTION = 0.9f;
+
+	enum VertexKind{
+		KIND_MANIFOLD, // inside a surface, collapses onto any neighbour
+		KIND_BORDER, // on an open edge, only collapses along it
+		KIND_SEAM, // one of two vertices at a position with different attributes, both collapse along the seam together
+		KIND_LOCKED, // corners, where seams meet and anything non manifold. never moves
+	};
+
+	// sum of squared distances to a set of weighted planes, as a symmetric 4x4 matrix
+	struct Quadric{
+		double a00, a01, a02, a11, a12, a22;
+		double b0, b1, b2;
+		double c;
+		double weight;
+	};
+
+	struct Collapse{
+		uint32_t from;
+		uint32_t to;
+		uint32_t siblingFrom; // the other side of a seam, ~0u when its not one
+		uint32_t siblingTo;
+		double cost;
+	};
+
+	// half edges of every vertex, as offsets into one array of the vertices they lead to. with a remap both ends
+	// go through it, so its the edges between positions. also used for the triangles around each position
+	struct Adjacency{
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> items;
+	};
+
+	static void AddPlane(Quadric& quadric, const glm::dvec3& normal, double distance, double weight){
+		quadric.a00 += weight * normal.x * normal.x;
+		quadric.a01 += weight * normal.x * normal.y;
+		quadric.a02 += weight * normal.x * normal.z;
+		quadric.a11 += weight * normal.y * normal.y;
+		quadric.a12 += weight * normal.y * normal.z;
+		quadric.a22 += weight * normal.z * normal.z;
+		quadric.b0 += weight * normal.x * distance;
+		quadric.b1 += weight * normal.y * distance;
+		quadric.b2 += weight * normal.z * distance;
+		quadric.c += weight * distance * distance;
+		quadric.weight += weight;
+	}
+
+	static void AddQuadric(Quadric& quadric, const Quadric& other){
+		quadric.a00 += other.a00;
+		quadric.a01 += other.a01;
+		quadric.a02 += other.a02;
+		quadric.a11 += other.a11;
+		quadric.a12 += other.a12;
+		quadric.a22 += other.a22;
+		quadric.b0 += other.b0;
+		quadric.b1 += other.b1;
+		quadric.b2 += other.b2;
+		quadric.c += other.c;
+		quadric.weight += other.weight;
+	}
+
+	// the weighted mean squared distance from the point to the planes
+	static double QuadricError(const Quadric& quadric, const glm::dvec3& point){
+		if (quadric.weight <= 0.0){
+			return 0.0;
+		}
+		double x = point.x, y = point.y, z = point.z;
+		double result = quadric.a00 * x * x + quadric.a11 * y * y + quadric.a22 * z * z
+			+ 2.0 * (quadric.a01 * x * y + quadric.a02 * x * z + quadric.a12 * y * z)
+			+ 2.0 * (quadric.b0 * x + quadric.b1 * y + quadric.b2 * z) + quadric.c;
+		return std::abs(result) / quadric.weight;
+	}
+
+	static void BuildEdges(const std::vector<uint32_t>& indices, const uint32_t* remap, uint32_t vertexCount, Adjacency& adjacency){
+		adjacency.offsets.assign(vertexCount + 1, 0);
+		for (size_t i = 0; i < indices.size(); i++){
+			adjacency.offsets[(remap ? remap[indices[i]] : indices[i]) + 1]++;
+		}
+		for (uint32_t v = 0; v < vertexCount; v++){
+			adjacency.offsets[v + 1] += adjacency.offsets[v];
+		}
+		adjacency.items.resize(indices.size());
+		std::vector<uint32_t> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+		for (size_t t = 0; t < indices.size(); t += 3){
+			for (int e = 0; e < 3; e++){
+				uint32_t a = indices[t + e];
+				uint32_t b = indices[t + (e + 1) % 3];
+				if (remap){
+					a = remap[a];
+					b = remap[b];
+				}
+				adjacency.items[cursor[a]++] = b;
+			}
+		}
+	}
+
+	static void BuildTriangleFans(const std::vector<uint32_t>& indices, const uint32_t* remap, uint32_t vertexCount, Adjacency& adjacency){
+		adjacency.offsets.assign(vertexCount + 1, 0);
+		for (size_t i = 0; i < indices.size(); i++){
+			adjacency.offsets[remap[indices[i]] + 1]++;
+		}
+		for (uint32_t v = 0; v < vertexCount; v++){
+			adjacency.offsets[v + 1] += adjacency.offsets[v];
+		}
+		adjacency.items.resize(indices.size());
+		std::vector<uint32_t> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++){
+			adjacency.items[cursor[remap[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	static bool HasEdge(const Adjacency& adjacency, uint32_t a, uint32_t b){
+		for (uint32_t i = adjacency.offsets[a]; i < adjacency.offsets[a + 1]; i++){
+			if (adjacency.items[i] == b){
+				return true;
+			}
+		}
+		return false;
+	}
+
+	float SimplifyMesh(const std::vector<glm::vec3>& positions, const float* attributes, uint32_t attributeCount,
+		const std::vector<uint32_t>& indices, uint32_t targetIndexCount, float targetError, std::vector<uint32_t>& result){
+
+		uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+		result = indices;
+		if (vertexCount == 0 || result.size() <= targetIndexCount || targetError <= 0.0f){
+			return 0.0f;
+		}
+
+		// everything is measured in units of the bounding radius, so errors mean the same whatever the meshes size
+		glm::vec3 boundsMin(FLT_MAX);
+		glm::vec3 boundsMax(-FLT_MAX);
+		for (const auto& position : positions){
+			boundsMin = glm::min(boundsMin, position);
+			boundsMax = glm::max(boundsMax, position);
+		}
+		glm::dvec3 center = (glm::dvec3(boundsMin) + glm::dvec3(boundsMax)) * 0.5;
+		double radius = glm::length(glm::dvec3(boundsMax) - glm::dvec3(boundsMin)) * 0.5;
+		if (radius <= 0.0){
+			radius = 1.0;
+		}
+		std::vector<glm::dvec3> points(vertexCount);
+		for (uint32_t v = 0; v < vertexCount; v++){
+			points[v] = (glm::dvec3(positions[v]) - center) / radius;
+		}
+
+		// vertices at the same position all remap to the first of them, and are linked in a ring through wedge
+		std::vector<uint32_t> order(vertexCount);
+		std::iota(order.begin(), order.end(), 0u);
+		std::sort(order.begin(), order.end(), [&positions](uint32_t a, uint32_t b){
+			const glm::vec3& pa = positions[a];
+			const glm::vec3& pb = positions[b];
+			return pa.x != pb.x ? pa.x < pb.x : pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z;
+		});
+		std::vector<uint32_t> remap(vertexCount);
+		std::vector<uint32_t> wedge(vertexCount);
+		for (uint32_t i = 0; i < vertexCount;){
+			uint32_t end = i + 1;
+			while (end < vertexCount && positions[order[end]] == positions[order[i]]){
+				end++;
+			}
+			for (uint32_t k = i; k < end; k++){
+				remap[order[k]] = order[i];
+				wedge[order[k]] = order[k + 1 < end ? k + 1 : i];
+			}
+			i = end;
+		}
+
+		Adjacency edges;
+		Adjacency positionEdges;
+		BuildEdges(result, nullptr, vertexCount, edges);
+		BuildEdges(result, remap.data(), vertexCount, positionEdges);
+
+		// a half edge without a twin is open. on a border or seam each vertex has exactly one going out and one
+		// coming in, loop and loopBack follow them
+		std::vector<uint32_t> loop(vertexCount, ~0u);
+		std::vector<uint32_t> loopBack(vertexCount, ~0u);
+		std::vector<uint32_t> openOut(vertexCount, 0);
+		std::vector<uint32_t> openIn(vertexCount, 0);
+		for (uint32_t a = 0; a < vertexCount; a++){
+			for (uint32_t i = edges.offsets[a]; i < edges.offsets[a + 1]; i++){
+				uint32_t b = edges.items[i];
+				if (!HasEdge(edges, b, a)){
+					openOut[a]++;
+					openIn[b]++;
+					loop[a] = b;
+					loopBack[b] = a;
+				}
+			}
+		}
+
+		// a seam is open between vertices but closed between positions, and the other side runs the other way
+		std::vector<uint8_t> kinds(vertexCount, KIND_LOCKED);
+		for (uint32_t v = 0; v < vertexCount; v++){
+			uint32_t sibling = wedge[v];
+			bool single = openOut[v] == 1 && openIn[v] == 1;
+			if (sibling == v){
+				if (openOut[v] == 0 && openIn[v] == 0){
+					kinds[v] = KIND_MANIFOLD;
+				}
+				else if (single && !HasEdge(positionEdges, remap[loop[v]], v) && !HasEdge(positionEdges, v, remap[loopBack[v]])){
+					kinds[v] = KIND_BORDER;
+				}
+			}
+			else if (wedge[sibling] == v && single && openOut[sibling] == 1 && openIn[sibling] == 1
+				&& remap[loop[sibling]] == remap[loopBack[v]] && remap[loopBack[sibling]] == remap[loop[v]]
+				&& HasEdge(positionEdges, remap[loop[v]], remap[v]) && HasEdge(positionEdges, remap[v], remap[loopBack[v]])){
+				kinds[v] = KIND_SEAM;
+			}
+		}
+
+		// one quadric per position: the planes of the triangles around it weighted by area, and planes standing up
+		// along its open edges so borders and seams keep their line
+		std::vector<Quadric> quadrics(vertexCount, Quadric());
+		for (size_t t = 0; t < result.size(); t += 3){
+			const glm::dvec3& p0 = points[result[t]];
+			glm::dvec3 normal = glm::cross(points[result[t + 1]] - p0, points[result[t + 2]] - p0);
+			double area = glm::length(normal);
+			if (area <= 0.0){
+				continue;
+			}
+			normal /= area;
+			for (int e = 0; e < 3; e++){
+				AddPlane(quadrics[remap[result[t + e]]], normal, -glm::dot(normal, p0), area);
+			}
+
+			for (int e = 0; e < 3; e++){
+				uint32_t a = result[t + e];
+				uint32_t b = result[t + (e + 1) % 3];
+				if (HasEdge(edges, b, a)){
+					continue;
+				}
+				glm::dvec3 edge = points[b] - points[a];
+				double length = glm::length(edge);
+				if (length <= 0.0){
+					continue;
+				}
+				glm::dvec3 edgeNormal = glm::normalize(glm::cross(edge, normal));
+				double weight = (HasEdge(positionEdges, remap[b], remap[a]) ? SEAM_WEIGHT : BORDER_WEIGHT) * length * length;
+				AddPlane(quadrics[remap[a]], edgeNormal, -glm::dot(edgeNormal, points[a]), weight);
+				AddPlane(quadrics[remap[b]], edgeNormal, -glm::dot(edgeNormal, points[a]), weight);
+			}
+		}
+
+		auto attributeCost = [attributes, attributeCount](uint32_t a, uint32_t b){
+			double cost = 0.0;
+			for (uint32_t k = 0; k < attributeCount; k++){
+				double difference = attributes[a * attributeCount + k] - attributes[b * attributeCount + k];
+				cost += difference * difference;
+			}
+			return cost;
+		};
+
+		// fills in the collapse and returns true when from can move onto to
+		auto prepare = [&](uint32_t from, uint32_t to, Collapse& collapse){
+			uint8_t kind = kinds[from];
+			if (kind == KIND_LOCKED || remap[from] == remap[to]){
+				return false;
+			}
+			collapse.from = from;
+			collapse.to = to;
+			collapse.siblingFrom = ~0u;
+			collapse.siblingTo = ~0u;
+			if (kind != KIND_MANIFOLD && loop[from] != to && loopBack[from] != to){
+				return false;
+			}
+			collapse.cost = QuadricError(quadrics[remap[from]], points[to]);
+			if (attributes){
+				collapse.cost += attributeCost(from, to);
+			}
+			if (kind == KIND_SEAM){
+				// the other side runs the other way, the vertex there at the same position as to
+				uint32_t sibling = wedge[from];
+				uint32_t siblingTo = remap[loopBack[sibling]] == remap[to] ? loopBack[sibling] : remap[loop[sibling]] == remap[to] ? loop[sibling] : ~0u;
+				if (siblingTo == ~0u){
+					return false;
+				}
+				collapse.siblingFrom = sibling;
+				collapse.siblingTo = siblingTo;
+				if (attributes){
+					collapse.cost = std::max(collapse.cost, QuadricError(quadrics[remap[from]], points[to]) + attributeCost(sibling, siblingTo));
+				}
+			}
+			return true;
+		};
+
+		// a border or seam loop skips over the vertex that moved
+		auto relink = [&loop, &loopBack](uint32_t from, uint32_t to){
+			if (loop[from] == to){
+				uint32_t before = loopBack[from];
+				loop[before] = to;
+				loopBack[to] = before;
+			}
+			else{
+				uint32_t after = loop[from];
+				loopBack[after] = to;
+				loop[to] = after;
+			}
+		};
+
+		double maxCost = static_cast<double>(targetError) * targetError;
+		double errorReached = 0.0;
+		std::vector<Collapse> collapses;
+		std::vector<uint32_t> collapseRemap(vertexCount);
+		std::vector<uint8_t> locked(vertexCount);
+		Adjacency fans;
+
+		while (result.size() > targetIndexCount){
+			BuildEdges(result, nullptr, vertexCount, edges);
+			BuildTriangleFans(result, remap.data(), vertexCount, fans);
+
+			// inside edges turn up once from each side, only the one going up is taken. each goes whichever way is cheaper
+			collapses.clear();
+			for (size_t t = 0; t < result.size(); t += 3){
+				for (int e = 0; e < 3; e++){
+					uint32_t a = result[t + e];
+					uint32_t b = result[t + (e + 1) % 3];
+					if (a > b && HasEdge(edges, b, a)){
+						continue;
+					}
+					Collapse forward, backward;
+					bool canForward = prepare(a, b, forward);
+					bool canBackward = prepare(b, a, backward);
+					if (canForward && (!canBackward || forward.cost <= backward.cost)){
+						if (forward.cost <= maxCost){
+							collapses.push_back(forward);
+						}
+					}
+					else if (canBackward && backward.cost <= maxCost){
+						collapses.push_back(backward);
+					}
+				}
+			}
+			if (collapses.empty()){
+				break;
+			}
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b){ return a.cost < b.cost; });
+
+			// a collapse takes two triangles inside the surface, so going for half of what has to go doesnt overshoot.
+			// everything around a position that moves is locked for the rest of the pass, so the flip test can trust
+			// its neighbours
+			size_t collapseLimit = std::max<size_t>((result.size() - targetIndexCount) / 6, 1);
+			std::iota(collapseRemap.begin(), collapseRemap.end(), 0u);
+			std::fill(locked.begin(), locked.end(), 0);
+			size_t applied = 0;
+			for (const auto& collapse : collapses){
+				if (applied >= collapseLimit){
+					break;
+				}
+				uint32_t fromPosition = remap[collapse.from];
+				uint32_t toPosition = remap[collapse.to];
+				if (locked[fromPosition] || locked[toPosition]){
+					continue;
+				}
+
+				// no triangle that stays may turn over
+				bool flips = false;
+				for (uint32_t i = fans.offsets[fromPosition]; i < fans.offsets[fromPosition + 1] && !flips; i++){
+					const uint32_t* triangle = &result[fans.items[i] * 3];
+					glm::dvec3 corners[3];
+					bool goesAway = false;
+					int moving = 0;
+					for (int k = 0; k < 3; k++){
+						uint32_t position = remap[triangle[k]];
+						goesAway |= position == toPosition;
+						moving = position == fromPosition ? k : moving;
+						corners[k] = points[position];
+					}
+					if (goesAway){
+						continue;
+					}
+					glm::dvec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+					corners[moving] = points[toPosition];
+					glm::dvec3 after = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+					flips = glm::dot(before, after) <= 0.0 && glm::dot(before, before) > 0.0;
+				}
+				if (flips){
+					continue;
+				}
+
+				collapseRemap[collapse.from] = collapse.to;
+				if (kinds[collapse.from] != KIND_MANIFOLD){
+					relink(collapse.from, collapse.to);
+				}
+				if (collapse.siblingFrom != ~0u){
+					collapseRemap[collapse.siblingFrom] = collapse.siblingTo;
+					relink(collapse.siblingFrom, collapse.siblingTo);
+				}
+				AddQuadric(quadrics[toPosition], quadrics[fromPosition]);
+
+				for (uint32_t i = fans.offsets[fromPosition]; i < fans.offsets[fromPosition + 1]; i++){
+					const uint32_t* triangle = &result[fans.items[i] * 3];
+					for (int k = 0; k < 3; k++){
+						locked[remap[triangle[k]]] = 1;
+					}
+				}
+				locked[toPosition] = 1;
+
+				errorReached = std::max(errorReached, collapse.cost);
+				applied++;
+			}
+			if (applied == 0){
+				break;
+			}
+
+			// triangles with two corners at one position are gone
+			size_t write = 0;
+			for (size_t t = 0; t < result.size(); t += 3){
+				uint32_t a = collapseRemap[result[t]];
+				uint32_t b = collapseRemap[result[t + 1]];
+				uint32_t c = collapseRemap[result[t + 2]];
+				if (remap[a] == remap[b] || remap[b] == remap[c] || remap[c] == remap[a]){
+					continue;
+				}
+				result[write++] = a;
+				result[write++] = b;
+				result[write++] = c;
+			}
+			result.resize(write);
+		}
+
+		return static_cast<float>(std::sqrt(errorReached));
+	}
+
+	void GenerateLods(const std::vector<glm::vec3>& positions, const float* attributes, uint32_t attributeCount, const std::vector<uint32_t>& indices,
+		const SEMeshLodDesc& desc, std::vector<uint32_t>& lodIndices, std::vector<SEMeshLod>& lods){
+
+		lodIndices = indices;
+		lods.clear();
+		lods.push_back({ 0, static_cast<uint32_t>(indices.size()), 0.0f });
+
+		// the simplifier weighs attributes against positions one to one
+		std::vector<float> weightedAttributes;
+		if (attributes){
+			weightedAttributes.assign(attributes, attributes + positions.size() * attributeCount);
+			for (auto& attribute : weightedAttributes){
+				attribute *= desc.attributeWeight;
+			}
+		}
+
+		// each level starts from the one before it, so the errors add up
+		std::vector<uint32_t> previous = indices;
+		std::vector<uint32_t> simplified;
+		float error = 0.0f;
+		uint32_t maxLods = std::min(desc.maxLods, SE_MESH_MAX_LODS);
+		while (lods.size() < maxLods && error < desc.maxError){
+			uint32_t target = static_cast<uint32_t>(previous.size() / 3 * desc.reduction) * 3;
+			float levelError = SimplifyMesh(positions, attributes ? weightedAttributes.data() : nullptr, attributeCount, previous, target,
+				desc.maxError - error, simplified);
+			if (simplified.empty() || simplified.size() > previous.size() * MIN_LOD_REDUCTION){
+				break;
+			}
+
+			error += levelError;
+			lods.push_back({ static_cast<uint32_t>(lodIndices.size()), static_cast<uint32_t>(simplified.size()), error });
+			lodIndices.insert(lodIndices.end(), simplified.begin(), simplified.end());
+			previous.swap(simplified);
+		}
+	}
+
+	SELodView MakeLodView(const glm::mat4& viewProjection, float viewportHeight, float pixelError){
+		SELodView view;
+		view.depthRow = glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+		// clip space y over w spans two units across the viewport, so at depth 1 a world unit covers this many pixels
+		glm::vec3 yRow(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1]);
+		view.scale = glm::length(yRow) * viewportHeight * 0.5f / pixelError;
+		return view;
+	}
+
+	uint32_t SelectLod(const std::vector<SEMeshLod>& lods, const SELodView& view, const glm::vec3& center, float radius){
+		// the nearest the bounding sphere gets to the camera
+		float depth = glm::dot(view.depthRow, glm::vec4(center, 1.0f)) - radius * glm::length(glm::vec3(view.depthRow));
+		if (depth <= 0.0f){
+			return 0;
+		}
+		// a levels error in pixels is error * radius * scale / depth
+		for (uint32_t i = static_cast<uint32_t>(lods.size()) - 1; i > 0; i--){
+			if (lods[i].error * radius * view.scale <= depth){
+				return i;
+			}
+		}
+		return 0;
+	}
+}
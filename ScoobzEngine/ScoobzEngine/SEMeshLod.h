@@ -0,0 +1,49 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace ScoobzEngine {
+
+	// the most levels a mesh can have, the full mesh included. matches the Lods buffer in cull.comp
+	const uint32_t SE_MESH_MAX_LODS = 8;
+
+	// one level of detail, a range of the meshes index buffer. every level uses the same vertices
+	struct SEMeshLod{
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		float error; // furthest the surface moved from the full mesh, relative to the meshes bounding radius
+	};
+
+	struct SEMeshLodDesc{
+		uint32_t maxLods = SE_MESH_MAX_LODS;
+		float reduction = 0.5f; // each level aims for this fraction of the triangles of the one before
+		float maxError = 0.1f; // the chain stops once a level would be further off than this, relative to the radius
+		float attributeWeight = 0.5f; // how much a change in the attributes counts against a change in position
+	};
+
+	// what LOD selection needs from the view, the same on the CPU and in cull.comp
+	struct SELodView{
+		glm::vec4 depthRow; // clip space w from a world position, the view depth for a perspective projection
+		float scale; // pixels one world unit covers at depth 1, over the error allowed in pixels
+	};
+
+	// simplifies the triangles in indices down to the target index count, or until the next collapse would move
+	// the surface more than the target error, relative to the meshes bounding radius. edges are collapsed onto one
+	// of their own vertices, cheapest first by quadric error, so no vertex is ever moved or made up and every
+	// attribute stays exact. vertices with the same position but different attributes are a seam: seams and
+	// open borders only collapse along themselves, and both sides of a seam together, so they never crack open.
+	// attributes are optional, attribute count floats per vertex. returns the error reached
+	float SimplifyMesh(const std::vector<glm::vec3>&, const float*, uint32_t, const std::vector<uint32_t>&, uint32_t, float, std::vector<uint32_t>&);
+	// the full mesh then every level simplified from the one before it, appended to the index buffer one after
+	// another. stops early once a level stops getting smaller or gets too far off. positions, attributes,
+	// attribute count, indices, desc, the index buffer out and the levels out
+	void GenerateLods(const std::vector<glm::vec3>&, const float*, uint32_t, const std::vector<uint32_t>&, const SEMeshLodDesc&,
+		std::vector<uint32_t>&, std::vector<SEMeshLod>&);
+
+	// view projection in Vulkan clip space, viewport height and how many pixels of error to allow
+	SELodView MakeLodView(const glm::mat4&, float, float);
+	// the coarsest level whose error covers no more than the allowed pixels, for an object with this world bounds
+	// centre and radius. the full mesh when the object is at or behind the camera
+	uint32_t SelectLod(const std::vector<SEMeshLod>&, const SELodView&, const glm::vec3&, float);
+}
@@ -0,0 +1,234 @@
+#include "SEMeshlet.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace ScoobzEngine {
+
+	// a cone wider than this many degrees either side of its axis never culls anything worth the test
+	static const float MIN_CONE_DOT = 0.1f;
+
+	static void FinishMeshlet(const std::vector<glm::vec3>& positions, const uint32_t* triangles, uint32_t vertexCount, SEMeshlet& meshlet){
+		uint32_t triangleCount = meshlet.indexCount / 3;
+		meshlet.vertexCount = vertexCount;
+
+		// sphere around the box, then shrunk to the furthest corner
+		glm::vec3 boundsMin(FLT_MAX);
+		glm::vec3 boundsMax(-FLT_MAX);
+		for (uint32_t i = 0; i < meshlet.indexCount; i++){
+			boundsMin = glm::min(boundsMin, positions[triangles[i]]);
+			boundsMax = glm::max(boundsMax, positions[triangles[i]]);
+		}
+		meshlet.center = (boundsMin + boundsMax) * 0.5f;
+		float radiusSquared = 0.0f;
+		for (uint32_t i = 0; i < meshlet.indexCount; i++){
+			glm::vec3 offset = positions[triangles[i]] - meshlet.center;
+			radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+		}
+		meshlet.radius = std::sqrt(radiusSquared);
+
+		// the cone axis is the average facing, its width the facing furthest from it
+		std::vector<glm::vec3> normals(triangleCount);
+		glm::vec3 axis(0.0f);
+		for (uint32_t t = 0; t < triangleCount; t++){
+			const glm::vec3& p0 = positions[triangles[t * 3]];
+			glm::vec3 normal = glm::cross(positions[triangles[t * 3 + 1]] - p0, positions[triangles[t * 3 + 2]] - p0);
+			float length = glm::length(normal);
+			normals[t] = length > 0.0f ? normal / length : glm::vec3(0.0f);
+			axis += normals[t];
+		}
+		meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+		meshlet.coneApex = meshlet.center;
+		meshlet.coneCutoff = SE_MESHLET_NO_CONE;
+		float axisLength = glm::length(axis);
+		if (axisLength <= 0.0f){
+			return;
+		}
+		axis /= axisLength;
+
+		float minDot = 1.0f;
+		for (const auto& normal : normals){
+			minDot = std::min(minDot, glm::dot(normal, axis));
+		}
+		if (minDot < MIN_CONE_DOT){
+			return;
+		}
+
+		// the apex goes back along the axis until its behind every triangle, so any view inside the cone from
+		// there sees only their backs
+		float maxT = 0.0f;
+		for (uint32_t t = 0; t < triangleCount; t++){
+			float distance = glm::dot(meshlet.center - positions[triangles[t * 3]], normals[t]);
+			maxT = std::max(maxT, distance / glm::dot(axis, normals[t]));
+		}
+		meshlet.coneAxis = axis;
+		meshlet.coneApex = meshlet.center - axis * maxT;
+		meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+	}
+
+	void BuildMeshlets(const std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices, uint32_t firstIndex, uint32_t indexCount,
+		std::vector<SEMeshlet>& meshlets){
+
+		meshlets.clear();
+		uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+		uint32_t triangleCount = indexCount / 3;
+		const uint32_t* source = indices.data() + firstIndex;
+
+		// the triangles around every vertex
+		std::vector<uint32_t> offsets(vertexCount + 1, 0);
+		for (uint32_t i = 0; i < triangleCount * 3; i++){
+			offsets[source[i] + 1]++;
+		}
+		for (uint32_t v = 0; v < vertexCount; v++){
+			offsets[v + 1] += offsets[v];
+		}
+		std::vector<uint32_t> vertexTriangles(triangleCount * 3);
+		std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+		for (uint32_t i = 0; i < triangleCount * 3; i++){
+			vertexTriangles[cursor[source[i]]++] = i / 3;
+		}
+
+		std::vector<glm::vec3> centroids(triangleCount);
+		for (uint32_t t = 0; t < triangleCount; t++){
+			centroids[t] = (positions[source[t * 3]] + positions[source[t * 3 + 1]] + positions[source[t * 3 + 2]]) / 3.0f;
+		}
+
+		std::vector<uint32_t> reordered;
+		reordered.reserve(triangleCount * 3);
+		std::vector<uint8_t> emitted(triangleCount, 0);
+		std::vector<uint32_t> vertexMeshlet(vertexCount, ~0u); // the last meshlet each vertex was added to
+		std::vector<uint32_t> meshletVertices;
+		uint32_t nextSeed = 0;
+
+		while (reordered.size() < triangleCount * 3){
+			SEMeshlet meshlet = {};
+			meshlet.firstIndex = firstIndex + static_cast<uint32_t>(reordered.size());
+			uint32_t meshletIndex = static_cast<uint32_t>(meshlets.size());
+			meshletVertices.clear();
+			glm::vec3 centroidSum(0.0f);
+
+			// starts from the first triangle thats left, then grows from whatever touches it
+			while (emitted[nextSeed]){
+				nextSeed++;
+			}
+			uint32_t next = nextSeed;
+
+			while (next != ~0u){
+				const uint32_t* triangle = source + next * 3;
+				for (int k = 0; k < 3; k++){
+					if (vertexMeshlet[triangle[k]] != meshletIndex){
+						vertexMeshlet[triangle[k]] = meshletIndex;
+						meshletVertices.push_back(triangle[k]);
+					}
+				}
+				reordered.insert(reordered.end(), triangle, triangle + 3);
+				emitted[next] = 1;
+				meshlet.indexCount += 3;
+				centroidSum += centroids[next];
+				if (meshlet.indexCount / 3 == SE_MESHLET_MAX_TRIANGLES){
+					break;
+				}
+
+				// the neighbour that brings in the fewest new vertices, then the one closest to the middle so far
+				glm::vec3 middle = centroidSum / static_cast<float>(meshlet.indexCount / 3);
+				uint32_t room = SE_MESHLET_MAX_VERTICES - static_cast<uint32_t>(meshletVertices.size());
+				uint32_t bestNew = 4;
+				float bestDistance = FLT_MAX;
+				next = ~0u;
+				for (uint32_t vertex : meshletVertices){
+					for (uint32_t i = offsets[vertex]; i < offsets[vertex + 1]; i++){
+						uint32_t candidate = vertexTriangles[i];
+						if (emitted[candidate]){
+							continue;
+						}
+						const uint32_t* corners = source + candidate * 3;
+						uint32_t newVertices = 0;
+						for (int k = 0; k < 3; k++){
+							newVertices += vertexMeshlet[corners[k]] != meshletIndex ? 1 : 0;
+						}
+						if (newVertices > room){
+							continue;
+						}
+						glm::vec3 offset = centroids[candidate] - middle;
+						float distance = glm::dot(offset, offset);
+						if (newVertices < bestNew || (newVertices == bestNew && distance < bestDistance)){
+							bestNew = newVertices;
+							bestDistance = distance;
+							next = candidate;
+						}
+					}
+				}
+			}
+
+			FinishMeshlet(positions, reordered.data() + (meshlet.firstIndex - firstIndex), static_cast<uint32_t>(meshletVertices.size()), meshlet);
+			meshlets.push_back(meshlet);
+		}
+
+		std::copy(reordered.begin(), reordered.end(), indices.begin() + firstIndex);
+	}
+
+	glm::vec4 GetViewpoint(const glm::mat4& viewProjection){
+		// the camera is the one point clip x, y and w are all 0 at, whatever its depth
+		glm::vec4 rows[3];
+		const int rowIndices[3] = { 0, 1, 3 };
+		for (int i = 0; i < 3; i++){
+			rows[i] = glm::vec4(viewProjection[0][rowIndices[i]], viewProjection[1][rowIndices[i]], viewProjection[2][rowIndices[i]], viewProjection[3][rowIndices[i]]);
+		}
+		// the 4D cross product of the three rows, each component the determinant without that column
+		glm::vec4 viewpoint;
+		for (int c = 0; c < 4; c++){
+			glm::vec3 minors[3];
+			for (int i = 0; i < 3; i++){
+				int k = 0;
+				for (int j = 0; j < 4; j++){
+					if (j != c){
+						minors[i][k++] = rows[i][j];
+					}
+				}
+			}
+			float determinant = glm::dot(minors[0], glm::cross(minors[1], minors[2]));
+			viewpoint[c] = c % 2 == 0 ? determinant : -determinant;
+		}
+
+		// point or direction, w * p - xyz has to point into the view, the way depth goes up
+		glm::vec3 depthRow(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2]);
+		bool flip = viewpoint.w != 0.0f ? viewpoint.w < 0.0f : glm::dot(depthRow, -glm::vec3(viewpoint)) < 0.0f;
+		return flip ? -viewpoint : viewpoint;
+	}
+
+	uint32_t CullMeshlets(const std::vector<SEMeshlet>& meshlets, const glm::mat4& model, const SEFrustum& frustum, const glm::vec4& viewpoint,
+		std::vector<uint32_t>& visible){
+
+		// planes go to local space by the transpose, the viewpoint by the inverse. facing away is the same in
+		// either space, so the cones need no fixing up for scale. the planes arent normalised any more, so the
+		// radius is scaled by their normals length instead
+		glm::vec4 planes[6];
+		float planeScales[6];
+		glm::mat4 planeTransform = glm::transpose(model);
+		for (int i = 0; i < 6; i++){
+			planes[i] = planeTransform * frustum.planes[i];
+			planeScales[i] = glm::length(glm::vec3(planes[i]));
+		}
+		glm::vec4 localViewpoint = glm::inverse(model) * viewpoint;
+
+		visible.resize(meshlets.size());
+		uint32_t visibleCount = 0;
+		for (uint32_t m = 0; m < meshlets.size(); m++){
+			const SEMeshlet& meshlet = meshlets[m];
+			bool inside = true;
+			for (int i = 0; i < 6 && inside; i++){
+				inside = glm::dot(glm::vec3(planes[i]), meshlet.center) + planes[i].w >= -meshlet.radius * planeScales[i];
+			}
+			if (!inside){
+				continue;
+			}
+			glm::vec3 view = localViewpoint.w * meshlet.coneApex - glm::vec3(localViewpoint);
+			float viewLength = glm::length(view);
+			if (viewLength > 0.0f && glm::dot(view, meshlet.coneAxis) >= meshlet.coneCutoff * viewLength){
+				continue;
+			}
+			visible[visibleCount++] = m;
+		}
+		return visibleCount;
+	}
+}
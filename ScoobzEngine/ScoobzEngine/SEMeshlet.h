@@ -0,0 +1,41 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "SEFrustumCull.h"
+
+namespace ScoobzEngine {
+
+	// how big a meshlet gets, what mesh shaders on most hardware are happiest with
+	const uint32_t SE_MESHLET_MAX_VERTICES = 64;
+	const uint32_t SE_MESHLET_MAX_TRIANGLES = 124;
+	// a cone cutoff no view can reach, for meshlets whose triangles face too many ways to ever all face away
+	const float SE_MESHLET_NO_CONE = 2.0f;
+
+	// a cluster of neighbouring triangles, one range of the meshes index buffer, and what it takes to cull it on its
+	// own in the meshes local space. matches Meshlet in cull.comp
+	struct SEMeshlet{
+		glm::vec3 center;
+		float radius;
+		// every triangle faces away from a viewpoint v when dot(normalize(coneApex - v), coneAxis) >= coneCutoff
+		glm::vec3 coneApex;
+		float coneCutoff;
+		glm::vec3 coneAxis;
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		uint32_t vertexCount;
+		uint32_t padding[2];
+	};
+
+	// splits the triangles in index range first index, index count into meshlets, reordering them in place so each
+	// meshlet is one run of the range. grown greedily from neighbouring triangles, preferring ones that bring in
+	// the fewest new vertices then the closest, so meshlets stay compact and their bounds tight
+	void BuildMeshlets(const std::vector<glm::vec3>&, std::vector<uint32_t>&, uint32_t, uint32_t, std::vector<SEMeshlet>&);
+
+	// the camera of a view projection as a homogeneous point. w is 0 for an orthographic projection, then its the
+	// direction back towards the camera. either way w * p - xyz points from the camera through p
+	glm::vec4 GetViewpoint(const glm::mat4&);
+	// writes the meshlets of one object that touch the frustum and have any triangle facing the viewpoint, as
+	// indices into the meshlets, and returns how many there are. the model matrix takes both into local space
+	uint32_t CullMeshlets(const std::vector<SEMeshlet>&, const glm::mat4&, const SEFrustum&, const glm::vec4&, std::vector<uint32_t>&);
+}
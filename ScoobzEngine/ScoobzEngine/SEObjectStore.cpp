@@ -0,0 +1,178 @@
+#include "SEObjectStore.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ScoobzEngine {
+
+	// padding has a sphere so far inside out that no plane test can pass
+	static const float PADDING_RADIUS = -1e30f;
+
+	SEObjectStore::SEObjectStore(){}
+	SEObjectStore::~SEObjectStore(){}
+
+	SEObjectHandle SEObjectStore::Add(const glm::mat4& model, const glm::vec3& boundsMin, const glm::vec3& boundsMax, uint32_t material){
+		SEObjectHandle handle;
+		if (!freeHandles.empty()){
+			handle = freeHandles.back();
+			freeHandles.pop_back();
+		}
+		else{
+			handle = static_cast<SEObjectHandle>(indices.size());
+			indices.push_back(SE_INVALID_OBJECT);
+		}
+
+		uint32_t index = count++;
+		version++;
+		Resize(count);
+		transforms.push_back(model);
+		localCenters.push_back((boundsMin + boundsMax) * 0.5f);
+		localExtents.push_back((boundsMax - boundsMin) * 0.5f);
+		materials.push_back(material);
+		handles.push_back(handle);
+		indices[handle] = index;
+		UpdateBounds(index);
+		return handle;
+	}
+
+	void SEObjectStore::Remove(SEObjectHandle handle){
+		if (handle >= indices.size() || indices[handle] == SE_INVALID_OBJECT){
+			throw std::runtime_error("Removing an object that isnt in the store");
+		}
+
+		SetOccluder(handle, false);
+
+		uint32_t index = indices[handle];
+		uint32_t last = count - 1;
+		if (index != last){
+			centerX[index] = centerX[last];
+			centerY[index] = centerY[last];
+			centerZ[index] = centerZ[last];
+			extentX[index] = extentX[last];
+			extentY[index] = extentY[last];
+			extentZ[index] = extentZ[last];
+			radius[index] = radius[last];
+			transforms[index] = transforms[last];
+			localCenters[index] = localCenters[last];
+			localExtents[index] = localExtents[last];
+			materials[index] = materials[last];
+			handles[index] = handles[last];
+			indices[handles[index]] = index;
+			MarkChanged(index);
+		}
+		transforms.pop_back();
+		localCenters.pop_back();
+		localExtents.pop_back();
+		materials.pop_back();
+		handles.pop_back();
+
+		indices[handle] = SE_INVALID_OBJECT;
+		freeHandles.push_back(handle);
+		count--;
+		version++;
+		SetPadding(last);
+		Resize(count);
+	}
+
+	void SEObjectStore::SetTransform(SEObjectHandle handle, const glm::mat4& model){
+		uint32_t index = indices[handle];
+		transforms[index] = model;
+		UpdateBounds(index);
+	}
+
+	void SEObjectStore::Clear(){
+		count = 0;
+		version++;
+		Resize(0);
+		transforms.clear();
+		localCenters.clear();
+		localExtents.clear();
+		materials.clear();
+		handles.clear();
+		indices.clear();
+		freeHandles.clear();
+		occluders.clear();
+		ClearChanges();
+	}
+
+	void SEObjectStore::SetOccluder(SEObjectHandle handle, bool occluder){
+		auto found = std::find(occluders.begin(), occluders.end(), handle);
+		if (occluder && found == occluders.end()){
+			occluders.push_back(handle);
+		}
+		else if (!occluder && found != occluders.end()){
+			occluders.erase(found);
+		}
+	}
+
+	void SEObjectStore::ClearChanges(){
+		for (uint32_t index : changes){
+			changed[index] = 0;
+		}
+		changes.clear();
+	}
+
+	void SEObjectStore::MarkChanged(uint32_t index){
+		if (index >= changed.size()){
+			changed.resize(index + 1);
+		}
+		if (!changed[index]){
+			changed[index] = 1;
+			changes.push_back(index);
+		}
+	}
+
+	// the world box is the local box transformed and boxed again, the sphere is around the same centre and only
+	// grows with the largest scale, so it stays tighter than the box for rotated objects
+	void SEObjectStore::UpdateBounds(uint32_t index){
+		const glm::mat4& model = transforms[index];
+		const glm::vec3& localCenter = localCenters[index];
+		const glm::vec3& localExtent = localExtents[index];
+
+		glm::vec4 center = model * glm::vec4(localCenter, 1.0f);
+		centerX[index] = center.x;
+		centerY[index] = center.y;
+		centerZ[index] = center.z;
+
+		glm::vec3 extent;
+		for (int row = 0; row < 3; row++){
+			extent[row] = std::abs(model[0][row]) * localExtent.x + std::abs(model[1][row]) * localExtent.y + std::abs(model[2][row]) * localExtent.z;
+		}
+		extentX[index] = extent.x;
+		extentY[index] = extent.y;
+		extentZ[index] = extent.z;
+
+		float scale = std::max(std::max(glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1]))), glm::length(glm::vec3(model[2])));
+		radius[index] = glm::length(localExtent) * scale;
+		MarkChanged(index);
+	}
+
+	void SEObjectStore::SetPadding(uint32_t index){
+		centerX[index] = 0.0f;
+		centerY[index] = 0.0f;
+		centerZ[index] = 0.0f;
+		extentX[index] = 0.0f;
+		extentY[index] = 0.0f;
+		extentZ[index] = 0.0f;
+		radius[index] = PADDING_RADIUS;
+	}
+
+	// keeps the bounds arrays at the next multiple of the padding, new slots start out as padding
+	void SEObjectStore::Resize(uint32_t objectCount){
+		uint32_t oldSize = GetPaddedCount();
+		uint32_t newSize = (objectCount + SE_OBJECT_STORE_PAD - 1) / SE_OBJECT_STORE_PAD * SE_OBJECT_STORE_PAD;
+		if (newSize == oldSize){
+			return;
+		}
+		centerX.resize(newSize);
+		centerY.resize(newSize);
+		centerZ.resize(newSize);
+		extentX.resize(newSize);
+		extentY.resize(newSize);
+		extentZ.resize(newSize);
+		radius.resize(newSize);
+		for (uint32_t i = oldSize; i < newSize; i++){
+			SetPadding(i);
+		}
+	}
+}
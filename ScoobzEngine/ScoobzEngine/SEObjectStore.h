@@ -0,0 +1,92 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace ScoobzEngine {
+
+	typedef uint32_t SEObjectHandle;
+	const SEObjectHandle SE_INVALID_OBJECT = ~0u;
+
+	// the bounds arrays are always a multiple of this long, so a culling kernel can run 8 wide to the end
+	const uint32_t SE_OBJECT_STORE_PAD = 8;
+
+	// every object in the scene. world bounds are kept as one array per component, so the culler loads the same
+	// component of 4 or 8 objects in one go. each object has both a box and a sphere around the box centre, the
+	// culler uses whichever is tighter against each plane. removing moves the last object into the hole, handles
+	// stay valid but indices dont
+	class SEObjectStore{
+
+	public:
+		SEObjectStore();~SEObjectStore();
+
+		//FUNCTIONS :: PUBLIC
+		// model matrix, local space bounds min and max, material index into the bindless tables
+		SEObjectHandle Add(const glm::mat4&, const glm::vec3&, const glm::vec3&, uint32_t);
+		void Remove(SEObjectHandle);
+		// moves the world bounds with the object
+		void SetTransform(SEObjectHandle, const glm::mat4&);
+		void Clear();
+		// occluders are drawn into the occlusion buffer every frame and hide whatever is behind them, so only
+		// flag objects that are solid all the way through their bounds, like walls and floors
+		void SetOccluder(SEObjectHandle, bool);
+		// forgets the changes so far, for whoever keeps a copy of the store once theyve caught up
+		void ClearChanges();
+
+		//Getters
+		uint32_t GetCount() const { return count; }
+		// what the bounds arrays are padded to, the padding is never inside any frustum
+		uint32_t GetPaddedCount() const { return static_cast<uint32_t>(centerX.size()); }
+		const float* GetCenterX() const { return centerX.data(); }
+		const float* GetCenterY() const { return centerY.data(); }
+		const float* GetCenterZ() const { return centerZ.data(); }
+		const float* GetExtentX() const { return extentX.data(); }
+		const float* GetExtentY() const { return extentY.data(); }
+		const float* GetExtentZ() const { return extentZ.data(); }
+		const float* GetRadius() const { return radius.data(); }
+		// by index, the culler hands back indices
+		const glm::mat4& GetTransform(uint32_t index) const { return transforms[index]; }
+		uint32_t GetMaterial(uint32_t index) const { return materials[index]; }
+		SEObjectHandle GetHandle(uint32_t index) const { return handles[index]; }
+		uint32_t GetIndex(SEObjectHandle handle) const { return indices[handle]; }
+		const glm::vec3& GetLocalCenter(uint32_t index) const { return localCenters[index]; }
+		const glm::vec3& GetLocalExtent(uint32_t index) const { return localExtents[index]; }
+		const std::vector<SEObjectHandle>& GetOccluders() const { return occluders; }
+		// indices added, moved or filled by a removal since ClearChanges, each once. some can be past the count
+		// when objects were removed after they changed
+		const std::vector<uint32_t>& GetChanges() const { return changes; }
+		// goes up whenever objects are added or removed, anything kept by index has to start over when it moves
+		uint64_t GetVersion() const { return version; }
+
+	private:
+		void UpdateBounds(uint32_t);
+		void SetPadding(uint32_t);
+		void Resize(uint32_t);
+		void MarkChanged(uint32_t);
+
+		// world bounds, one entry per object plus padding
+		std::vector<float> centerX;
+		std::vector<float> centerY;
+		std::vector<float> centerZ;
+		std::vector<float> extentX;
+		std::vector<float> extentY;
+		std::vector<float> extentZ;
+		std::vector<float> radius;
+
+		// only touched for visible objects or when something moves
+		std::vector<glm::mat4> transforms;
+		std::vector<glm::vec3> localCenters;
+		std::vector<glm::vec3> localExtents;
+		std::vector<uint32_t> materials;
+		std::vector<SEObjectHandle> handles; // index to handle
+
+		std::vector<uint32_t> indices; // handle to index, SE_INVALID_OBJECT once removed
+		std::vector<SEObjectHandle> freeHandles;
+		std::vector<SEObjectHandle> occluders; // a handful at most, so kept as a plain list
+		uint32_t count = 0;
+		uint64_t version = 0;
+
+		std::vector<uint32_t> changes;
+		std::vector<uint8_t> changed; // by index, whether its already in changes
+	};
+}
@@ -0,0 +1,264 @@
+#include "SEOcclusionCull.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ScoobzEngine {
+
+	// anything closer to the camera plane than this in w is treated as crossing it
+	static const float MIN_W = 1e-5f;
+	// an object has to be this far behind to count as hidden, so an occluder never hides itself through rounding
+	static const float DEPTH_BIAS = 1e-6f;
+
+	// the box corners, bit 0 is x, bit 1 y and bit 2 z. each face goes round its corners in order
+	static const int BOX_FACES[6][4] = {
+		{ 0, 2, 6, 4 }, { 1, 3, 7, 5 },
+		{ 0, 1, 5, 4 }, { 2, 3, 7, 6 },
+		{ 0, 1, 3, 2 }, { 4, 5, 7, 6 },
+	};
+
+	SEOcclusionBuffer::SEOcclusionBuffer(){}
+	SEOcclusionBuffer::~SEOcclusionBuffer(){}
+
+	void SEOcclusionBuffer::Create(uint32_t bufferWidth, uint32_t bufferHeight){
+		if (bufferWidth == 0 || bufferHeight == 0 || (bufferWidth & (bufferWidth - 1)) || (bufferHeight & (bufferHeight - 1))){
+			throw std::runtime_error("Occlusion buffer size has to be a power of two");
+		}
+		width = bufferWidth;
+		height = bufferHeight;
+
+		levelOffsets.clear();
+		uint32_t texels = 0;
+		for (uint32_t levelWidth = width, levelHeight = height;; levelWidth = std::max(levelWidth / 2, 1u), levelHeight = std::max(levelHeight / 2, 1u)){
+			if (levelOffsets.size() == SE_OCCLUSION_MAX_LEVELS){
+				throw std::runtime_error("Occlusion buffer is too big");
+			}
+			levelOffsets.push_back(texels);
+			texels += levelWidth * levelHeight;
+			if (levelWidth == 1 && levelHeight == 1){
+				break;
+			}
+		}
+		pyramid.assign(texels, 1.0f);
+	}
+
+	void SEOcclusionBuffer::Begin(const glm::mat4& viewProj){
+		viewProjection = viewProj;
+		std::fill(pyramid.begin(), pyramid.begin() + width * height, 1.0f);
+		stats = {};
+	}
+
+	void SEOcclusionBuffer::DrawOccluders(const SEObjectStore& store){
+		for (SEObjectHandle handle : store.GetOccluders()){
+			uint32_t index = store.GetIndex(handle);
+			DrawOccluder(store.GetTransform(index), store.GetLocalCenter(index), store.GetLocalExtent(index));
+		}
+	}
+
+	// clipping against the camera plane would need new vertices, an occluder that crosses it is just left out
+	void SEOcclusionBuffer::DrawOccluder(const glm::mat4& model, const glm::vec3& localCenter, const glm::vec3& localExtent){
+		glm::mat4 clipFromLocal = viewProjection * model;
+		glm::vec3 corners[8];
+		for (int i = 0; i < 8; i++){
+			glm::vec3 corner = localCenter + localExtent * glm::vec3((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+			glm::vec4 clip = clipFromLocal * glm::vec4(corner, 1.0f);
+			if (clip.w < MIN_W){
+				stats.occludersSkipped++;
+				return;
+			}
+			corners[i] = glm::vec3((clip.x / clip.w * 0.5f + 0.5f) * width, (clip.y / clip.w * 0.5f + 0.5f) * height, clip.z / clip.w);
+		}
+
+		// every face, facing or not. the nearest depth wins and the back faces are hidden by the front ones anyway
+		for (const auto& face : BOX_FACES){
+			glm::vec3 quad[4] = { corners[face[0]], corners[face[1]], corners[face[2]], corners[face[3]] };
+			DrawQuad(quad);
+		}
+		stats.occludersDrawn++;
+	}
+
+	// a box face stays a convex quad on screen, drawn whole so there is no shared diagonal to leave a gap along.
+	// a pixel is only filled when all of it is inside, at the farthest depth the face has over it
+	void SEOcclusionBuffer::DrawQuad(const glm::vec3* quad){
+		float area = 0.0f;
+		for (int i = 0; i < 4; i++){
+			const glm::vec3& a = quad[i];
+			const glm::vec3& b = quad[(i + 1) & 3];
+			area += a.x * b.y - b.x * a.y;
+		}
+		// edge on, or too small to cover a whole pixel
+		if (std::abs(area) < 2.0f){
+			return;
+		}
+		float winding = area > 0.0f ? 1.0f : -1.0f;
+
+		// edge i is inside where edgeX * x + edgeY * y + edgeC >= 0, already pulled in by half a pixel
+		float edgeX[4], edgeY[4], edgeC[4];
+		for (int i = 0; i < 4; i++){
+			const glm::vec3& a = quad[i];
+			const glm::vec3& b = quad[(i + 1) & 3];
+			edgeX[i] = -(b.y - a.y) * winding;
+			edgeY[i] = (b.x - a.x) * winding;
+			edgeC[i] = -(edgeX[i] * a.x + edgeY[i] * a.y) - 0.5f * (std::abs(edgeX[i]) + std::abs(edgeY[i]));
+		}
+
+		// the face is flat, so depth is a plane in screen space. taken from the bigger half of the quad, pushed
+		// back to the far corner of each pixel
+		const glm::vec3& p0 = quad[0];
+		const glm::vec3& p1 = quad[1];
+		const glm::vec3& p2 = quad[2];
+		const glm::vec3& p3 = quad[3];
+		glm::vec3 e1 = p1 - p0, e2 = p2 - p0, e3 = p3 - p0;
+		float det012 = e1.x * e2.y - e2.x * e1.y;
+		float det023 = e2.x * e3.y - e3.x * e2.y;
+		glm::vec3 u = e1, v = e2;
+		float det = det012;
+		if (std::abs(det023) > std::abs(det012)){
+			u = e2;
+			v = e3;
+			det = det023;
+		}
+		float depthX = (u.z * v.y - v.z * u.y) / det;
+		float depthY = (v.z * u.x - u.z * v.x) / det;
+		float depthC = p0.z - depthX * p0.x - depthY * p0.y + 0.5f * (std::abs(depthX) + std::abs(depthY));
+
+		float minX = std::min(std::min(p0.x, p1.x), std::min(p2.x, p3.x));
+		float maxX = std::max(std::max(p0.x, p1.x), std::max(p2.x, p3.x));
+		float minY = std::min(std::min(p0.y, p1.y), std::min(p2.y, p3.y));
+		float maxY = std::max(std::max(p0.y, p1.y), std::max(p2.y, p3.y));
+		int x0 = std::max(static_cast<int>(std::floor(minX)), 0);
+		int x1 = std::min(static_cast<int>(std::ceil(maxX)), static_cast<int>(width) - 1);
+		int y0 = std::max(static_cast<int>(std::floor(minY)), 0);
+		int y1 = std::min(static_cast<int>(std::ceil(maxY)), static_cast<int>(height) - 1);
+
+		for (int y = y0; y <= y1; y++){
+			float py = y + 0.5f;
+			float* row = pyramid.data() + y * width;
+			for (int x = x0; x <= x1; x++){
+				float px = x + 0.5f;
+				bool inside = true;
+				for (int i = 0; i < 4; i++){
+					inside &= edgeX[i] * px + edgeY[i] * py + edgeC[i] >= 0.0f;
+				}
+				if (inside){
+					float depth = std::min(std::max(depthX * px + depthY * py + depthC, 0.0f), 1.0f);
+					row[x] = std::min(row[x], depth);
+				}
+			}
+		}
+	}
+
+	void SEOcclusionBuffer::BuildHiZ(){
+		uint32_t levelWidth = width;
+		uint32_t levelHeight = height;
+		for (uint32_t level = 1; level < GetLevelCount(); level++){
+			const float* source = pyramid.data() + levelOffsets[level - 1];
+			uint32_t sourceWidth = levelWidth;
+			uint32_t sourceHeight = levelHeight;
+			levelWidth = std::max(levelWidth / 2, 1u);
+			levelHeight = std::max(levelHeight / 2, 1u);
+			float* destination = pyramid.data() + levelOffsets[level];
+
+			// once one side is down to a texel it stops halving, the other side still pairs up
+			uint32_t stepX = sourceWidth > 1 ? 2 : 1;
+			uint32_t stepY = sourceHeight > 1 ? 2 : 1;
+			for (uint32_t y = 0; y < levelHeight; y++){
+				const float* row0 = source + (y * stepY) * sourceWidth;
+				const float* row1 = source + (y * stepY + stepY - 1) * sourceWidth;
+				for (uint32_t x = 0; x < levelWidth; x++){
+					uint32_t left = x * stepX;
+					uint32_t right = left + stepX - 1;
+					destination[y * levelWidth + x] = std::max(std::max(row0[left], row0[right]), std::max(row1[left], row1[right]));
+				}
+			}
+		}
+	}
+
+	bool SEOcclusionBuffer::IsVisible(const glm::vec3& center, const glm::vec3& extent){
+		stats.objectsTested++;
+
+		// the corners in clip space are the centre plus or minus each axis, so only the centre needs a full transform
+		glm::vec4 clipCenter = viewProjection * glm::vec4(center, 1.0f);
+		glm::vec4 clipAxisX = viewProjection[0] * extent.x;
+		glm::vec4 clipAxisY = viewProjection[1] * extent.y;
+		glm::vec4 clipAxisZ = viewProjection[2] * extent.z;
+
+		float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f, minDepth = 1e30f;
+		for (int i = 0; i < 8; i++){
+			glm::vec4 clip = clipCenter + ((i & 1) ? clipAxisX : -clipAxisX) + ((i & 2) ? clipAxisY : -clipAxisY) + ((i & 4) ? clipAxisZ : -clipAxisZ);
+			if (clip.w < MIN_W){
+				return true;
+			}
+			float inverseW = 1.0f / clip.w;
+			float x = clip.x * inverseW;
+			float y = clip.y * inverseW;
+			minX = std::min(minX, x);
+			maxX = std::max(maxX, x);
+			minY = std::min(minY, y);
+			maxY = std::max(maxY, y);
+			minDepth = std::min(minDepth, clip.z * inverseW);
+		}
+		// only the rectangle goes to pixels, not every corner
+		minX = (minX * 0.5f + 0.5f) * width;
+		maxX = (maxX * 0.5f + 0.5f) * width;
+		minY = (minY * 0.5f + 0.5f) * height;
+		maxY = (maxY * 0.5f + 0.5f) * height;
+
+		// off screen is up to the frustum, in front of the near plane is always visible
+		if (maxX < 0.0f || maxY < 0.0f || minX >= width || minY >= height || minDepth <= 0.0f){
+			return true;
+		}
+
+		int x0 = std::max(static_cast<int>(std::floor(minX)), 0);
+		int x1 = std::min(static_cast<int>(std::floor(maxX)), static_cast<int>(width) - 1);
+		int y0 = std::max(static_cast<int>(std::floor(minY)), 0);
+		int y1 = std::min(static_cast<int>(std::floor(maxY)), static_cast<int>(height) - 1);
+
+		// climb until the rectangle is at most two texels each way
+		uint32_t level = 0;
+		while ((x1 - x0 > 1 || y1 - y0 > 1) && level + 1 < GetLevelCount()){
+			x0 >>= 1;
+			x1 >>= 1;
+			y0 >>= 1;
+			y1 >>= 1;
+			level++;
+		}
+
+		uint32_t levelWidth = std::max(width >> level, 1u);
+		const float* texels = pyramid.data() + levelOffsets[level];
+		float farthest = 0.0f;
+		for (int y = y0; y <= y1; y++){
+			for (int x = x0; x <= x1; x++){
+				farthest = std::max(farthest, texels[y * levelWidth + x]);
+			}
+		}
+
+		if (minDepth > farthest + DEPTH_BIAS){
+			stats.objectsOccluded++;
+			return false;
+		}
+		return true;
+	}
+
+	uint32_t CullOccluded(const SEObjectStore& store, SEOcclusionBuffer& occlusion, std::vector<uint32_t>& visible, uint32_t visibleCount){
+		if (occlusion.IsEmpty()){
+			return visibleCount;
+		}
+
+		const float* centerX = store.GetCenterX();
+		const float* centerY = store.GetCenterY();
+		const float* centerZ = store.GetCenterZ();
+		const float* extentX = store.GetExtentX();
+		const float* extentY = store.GetExtentY();
+		const float* extentZ = store.GetExtentZ();
+
+		uint32_t kept = 0;
+		for (uint32_t i = 0; i < visibleCount; i++){
+			uint32_t index = visible[i];
+			visible[kept] = index;
+			kept += occlusion.IsVisible(glm::vec3(centerX[index], centerY[index], centerZ[index]),
+				glm::vec3(extentX[index], extentY[index], extentZ[index])) ? 1 : 0;
+		}
+		return kept;
+	}
+}
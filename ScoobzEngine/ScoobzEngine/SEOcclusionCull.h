@@ -0,0 +1,68 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include "SEObjectStore.h"
+
+namespace ScoobzEngine {
+
+	// matches levelOffsets in cull.comp
+	const uint32_t SE_OCCLUSION_MAX_LEVELS = 16;
+
+	// what the last frame drew and tested
+	struct SEOcclusionStats{
+		uint32_t occludersDrawn;
+		uint32_t occludersSkipped; // crossed the camera plane, leaving them out is always safe
+		uint32_t objectsTested;
+		uint32_t objectsOccluded;
+	};
+
+	// a small software depth buffer the occluders are drawn into on the CPU, and a hierarchical z pyramid over it
+	// where each texel is the farthest depth of the four below it. an object is hidden when its nearest point is
+	// behind the farthest depth anywhere its screen rectangle covers, found in at most four texels of whichever
+	// level makes the rectangle two texels wide. everything is conservative: occluders only fill pixels they cover
+	// completely at no nearer than their real depth, so nothing visible is ever rejected
+	class SEOcclusionBuffer{
+
+	public:
+		SEOcclusionBuffer();~SEOcclusionBuffer();
+
+		//FUNCTIONS :: PUBLIC
+		// width and height, powers of two so every level halves exactly
+		void Create(uint32_t, uint32_t);
+		// clears to the far plane. the view projection is Vulkan clip space, depth 0 to 1
+		void Begin(const glm::mat4&);
+		// model matrix, local bounds centre and extent. the box is drawn solid, a flat box as its one face
+		void DrawOccluder(const glm::mat4&, const glm::vec3&, const glm::vec3&);
+		void DrawOccluders(const SEObjectStore&);
+		// call once every occluder is in, before any test
+		void BuildHiZ();
+		// world box centre and extent, false only when its completely behind the occluders
+		bool IsVisible(const glm::vec3&, const glm::vec3&);
+
+		//Getters
+		uint32_t GetWidth() const { return width; }
+		uint32_t GetHeight() const { return height; }
+		uint32_t GetLevelCount() const { return static_cast<uint32_t>(levelOffsets.size()); }
+		// where each level starts in the pyramid, level 0 is the full size buffer
+		uint32_t GetLevelOffset(uint32_t level) const { return levelOffsets[level]; }
+		// every level packed one after another, row by row
+		const std::vector<float>& GetPyramid() const { return pyramid; }
+		const glm::mat4& GetViewProjection() const { return viewProjection; }
+		// nothing drawn this frame, every test would pass
+		bool IsEmpty() const { return stats.occludersDrawn == 0; }
+		SEOcclusionStats GetStats() const { return stats; }
+
+	private:
+		void DrawQuad(const glm::vec3*);
+
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector<float> pyramid;
+		std::vector<uint32_t> levelOffsets;
+		glm::mat4 viewProjection = glm::mat4(1.0f);
+		SEOcclusionStats stats = {};
+	};
+
+	// drops the visible objects hidden by the occlusion buffer, keeping the rest in order. returns how many are left
+	uint32_t CullOccluded(const SEObjectStore&, SEOcclusionBuffer&, std::vector<uint32_t>&, uint32_t);
+}
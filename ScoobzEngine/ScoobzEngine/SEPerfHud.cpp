@@ -0,0 +1,135 @@
+#include "SEPerfHud.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+
+namespace ScoobzEngine {
+
+	// RGBA8, red in the low byte
+	static const uint32_t PANEL_COLOR = 0xc0000000;
+	static const uint32_t GRAPH_COLOR = 0x40ffffff;
+	static const uint32_t BUDGET_COLOR = 0x80ffffff;
+	static const uint32_t TEXT_COLOR = 0xffffffff;
+	static const uint32_t FAST_COLOR = 0xff40c040;
+	static const uint32_t SLOW_COLOR = 0xff40c0e0;
+	static const uint32_t MISSED_COLOR = 0xff4040e0;
+	// a frame at 60 Hz, bars past it turn yellow and past two of them red
+	static const float FRAME_BUDGET_MS = 1000.0f / 60.0f;
+	static const float PADDING = 6.0f;
+	static const float BAR_WIDTH = 2.0f;
+	static const float GRAPH_HEIGHT = 64.0f;
+	static const uint32_t LINE_COUNT = 6;
+
+	SEPerfHud::SEPerfHud(){}
+	SEPerfHud::~SEPerfHud(){}
+
+	void SEPerfHud::AddSample(const SEFrameSample& sample){
+		history[next] = sample;
+		next = (next + 1) % SE_HUD_HISTORY;
+		count = std::min(count + 1, SE_HUD_HISTORY);
+
+		totalSamples++;
+		totalFrameMs += sample.frameMs;
+		totalCpuMs += sample.cpuMs;
+		totalFenceWaitMs += sample.fenceWaitMs;
+		if (sample.gpuMs >= 0.0f){
+			totalGpuSamples++;
+			totalGpuMs += sample.gpuMs;
+		}
+		worstFrameMs = std::max(worstFrameMs, sample.frameMs);
+	}
+
+	void SEPerfHud::Draw(SESpriteBatch* batch, SETextRenderer* text, const glm::vec2& position){
+		if (!visible || count == 0 || !batch || !text){
+			return;
+		}
+
+		// the timings are averaged over the ring so they can be read, the counts are the newest frames
+		float frameMs = 0.0f;
+		float cpuMs = 0.0f;
+		float gpuMs = 0.0f;
+		float fenceWaitMs = 0.0f;
+		float worstMs = 0.0f;
+		uint32_t gpuCount = 0;
+		for (uint32_t i = 0; i < count; i++){
+			const SEFrameSample& sample = history[(next + SE_HUD_HISTORY - count + i) % SE_HUD_HISTORY];
+			frameMs += sample.frameMs;
+			cpuMs += sample.cpuMs;
+			fenceWaitMs += sample.fenceWaitMs;
+			worstMs = std::max(worstMs, sample.frameMs);
+			if (sample.gpuMs >= 0.0f){
+				gpuMs += sample.gpuMs;
+				gpuCount++;
+			}
+		}
+		frameMs /= count;
+		cpuMs /= count;
+		fenceWaitMs /= count;
+		const SEFrameSample& latest = GetLatest();
+
+		char lines[LINE_COUNT][96];
+		snprintf(lines[0], sizeof(lines[0]), "Frame %6.2f ms %5.0f fps  worst %.2f ms", frameMs, frameMs > 0.0f ? 1000.0f / frameMs : 0.0f, worstMs);
+		snprintf(lines[1], sizeof(lines[1]), "CPU   %6.2f ms", cpuMs);
+		if (gpuCount > 0){
+			snprintf(lines[2], sizeof(lines[2]), "GPU   %6.2f ms", gpuMs / gpuCount);
+		}
+		else{
+			snprintf(lines[2], sizeof(lines[2]), "GPU      n/a");
+		}
+		snprintf(lines[3], sizeof(lines[3]), "Wait  %6.2f ms", fenceWaitMs);
+		snprintf(lines[4], sizeof(lines[4]), "Draws %u  Triangles %.1fk", latest.drawCalls, latest.triangles / 1000.0);
+		snprintf(lines[5], sizeof(lines[5]), "Memory %.1f MB device %.1f MB host  %llu allocations +%llu",
+			latest.deviceBytes / (1024.0 * 1024.0), latest.hostBytes / (1024.0 * 1024.0),
+			static_cast<unsigned long long>(latest.allocations), static_cast<unsigned long long>(latest.newAllocations));
+
+		float lineHeight = std::round(text->GetLineHeight());
+		float width = SE_HUD_HISTORY * BAR_WIDTH;
+		for (const auto& line : lines){
+			width = std::max(width, text->Measure(line).x);
+		}
+		glm::vec2 origin = glm::floor(position);
+		glm::vec2 graphOrigin = origin + glm::vec2(PADDING, PADDING * 2.0f + LINE_COUNT * lineHeight);
+		glm::vec2 panelSize(width + PADDING * 2.0f, graphOrigin.y - origin.y + GRAPH_HEIGHT + PADDING);
+
+		// drawn in order on the text layer out of one texture, so the batch keeps them stacked and in one draw
+		text->DrawRect(batch, origin, panelSize, PANEL_COLOR);
+		text->DrawRect(batch, graphOrigin, glm::vec2(SE_HUD_HISTORY * BAR_WIDTH, GRAPH_HEIGHT), GRAPH_COLOR);
+
+		// the newest frame on the right, scaled so two budgets always fit and the worst frame does too
+		float graphMs = std::max(FRAME_BUDGET_MS * 2.0f, worstMs);
+		for (uint32_t i = 0; i < count; i++){
+			float sampleMs = history[(next + SE_HUD_HISTORY - count + i) % SE_HUD_HISTORY].frameMs;
+			float height = std::max(std::round(sampleMs / graphMs * GRAPH_HEIGHT), 1.0f);
+			uint32_t color = sampleMs > FRAME_BUDGET_MS * 2.0f ? MISSED_COLOR : sampleMs > FRAME_BUDGET_MS ? SLOW_COLOR : FAST_COLOR;
+			float x = graphOrigin.x + (SE_HUD_HISTORY - count + i) * BAR_WIDTH;
+			text->DrawRect(batch, glm::vec2(x, graphOrigin.y + GRAPH_HEIGHT - height), glm::vec2(BAR_WIDTH, height), color);
+		}
+		float budgetY = std::round(graphOrigin.y + GRAPH_HEIGHT - FRAME_BUDGET_MS / graphMs * GRAPH_HEIGHT);
+		text->DrawRect(batch, glm::vec2(graphOrigin.x, budgetY), glm::vec2(SE_HUD_HISTORY * BAR_WIDTH, 1.0f), BUDGET_COLOR);
+
+		for (uint32_t i = 0; i < LINE_COUNT; i++){
+			text->DrawImmediate(batch, lines[i], origin + glm::vec2(PADDING, PADDING + i * lineHeight), TEXT_COLOR);
+		}
+	}
+
+	void SEPerfHud::PrintStats(){
+		if (totalSamples == 0){
+			return;
+		}
+		double frameMs = totalFrameMs / totalSamples;
+		std::cout << "---- Frame ----" << std::endl;
+		std::cout << std::fixed << std::setprecision(2);
+		std::cout << "Frame time: " << frameMs << " ms (" << (frameMs > 0.0 ? 1000.0 / frameMs : 0.0) << " fps), worst "
+			<< worstFrameMs << " ms" << std::endl;
+		std::cout << "CPU: " << totalCpuMs / totalSamples << " ms, fence wait: " << totalFenceWaitMs / totalSamples << " ms, GPU: ";
+		if (totalGpuSamples > 0){
+			std::cout << totalGpuMs / totalGpuSamples << " ms" << std::endl;
+		}
+		else{
+			std::cout << "not timed" << std::endl;
+		}
+		std::cout << std::defaultfloat;
+	}
+}
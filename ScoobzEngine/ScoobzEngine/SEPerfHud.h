@@ -0,0 +1,64 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include "SESpriteBatch.h"
+#include "SETextRenderer.h"
+
+namespace ScoobzEngine {
+
+	// frames the HUD averages over and graphs, one bar each
+	const uint32_t SE_HUD_HISTORY = 120;
+
+	// what one frame measured
+	struct SEFrameSample{
+		float frameMs; // from the start of the frame before
+		float cpuMs; // recording and submitting, the waits left out
+		float gpuMs; // first to last command, negative when the device cant time it
+		float fenceWaitMs; // blocked on the GPU finishing this slots last frame
+		uint32_t drawCalls; // an indirect call counts once however many draws it makes
+		uint64_t triangles; // the GPU culled draws count as what their slot culled last time it ran
+		uint64_t allocations; // live device memory allocations
+		uint64_t newAllocations; // made since the frame before
+		VkDeviceSize deviceBytes; // live in device local memory
+		VkDeviceSize hostBytes; // live in memory that isnt device local
+	};
+
+	// an overlay of frame timings, draws and memory over a rolling frame time graph. samples go into a fixed ring
+	// and everything, the panel and graph included, is drawn out of a text renderers atlas on one sprite layer, so
+	// the overlay is a single batched draw and a frame with it showing allocates nothing
+	class SEPerfHud{
+
+	public:
+		SEPerfHud();~SEPerfHud();
+
+		//FUNCTIONS :: PUBLIC
+		void AddSample(const SEFrameSample&);
+		// the top left corner in pixels, does nothing while hidden. main thread only, like any sprite
+		void Draw(SESpriteBatch*, SETextRenderer*, const glm::vec2&);
+		void SetVisible(bool visibleIn) { visible = visibleIn; }
+		void Toggle() { visible = !visible; }
+		// averages over every sample since startup
+		void PrintStats();
+
+		//Getters
+		bool IsVisible() { return visible; }
+		// zeroed until the first sample
+		const SEFrameSample& GetLatest() { return history[(next + SE_HUD_HISTORY - 1) % SE_HUD_HISTORY]; }
+
+	private:
+		std::array<SEFrameSample, SE_HUD_HISTORY> history = {};
+		uint32_t next = 0;
+		uint32_t count = 0; // samples in the ring, up to SE_HUD_HISTORY
+		bool visible = false;
+
+		uint64_t totalSamples = 0;
+		uint64_t totalGpuSamples = 0;
+		double totalFrameMs = 0.0;
+		double totalCpuMs = 0.0;
+		double totalGpuMs = 0.0;
+		double totalFenceWaitMs = 0.0;
+		float worstFrameMs = 0.0f;
+	};
+}
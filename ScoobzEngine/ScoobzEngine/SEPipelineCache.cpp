@@ -0,0 +1,453 @@
+#include "SEPipelineCache.h"
+#include <algorithm>
+#include <iomanip>
+
+namespace ScoobzEngine {
+
+	SEPipelineCache::SEPipelineCache(){}
+	SEPipelineCache::~SEPipelineCache(){}
+
+	void SEPipelineCache::Create(const VkDevice* logicalDevice, SEJobSystem* jobs){
+		device = logicalDevice;
+		jobSystem = jobs;
+
+		VkPipelineCacheCreateInfo cacheInfo = {};
+		cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+		if (vkCreatePipelineCache(*device, &cacheInfo, nullptr, &vulkanCache) != VK_SUCCESS){
+			throw std::runtime_error("Failed to create pipeline cache");
+		}
+		else{
+			std::cout << "Pipeline Cache Creation: SUCCESSFUL!" << std::endl;
+		}
+	}
+
+	void SEPipelineCache::Cleanup(){
+		DestroyAll();
+		vkDestroyPipelineCache(*device, vulkanCache, VK_NULL_HANDLE);
+	}
+
+	SEPipelineHandle SEPipelineCache::Request(const SEPipelineDesc& desc){
+		SEPipelineKey key = MakeKey(desc);
+
+		Entry* entry;
+		SEPipelineHandle handle;
+		bool existing;
+		{
+			std::lock_guard<std::mutex> lock(entryMutex);
+			auto found = registry.find(key);
+			existing = found != registry.end();
+			if (existing){
+				handle = found->second;
+			}
+			else{
+				handle = static_cast<SEPipelineHandle>(entries.size());
+				entries.emplace_back();
+				entry = &entries.back();
+				entry->desc = desc;
+				entry->requestTime = Clock::now();
+				registry.emplace(key, handle);
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(statsMutex);
+			stats.requested++;
+			if (existing){
+				stats.deduplicated++;
+			}
+		}
+
+		if (!existing){
+			jobSystem->Run([this, entry] { Compile(entry); }, &entry->compiling);
+		}
+		return handle;
+	}
+
+	SEPipelineKey SEPipelineCache::MakeKey(const SEPipelineDesc& desc){
+		SEPipelineKey key;
+		memset(&key, 0, sizeof(key));
+		key.vertShader = desc.vertShader;
+		key.fragShader = desc.fragShader;
+		key.compShader = desc.compShader;
+		key.layout = desc.layout;
+		key.vertexLayout = HashVertexLayout(desc.vertexBindings, desc.vertexAttributes);
+		key.renderPass = desc.renderPassCompatibility;
+		key.specialization = desc.specialization.Hash();
+		key.subpass = desc.subpass;
+		key.dynamicStates = desc.dynamicStates;
+		key.topology = static_cast<uint8_t>(desc.topology);
+		key.polygonMode = static_cast<uint8_t>(desc.polygonMode);
+		key.cullMode = static_cast<uint8_t>(desc.cullMode);
+		key.frontFace = static_cast<uint8_t>(desc.frontFace);
+		key.blendEnable = desc.blendEnable ? 1 : 0;
+		key.depthTest = desc.depthTest ? 1 : 0;
+		key.depthWrite = desc.depthWrite ? 1 : 0;
+		key.depthCompare = static_cast<uint8_t>(desc.depthCompare);
+		return key;
+	}
+
+	void SEPipelineCache::SetFallback(SEPipelineHandle handle){
+		fallback = handle;
+	}
+
+	VkPipeline SEPipelineCache::Get(SEPipelineHandle handle){
+		Entry* entry = GetEntry(handle);
+		if (entry && entry->state.load(std::memory_order_acquire) == PIPELINE_READY){
+			return entry->pipeline;
+		}
+
+		Entry* fallbackEntry = GetEntry(fallback);
+		if (entry && entry->desc.compShader == VK_NULL_HANDLE && fallbackEntry && fallbackEntry->state.load(std::memory_order_acquire) == PIPELINE_READY){
+			return fallbackEntry->pipeline;
+		}
+
+		return VK_NULL_HANDLE;
+	}
+
+	bool SEPipelineCache::IsReady(SEPipelineHandle handle){
+		Entry* entry = GetEntry(handle);
+		return entry && entry->state.load(std::memory_order_acquire) == PIPELINE_READY;
+	}
+
+	void SEPipelineCache::Wait(SEPipelineHandle handle){
+		Entry* entry = GetEntry(handle);
+		if (entry){
+			jobSystem->WaitForCounter(&entry->compiling);
+			jobSystem->WaitForCounter(&entry->rebuilding);
+		}
+	}
+
+	void SEPipelineCache::WaitAll(){
+		SEPipelineHandle count;
+		{
+			std::lock_guard<std::mutex> lock(entryMutex);
+			count = static_cast<SEPipelineHandle>(entries.size());
+		}
+		for (SEPipelineHandle i = 0; i < count; i++){
+			Wait(i);
+		}
+	}
+
+	void SEPipelineCache::DestroyAll(){
+		WaitAll();
+
+		std::lock_guard<std::mutex> lock(entryMutex);
+		for (auto& entry : entries){
+			if (entry.pipeline != VK_NULL_HANDLE){
+				vkDestroyPipeline(*device, entry.pipeline, VK_NULL_HANDLE);
+			}
+			if (entry.nextPipeline != VK_NULL_HANDLE){
+				vkDestroyPipeline(*device, entry.nextPipeline, VK_NULL_HANDLE);
+			}
+		}
+		entries.clear();
+		rebuildingEntries.clear();
+		registry.clear();
+		fallback = SE_INVALID_PIPELINE;
+	}
+
+	uint32_t SEPipelineCache::ReplaceShader(VkShaderModule oldModule, VkShaderModule newModule){
+		std::vector<std::pair<Entry*, SEPipelineHandle>> affected;
+		{
+			std::lock_guard<std::mutex> lock(entryMutex);
+			for (size_t i = 0; i < entries.size(); i++){
+				const SEPipelineDesc& desc = entries[i].desc;
+				if (desc.vertShader == oldModule || desc.fragShader == oldModule || desc.compShader == oldModule){
+					affected.emplace_back(&entries[i], static_cast<SEPipelineHandle>(i));
+				}
+			}
+		}
+
+		for (auto& pair : affected){
+			Entry* entry = pair.first;
+
+			// the old module has to be out of every compile before the caller destroys it
+			jobSystem->WaitForCounter(&entry->compiling);
+			jobSystem->WaitForCounter(&entry->rebuilding);
+
+			// a rebuild that finished but was never swapped in is stale now
+			if (entry->nextPipeline != VK_NULL_HANDLE){
+				vkDestroyPipeline(*device, entry->nextPipeline, VK_NULL_HANDLE);
+				entry->nextPipeline = VK_NULL_HANDLE;
+			}
+
+			entry->nextDesc = entry->desc;
+			if (entry->nextDesc.vertShader == oldModule){
+				entry->nextDesc.vertShader = newModule;
+			}
+			if (entry->nextDesc.fragShader == oldModule){
+				entry->nextDesc.fragShader = newModule;
+			}
+			if (entry->nextDesc.compShader == oldModule){
+				entry->nextDesc.compShader = newModule;
+			}
+
+			// the handle stays the same, only the key that finds it changes
+			{
+				std::lock_guard<std::mutex> lock(entryMutex);
+				auto found = registry.find(MakeKey(entry->desc));
+				if (found != registry.end() && found->second == pair.second){
+					registry.erase(found);
+				}
+				registry[MakeKey(entry->nextDesc)] = pair.second;
+				entry->desc = entry->nextDesc;
+			}
+
+			entry->nextState.store(PIPELINE_PENDING, std::memory_order_relaxed);
+			if (std::find(rebuildingEntries.begin(), rebuildingEntries.end(), entry) == rebuildingEntries.end()){
+				rebuildingEntries.push_back(entry);
+			}
+			jobSystem->Run([this, entry] { Rebuild(entry); }, &entry->rebuilding);
+		}
+
+		return static_cast<uint32_t>(affected.size());
+	}
+
+	void SEPipelineCache::SwapRebuilt(SEDeletionQueue* deletionQueue){
+		for (auto entry = rebuildingEntries.begin(); entry != rebuildingEntries.end();){
+			int nextState = (*entry)->nextState.load(std::memory_order_acquire);
+			if (nextState == PIPELINE_PENDING){
+				++entry;
+				continue;
+			}
+
+			if (nextState == PIPELINE_READY){
+				// frames still in flight can be using the old pipeline, it goes when their slot comes round again
+				VkPipeline retired = (*entry)->pipeline;
+				if (retired != VK_NULL_HANDLE){
+					const VkDevice* logicalDevice = device;
+					deletionQueue->Push([logicalDevice, retired] { vkDestroyPipeline(*logicalDevice, retired, VK_NULL_HANDLE); });
+				}
+				(*entry)->pipeline = (*entry)->nextPipeline;
+				(*entry)->nextPipeline = VK_NULL_HANDLE;
+				(*entry)->state.store(PIPELINE_READY, std::memory_order_release);
+			}
+			// a failed rebuild keeps drawing with the pipeline it had
+			entry = rebuildingEntries.erase(entry);
+		}
+	}
+
+	SEPipelineCache::Entry* SEPipelineCache::GetEntry(SEPipelineHandle handle){
+		std::lock_guard<std::mutex> lock(entryMutex);
+		if (handle >= entries.size()){
+			return nullptr;
+		}
+		return &entries[handle];
+	}
+
+	void SEPipelineCache::Compile(Entry* entry){
+		auto compileStart = Clock::now();
+
+		// a failed compile mustnt take the worker down with it, draws just keep using the fallback
+		bool succeeded = true;
+		try{
+			entry->pipeline = BuildPipeline(entry->desc);
+		}
+		catch (const std::exception& e){
+			std::cerr << "Pipeline '" << entry->desc.name << "': " << e.what() << std::endl;
+			succeeded = false;
+		}
+
+		auto compileEnd = Clock::now();
+		entry->state.store(succeeded ? PIPELINE_READY : PIPELINE_FAILED, std::memory_order_release);
+
+		std::lock_guard<std::mutex> lock(statsMutex);
+		if (!succeeded){
+			stats.failed++;
+			return;
+		}
+
+		if (stats.compiled == 0 || compileStart < firstCompileStart){
+			firstCompileStart = compileStart;
+		}
+		if (stats.compiled == 0 || compileEnd > lastCompileEnd){
+			lastCompileEnd = compileEnd;
+		}
+		stats.compiled++;
+		stats.totalCompileTime += std::chrono::duration<double, std::milli>(compileEnd - compileStart).count();
+
+		double timeToReady = std::chrono::duration<double, std::milli>(compileEnd - entry->requestTime).count();
+		totalTimeToReady += timeToReady;
+		stats.maxTimeToReady = std::max(stats.maxTimeToReady, timeToReady);
+	}
+
+	void SEPipelineCache::Rebuild(Entry* entry){
+		bool succeeded = true;
+		try{
+			entry->nextPipeline = BuildPipeline(entry->nextDesc);
+		}
+		catch (const std::exception& e){
+			std::cerr << "Pipeline '" << entry->nextDesc.name << "' rebuild: " << e.what() << std::endl;
+			succeeded = false;
+		}
+		entry->nextState.store(succeeded ? PIPELINE_READY : PIPELINE_FAILED, std::memory_order_release);
+
+		std::lock_guard<std::mutex> lock(statsMutex);
+		if (succeeded){
+			stats.rebuilt++;
+		}
+		else{
+			stats.failed++;
+		}
+	}
+
+	VkPipeline SEPipelineCache::BuildPipeline(const SEPipelineDesc& desc){
+		// both stages read the same constants, ids a stage doesnt declare are ignored by it
+		VkSpecializationInfo specializationInfo = desc.specialization.GetInfo();
+		const VkSpecializationInfo* pSpecializationInfo = desc.specialization.Empty() ? nullptr : &specializationInfo;
+
+		if (desc.compShader != VK_NULL_HANDLE){
+			VkComputePipelineCreateInfo pipelineInfo = {};
+			pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+			pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+			pipelineInfo.stage.module = desc.compShader;
+			pipelineInfo.stage.pName = "main";
+			pipelineInfo.stage.pSpecializationInfo = pSpecializationInfo;
+			pipelineInfo.layout = desc.layout;
+
+			VkPipeline pipeline;
+			if (vkCreateComputePipelines(*device, vulkanCache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS){
+				throw std::runtime_error("Failed to create Compute pipeline");
+			}
+			return pipeline;
+		}
+
+		VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
+		vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+		vertShaderStageInfo.module = desc.vertShader;
+		vertShaderStageInfo.pName = "main";
+		vertShaderStageInfo.pSpecializationInfo = pSpecializationInfo;
+
+		VkPipelineShaderStageCreateInfo fragShaderStageInfo = {};
+		fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		fragShaderStageInfo.module = desc.fragShader;
+		fragShaderStageInfo.pName = "main";
+		fragShaderStageInfo.pSpecializationInfo = pSpecializationInfo;
+
+		VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
+		bool depthOnly = desc.fragShader == VK_NULL_HANDLE;
+
+		VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(desc.vertexBindings.size());
+		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(desc.vertexAttributes.size());
+		vertexInputInfo.pVertexBindingDescriptions = desc.vertexBindings.data();
+		vertexInputInfo.pVertexAttributeDescriptions = desc.vertexAttributes.data();
+
+		VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+		inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		inputAssembly.topology = desc.topology;
+		inputAssembly.primitiveRestartEnable = false;
+
+		// viewport and scissor are set while recording, the counts still have to be given here
+		VkPipelineViewportStateCreateInfo viewportState = {};
+		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		viewportState.viewportCount = 1;
+		viewportState.scissorCount = 1;
+
+		VkPipelineRasterizationStateCreateInfo rasterizer = {};
+		rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		rasterizer.depthClampEnable = VK_FALSE;
+		rasterizer.rasterizerDiscardEnable = VK_FALSE;
+		rasterizer.polygonMode = desc.polygonMode;
+		rasterizer.lineWidth = 1.0f;
+		rasterizer.cullMode = desc.cullMode;
+		rasterizer.frontFace = desc.frontFace;
+		rasterizer.depthBiasEnable = VK_FALSE;
+
+		VkPipelineMultisampleStateCreateInfo multisampling = {};
+		multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		multisampling.sampleShadingEnable = VK_FALSE;
+		multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+		VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+		depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		depthStencil.depthTestEnable = desc.depthTest;
+		depthStencil.depthWriteEnable = desc.depthWrite;
+		depthStencil.depthCompareOp = desc.depthCompare;
+		depthStencil.depthBoundsTestEnable = VK_FALSE;
+		depthStencil.stencilTestEnable = VK_FALSE;
+
+		VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+		colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		colorBlendAttachment.blendEnable = desc.blendEnable;
+		colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+		colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+		VkPipelineColorBlendStateCreateInfo colorBlending = {};
+		colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		colorBlending.logicOpEnable = VK_FALSE;
+		colorBlending.attachmentCount = depthOnly ? 0 : 1;
+		colorBlending.pAttachments = depthOnly ? nullptr : &colorBlendAttachment;
+
+		std::vector<VkDynamicState> dynamicStates;
+		if (desc.dynamicStates & SE_DYNAMIC_VIEWPORT){
+			dynamicStates.push_back(VK_DYNAMIC_STATE_VIEWPORT);
+		}
+		if (desc.dynamicStates & SE_DYNAMIC_SCISSOR){
+			dynamicStates.push_back(VK_DYNAMIC_STATE_SCISSOR);
+		}
+		if (desc.dynamicStates & SE_DYNAMIC_LINE_WIDTH){
+			dynamicStates.push_back(VK_DYNAMIC_STATE_LINE_WIDTH);
+		}
+
+		VkPipelineDynamicStateCreateInfo dynamicState = {};
+		dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+		dynamicState.pDynamicStates = dynamicStates.data();
+
+		VkGraphicsPipelineCreateInfo pipelineInfo = {};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		pipelineInfo.stageCount = depthOnly ? 1 : 2;
+		pipelineInfo.pStages = shaderStages;
+		pipelineInfo.pVertexInputState = &vertexInputInfo;
+		pipelineInfo.pInputAssemblyState = &inputAssembly;
+		pipelineInfo.pViewportState = &viewportState;
+		pipelineInfo.pRasterizationState = &rasterizer;
+		pipelineInfo.pMultisampleState = &multisampling;
+		pipelineInfo.pDepthStencilState = &depthStencil;
+		pipelineInfo.pColorBlendState = &colorBlending;
+		pipelineInfo.pDynamicState = &dynamicState;
+		pipelineInfo.layout = desc.layout;
+		pipelineInfo.renderPass = desc.renderPass;
+		pipelineInfo.subpass = desc.subpass;
+
+		VkPipeline pipeline;
+		if (vkCreateGraphicsPipelines(*device, vulkanCache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS){
+			throw std::runtime_error("Failed to create Graphics pipeline");
+		}
+
+		return pipeline;
+	}
+
+	SEPipelineStats SEPipelineCache::GetStats(){
+		std::lock_guard<std::mutex> lock(statsMutex);
+		SEPipelineStats result = stats;
+
+		double window = std::chrono::duration<double>(lastCompileEnd - firstCompileStart).count();
+		result.pipelinesPerSecond = (result.compiled > 0 && window > 0.0) ? result.compiled / window : 0.0;
+		result.averageTimeToReady = result.compiled > 0 ? totalTimeToReady / result.compiled : 0.0;
+
+		return result;
+	}
+
+	void SEPipelineCache::PrintStats(){
+		SEPipelineStats current = GetStats();
+
+		std::cout << "---- Pipeline compilation ----" << std::endl;
+		std::cout << std::fixed << std::setprecision(2);
+		std::cout << "Requested: " << current.requested << ", deduplicated: " << current.deduplicated
+			<< ", compiled: " << current.compiled << ", rebuilt: " << current.rebuilt << ", failed: " << current.failed << std::endl;
+		std::cout << "Compile time: " << current.totalCompileTime << " ms, " << current.pipelinesPerSecond << " pipelines/sec" << std::endl;
+		std::cout << "Time to ready: " << current.averageTimeToReady << " ms average, " << current.maxTimeToReady << " ms max" << std::endl;
+		std::cout << std::defaultfloat;
+	}
+}
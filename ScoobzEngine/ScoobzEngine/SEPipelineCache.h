@@ -0,0 +1,140 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "SEDeletionQueue.h"
+#include "SEJobSystem.h"
+#include "SEPipelineKey.h"
+#include "SEShaderPermutations.h"
+
+namespace ScoobzEngine {
+
+	// everything a graphics pipeline is built from, the defaults match the engines standard opaque pass.
+	// viewport and scissor are always dynamic so nothing here depends on the window size.
+	// a compute shader makes it a compute pipeline instead, only the layout and specialization are used with it
+	struct SEPipelineDesc{
+		std::string name;
+		VkShaderModule vertShader = VK_NULL_HANDLE;
+		VkShaderModule fragShader = VK_NULL_HANDLE; // none makes a depth only pipeline for a subpass without colour
+		VkShaderModule compShader = VK_NULL_HANDLE;
+		SESpecialization specialization; // applied to every stage, see SEShaderPermutations
+		VkPipelineLayout layout = VK_NULL_HANDLE;
+		VkRenderPass renderPass = VK_NULL_HANDLE; // any render pass compatible with renderPassCompatibility
+		uint64_t renderPassCompatibility = 0; // HashRenderPassCompatibility of the render pass above
+		uint32_t subpass = 0;
+		std::vector<VkVertexInputBindingDescription> vertexBindings;
+		std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+		uint32_t dynamicStates = SE_DYNAMIC_VIEWPORT | SE_DYNAMIC_SCISSOR;
+		VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+		VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+		VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;
+		VkBool32 blendEnable = VK_FALSE;
+		VkBool32 depthTest = VK_FALSE;
+		VkBool32 depthWrite = VK_FALSE;
+		VkCompareOp depthCompare = VK_COMPARE_OP_LESS;
+	};
+
+	typedef uint32_t SEPipelineHandle;
+	static const SEPipelineHandle SE_INVALID_PIPELINE = ~0u;
+
+	struct SEPipelineStats{
+		uint32_t requested;
+		uint32_t compiled;
+		uint32_t failed;
+		uint32_t deduplicated; // requests answered with an existing pipeline
+		uint32_t rebuilt; // recompiled after a shader changed
+		double totalCompileTime; // ms spent inside vkCreate*Pipelines, summed over all threads
+		double pipelinesPerSecond; // compiled / (last compile end - first compile start)
+		double averageTimeToReady; // ms from Request to the pipeline being usable
+		double maxTimeToReady;
+	};
+
+	// compiles pipelines as jobs so the render thread never stalls on the driver.
+	// Request returns a handle straight away, Get hands back the pipeline once its ready, the fallback until then,
+	// or VK_NULL_HANDLE if theres no fallback either and the draw should be skipped. the fallback is a graphics
+	// pipeline, so compute pipelines never get it and are VK_NULL_HANDLE until theyre ready.
+	// requests are deduplicated by SEPipelineKey, so materials sharing state share one pipeline and one compile
+	class SEPipelineCache{
+
+	public:
+		SEPipelineCache();~SEPipelineCache();
+
+		//FUNCTIONS :: PUBLIC
+		void Create(const VkDevice*, SEJobSystem*);
+		void Cleanup();
+		SEPipelineHandle Request(const SEPipelineDesc&);
+		static SEPipelineKey MakeKey(const SEPipelineDesc&);
+		// used for any draw whose own pipeline isnt ready yet or failed to compile
+		void SetFallback(SEPipelineHandle);
+		VkPipeline Get(SEPipelineHandle);
+		bool IsReady(SEPipelineHandle);
+		// both help run jobs while they wait
+		void Wait(SEPipelineHandle);
+		void WaitAll();
+		// waits for anything in flight then destroys every pipeline, needed before destroying a layout or shader module
+		// a key refers to, since a new object could reuse the old handle
+		void DestroyAll();
+		// recompiles, in the background, only the pipelines built with the old module. draws keep getting the
+		// current pipeline until SwapRebuilt, the old module can be destroyed as soon as this returns.
+		// returns how many pipelines are being rebuilt
+		uint32_t ReplaceShader(VkShaderModule, VkShaderModule);
+		// call at a frame boundary on the render thread, old pipelines go to the deletion queue
+		void SwapRebuilt(SEDeletionQueue*);
+		void PrintStats();
+
+		//Getters
+		SEPipelineStats GetStats();
+
+	private:
+		typedef std::chrono::high_resolution_clock Clock;
+
+		enum PipelineState{
+			PIPELINE_PENDING,
+			PIPELINE_READY,
+			PIPELINE_FAILED
+		};
+
+		struct Entry{
+			SEPipelineDesc desc;
+			std::atomic<int> state{ PIPELINE_PENDING };
+			VkPipeline pipeline = VK_NULL_HANDLE; // only read once state is ready
+			SEJobCounter compiling;
+			Clock::time_point requestTime;
+
+			// hot reload, the replacement compiles here while pipeline keeps being used
+			SEPipelineDesc nextDesc;
+			std::atomic<int> nextState{ PIPELINE_PENDING };
+			VkPipeline nextPipeline = VK_NULL_HANDLE;
+			SEJobCounter rebuilding;
+		};
+
+		void Compile(Entry*);
+		void Rebuild(Entry*);
+		VkPipeline BuildPipeline(const SEPipelineDesc&);
+		Entry* GetEntry(SEPipelineHandle);
+
+		const VkDevice* device = nullptr;
+		SEJobSystem* jobSystem = nullptr;
+		VkPipelineCache vulkanCache = VK_NULL_HANDLE; // shared by every compile job, the driver synchronises it
+
+		std::mutex entryMutex;
+		std::deque<Entry> entries; // deque so entries dont move while a job holds one
+		std::unordered_map<SEPipelineKey, SEPipelineHandle, SEPipelineKeyHash> registry;
+		SEPipelineHandle fallback = SE_INVALID_PIPELINE;
+		std::vector<Entry*> rebuildingEntries; // render thread only
+
+		std::mutex statsMutex;
+		SEPipelineStats stats = {};
+		double totalTimeToReady = 0.0;
+		Clock::time_point firstCompileStart;
+		Clock::time_point lastCompileEnd;
+	};
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstring>
+#include <vector>
+#include "SEHash.h"
+
+namespace ScoobzEngine {
+
+	enum SEDynamicStateBits{
+		SE_DYNAMIC_VIEWPORT = 1 << 0,
+		SE_DYNAMIC_SCISSOR = 1 << 1,
+		SE_DYNAMIC_LINE_WIDTH = 1 << 2
+	};
+
+	// compact identity of a graphics pipeline, two equal keys build interchangeable pipelines.
+	// the render pass is stored as a compatibility hash rather than a handle so pipelines outlive a recreated
+	// render pass with the same formats. no padding, so hashing and comparing the raw bytes is safe
+	struct SEPipelineKey{
+		VkShaderModule vertShader;
+		VkShaderModule fragShader;
+		VkShaderModule compShader;
+		VkPipelineLayout layout;
+		uint64_t vertexLayout; // hash of the vertex binding and attribute descriptions
+		uint64_t renderPass; // see HashRenderPassCompatibility
+		uint64_t specialization; // SESpecialization::Hash, 0 for the shaders defaults
+		uint32_t subpass;
+		uint32_t dynamicStates; // SEDynamicStateBits
+		uint8_t topology;
+		uint8_t polygonMode;
+		uint8_t cullMode;
+		uint8_t frontFace;
+		uint8_t blendEnable;
+		uint8_t depthTest;
+		uint8_t depthWrite;
+		uint8_t depthCompare;
+
+		bool operator==(const SEPipelineKey& other) const { return memcmp(this, &other, sizeof(SEPipelineKey)) == 0; }
+		bool operator!=(const SEPipelineKey& other) const { return !(*this == other); }
+	};
+	static_assert(sizeof(SEPipelineKey) == 4 * sizeof(uint64_t) + 3 * sizeof(uint64_t) + 2 * sizeof(uint32_t) + 8, "SEPipelineKey has padding");
+
+	struct SEPipelineKeyHash{
+		size_t operator()(const SEPipelineKey& key) const { return static_cast<size_t>(HashFnv1a(&key, sizeof(key))); }
+	};
+
+	inline uint64_t HashVertexLayout(const std::vector<VkVertexInputBindingDescription>& bindings,
+		const std::vector<VkVertexInputAttributeDescription>& attributes){
+		uint64_t hash = HashFnv1a(bindings.data(), bindings.size() * sizeof(VkVertexInputBindingDescription));
+		return HashFnv1a(attributes.data(), attributes.size() * sizeof(VkVertexInputAttributeDescription), hash);
+	}
+
+	// only what Vulkan render pass compatibility looks at: attachment formats and sample counts and how subpasses
+	// reference them. load/store ops and layouts dont matter
+	inline uint64_t HashRenderPassCompatibility(const VkRenderPassCreateInfo& info){
+		uint64_t hash = HashFnv1a(&info.attachmentCount, sizeof(uint32_t));
+		for (uint32_t i = 0; i < info.attachmentCount; i++){
+			hash = HashFnv1a(&info.pAttachments[i].format, sizeof(VkFormat), hash);
+			hash = HashFnv1a(&info.pAttachments[i].samples, sizeof(VkSampleCountFlagBits), hash);
+		}
+		for (uint32_t i = 0; i < info.subpassCount; i++){
+			const VkSubpassDescription& subpass = info.pSubpasses[i];
+			hash = HashFnv1a(&subpass.inputAttachmentCount, sizeof(uint32_t), hash);
+			hash = HashFnv1a(&subpass.colorAttachmentCount, sizeof(uint32_t), hash);
+			for (uint32_t j = 0; j < subpass.inputAttachmentCount; j++){
+				hash = HashFnv1a(&subpass.pInputAttachments[j].attachment, sizeof(uint32_t), hash);
+			}
+			for (uint32_t j = 0; j < subpass.colorAttachmentCount; j++){
+				hash = HashFnv1a(&subpass.pColorAttachments[j].attachment, sizeof(uint32_t), hash);
+			}
+			uint32_t depthAttachment = subpass.pDepthStencilAttachment ? subpass.pDepthStencilAttachment->attachment : VK_ATTACHMENT_UNUSED;
+			hash = HashFnv1a(&depthAttachment, sizeof(uint32_t), hash);
+		}
+		return hash;
+	}
+}
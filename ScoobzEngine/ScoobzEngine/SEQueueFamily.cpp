@@ -26,7 +26,11 @@ namespace ScoobzEngine {
 				indices.transferFamily = i;
 			}
 
-			if (indices.isComplete()){
+			if (queueFamily.queueCount > 0 && (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) && indices.computeFamily == -1){
+				indices.computeFamily = i;
+			}
+
+			if (indices.isComplete() && indices.computeFamily >= 0){
 				break;
 			}
 			i++;
@@ -35,6 +39,9 @@ namespace ScoobzEngine {
 		if (indices.graphicsFamily >= 0 && indices.transferFamily == -1){
 			indices.transferFamily = indices.graphicsFamily;
 		}
+		if (indices.graphicsFamily >= 0 && (queueFamilies[indices.graphicsFamily].queueFlags & VK_QUEUE_COMPUTE_BIT)){
+			indices.computeFamily = indices.graphicsFamily;
+		}
 
 		return indices;
 	}
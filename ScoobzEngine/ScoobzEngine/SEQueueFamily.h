@@ -7,6 +7,8 @@ namespace ScoobzEngine {
 
 		int graphicsFamily = -1;
 		int transferFamily = -1;
+		// the graphics family when it can run compute, so culling can go in the same command buffer as the draws
+		int computeFamily = -1;
 
 		bool isComplete(){
 			return (graphicsFamily >= 0 && transferFamily >=0);
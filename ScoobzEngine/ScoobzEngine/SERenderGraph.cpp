@@ -0,0 +1,825 @@
+#include "SERenderGraph.h"
+#include "SEBuffer.h"
+#include "SEHash.h"
+#include "SEPipelineKey.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace ScoobzEngine {
+
+	// without a device image sizes are guessed, aligned like most desktop drivers align render targets
+	static const VkDeviceSize ESTIMATED_ALIGNMENT = 64 * 1024;
+	static const uint32_t NO_TRANSIENT = ~0u;
+
+	struct SEGraphAccessInfo{
+		VkImageLayout layout;
+		VkPipelineStageFlags stages;
+		VkAccessFlags access;
+		VkImageUsageFlags usage;
+		bool write;
+	};
+
+	static SEGraphAccessInfo GetAccessInfo(SEGraphAccess access){
+		switch (access){
+		case SE_GRAPH_COLOR_WRITE:
+			return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+				VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, true };
+		case SE_GRAPH_DEPTH_WRITE:
+			return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+				VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, true };
+		case SE_GRAPH_DEPTH_READ:
+			return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+				VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, false };
+		case SE_GRAPH_SAMPLED:
+			return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+				VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_USAGE_SAMPLED_BIT, false };
+		case SE_GRAPH_TRANSFER_READ:
+			return { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, false };
+		case SE_GRAPH_TRANSFER_WRITE:
+		default:
+			return { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_USAGE_TRANSFER_DST_BIT, true };
+		}
+	}
+
+	static bool IsAttachment(SEGraphAccess access){
+		return access == SE_GRAPH_COLOR_WRITE || access == SE_GRAPH_DEPTH_WRITE || access == SE_GRAPH_DEPTH_READ;
+	}
+
+	static VkDeviceSize EstimateBytesPerPixel(VkFormat format){
+		switch (format){
+		case VK_FORMAT_R8_UNORM:
+			return 1;
+		case VK_FORMAT_R8G8_UNORM:
+		case VK_FORMAT_D16_UNORM:
+			return 2;
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+		case VK_FORMAT_R32G32_SFLOAT:
+		case VK_FORMAT_D32_SFLOAT_S8_UINT:
+			return 8;
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			return 16;
+		default:
+			return 4;
+		}
+	}
+
+	static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment){
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	static bool SameStats(const SERenderGraphStats& a, const SERenderGraphStats& b){
+		return a.passes == b.passes && a.culledPasses == b.culledPasses && a.accesses == b.accesses && a.barriers == b.barriers
+			&& a.barrierBatches == b.barrierBatches && a.transients == b.transients && a.transientBytes == b.transientBytes
+			&& a.allocatedBytes == b.allocatedBytes;
+	}
+
+	VkDeviceSize PlanAliasing(std::vector<SEAliasRequest>& requests){
+		std::vector<uint32_t> order(requests.size());
+		for (uint32_t i = 0; i < order.size(); i++){
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b){ return requests[a].size > requests[b].size; });
+
+		VkDeviceSize total = 0;
+		std::vector<uint32_t> placed;
+		std::vector<uint32_t> alive;
+		for (uint32_t index : order){
+			SEAliasRequest& request = requests[index];
+
+			// everything already placed that is in use at the same time, lowest first
+			alive.clear();
+			for (uint32_t other : placed){
+				if (requests[other].firstPass <= request.lastPass && request.firstPass <= requests[other].lastPass){
+					alive.push_back(other);
+				}
+			}
+			std::sort(alive.begin(), alive.end(), [&](uint32_t a, uint32_t b){ return requests[a].offset < requests[b].offset; });
+
+			VkDeviceSize offset = 0;
+			for (uint32_t other : alive){
+				VkDeviceSize aligned = AlignUp(offset, request.alignment);
+				if (aligned + request.size <= requests[other].offset){
+					break;
+				}
+				offset = std::max(offset, requests[other].offset + requests[other].size);
+			}
+			request.offset = AlignUp(offset, request.alignment);
+			total = std::max(total, request.offset + request.size);
+			placed.push_back(index);
+		}
+		return total;
+	}
+
+	SERenderGraph::SERenderGraph(){}
+	SERenderGraph::~SERenderGraph(){}
+
+	void SERenderGraph::Create(const VkDevice* logicalDevice, const VkPhysicalDevice* physical, uint32_t framesInFlight){
+		device = logicalDevice;
+		physicalDevice = *physical;
+		slots.resize(framesInFlight);
+		std::cout << "Render Graph Creation: SUCCESSFUL!" << std::endl;
+	}
+
+	void SERenderGraph::Cleanup(){
+		ReleaseResources();
+		for (auto& renderPass : renderPasses){
+			vkDestroyRenderPass(*device, renderPass.second, VK_NULL_HANDLE);
+		}
+		renderPasses.clear();
+	}
+
+	void SERenderGraph::BeginFrame(uint32_t slot){
+		currentSlot = slot;
+		resources.clear();
+		passes.clear();
+		finalBarriers.clear();
+		finalSrcStages = 0;
+	}
+
+	void SERenderGraph::ReleaseResources(){
+		for (auto& slot : slots){
+			DestroyTransients(slot);
+		}
+	}
+
+	SEGraphResource SERenderGraph::ImportImage(const std::string& name, VkImage image, VkImageView view, VkFormat format, VkExtent2D extent,
+		VkImageLayout initialLayout, VkPipelineStageFlags initialStage, VkImageLayout finalLayout){
+		Resource resource = {};
+		resource.name = name;
+		resource.format = format;
+		resource.extent = extent;
+		resource.imported = true;
+		resource.image = image;
+		resource.view = view;
+		resource.initialLayout = initialLayout;
+		resource.initialStage = initialStage;
+		resource.finalLayout = finalLayout;
+		resource.transient = NO_TRANSIENT;
+		resources.push_back(resource);
+		return static_cast<SEGraphResource>(resources.size() - 1);
+	}
+
+	SEGraphResource SERenderGraph::CreateImage(const std::string& name, VkFormat format, VkExtent2D extent){
+		Resource resource = {};
+		resource.name = name;
+		resource.format = format;
+		resource.extent = extent;
+		resource.imported = false;
+		resource.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		resource.finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		resource.transient = NO_TRANSIENT;
+		resources.push_back(resource);
+		return static_cast<SEGraphResource>(resources.size() - 1);
+	}
+
+	SEGraphPass SERenderGraph::AddPass(const std::string& name, std::function<void(VkCommandBuffer)> execute){
+		Pass pass = {};
+		pass.name = name;
+		pass.execute = std::move(execute);
+		pass.live = true;
+		passes.push_back(std::move(pass));
+		return static_cast<SEGraphPass>(passes.size() - 1);
+	}
+
+	void SERenderGraph::Write(SEGraphPass pass, SEGraphResource resource, SEGraphAccess access, const VkClearValue* clearValue){
+		if (!GetAccessInfo(access).write){
+			throw std::runtime_error(passes[pass].name + " writes " + resources[resource].name + " with a read access");
+		}
+		for (const auto& existing : passes[pass].accesses){
+			if (existing.resource == resource){
+				throw std::runtime_error(passes[pass].name + " uses " + resources[resource].name + " twice");
+			}
+		}
+
+		Access entry = {};
+		entry.resource = resource;
+		entry.access = access;
+		entry.clear = clearValue != nullptr;
+		if (clearValue){
+			entry.clearValue = *clearValue;
+		}
+		passes[pass].accesses.push_back(entry);
+		resources[resource].usage |= GetAccessInfo(access).usage;
+	}
+
+	void SERenderGraph::Read(SEGraphPass pass, SEGraphResource resource, SEGraphAccess access){
+		if (GetAccessInfo(access).write){
+			throw std::runtime_error(passes[pass].name + " reads " + resources[resource].name + " with a write access");
+		}
+		for (const auto& existing : passes[pass].accesses){
+			if (existing.resource == resource){
+				throw std::runtime_error(passes[pass].name + " uses " + resources[resource].name + " twice");
+			}
+		}
+
+		Access entry = {};
+		entry.resource = resource;
+		entry.access = access;
+		passes[pass].accesses.push_back(entry);
+		resources[resource].usage |= GetAccessInfo(access).usage;
+	}
+
+	void SERenderGraph::Compile(){
+		auto start = std::chrono::high_resolution_clock::now();
+
+		CullPasses();
+		ComputeLifetimes();
+		PlanTransients();
+		PlanBarriers();
+		PlanRenderPasses();
+
+		stats.passes = static_cast<uint32_t>(passes.size());
+		stats.culledPasses = 0;
+		for (const auto& pass : passes){
+			if (!pass.live){
+				stats.culledPasses++;
+			}
+		}
+
+		compileMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		framesCompiled++;
+
+		// the frame usually looks the same as the last one, only say something when it doesnt
+		if (!SameStats(stats, printedStats)){
+			PrintFrame();
+			printedStats = stats;
+		}
+	}
+
+	// walks back from the outputs. a pass lives if it writes something a later live pass or an import needs,
+	// and then everything it reads or loads is needed too. a clear means nothing before it is
+	void SERenderGraph::CullPasses(){
+		std::vector<bool> needed(resources.size());
+		for (size_t i = 0; i < resources.size(); i++){
+			needed[i] = resources[i].imported;
+		}
+
+		for (size_t i = passes.size(); i-- > 0;){
+			Pass& pass = passes[i];
+			pass.live = false;
+			for (const auto& access : pass.accesses){
+				if (GetAccessInfo(access.access).write && needed[access.resource]){
+					pass.live = true;
+				}
+			}
+			if (!pass.live){
+				continue;
+			}
+			for (const auto& access : pass.accesses){
+				needed[access.resource] = access.clear ? resources[access.resource].imported : true;
+			}
+		}
+	}
+
+	void SERenderGraph::ComputeLifetimes(){
+		for (auto& resource : resources){
+			resource.firstPass = ~0u;
+			resource.lastPass = 0;
+			resource.transient = NO_TRANSIENT;
+		}
+		for (uint32_t i = 0; i < passes.size(); i++){
+			if (!passes[i].live){
+				continue;
+			}
+			for (const auto& access : passes[i].accesses){
+				Resource& resource = resources[access.resource];
+				resource.firstPass = std::min(resource.firstPass, i);
+				resource.lastPass = std::max(resource.lastPass, i);
+			}
+		}
+	}
+
+	// transients only used by culled passes are never made. on a device the slot keeps its images for as long
+	// as frames ask for the same ones, so this only allocates when the shape of the frame changes
+	void SERenderGraph::PlanTransients(){
+		std::vector<uint32_t> used;
+		uint64_t signature = FNV_OFFSET_BASIS;
+		for (uint32_t i = 0; i < resources.size(); i++){
+			Resource& resource = resources[i];
+			if (resource.imported || resource.firstPass == ~0u){
+				continue;
+			}
+			resource.transient = static_cast<uint32_t>(used.size());
+			used.push_back(i);
+
+			signature = HashFnv1a(&resource.format, sizeof(VkFormat), signature);
+			signature = HashFnv1a(&resource.extent, sizeof(VkExtent2D), signature);
+			signature = HashFnv1a(&resource.usage, sizeof(VkImageUsageFlags), signature);
+			signature = HashFnv1a(&resource.firstPass, sizeof(uint32_t), signature);
+			signature = HashFnv1a(&resource.lastPass, sizeof(uint32_t), signature);
+		}
+		stats.transients = static_cast<uint32_t>(used.size());
+
+		if (device){
+			Slot& slot = slots[currentSlot];
+			if (slot.signature != signature){
+				DestroyTransients(slot);
+				RealizeTransients(slot, used);
+				slot.signature = signature;
+			}
+			stats.transientBytes = slot.transientBytes;
+			stats.allocatedBytes = slot.allocatedBytes;
+			return;
+		}
+
+		std::vector<SEAliasRequest> requests(used.size());
+		stats.transientBytes = 0;
+		for (size_t i = 0; i < used.size(); i++){
+			const Resource& resource = resources[used[i]];
+			VkDeviceSize size = static_cast<VkDeviceSize>(resource.extent.width) * resource.extent.height * EstimateBytesPerPixel(resource.format);
+			requests[i] = { AlignUp(size, ESTIMATED_ALIGNMENT), ESTIMATED_ALIGNMENT, resource.firstPass, resource.lastPass, 0 };
+			stats.transientBytes += requests[i].size;
+		}
+		stats.allocatedBytes = PlanAliasing(requests);
+
+		plannedImages.resize(used.size());
+		for (size_t i = 0; i < used.size(); i++){
+			plannedImages[i] = { VK_NULL_HANDLE, VK_NULL_HANDLE, requests[i].offset, requests[i].size };
+		}
+	}
+
+	// every transient in the slot shares one allocation, placed by PlanAliasing
+	void SERenderGraph::RealizeTransients(Slot& slot, const std::vector<uint32_t>& used){
+		slot.images.resize(used.size());
+		std::vector<SEAliasRequest> requests(used.size());
+		uint32_t memoryTypeBits = ~0u;
+		slot.transientBytes = 0;
+
+		for (size_t i = 0; i < used.size(); i++){
+			const Resource& resource = resources[used[i]];
+
+			VkImageCreateInfo imageInfo = {};
+			imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageInfo.format = resource.format;
+			imageInfo.extent = { resource.extent.width, resource.extent.height, 1 };
+			imageInfo.mipLevels = 1;
+			imageInfo.arrayLayers = 1;
+			imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageInfo.usage = resource.usage;
+			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+			if (vkCreateImage(*device, &imageInfo, nullptr, &slot.images[i].image) != VK_SUCCESS){
+				throw std::runtime_error("Failed to create transient image " + resource.name);
+			}
+
+			VkMemoryRequirements memRequirements;
+			vkGetImageMemoryRequirements(*device, slot.images[i].image, &memRequirements);
+			requests[i] = { memRequirements.size, memRequirements.alignment, resource.firstPass, resource.lastPass, 0 };
+			memoryTypeBits &= memRequirements.memoryTypeBits;
+			slot.transientBytes += memRequirements.size;
+		}
+		slot.allocatedBytes = PlanAliasing(requests);
+
+		if (used.empty()){
+			return;
+		}
+		if (memoryTypeBits == 0){
+			throw std::runtime_error("Transient images have no memory type in common");
+		}
+
+		VkMemoryAllocateInfo allocateInfo = {};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocateInfo.allocationSize = slot.allocatedBytes;
+		allocateInfo.memoryTypeIndex = SEBuffer::findMemoryType(physicalDevice, memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		if (SEBuffer::AllocateMemory(*device, &allocateInfo, &slot.memory) != VK_SUCCESS){
+			throw std::runtime_error("Failed to allocate transient image memory");
+		}
+
+		for (size_t i = 0; i < used.size(); i++){
+			const Resource& resource = resources[used[i]];
+			TransientImage& transient = slot.images[i];
+			transient.offset = requests[i].offset;
+			transient.size = requests[i].size;
+			vkBindImageMemory(*device, transient.image, slot.memory, transient.offset);
+
+			VkImageViewCreateInfo viewInfo = {};
+			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			viewInfo.image = transient.image;
+			viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			viewInfo.format = resource.format;
+			viewInfo.subresourceRange.aspectMask = GetAspect(resource.format);
+			viewInfo.subresourceRange.baseMipLevel = 0;
+			viewInfo.subresourceRange.levelCount = 1;
+			viewInfo.subresourceRange.baseArrayLayer = 0;
+			viewInfo.subresourceRange.layerCount = 1;
+
+			if (vkCreateImageView(*device, &viewInfo, nullptr, &transient.view) != VK_SUCCESS){
+				throw std::runtime_error("Failed to create transient image view " + resource.name);
+			}
+		}
+	}
+
+	// called once the slots fence has been waited on, so nothing in flight still uses any of it
+	void SERenderGraph::DestroyTransients(Slot& slot){
+		for (auto& framebuffer : slot.framebuffers){
+			vkDestroyFramebuffer(*device, framebuffer.second, VK_NULL_HANDLE);
+		}
+		slot.framebuffers.clear();
+		for (auto& transient : slot.images){
+			vkDestroyImageView(*device, transient.view, VK_NULL_HANDLE);
+			vkDestroyImage(*device, transient.image, VK_NULL_HANDLE);
+		}
+		slot.images.clear();
+		if (slot.memory != VK_NULL_HANDLE){
+			SEBuffer::FreeMemory(*device, slot.memory);
+			slot.memory = VK_NULL_HANDLE;
+		}
+		slot.signature = 0;
+		slot.transientBytes = 0;
+		slot.allocatedBytes = 0;
+	}
+
+	// tracks each images layout and who last touched it through the live passes. a barrier is only added for a
+	// layout change, a write after anything, or a read in a stage that hasnt waited on the last write yet.
+	// reads after reads in the same layout need nothing
+	void SERenderGraph::PlanBarriers(){
+		std::vector<TransientImage>& transientImages = GetTransientImages();
+		std::vector<ImageState> states(resources.size());
+		for (size_t i = 0; i < resources.size(); i++){
+			states[i] = { resources[i].initialLayout, resources[i].imported ? resources[i].initialStage : 0, 0, 0, 0 };
+		}
+
+		// the transient last used before this one in the same memory, its work has to finish before this one starts.
+		// the previous frame in the slot is already done, its fence was waited on
+		auto aliasPredecessor = [&](const Resource& resource){
+			const TransientImage& image = transientImages[resource.transient];
+			uint32_t predecessor = NO_TRANSIENT;
+			for (uint32_t i = 0; i < resources.size(); i++){
+				const Resource& other = resources[i];
+				if (other.transient == NO_TRANSIENT || other.lastPass >= resource.firstPass){
+					continue;
+				}
+				const TransientImage& otherImage = transientImages[other.transient];
+				bool overlaps = otherImage.offset < image.offset + image.size && image.offset < otherImage.offset + otherImage.size;
+				if (overlaps && (predecessor == NO_TRANSIENT || other.lastPass > resources[predecessor].lastPass)){
+					predecessor = i;
+				}
+			}
+			return predecessor;
+		};
+
+		stats.accesses = 0;
+		stats.barriers = 0;
+		stats.barrierBatches = 0;
+		for (uint32_t i = 0; i < passes.size(); i++){
+			Pass& pass = passes[i];
+			pass.barriers.clear();
+			pass.srcStages = 0;
+			pass.dstStages = 0;
+			if (!pass.live){
+				continue;
+			}
+
+			for (const auto& access : pass.accesses){
+				stats.accesses++;
+				const Resource& resource = resources[access.resource];
+				SEGraphAccessInfo info = GetAccessInfo(access.access);
+				ImageState& state = states[access.resource];
+
+				bool needed = false;
+				VkImageLayout oldLayout = state.layout;
+				VkPipelineStageFlags srcStages = 0;
+				VkAccessFlags srcAccess = 0;
+				if (!resource.imported && resource.firstPass == i){
+					// whatever was in the memory before is thrown away
+					needed = true;
+					oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+					uint32_t predecessor = aliasPredecessor(resource);
+					if (predecessor != NO_TRANSIENT){
+						srcStages = states[predecessor].writeStages | states[predecessor].readStages;
+						srcAccess = states[predecessor].writeAccess;
+					}
+				}
+				else if (state.layout != info.layout || info.write){
+					needed = state.layout != info.layout || (state.writeStages | state.readStages) != 0;
+					srcStages = state.writeStages | state.readStages;
+					srcAccess = state.writeAccess;
+				}
+				else{
+					needed = state.writeStages != 0 && (info.stages & ~state.visibleStages) != 0;
+					srcStages = state.writeStages;
+					srcAccess = state.writeAccess;
+				}
+
+				if (needed){
+					VkImageMemoryBarrier barrier = {};
+					barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+					barrier.srcAccessMask = srcAccess;
+					barrier.dstAccessMask = info.access;
+					barrier.oldLayout = oldLayout;
+					barrier.newLayout = info.layout;
+					barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					barrier.image = resource.imported ? resource.image : transientImages[resource.transient].image;
+					barrier.subresourceRange.aspectMask = GetAspect(resource.format);
+					barrier.subresourceRange.baseMipLevel = 0;
+					barrier.subresourceRange.levelCount = 1;
+					barrier.subresourceRange.baseArrayLayer = 0;
+					barrier.subresourceRange.layerCount = 1;
+					pass.barriers.push_back(barrier);
+					pass.srcStages |= srcStages;
+					pass.dstStages |= info.stages;
+				}
+
+				if (info.write){
+					state = { info.layout, info.stages, info.access, 0, 0 };
+				}
+				else if (needed && oldLayout != info.layout){
+					// the transition is a write of its own, later readers in other stages wait on it
+					state = { info.layout, info.stages, 0, info.stages, info.stages };
+				}
+				else{
+					state.readStages |= info.stages;
+					if (needed){
+						state.visibleStages |= info.stages;
+					}
+				}
+			}
+
+			if (!pass.barriers.empty()){
+				// nothing to wait on, like a transient that has the memory to itself
+				if (pass.srcStages == 0){
+					pass.srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+				}
+				stats.barriers += static_cast<uint32_t>(pass.barriers.size());
+				stats.barrierBatches++;
+			}
+		}
+
+		for (size_t i = 0; i < resources.size(); i++){
+			const Resource& resource = resources[i];
+			if (!resource.imported || resource.firstPass == ~0u || states[i].layout == resource.finalLayout){
+				continue;
+			}
+			VkImageMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask = states[i].writeAccess;
+			barrier.dstAccessMask = 0;
+			barrier.oldLayout = states[i].layout;
+			barrier.newLayout = resource.finalLayout;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = resource.image;
+			barrier.subresourceRange.aspectMask = GetAspect(resource.format);
+			barrier.subresourceRange.baseMipLevel = 0;
+			barrier.subresourceRange.levelCount = 1;
+			barrier.subresourceRange.baseArrayLayer = 0;
+			barrier.subresourceRange.layerCount = 1;
+			finalBarriers.push_back(barrier);
+			finalSrcStages |= states[i].writeStages | states[i].readStages;
+		}
+		if (!finalBarriers.empty()){
+			if (finalSrcStages == 0){
+				finalSrcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			}
+			stats.barriers += static_cast<uint32_t>(finalBarriers.size());
+			stats.barrierBatches++;
+		}
+	}
+
+	// one subpass per pass, with every attachment already in the layout the barriers put it in so the render pass
+	// never transitions anything itself. contents nothing later reads arent stored, and nothing is loaded that
+	// wasnt written first
+	void SERenderGraph::PlanRenderPasses(){
+		for (uint32_t i = 0; i < passes.size(); i++){
+			Pass& pass = passes[i];
+			pass.renderPass = VK_NULL_HANDLE;
+			pass.framebuffer = VK_NULL_HANDLE;
+			pass.clearValues.clear();
+			if (!pass.live){
+				continue;
+			}
+
+			std::vector<const Access*> attachments;
+			const Access* depth = nullptr;
+			for (const auto& access : pass.accesses){
+				if (access.access == SE_GRAPH_COLOR_WRITE){
+					attachments.push_back(&access);
+				}
+				else if (IsAttachment(access.access)){
+					if (depth){
+						throw std::runtime_error(pass.name + " has more than one depth attachment");
+					}
+					depth = &access;
+				}
+			}
+			if (depth){
+				attachments.push_back(depth);
+			}
+			if (attachments.empty()){
+				continue;
+			}
+
+			std::vector<VkAttachmentDescription> descriptions;
+			std::vector<VkImageView> views;
+			pass.extent = resources[attachments[0]->resource].extent;
+			for (const Access* access : attachments){
+				const Resource& resource = resources[access->resource];
+				if (resource.extent.width != pass.extent.width || resource.extent.height != pass.extent.height){
+					throw std::runtime_error(pass.name + " has attachments of different sizes");
+				}
+				bool undefined = resource.firstPass == i && (!resource.imported || resource.initialLayout == VK_IMAGE_LAYOUT_UNDEFINED);
+				bool keep = resource.imported || resource.lastPass > i;
+
+				VkAttachmentDescription description = {};
+				description.format = resource.format;
+				description.samples = VK_SAMPLE_COUNT_1_BIT;
+				description.loadOp = access->clear ? VK_ATTACHMENT_LOAD_OP_CLEAR : (undefined ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_LOAD_OP_LOAD);
+				description.storeOp = keep ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+				description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				description.initialLayout = GetAccessInfo(access->access).layout;
+				description.finalLayout = description.initialLayout;
+				descriptions.push_back(description);
+				views.push_back(GetView(access->resource));
+				pass.clearValues.push_back(access->clearValue);
+			}
+
+			if (device){
+				pass.renderPass = GetRenderPass(descriptions, depth != nullptr, nullptr);
+				pass.framebuffer = GetFramebuffer(pass.renderPass, views, pass.extent);
+			}
+		}
+	}
+
+	void SERenderGraph::Execute(VkCommandBuffer commandBuffer){
+		for (auto& pass : passes){
+			if (!pass.live){
+				continue;
+			}
+
+			if (!pass.barriers.empty()){
+				vkCmdPipelineBarrier(commandBuffer, pass.srcStages, pass.dstStages, 0,
+					0, nullptr, 0, nullptr, static_cast<uint32_t>(pass.barriers.size()), pass.barriers.data());
+			}
+
+			if (pass.renderPass != VK_NULL_HANDLE){
+				VkRenderPassBeginInfo renderPassInfo = {};
+				renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+				renderPassInfo.renderPass = pass.renderPass;
+				renderPassInfo.framebuffer = pass.framebuffer;
+				renderPassInfo.renderArea.offset = { 0,0 };
+				renderPassInfo.renderArea.extent = pass.extent;
+				renderPassInfo.clearValueCount = static_cast<uint32_t>(pass.clearValues.size());
+				renderPassInfo.pClearValues = pass.clearValues.data();
+
+				vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+				if (pass.execute){
+					pass.execute(commandBuffer);
+				}
+				vkCmdEndRenderPass(commandBuffer);
+			}
+			else if (pass.execute){
+				pass.execute(commandBuffer);
+			}
+		}
+
+		if (!finalBarriers.empty()){
+			vkCmdPipelineBarrier(commandBuffer, finalSrcStages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+				0, nullptr, 0, nullptr, static_cast<uint32_t>(finalBarriers.size()), finalBarriers.data());
+		}
+	}
+
+	VkRenderPass SERenderGraph::GetCompatibleRenderPass(const std::vector<VkFormat>& colorFormats, VkFormat depthFormat, uint64_t* compatibility){
+		std::vector<VkAttachmentDescription> descriptions;
+		for (size_t i = 0; i <= colorFormats.size(); i++){
+			bool isDepth = i == colorFormats.size();
+			if (isDepth && depthFormat == VK_FORMAT_UNDEFINED){
+				break;
+			}
+			VkAttachmentDescription description = {};
+			description.format = isDepth ? depthFormat : colorFormats[i];
+			description.samples = VK_SAMPLE_COUNT_1_BIT;
+			description.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+			description.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+			description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			description.initialLayout = isDepth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+			description.finalLayout = description.initialLayout;
+			descriptions.push_back(description);
+		}
+		return GetRenderPass(descriptions, depthFormat != VK_FORMAT_UNDEFINED, compatibility);
+	}
+
+	// render passes only differ in formats, load/store ops and layouts, so a handful cover every frame
+	VkRenderPass SERenderGraph::GetRenderPass(const std::vector<VkAttachmentDescription>& descriptions, bool hasDepth, uint64_t* compatibility){
+		uint32_t colorCount = static_cast<uint32_t>(descriptions.size()) - (hasDepth ? 1 : 0);
+		std::vector<VkAttachmentReference> colorRefs(colorCount);
+		for (uint32_t i = 0; i < colorCount; i++){
+			colorRefs[i].attachment = i;
+			colorRefs[i].layout = descriptions[i].initialLayout;
+		}
+		VkAttachmentReference depthRef = {};
+		if (hasDepth){
+			depthRef.attachment = colorCount;
+			depthRef.layout = descriptions[colorCount].initialLayout;
+		}
+
+		VkSubpassDescription subpass = {};
+		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = colorCount;
+		subpass.pColorAttachments = colorRefs.data();
+		subpass.pDepthStencilAttachment = hasDepth ? &depthRef : nullptr;
+
+		VkRenderPassCreateInfo renderPassInfo = {};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassInfo.attachmentCount = static_cast<uint32_t>(descriptions.size());
+		renderPassInfo.pAttachments = descriptions.data();
+		renderPassInfo.subpassCount = 1;
+		renderPassInfo.pSubpasses = &subpass;
+
+		if (compatibility){
+			*compatibility = HashRenderPassCompatibility(renderPassInfo);
+		}
+
+		uint64_t key = HashFnv1a(descriptions.data(), descriptions.size() * sizeof(VkAttachmentDescription), hasDepth ? 1 : 0);
+		auto found = renderPasses.find(key);
+		if (found != renderPasses.end()){
+			return found->second;
+		}
+
+		VkRenderPass renderPass;
+		if (vkCreateRenderPass(*device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS){
+			throw std::runtime_error("Failed to create Render pass");
+		}
+		renderPasses.emplace(key, renderPass);
+		return renderPass;
+	}
+
+	VkFramebuffer SERenderGraph::GetFramebuffer(VkRenderPass renderPass, const std::vector<VkImageView>& views, VkExtent2D extent){
+		uint64_t key = HashFnv1a(&renderPass, sizeof(VkRenderPass));
+		key = HashFnv1a(views.data(), views.size() * sizeof(VkImageView), key);
+		key = HashFnv1a(&extent, sizeof(VkExtent2D), key);
+
+		Slot& slot = slots[currentSlot];
+		auto found = slot.framebuffers.find(key);
+		if (found != slot.framebuffers.end()){
+			return found->second;
+		}
+
+		VkFramebufferCreateInfo framebufferInfo = {};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = renderPass;
+		framebufferInfo.attachmentCount = static_cast<uint32_t>(views.size());
+		framebufferInfo.pAttachments = views.data();
+		framebufferInfo.width = extent.width;
+		framebufferInfo.height = extent.height;
+		framebufferInfo.layers = 1;
+
+		VkFramebuffer framebuffer;
+		if (vkCreateFramebuffer(*device, &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS){
+			throw std::runtime_error("Failed to create framebuffer");
+		}
+		slot.framebuffers.emplace(key, framebuffer);
+		return framebuffer;
+	}
+
+	std::vector<SERenderGraph::TransientImage>& SERenderGraph::GetTransientImages(){
+		return device ? slots[currentSlot].images : plannedImages;
+	}
+
+	VkImageView SERenderGraph::GetView(SEGraphResource resource){
+		if (resources[resource].imported){
+			return resources[resource].view;
+		}
+		return GetTransientImages()[resources[resource].transient].view;
+	}
+
+	VkImageAspectFlags SERenderGraph::GetAspect(VkFormat format){
+		switch (format){
+		case VK_FORMAT_D16_UNORM:
+		case VK_FORMAT_D32_SFLOAT:
+			return VK_IMAGE_ASPECT_DEPTH_BIT;
+		case VK_FORMAT_D24_UNORM_S8_UINT:
+		case VK_FORMAT_D32_SFLOAT_S8_UINT:
+			return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+		default:
+			return VK_IMAGE_ASPECT_COLOR_BIT;
+		}
+	}
+
+	void SERenderGraph::PrintFrame(){
+		const double mb = 1.0 / (1024.0 * 1024.0);
+		std::cout << std::fixed << std::setprecision(2)
+			<< "Render Graph: " << stats.passes - stats.culledPasses << " of " << stats.passes << " passes ("
+			<< stats.culledPasses << " culled), " << stats.barriers << " barriers in " << stats.barrierBatches << " batches for "
+			<< stats.accesses << " accesses, " << stats.transients << " transients " << stats.transientBytes * mb << " MB in "
+			<< stats.allocatedBytes * mb << " MB (" << (stats.transientBytes - stats.allocatedBytes) * mb << " MB aliased)"
+			<< std::defaultfloat << std::endl;
+	}
+
+	void SERenderGraph::PrintStats(){
+		std::cout << "Render Graph: " << framesCompiled << " frames compiled, " << std::fixed << std::setprecision(1)
+			<< (framesCompiled ? compileMs * 1000.0 / framesCompiled : 0.0) << " us per compile" << std::defaultfloat << std::endl;
+		PrintFrame();
+	}
+}
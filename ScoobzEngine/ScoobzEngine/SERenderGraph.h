@@ -0,0 +1,191 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ScoobzEngine {
+
+	// how a pass uses an image, decides the layout, stages and access the graph synchronises on
+	enum SEGraphAccess{
+		SE_GRAPH_COLOR_WRITE,
+		SE_GRAPH_DEPTH_WRITE, // depth test and write
+		SE_GRAPH_DEPTH_READ, // depth test only, the image stays in the read only layout
+		SE_GRAPH_SAMPLED, // read in a fragment shader
+		SE_GRAPH_TRANSFER_READ,
+		SE_GRAPH_TRANSFER_WRITE,
+	};
+
+	typedef uint32_t SEGraphResource;
+	typedef uint32_t SEGraphPass;
+
+	// what Compile worked out for the frame
+	struct SERenderGraphStats{
+		uint32_t passes = 0;
+		uint32_t culledPasses = 0;
+		uint32_t accesses = 0; // a barrier before every use would cost this many
+		uint32_t barriers = 0; // image barriers actually recorded
+		uint32_t barrierBatches = 0; // vkCmdPipelineBarrier calls
+		uint32_t transients = 0;
+		VkDeviceSize transientBytes = 0; // each transient in its own memory
+		VkDeviceSize allocatedBytes = 0; // all of them aliased
+	};
+
+	// one transient for PlanAliasing, offset is filled in
+	struct SEAliasRequest{
+		VkDeviceSize size;
+		VkDeviceSize alignment;
+		uint32_t firstPass;
+		uint32_t lastPass;
+		VkDeviceSize offset;
+	};
+
+	// places transients in one block of memory, two only share bytes if the passes they are used in dont overlap.
+	// largest first, each at the lowest offset clear of everything alive at the same time. returns the block size
+	VkDeviceSize PlanAliasing(std::vector<SEAliasRequest>&);
+
+	// the frame is described again every frame as passes declaring the images they read and write. Compile drops
+	// passes nothing uses, works out every layout transition and barrier between passes (one vkCmdPipelineBarrier
+	// per pass, nothing between reads) and puts transient images whose lifetimes dont overlap in the same memory.
+	// passes with attachments get a render pass and framebuffer, both cached across frames
+	class SERenderGraph{
+
+	public:
+		SERenderGraph();~SERenderGraph();
+
+		//FUNCTIONS :: PUBLIC
+		// frames in flight, each slot gets its own transient images so frames never share one
+		void Create(const VkDevice*, const VkPhysicalDevice*, uint32_t);
+		void Cleanup();
+		// call right after waiting on the slots fence, starts an empty graph
+		void BeginFrame(uint32_t);
+		// drops every transient and framebuffer, only safe once the device is idle. for swapchain recreation
+		void ReleaseResources();
+
+		// an image owned elsewhere, like a swapchain image. it starts the frame in initialLayout, written by
+		// initialStage, and is left in finalLayout. imported images are outputs, passes writing them are never culled
+		SEGraphResource ImportImage(const std::string&, VkImage, VkImageView, VkFormat, VkExtent2D, VkImageLayout, VkPipelineStageFlags, VkImageLayout);
+		// an image that only lives for this frame
+		SEGraphResource CreateImage(const std::string&, VkFormat, VkExtent2D);
+
+		SEGraphPass AddPass(const std::string&, std::function<void(VkCommandBuffer)>);
+		// a pass uses each resource once. attachments keep the order they are added in, colour before depth.
+		// writing with a clear value throws the old contents away, without one they are loaded
+		void Write(SEGraphPass, SEGraphResource, SEGraphAccess, const VkClearValue* = nullptr);
+		void Read(SEGraphPass, SEGraphResource, SEGraphAccess);
+
+		// culls, plans barriers and memory and makes sure this slots transients exist. without Create it still
+		// plans everything with estimated image sizes, so tools and benchmarks can run it
+		void Compile();
+		// records the passes that survived with their barriers and render passes
+		void Execute(VkCommandBuffer);
+		void PrintStats();
+
+		// compatible with what the graph builds for a pass with these attachments, for creating pipelines up front
+		VkRenderPass GetCompatibleRenderPass(const std::vector<VkFormat>&, VkFormat, uint64_t*);
+
+		//Getters
+		const SERenderGraphStats& GetStats() { return stats; }
+		bool IsCulled(SEGraphPass pass) { return !passes[pass].live; }
+
+	private:
+		struct Resource{
+			std::string name;
+			VkFormat format;
+			VkExtent2D extent;
+			bool imported;
+			VkImage image;
+			VkImageView view;
+			VkImageLayout initialLayout;
+			VkPipelineStageFlags initialStage;
+			VkImageLayout finalLayout;
+			VkImageUsageFlags usage; // every way its used this frame, transients are created with it
+			// filled by Compile, the first and last pass that uses it and survived culling
+			uint32_t firstPass;
+			uint32_t lastPass;
+			uint32_t transient; // index into the slots images, ~0u for imported or unused
+		};
+
+		struct Access{
+			SEGraphResource resource;
+			SEGraphAccess access;
+			bool clear;
+			VkClearValue clearValue;
+		};
+
+		struct Pass{
+			std::string name;
+			std::function<void(VkCommandBuffer)> execute;
+			std::vector<Access> accesses;
+			bool live;
+			// filled by Compile
+			std::vector<VkImageMemoryBarrier> barriers;
+			VkPipelineStageFlags srcStages;
+			VkPipelineStageFlags dstStages;
+			VkRenderPass renderPass;
+			VkFramebuffer framebuffer;
+			VkExtent2D extent;
+			std::vector<VkClearValue> clearValues;
+		};
+
+		// the last thing that happened to an image while walking the passes
+		struct ImageState{
+			VkImageLayout layout;
+			VkPipelineStageFlags writeStages;
+			VkAccessFlags writeAccess;
+			VkPipelineStageFlags readStages; // since the last write
+			VkPipelineStageFlags visibleStages; // already waited on the last write
+		};
+
+		struct TransientImage{
+			VkImage image;
+			VkImageView view;
+			VkDeviceSize offset;
+			VkDeviceSize size;
+		};
+
+		// a frame in flights own transients, rebuilt whenever the frame asks for different ones
+		struct Slot{
+			uint64_t signature = 0;
+			std::vector<TransientImage> images;
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkDeviceSize transientBytes = 0;
+			VkDeviceSize allocatedBytes = 0;
+			std::unordered_map<uint64_t, VkFramebuffer> framebuffers;
+		};
+
+		void CullPasses();
+		void ComputeLifetimes();
+		void PlanTransients();
+		void RealizeTransients(Slot&, const std::vector<uint32_t>&);
+		void DestroyTransients(Slot&);
+		void PlanBarriers();
+		void PlanRenderPasses();
+		VkRenderPass GetRenderPass(const std::vector<VkAttachmentDescription>&, bool, uint64_t*);
+		VkFramebuffer GetFramebuffer(VkRenderPass, const std::vector<VkImageView>&, VkExtent2D);
+		std::vector<TransientImage>& GetTransientImages();
+		VkImageView GetView(SEGraphResource);
+		VkImageAspectFlags GetAspect(VkFormat);
+		void PrintFrame();
+
+		const VkDevice* device = nullptr;
+		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+
+		std::vector<Resource> resources;
+		std::vector<Pass> passes;
+		std::vector<VkImageMemoryBarrier> finalBarriers; // imported images to their final layouts
+		VkPipelineStageFlags finalSrcStages = 0;
+
+		std::vector<Slot> slots;
+		uint32_t currentSlot = 0;
+		// transients planned without a device, sizes estimated
+		std::vector<TransientImage> plannedImages;
+		std::unordered_map<uint64_t, VkRenderPass> renderPasses;
+
+		SERenderGraphStats stats;
+		SERenderGraphStats printedStats;
+		uint64_t framesCompiled = 0;
+		double compileMs = 0.0;
+	};
+}
@@ -0,0 +1,238 @@
+#include "SEShaderLibrary.h"
+#include "SEHash.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace ScoobzEngine {
+
+	SEShaderLibrary::SEShaderLibrary(){}
+	SEShaderLibrary::~SEShaderLibrary(){}
+
+	void SEShaderLibrary::Create(const VkDevice* logicalDevice){
+		device = logicalDevice;
+	}
+
+	void SEShaderLibrary::Cleanup(){
+		std::lock_guard<std::mutex> lock(libraryMutex);
+		for (auto& shader : shaders){
+			if (shader.second->refCount > 0){
+				std::cerr << "Shader '" << shader.second->path << "' still has " << shader.second->refCount << " references at cleanup" << std::endl;
+			}
+			vkDestroyShaderModule(*device, shader.second->module, VK_NULL_HANDLE);
+			stats.modulesDestroyed++;
+		}
+		shaders.clear();
+		paths.clear();
+	}
+
+	SEShader* SEShaderLibrary::Load(const std::string& path){
+		{
+			std::lock_guard<std::mutex> lock(libraryMutex);
+			auto found = paths.find(path);
+			if (found != paths.end()){
+				found->second->refCount++;
+				stats.pathHits++;
+				return found->second;
+			}
+		}
+
+		// read outside the lock so other threads can keep loading, a racing Load of the same path
+		// just finds the content hash already there
+		std::vector<char> code = ReadSpirvFile(path);
+
+		std::lock_guard<std::mutex> lock(libraryMutex);
+		stats.fileReads++;
+		SEShader* shader = LoadLocked(code, path);
+		paths[path] = shader;
+		return shader;
+	}
+
+	SEShader* SEShaderLibrary::LoadFromMemory(const std::vector<char>& code, const std::string& name){
+		std::lock_guard<std::mutex> lock(libraryMutex);
+		return LoadLocked(code, name);
+	}
+
+	SEShader* SEShaderLibrary::LoadLocked(const std::vector<char>& code, const std::string& name){
+		uint64_t hash = HashFnv1a(code.data(), code.size());
+
+		auto found = shaders.find(hash);
+		if (found != shaders.end()){
+			found->second->refCount++;
+			stats.contentHits++;
+			return found->second.get();
+		}
+
+		// reflect first, it throws on anything that isnt SPIR-V before we hand it to the driver
+		std::unique_ptr<SEShader> shader(new SEShader());
+		shader->hash = hash;
+		shader->reflection = ReflectSpirv(code);
+		shader->path = name;
+		shader->refCount = 1;
+		shader->module = CreateModule(code, name);
+
+		SEShader* result = shader.get();
+		shaders.emplace(hash, std::move(shader));
+		return result;
+	}
+
+	VkShaderModule SEShaderLibrary::CreateModule(const std::vector<char>& code, const std::string& name){
+		VkShaderModuleCreateInfo createInfo = {};
+		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		createInfo.codeSize = code.size();
+
+		std::vector<uint32_t> codeAligned(code.size() / sizeof(uint32_t) + 1);
+		memcpy(codeAligned.data(), code.data(), code.size());
+		createInfo.pCode = codeAligned.data();
+
+		VkShaderModule shaderModule;
+		if (vkCreateShaderModule(*device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS){
+			throw std::runtime_error("Failed to create shader module: " + name);
+		}
+		else{
+			std::cout << "Shader Module Creation: SUCCESSFUL! (" << name << ")" << std::endl;
+		}
+		stats.modulesCreated++;
+
+		return shaderModule;
+	}
+
+	SEShader* SEShaderLibrary::Reload(const std::string& path, VkShaderModule* retiredModule, const SEShaderReloadCheck& check){
+		*retiredModule = VK_NULL_HANDLE;
+		{
+			std::lock_guard<std::mutex> lock(libraryMutex);
+			if (paths.find(path) == paths.end()){
+				return nullptr;
+			}
+		}
+
+		std::vector<char> code = ReadSpirvFile(path);
+		uint64_t hash = HashFnv1a(code.data(), code.size());
+
+		std::lock_guard<std::mutex> lock(libraryMutex);
+		stats.fileReads++;
+
+		auto found = paths.find(path);
+		if (found == paths.end()){
+			return nullptr;
+		}
+		SEShader* shader = found->second;
+		if (shader->hash == hash){
+			return nullptr; // touched but not changed
+		}
+		// everything that can throw happens before the shader is touched
+		SEShaderReflection reflection = ReflectSpirv(code);
+		if (check && !check(shader, reflection)){
+			return nullptr;
+		}
+		VkShaderModule newModule = CreateModule(code, path);
+
+		// the same bytes loaded under another name share this shader, so only this path moves to a new one
+		bool shared = shader->path != path;
+		for (auto entry = paths.begin(); entry != paths.end() && !shared; ++entry){
+			shared = entry->second == shader && entry->first != path;
+		}
+		if (shared){
+			std::unique_ptr<SEShader> split(new SEShader());
+			split->hash = hash;
+			split->module = newModule;
+			split->reflection = std::move(reflection);
+			split->path = path;
+			split->refCount = 0; // whoever loaded the path still holds the old one
+			SEShader* result = split.get();
+			shaders.emplace(hash, std::move(split));
+			paths[path] = result;
+			stats.reloads++;
+			return result;
+		}
+
+		*retiredModule = shader->module;
+		auto range = shaders.equal_range(shader->hash);
+		auto owner = std::find_if(range.first, range.second,
+			[shader](const std::pair<const uint64_t, std::unique_ptr<SEShader>>& entry) { return entry.second.get() == shader; });
+		std::unique_ptr<SEShader> owned = std::move(owner->second);
+		shaders.erase(owner);
+
+		shader->module = newModule;
+		shader->hash = hash;
+		shader->reflection = std::move(reflection);
+		shaders.emplace(hash, std::move(owned));
+		stats.reloads++;
+
+		return shader;
+	}
+
+	void SEShaderLibrary::DestroyRetiredModule(VkShaderModule shaderModule){
+		std::lock_guard<std::mutex> lock(libraryMutex);
+		vkDestroyShaderModule(*device, shaderModule, VK_NULL_HANDLE);
+		stats.modulesDestroyed++;
+	}
+
+	void SEShaderLibrary::AddRef(SEShader* shader){
+		std::lock_guard<std::mutex> lock(libraryMutex);
+		shader->refCount++;
+	}
+
+	void SEShaderLibrary::Release(SEShader* shader){
+		std::lock_guard<std::mutex> lock(libraryMutex);
+		if (shader->refCount <= 0){
+			throw std::runtime_error("Shader released more times than it was loaded: " + shader->path);
+		}
+		shader->refCount--;
+	}
+
+	void SEShaderLibrary::Trim(){
+		std::lock_guard<std::mutex> lock(libraryMutex);
+		for (auto path = paths.begin(); path != paths.end();){
+			if (path->second->refCount == 0){
+				path = paths.erase(path);
+			}
+			else{
+				++path;
+			}
+		}
+		for (auto shader = shaders.begin(); shader != shaders.end();){
+			if (shader->second->refCount == 0){
+				vkDestroyShaderModule(*device, shader->second->module, VK_NULL_HANDLE);
+				stats.modulesDestroyed++;
+				shader = shaders.erase(shader);
+			}
+			else{
+				++shader;
+			}
+		}
+	}
+
+	std::vector<char> SEShaderLibrary::ReadSpirvFile(const std::string& path){
+		std::ifstream file(path, std::ios::ate | std::ios::binary);
+
+		if (!file.is_open()){
+			throw std::runtime_error("Failed to open shader: " + path);
+		}
+
+		size_t fileSize = (size_t)file.tellg();
+		std::vector<char> buffer(fileSize);
+
+		file.seekg(0);
+		file.read(buffer.data(), fileSize);
+		file.close();
+
+		return buffer;
+	}
+
+	SEShaderLibraryStats SEShaderLibrary::GetStats(){
+		std::lock_guard<std::mutex> lock(libraryMutex);
+		return stats;
+	}
+
+	size_t SEShaderLibrary::GetModuleCount(){
+		std::lock_guard<std::mutex> lock(libraryMutex);
+		return shaders.size();
+	}
+
+	void SEShaderLibrary::PrintStats(){
+		SEShaderLibraryStats current = GetStats();
+		std::cout << "Shader Library: " << GetModuleCount() << " modules, " << current.fileReads << " file reads, "
+			<< current.pathHits << " path hits, " << current.contentHits << " content hits, " << current.reloads << " reloads" << std::endl;
+	}
+}
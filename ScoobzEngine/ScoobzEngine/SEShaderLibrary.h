@@ -0,0 +1,85 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "SESpirvReflect.h"
+
+namespace ScoobzEngine {
+
+	// one shader module, shared by everything that loaded the same SPIR-V
+	struct SEShader{
+		uint64_t hash; // FNV-1a of the SPIR-V words
+		VkShaderModule module;
+		SEShaderReflection reflection;
+		std::string path; // the first path it was loaded from
+		int refCount;
+	};
+
+	// asked before a reload changes anything, with the shader as it is and the new codes reflection. false keeps the old one
+	typedef std::function<bool(const SEShader*, const SEShaderReflection&)> SEShaderReloadCheck;
+
+	struct SEShaderLibraryStats{
+		uint32_t fileReads;
+		uint32_t pathHits; // Load for a path thats already loaded
+		uint32_t contentHits; // new path, but the same SPIR-V as a module we already have
+		uint32_t modulesCreated;
+		uint32_t modulesDestroyed;
+		uint32_t reloads;
+	};
+
+	// keeps shader modules alive and reference counted so pipeline builds, resizes and material reloads
+	// never go back to the disk. modules are keyed by a hash of their contents, so two paths with the same
+	// SPIR-V share a module
+	class SEShaderLibrary{
+
+	public:
+		SEShaderLibrary();~SEShaderLibrary();
+
+		//FUNCTIONS :: PUBLIC
+		void Create(const VkDevice*);
+		void Cleanup();
+		// the file is only read the first time a path is asked for, every Load adds a reference
+		SEShader* Load(const std::string&);
+		SEShader* LoadFromMemory(const std::vector<char>&, const std::string&);
+		void AddRef(SEShader*);
+		// a shader with no references is kept until Trim, so unloading and reloading a material stays cheap
+		void Release(SEShader*);
+		// destroys modules nobody references, pipelines built from them must already be gone
+		void Trim();
+		// rereads a loaded path. if the SPIR-V changed the shader is updated in place (everyone that loaded it sees
+		// the new module), returned, and its old module handed back through the second argument. if other paths share
+		// the shader it stays as it is, the path gets a new one and the second argument is VK_NULL_HANDLE. returns
+		// nullptr if nothing changed, the check turned it down or the path isnt loaded. throws on unreadable or invalid
+		// SPIR-V and leaves the shader as it was
+		SEShader* Reload(const std::string&, VkShaderModule*, const SEShaderReloadCheck& = nullptr);
+		// for the module Reload handed back, once nothing is compiling with it
+		void DestroyRetiredModule(VkShaderModule);
+		void PrintStats();
+
+		//Getters
+		SEShaderLibraryStats GetStats();
+		size_t GetModuleCount();
+
+	private:
+		SEShader* LoadLocked(const std::vector<char>&, const std::string&);
+		VkShaderModule CreateModule(const std::vector<char>&, const std::string&);
+		static std::vector<char> ReadSpirvFile(const std::string&);
+
+		const VkDevice* device = nullptr;
+
+		std::mutex libraryMutex;
+		// by content hash. a multimap because a reload can make one shaders code match another ones, and shaders
+		// other code holds pointers to are never merged
+		std::unordered_multimap<uint64_t, std::unique_ptr<SEShader>> shaders;
+		std::map<std::string, SEShader*> paths;
+		SEShaderLibraryStats stats = {};
+	};
+}
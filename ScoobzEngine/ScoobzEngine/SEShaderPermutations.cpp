@@ -0,0 +1,108 @@
+#include "SEShaderPermutations.h"
+#include <algorithm>
+
+namespace ScoobzEngine {
+
+	void SESpecialization::Set(uint32_t constantId, uint32_t value){
+		auto found = std::lower_bound(entries.begin(), entries.end(), constantId,
+			[](const VkSpecializationMapEntry& entry, uint32_t id) { return entry.constantID < id; });
+		size_t index = found - entries.begin();
+
+		if (found != entries.end() && found->constantID == constantId){
+			data[index] = value;
+			return;
+		}
+
+		VkSpecializationMapEntry entry = {};
+		entry.constantID = constantId;
+		entry.size = sizeof(uint32_t);
+		entries.insert(found, entry);
+		data.insert(data.begin() + index, value);
+
+		// offsets follow the sorted order
+		for (size_t i = index; i < entries.size(); i++){
+			entries[i].offset = static_cast<uint32_t>(i * sizeof(uint32_t));
+		}
+	}
+
+	uint64_t SESpecialization::Hash() const{
+		if (entries.empty()){
+			return 0;
+		}
+		uint64_t hash = FNV_OFFSET_BASIS;
+		for (size_t i = 0; i < entries.size(); i++){
+			hash = HashFnv1a(&entries[i].constantID, sizeof(uint32_t), hash);
+			hash = HashFnv1a(&data[i], sizeof(uint32_t), hash);
+		}
+		return hash;
+	}
+
+	VkSpecializationInfo SESpecialization::GetInfo() const{
+		VkSpecializationInfo info = {};
+		info.mapEntryCount = static_cast<uint32_t>(entries.size());
+		info.pMapEntries = entries.data();
+		info.dataSize = data.size() * sizeof(uint32_t);
+		info.pData = data.data();
+		return info;
+	}
+
+	SEShaderPermutations::SEShaderPermutations(){}
+	SEShaderPermutations::~SEShaderPermutations(){}
+
+	void SEShaderPermutations::Create(const std::vector<const SEShaderReflection*>& stages){
+		features.clear();
+
+		for (const SEShaderReflection* stage : stages){
+			for (const auto& constant : stage->specConstants){
+				if (!constant.boolean){
+					continue;
+				}
+
+				auto existing = std::find_if(features.begin(), features.end(),
+					[&constant](const Feature& feature) { return feature.constantId == constant.id; });
+				if (existing != features.end()){
+					if (existing->name != constant.name || existing->defaultValue != constant.defaultValue){
+						throw std::runtime_error("Shader stages disagree on specialization constant " + std::to_string(constant.id)
+							+ " (" + existing->name + ", " + constant.name + ")");
+					}
+					continue;
+				}
+
+				Feature feature;
+				feature.constantId = constant.id;
+				feature.defaultValue = constant.defaultValue;
+				feature.name = constant.name;
+				features.push_back(feature);
+			}
+		}
+
+		if (features.size() > 32){
+			throw std::runtime_error("Shader declares more than 32 feature constants");
+		}
+		std::sort(features.begin(), features.end(), [](const Feature& a, const Feature& b) { return a.constantId < b.constantId; });
+	}
+
+	SESpecialization SEShaderPermutations::Specialize(uint32_t featureMask) const{
+		SESpecialization specialization;
+		for (uint32_t i = 0; i < features.size(); i++){
+			uint32_t value = (featureMask >> i) & 1;
+			if (value != features[i].defaultValue){
+				specialization.Set(features[i].constantId, value);
+			}
+		}
+		return specialization;
+	}
+
+	uint32_t SEShaderPermutations::GetFeatureBit(const std::string& name) const{
+		for (uint32_t i = 0; i < features.size(); i++){
+			if (features[i].name == name){
+				return 1u << i;
+			}
+		}
+		return 0;
+	}
+
+	const std::string& SEShaderPermutations::GetFeatureName(uint32_t index) const{
+		return features.at(index).name;
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "SEHash.h"
+#include "SESpirvReflect.h"
+
+namespace ScoobzEngine {
+
+	// specialization constant values for a pipeline, shared by all its stages. a stage ignores ids it doesnt declare.
+	// only values that differ from the shaders defaults are stored, so equal permutations always hash the same
+	struct SESpecialization{
+		std::vector<VkSpecializationMapEntry> entries; // sorted by constantID
+		std::vector<uint32_t> data; // one word per entry
+
+		void Set(uint32_t, uint32_t);
+		bool Empty() const { return entries.empty(); }
+		uint64_t Hash() const;
+		// points into this struct, it has to outlive the pipeline creation
+		VkSpecializationInfo GetInfo() const;
+	};
+
+	// one shader pair compiled into many variants through bool specialization constants rather than separate SPIR-V.
+	// every bool constant the stages declare is a feature, bit i of a feature mask is the i-th by constant id, so
+	//     layout(constant_id = 3) const bool ALPHA_TEST = false;
+	// becomes a feature the driver dead-strips when its off
+	class SEShaderPermutations{
+
+	public:
+		SEShaderPermutations();~SEShaderPermutations();
+
+		//FUNCTIONS :: PUBLIC
+		void Create(const std::vector<const SEShaderReflection*>&);
+		// bits for features the shaders dont declare are ignored
+		SESpecialization Specialize(uint32_t) const;
+
+		//Getters
+		// 0 if no stage declares a feature with that name
+		uint32_t GetFeatureBit(const std::string&) const;
+		uint32_t GetFeatureCount() const { return static_cast<uint32_t>(features.size()); }
+		const std::string& GetFeatureName(uint32_t) const;
+
+	private:
+		struct Feature{
+			uint32_t constantId;
+			uint32_t defaultValue;
+			std::string name;
+		};
+
+		std::vector<Feature> features; // by constant id
+	};
+}
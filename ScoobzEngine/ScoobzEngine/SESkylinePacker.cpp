@@ -0,0 +1,93 @@
+#include "SESkylinePacker.h"
+#include <algorithm>
+
+namespace ScoobzEngine {
+
+	SESkylinePacker::SESkylinePacker(){}
+	SESkylinePacker::~SESkylinePacker(){}
+
+	void SESkylinePacker::Create(uint32_t widthIn, uint32_t heightIn){
+		width = widthIn;
+		height = heightIn;
+		usedArea = 0;
+		skyline.assign(1, { 0, 0, width });
+	}
+
+	bool SESkylinePacker::Fit(size_t first, uint32_t rectWidth, uint32_t rectHeight, uint32_t& y) const {
+		if (skyline[first].x + rectWidth > width){
+			return false;
+		}
+		// resting on the highest segment the rectangle spans
+		y = 0;
+		uint32_t remaining = rectWidth;
+		for (size_t i = first; remaining > 0; i++){
+			y = std::max(y, skyline[i].y);
+			if (y + rectHeight > height){
+				return false;
+			}
+			remaining -= std::min(remaining, skyline[i].width);
+		}
+		return true;
+	}
+
+	bool SESkylinePacker::Pack(uint32_t rectWidth, uint32_t rectHeight, uint32_t& x, uint32_t& y){
+		if (rectWidth == 0 || rectHeight == 0){
+			x = 0;
+			y = 0;
+			return true;
+		}
+
+		size_t best = skyline.size();
+		uint32_t bestTop = UINT32_MAX;
+		uint32_t bestWidth = UINT32_MAX;
+		uint32_t bestY = 0;
+		for (size_t i = 0; i < skyline.size(); i++){
+			uint32_t fitY;
+			if (!Fit(i, rectWidth, rectHeight, fitY)){
+				continue;
+			}
+			uint32_t top = fitY + rectHeight;
+			if (top < bestTop || (top == bestTop && skyline[i].width < bestWidth)){
+				best = i;
+				bestTop = top;
+				bestWidth = skyline[i].width;
+				bestY = fitY;
+			}
+		}
+		if (best == skyline.size()){
+			return false;
+		}
+		x = skyline[best].x;
+		y = bestY;
+
+		// the new segment goes in, whatever it now covers is cut back or removed
+		skyline.insert(skyline.begin() + best, { x, bestTop, rectWidth });
+		uint32_t right = x + rectWidth;
+		size_t next = best + 1;
+		while (next < skyline.size() && skyline[next].x < right){
+			uint32_t segmentRight = skyline[next].x + skyline[next].width;
+			if (segmentRight <= right){
+				skyline.erase(skyline.begin() + next);
+			}
+			else{
+				skyline[next].width = segmentRight - right;
+				skyline[next].x = right;
+				break;
+			}
+		}
+
+		// neighbours at the same height become one segment
+		for (size_t i = 0; i + 1 < skyline.size();){
+			if (skyline[i].y == skyline[i + 1].y){
+				skyline[i].width += skyline[i + 1].width;
+				skyline.erase(skyline.begin() + i + 1);
+			}
+			else{
+				i++;
+			}
+		}
+
+		usedArea += static_cast<uint64_t>(rectWidth) * rectHeight;
+		return true;
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ScoobzEngine {
+
+	// packs rectangles into a fixed size area by keeping only its skyline, the top edge of everything placed so far
+	// as a list of horizontal segments. each rectangle goes where its top edge would end up lowest, ties going to
+	// the narrowest segment so wide gaps are kept for wide rectangles. space under an overhang is never reused, which
+	// costs little when rectangles arrive tallest first, and a placement is only ever a walk over the segments
+	class SESkylinePacker{
+
+	public:
+		SESkylinePacker();~SESkylinePacker();
+
+		//FUNCTIONS :: PUBLIC
+		// width and height, empty
+		void Create(uint32_t, uint32_t);
+		// width and height in, top left corner out. false when it doesnt fit anywhere, nothing changes then
+		bool Pack(uint32_t, uint32_t, uint32_t&, uint32_t&);
+
+		//Getters
+		uint32_t GetWidth() const { return width; }
+		uint32_t GetHeight() const { return height; }
+		// area of everything packed over the whole area
+		float GetOccupancy() const { return static_cast<float>(usedArea) / (static_cast<float>(width) * height); }
+
+	private:
+		struct Segment{
+			uint32_t x;
+			uint32_t y; // the skylines height over it, growing downwards from the top of the area
+			uint32_t width;
+		};
+
+		// where the rectangle would sit if its left edge were on this segment, false when it would stick out
+		bool Fit(size_t, uint32_t, uint32_t, uint32_t&) const;
+
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint64_t usedArea = 0;
+		std::vector<Segment> skyline; // left to right, covering the whole width
+	};
+}
@@ -0,0 +1,440 @@
+#include "SESpirvReflect.h"
+#include <algorithm>
+#include <cstring>
+
+namespace ScoobzEngine {
+
+	// the handful of SPIR-V enums reflection cares about, values from the SPIR-V 1.0 spec
+	static const uint32_t SPIRV_MAGIC = 0x07230203;
+
+	enum SpirvOp{
+		SPIRV_OP_NAME = 5,
+		SPIRV_OP_ENTRY_POINT = 15,
+		SPIRV_OP_TYPE_BOOL = 20,
+		SPIRV_OP_TYPE_INT = 21,
+		SPIRV_OP_TYPE_FLOAT = 22,
+		SPIRV_OP_TYPE_VECTOR = 23,
+		SPIRV_OP_TYPE_MATRIX = 24,
+		SPIRV_OP_TYPE_IMAGE = 25,
+		SPIRV_OP_TYPE_SAMPLER = 26,
+		SPIRV_OP_TYPE_SAMPLED_IMAGE = 27,
+		SPIRV_OP_TYPE_ARRAY = 28,
+		SPIRV_OP_TYPE_RUNTIME_ARRAY = 29,
+		SPIRV_OP_TYPE_STRUCT = 30,
+		SPIRV_OP_TYPE_POINTER = 32,
+		SPIRV_OP_CONSTANT = 43,
+		SPIRV_OP_SPEC_CONSTANT_TRUE = 48,
+		SPIRV_OP_SPEC_CONSTANT_FALSE = 49,
+		SPIRV_OP_SPEC_CONSTANT = 50,
+		SPIRV_OP_VARIABLE = 59,
+		SPIRV_OP_DECORATE = 71,
+		SPIRV_OP_MEMBER_DECORATE = 72
+	};
+
+	enum SpirvDecoration{
+		SPIRV_DECORATION_SPEC_ID = 1,
+		SPIRV_DECORATION_BLOCK = 2,
+		SPIRV_DECORATION_BUFFER_BLOCK = 3,
+		SPIRV_DECORATION_ARRAY_STRIDE = 6,
+		SPIRV_DECORATION_MATRIX_STRIDE = 7,
+		SPIRV_DECORATION_BUILT_IN = 11,
+		SPIRV_DECORATION_LOCATION = 30,
+		SPIRV_DECORATION_BINDING = 33,
+		SPIRV_DECORATION_DESCRIPTOR_SET = 34,
+		SPIRV_DECORATION_OFFSET = 35
+	};
+
+	enum SpirvStorageClass{
+		SPIRV_STORAGE_UNIFORM_CONSTANT = 0,
+		SPIRV_STORAGE_INPUT = 1,
+		SPIRV_STORAGE_UNIFORM = 2,
+		SPIRV_STORAGE_PUSH_CONSTANT = 9,
+		SPIRV_STORAGE_STORAGE_BUFFER = 12
+	};
+
+	static const uint32_t SPIRV_DIM_BUFFER = 5;
+	static const uint32_t SPIRV_DIM_SUBPASS_DATA = 6;
+
+	// everything we learn about one result id
+	struct SpirvId{
+		uint32_t opcode = 0;
+		uint32_t resultType = 0; // constants and variables
+		std::vector<uint32_t> operands; // words after the result id
+		std::string name;
+
+		bool hasLocation = false;
+		bool hasBinding = false;
+		bool hasSpecId = false;
+		bool builtIn = false;
+		bool block = false;
+		bool bufferBlock = false;
+		uint32_t location = 0;
+		uint32_t set = 0;
+		uint32_t binding = 0;
+		uint32_t specId = 0;
+		uint32_t arrayStride = 0;
+
+		// struct members
+		std::vector<uint32_t> memberOffsets;
+		std::vector<uint32_t> memberMatrixStrides;
+		bool hasBuiltInMember = false;
+	};
+
+	class SpirvModule{
+
+	public:
+		SpirvModule(const uint32_t* code, size_t wordCount){
+			if (wordCount < 5 || code[0] != SPIRV_MAGIC){
+				throw std::runtime_error("Shader code isnt valid SPIR-V");
+			}
+			ids.resize(code[3]);
+
+			size_t offset = 5;
+			while (offset < wordCount){
+				uint32_t opcode = code[offset] & 0xFFFF;
+				uint32_t length = code[offset] >> 16;
+				if (length == 0 || offset + length > wordCount){
+					throw std::runtime_error("SPIR-V instruction runs past the end of the module");
+				}
+				Parse(opcode, code + offset + 1, length - 1);
+				offset += length;
+			}
+		}
+
+		SpirvId& Get(uint32_t id){
+			if (id >= ids.size()){
+				throw std::runtime_error("SPIR-V id out of range");
+			}
+			return ids[id];
+		}
+
+		uint32_t SizeOf(uint32_t typeId, uint32_t matrixStride = 0){
+			SpirvId& type = Get(typeId);
+			switch (type.opcode){
+			case SPIRV_OP_TYPE_BOOL:
+				return 4;
+			case SPIRV_OP_TYPE_INT:
+			case SPIRV_OP_TYPE_FLOAT:
+				return type.operands[0] / 8;
+			case SPIRV_OP_TYPE_VECTOR:
+				return SizeOf(type.operands[0]) * type.operands[1];
+			case SPIRV_OP_TYPE_MATRIX:
+				return (matrixStride ? matrixStride : SizeOf(type.operands[0])) * type.operands[1];
+			case SPIRV_OP_TYPE_ARRAY:{
+				uint32_t stride = type.arrayStride ? type.arrayStride : SizeOf(type.operands[0]);
+				return stride * ConstantValue(type.operands[1]);
+			}
+			case SPIRV_OP_TYPE_RUNTIME_ARRAY:
+				return 0;
+			case SPIRV_OP_TYPE_STRUCT:{
+				uint32_t size = 0;
+				for (size_t i = 0; i < type.operands.size(); i++){
+					uint32_t offset = i < type.memberOffsets.size() ? type.memberOffsets[i] : size;
+					uint32_t stride = i < type.memberMatrixStrides.size() ? type.memberMatrixStrides[i] : 0;
+					size = std::max(size, offset + SizeOf(type.operands[i], stride));
+				}
+				return size;
+			}
+			default:
+				return 0;
+			}
+		}
+
+		uint32_t ConstantValue(uint32_t id){
+			SpirvId& constant = Get(id);
+			if (constant.opcode != SPIRV_OP_CONSTANT && constant.opcode != SPIRV_OP_SPEC_CONSTANT){
+				throw std::runtime_error("SPIR-V array length isnt a constant");
+			}
+			return constant.operands[0];
+		}
+
+		std::vector<SpirvId> ids;
+		uint32_t executionModel = ~0u;
+		std::string entryPoint;
+
+	private:
+		static std::string ReadString(const uint32_t* words, uint32_t wordCount){
+			const char* chars = reinterpret_cast<const char*>(words);
+			return std::string(chars, strnlen(chars, wordCount * sizeof(uint32_t)));
+		}
+
+		static void GrowTo(std::vector<uint32_t>& values, uint32_t index){
+			if (values.size() <= index){
+				values.resize(index + 1, 0);
+			}
+		}
+
+		void Parse(uint32_t opcode, const uint32_t* words, uint32_t wordCount){
+			switch (opcode){
+			case SPIRV_OP_ENTRY_POINT:
+				if (executionModel == ~0u && wordCount >= 3){
+					executionModel = words[0];
+					entryPoint = ReadString(words + 2, wordCount - 2);
+				}
+				break;
+			case SPIRV_OP_NAME:
+				if (wordCount >= 2){
+					Get(words[0]).name = ReadString(words + 1, wordCount - 1);
+				}
+				break;
+			case SPIRV_OP_DECORATE:
+				if (wordCount >= 2){
+					Decorate(Get(words[0]), words[1], wordCount >= 3 ? words[2] : 0);
+				}
+				break;
+			case SPIRV_OP_MEMBER_DECORATE:
+				if (wordCount >= 3){
+					SpirvId& type = Get(words[0]);
+					uint32_t member = words[1];
+					uint32_t value = wordCount >= 4 ? words[3] : 0;
+					if (words[2] == SPIRV_DECORATION_OFFSET){
+						GrowTo(type.memberOffsets, member);
+						type.memberOffsets[member] = value;
+					}
+					else if (words[2] == SPIRV_DECORATION_MATRIX_STRIDE){
+						GrowTo(type.memberMatrixStrides, member);
+						type.memberMatrixStrides[member] = value;
+					}
+					else if (words[2] == SPIRV_DECORATION_BUILT_IN){
+						type.hasBuiltInMember = true;
+					}
+				}
+				break;
+			case SPIRV_OP_TYPE_BOOL:
+			case SPIRV_OP_TYPE_INT:
+			case SPIRV_OP_TYPE_FLOAT:
+			case SPIRV_OP_TYPE_VECTOR:
+			case SPIRV_OP_TYPE_MATRIX:
+			case SPIRV_OP_TYPE_IMAGE:
+			case SPIRV_OP_TYPE_SAMPLER:
+			case SPIRV_OP_TYPE_SAMPLED_IMAGE:
+			case SPIRV_OP_TYPE_ARRAY:
+			case SPIRV_OP_TYPE_RUNTIME_ARRAY:
+			case SPIRV_OP_TYPE_STRUCT:
+			case SPIRV_OP_TYPE_POINTER:
+				if (wordCount >= 1){
+					SpirvId& type = Get(words[0]);
+					type.opcode = opcode;
+					type.operands.assign(words + 1, words + wordCount);
+				}
+				break;
+			case SPIRV_OP_CONSTANT:
+			case SPIRV_OP_SPEC_CONSTANT_TRUE:
+			case SPIRV_OP_SPEC_CONSTANT_FALSE:
+			case SPIRV_OP_SPEC_CONSTANT:
+			case SPIRV_OP_VARIABLE:
+				if (wordCount >= 2){
+					SpirvId& value = Get(words[1]);
+					value.opcode = opcode;
+					value.resultType = words[0];
+					value.operands.assign(words + 2, words + wordCount);
+				}
+				break;
+			default:
+				break;
+			}
+		}
+
+		static void Decorate(SpirvId& id, uint32_t decoration, uint32_t value){
+			switch (decoration){
+			case SPIRV_DECORATION_SPEC_ID: id.hasSpecId = true; id.specId = value; break;
+			case SPIRV_DECORATION_BLOCK: id.block = true; break;
+			case SPIRV_DECORATION_BUFFER_BLOCK: id.bufferBlock = true; break;
+			case SPIRV_DECORATION_ARRAY_STRIDE: id.arrayStride = value; break;
+			case SPIRV_DECORATION_BUILT_IN: id.builtIn = true; break;
+			case SPIRV_DECORATION_LOCATION: id.hasLocation = true; id.location = value; break;
+			case SPIRV_DECORATION_BINDING: id.hasBinding = true; id.binding = value; break;
+			case SPIRV_DECORATION_DESCRIPTOR_SET: id.set = value; break;
+			default: break;
+			}
+		}
+	};
+
+	static VkShaderStageFlagBits StageFromExecutionModel(uint32_t executionModel){
+		switch (executionModel){
+		case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+		case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+		case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+		case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+		case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+		case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+		default: throw std::runtime_error("SPIR-V module has no supported entry point");
+		}
+	}
+
+	static VkFormat InputFormat(SpirvModule& module, uint32_t typeId){
+		SpirvId& type = module.Get(typeId);
+		uint32_t componentCount = 1;
+		SpirvId* component = &type;
+		if (type.opcode == SPIRV_OP_TYPE_VECTOR){
+			componentCount = type.operands[1];
+			component = &module.Get(type.operands[0]);
+		}
+
+		static const VkFormat floatFormats[] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+		static const VkFormat intFormats[] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+		static const VkFormat uintFormats[] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+
+		if (componentCount < 1 || componentCount > 4 || component->operands.empty() || component->operands[0] != 32){
+			return VK_FORMAT_UNDEFINED;
+		}
+		if (component->opcode == SPIRV_OP_TYPE_FLOAT){
+			return floatFormats[componentCount - 1];
+		}
+		if (component->opcode == SPIRV_OP_TYPE_INT){
+			return component->operands[1] ? intFormats[componentCount - 1] : uintFormats[componentCount - 1];
+		}
+		return VK_FORMAT_UNDEFINED;
+	}
+
+	static VkDescriptorType DescriptorType(uint32_t storageClass, SpirvId& type){
+		if (storageClass == SPIRV_STORAGE_STORAGE_BUFFER){
+			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		}
+		if (storageClass == SPIRV_STORAGE_UNIFORM){
+			return type.bufferBlock ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		}
+
+		switch (type.opcode){
+		case SPIRV_OP_TYPE_SAMPLER:
+			return VK_DESCRIPTOR_TYPE_SAMPLER;
+		case SPIRV_OP_TYPE_SAMPLED_IMAGE:
+			return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		case SPIRV_OP_TYPE_IMAGE:{
+			// operands: sampled type, dim, depth, arrayed, ms, sampled (1 = with a sampler, 2 = storage)
+			uint32_t dim = type.operands[1];
+			bool storage = type.operands[5] == 2;
+			if (dim == SPIRV_DIM_SUBPASS_DATA){
+				return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+			}
+			if (dim == SPIRV_DIM_BUFFER){
+				return storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+			}
+			return storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		}
+		default:
+			throw std::runtime_error("Unsupported descriptor type in SPIR-V");
+		}
+	}
+
+	SEShaderReflection ReflectSpirv(const uint32_t* code, size_t wordCount){
+		SpirvModule module(code, wordCount);
+
+		SEShaderReflection reflection = {};
+		reflection.stage = StageFromExecutionModel(module.executionModel);
+		reflection.entryPoint = module.entryPoint;
+
+		for (SpirvId& id : module.ids){
+			if (id.opcode == SPIRV_OP_SPEC_CONSTANT || id.opcode == SPIRV_OP_SPEC_CONSTANT_TRUE || id.opcode == SPIRV_OP_SPEC_CONSTANT_FALSE){
+				if (id.hasSpecId){
+					SEShaderSpecConstant constant = {};
+					constant.id = id.specId;
+					constant.size = module.SizeOf(id.resultType);
+					constant.defaultValue = id.opcode == SPIRV_OP_SPEC_CONSTANT ? id.operands[0] : (id.opcode == SPIRV_OP_SPEC_CONSTANT_TRUE ? 1 : 0);
+					constant.boolean = id.opcode != SPIRV_OP_SPEC_CONSTANT;
+					constant.name = id.name;
+					reflection.specConstants.push_back(constant);
+				}
+				continue;
+			}
+
+			if (id.opcode != SPIRV_OP_VARIABLE){
+				continue;
+			}
+
+			uint32_t storageClass = id.operands[0];
+			SpirvId& pointer = module.Get(id.resultType);
+			uint32_t pointeeId = pointer.operands[1];
+
+			if (storageClass == SPIRV_STORAGE_INPUT){
+				SpirvId& pointee = module.Get(pointeeId);
+				if (id.builtIn || pointee.hasBuiltInMember || !id.hasLocation){
+					continue;
+				}
+
+				// matrices take one location per column
+				uint32_t columnType = pointeeId;
+				uint32_t columns = 1;
+				if (pointee.opcode == SPIRV_OP_TYPE_MATRIX){
+					columnType = pointee.operands[0];
+					columns = pointee.operands[1];
+				}
+				for (uint32_t column = 0; column < columns; column++){
+					SEShaderInput input = {};
+					input.location = id.location + column;
+					input.format = InputFormat(module, columnType);
+					input.size = module.SizeOf(columnType);
+					input.name = id.name;
+					reflection.inputs.push_back(input);
+				}
+			}
+			else if (storageClass == SPIRV_STORAGE_PUSH_CONSTANT){
+				reflection.pushConstantSize = std::max(reflection.pushConstantSize, module.SizeOf(pointeeId));
+			}
+			else if (storageClass == SPIRV_STORAGE_UNIFORM_CONSTANT || storageClass == SPIRV_STORAGE_UNIFORM
+				|| storageClass == SPIRV_STORAGE_STORAGE_BUFFER){
+				if (!id.hasBinding){
+					continue;
+				}
+
+				// arrays of resources become a descriptor count
+				uint32_t count = 1;
+				SpirvId* type = &module.Get(pointeeId);
+				while (type->opcode == SPIRV_OP_TYPE_ARRAY || type->opcode == SPIRV_OP_TYPE_RUNTIME_ARRAY){
+					count = type->opcode == SPIRV_OP_TYPE_ARRAY ? count * module.ConstantValue(type->operands[1]) : 0;
+					type = &module.Get(type->operands[0]);
+				}
+
+				SEShaderBinding binding = {};
+				binding.set = id.set;
+				binding.binding = id.binding;
+				binding.type = DescriptorType(storageClass, *type);
+				binding.count = count;
+				binding.name = id.name.empty() ? type->name : id.name;
+				reflection.bindings.push_back(binding);
+			}
+		}
+
+		std::sort(reflection.inputs.begin(), reflection.inputs.end(),
+			[](const SEShaderInput& a, const SEShaderInput& b) { return a.location < b.location; });
+		std::sort(reflection.bindings.begin(), reflection.bindings.end(), [](const SEShaderBinding& a, const SEShaderBinding& b) {
+			return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+		});
+		std::sort(reflection.specConstants.begin(), reflection.specConstants.end(),
+			[](const SEShaderSpecConstant& a, const SEShaderSpecConstant& b) { return a.id < b.id; });
+
+		return reflection;
+	}
+
+	SEShaderReflection ReflectSpirv(const std::vector<char>& code){
+		if (code.size() % sizeof(uint32_t) != 0){
+			throw std::runtime_error("SPIR-V code size isnt a multiple of 4");
+		}
+		std::vector<uint32_t> words(code.size() / sizeof(uint32_t));
+		memcpy(words.data(), code.data(), code.size());
+		return ReflectSpirv(words.data(), words.size());
+	}
+
+	void SEShaderReflection::GetPackedVertexInput(uint32_t binding, VkVertexInputBindingDescription& bindingDescription,
+		std::vector<VkVertexInputAttributeDescription>& attributes) const{
+		attributes.clear();
+		uint32_t offset = 0;
+		for (const auto& input : inputs){
+			if (input.format == VK_FORMAT_UNDEFINED){
+				throw std::runtime_error("Vertex input '" + input.name + "' has a type that cant be fed from a vertex buffer");
+			}
+			VkVertexInputAttributeDescription attribute = {};
+			attribute.binding = binding;
+			attribute.location = input.location;
+			attribute.format = input.format;
+			attribute.offset = offset;
+			attributes.push_back(attribute);
+			offset += input.size;
+		}
+
+		bindingDescription = {};
+		bindingDescription.binding = binding;
+		bindingDescription.stride = offset;
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ScoobzEngine {
+
+	struct SEShaderInput{
+		uint32_t location;
+		VkFormat format;
+		uint32_t size; // bytes
+		std::string name;
+	};
+
+	struct SEShaderBinding{
+		uint32_t set;
+		uint32_t binding;
+		VkDescriptorType type;
+		uint32_t count; // 0 for a runtime sized array
+		std::string name;
+	};
+
+	struct SEShaderSpecConstant{
+		uint32_t id;
+		uint32_t size; // bytes
+		uint32_t defaultValue; // raw bits of the default, bools are 0 or 1
+		bool boolean; // declared as a bool, these are what shader permutations switch
+		std::string name;
+	};
+
+	// what one shader module expects from the pipeline around it
+	struct SEShaderReflection{
+		VkShaderStageFlagBits stage;
+		std::string entryPoint;
+		std::vector<SEShaderInput> inputs; // stage inputs sorted by location, builtins left out
+		std::vector<SEShaderBinding> bindings; // sorted by set then binding
+		uint32_t pushConstantSize; // 0 if the stage has no push constant block
+		std::vector<SEShaderSpecConstant> specConstants; // sorted by id
+
+		// vertex attributes for a single interleaved binding, packed tightly in location order
+		void GetPackedVertexInput(uint32_t, VkVertexInputBindingDescription&, std::vector<VkVertexInputAttributeDescription>&) const;
+	};
+
+	// reads the decorations and types straight out of the SPIR-V words, only the first entry point is looked at.
+	// throws if the code isnt valid SPIR-V
+	SEShaderReflection ReflectSpirv(const uint32_t*, size_t);
+	SEShaderReflection ReflectSpirv(const std::vector<char>&);
+}
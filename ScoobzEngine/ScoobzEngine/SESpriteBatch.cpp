@@ -0,0 +1,249 @@
+#include "SESpriteBatch.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <xmmintrin.h>
+
+namespace ScoobzEngine {
+
+	// the sort key is 4 bytes, one counting pass over each
+	static const uint32_t RADIX_PASSES = 4;
+	// the layer can change inside a batch, only pipeline and texture end one
+	static const uint32_t BATCH_KEY_MASK = 0x00ffffff;
+	// sorted sprites are read all over the place, each one is fetched this many ahead of being written out
+	static const uint32_t PREFETCH_DISTANCE = 16;
+
+	static uint16_t ToUnorm16(float value){
+		value = std::min(std::max(value, 0.0f), 1.0f);
+		return static_cast<uint16_t>(value * 65535.0f + 0.5f);
+	}
+
+	SESpriteBatch::SESpriteBatch(){}
+	SESpriteBatch::~SESpriteBatch(){}
+
+	void SESpriteBatch::Create(const VkDevice* logicalDevice, const VkPhysicalDevice* physicalDevice, const VkSurfaceKHR* surface,
+		const VkCommandPool* commandPool, const VkQueue* queue, uint32_t maxSpritesIn, uint32_t framesInFlight){
+
+		device = logicalDevice;
+		maxSprites = maxSpritesIn;
+
+		// host coherent and mapped for its whole life, the CPU writes each frames vertices straight into it
+		VkDeviceSize frameBytes = static_cast<VkDeviceSize>(maxSprites) * 4 * sizeof(SESpriteVertex);
+		CreateBuffer(logicalDevice, physicalDevice, surface, frameBytes * framesInFlight, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, vertexBuffer, vertexMemory);
+		void* data;
+		if (vkMapMemory(*device, vertexMemory, 0, frameBytes * framesInFlight, 0, &data) != VK_SUCCESS){
+			throw std::runtime_error("Failed to map sprite vertices");
+		}
+		mappedVertices = static_cast<SESpriteVertex*>(data);
+
+		// every sprite is the same two triangles, so the indices never change and live on the device
+		VkDeviceSize indexBytes = static_cast<VkDeviceSize>(maxSprites) * 6 * sizeof(uint32_t);
+		VkBuffer stagingBuffer;
+		VkDeviceMemory stagingBufferMemory;
+		CreateBuffer(logicalDevice, physicalDevice, surface, indexBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+		if (vkMapMemory(*device, stagingBufferMemory, 0, indexBytes, 0, &data) != VK_SUCCESS){
+			throw std::runtime_error("Failed to map sprite index staging buffer");
+		}
+		uint32_t* indices = static_cast<uint32_t*>(data);
+		for (uint32_t i = 0; i < maxSprites; i++){
+			uint32_t corner = i * 4;
+			uint32_t quad[6] = { corner, corner + 1, corner + 2, corner + 2, corner + 3, corner };
+			memcpy(indices + i * 6, quad, sizeof(quad));
+		}
+		vkUnmapMemory(*device, stagingBufferMemory);
+
+		CreateBuffer(logicalDevice, physicalDevice, surface, indexBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexMemory);
+		CopyBuffer(logicalDevice, commandPool, stagingBuffer, indexBuffer, indexBytes, queue);
+		CleanupBuffer(logicalDevice, stagingBuffer, stagingBufferMemory);
+
+		sprites.reserve(maxSprites);
+		order.reserve(maxSprites);
+		scratch.reserve(maxSprites);
+
+		std::cout << "Sprite Batch Creation: SUCCESSFUL! (" << framesInFlight << " x " << maxSprites << " sprites, "
+			<< frameBytes * framesInFlight / (1024 * 1024) << " MB of vertices)" << std::endl;
+	}
+
+	void SESpriteBatch::Cleanup(){
+		vkUnmapMemory(*device, vertexMemory);
+		mappedVertices = nullptr;
+		CleanupBuffer(device, vertexBuffer, vertexMemory);
+		CleanupBuffer(device, indexBuffer, indexMemory);
+	}
+
+	uint32_t SESpriteBatch::AddPipeline(SEPipelineHandle pipeline){
+		if (pipelines.size() >= SE_SPRITE_MAX_PIPELINES){
+			throw std::runtime_error("Sprite batch has no room for another pipeline");
+		}
+		pipelines.push_back(pipeline);
+		return static_cast<uint32_t>(pipelines.size() - 1);
+	}
+
+	void SESpriteBatch::SetPipeline(uint32_t index, SEPipelineHandle pipeline){
+		pipelines.at(index) = pipeline;
+	}
+
+	void SESpriteBatch::Draw(const SESprite& sprite){
+		if (sprite.texture > SE_SPRITE_MAX_TEXTURE){
+			throw std::runtime_error("Sprite texture index is past SE_SPRITE_MAX_TEXTURE");
+		}
+		uint64_t key = (static_cast<uint64_t>(sprite.layer) << 24) | (static_cast<uint64_t>(sprite.pipeline) << 16) | sprite.texture;
+		order.push_back((key << 32) | sprites.size());
+		sprites.push_back(sprite);
+	}
+
+	// least significant byte first, each pass a stable counting sort, so sprites with equal keys stay in the order
+	// they were drawn. a byte thats the same for every sprite, usually the layer and pipeline, needs no pass at all
+	void SESpriteBatch::Sort(uint32_t count){
+		uint32_t histograms[RADIX_PASSES][256] = {};
+		for (uint32_t i = 0; i < count; i++){
+			uint32_t key = static_cast<uint32_t>(order[i] >> 32);
+			for (uint32_t pass = 0; pass < RADIX_PASSES; pass++){
+				histograms[pass][(key >> (pass * 8)) & 0xff]++;
+			}
+		}
+
+		scratch.resize(count);
+		for (uint32_t pass = 0; pass < RADIX_PASSES; pass++){
+			uint32_t* histogram = histograms[pass];
+			uint32_t shift = 32 + pass * 8;
+			if (histogram[(order[0] >> shift) & 0xff] == count){
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (uint32_t bucket = 0; bucket < 256; bucket++){
+				uint32_t bucketCount = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucketCount;
+			}
+			for (uint32_t i = 0; i < count; i++){
+				scratch[histogram[(order[i] >> shift) & 0xff]++] = order[i];
+			}
+			order.swap(scratch);
+		}
+	}
+
+	uint32_t SESpriteBatch::Build(SESpriteVertex* vertices, uint32_t capacity){
+		auto start = std::chrono::high_resolution_clock::now();
+
+		// the last ones drawn are the ones dropped
+		uint32_t count = static_cast<uint32_t>(std::min<size_t>(sprites.size(), capacity));
+		stats.dropped += sprites.size() - count;
+		order.resize(count);
+		batches.clear();
+
+		if (count > 0){
+			Sort(count);
+		}
+
+		uint32_t batchKey = ~0u;
+		for (uint32_t i = 0; i < count; i++){
+			if (i + PREFETCH_DISTANCE < count){
+				_mm_prefetch(reinterpret_cast<const char*>(&sprites[static_cast<uint32_t>(order[i + PREFETCH_DISTANCE])]), _MM_HINT_T0);
+			}
+			uint32_t key = static_cast<uint32_t>(order[i] >> 32);
+			const SESprite& sprite = sprites[static_cast<uint32_t>(order[i])];
+			if ((key & BATCH_KEY_MASK) != batchKey){
+				batchKey = key & BATCH_KEY_MASK;
+				batches.push_back({ sprite.pipeline, sprite.texture, i, 0 });
+			}
+			batches.back().spriteCount++;
+
+			// the corners go round from the min uv corner, rotation spins the half size axes
+			glm::vec2 halfSize = sprite.size * 0.5f;
+			glm::vec2 axisX(halfSize.x, 0.0f);
+			glm::vec2 axisY(0.0f, halfSize.y);
+			if (sprite.rotation != 0.0f){
+				float c = std::cos(sprite.rotation);
+				float s = std::sin(sprite.rotation);
+				axisX = glm::vec2(c, s) * halfSize.x;
+				axisY = glm::vec2(-s, c) * halfSize.y;
+			}
+			uint16_t u0 = ToUnorm16(sprite.uvRect.x);
+			uint16_t v0 = ToUnorm16(sprite.uvRect.y);
+			uint16_t u1 = ToUnorm16(sprite.uvRect.z);
+			uint16_t v1 = ToUnorm16(sprite.uvRect.w);
+
+			// built on the stack and copied out whole, so the mapped memory only sees one sequential write
+			SESpriteVertex quad[4];
+			quad[0] = { sprite.position - axisX - axisY, { u0, v0 }, sprite.color };
+			quad[1] = { sprite.position + axisX - axisY, { u1, v0 }, sprite.color };
+			quad[2] = { sprite.position + axisX + axisY, { u1, v1 }, sprite.color };
+			quad[3] = { sprite.position - axisX + axisY, { u0, v1 }, sprite.color };
+			memcpy(vertices + static_cast<size_t>(i) * 4, quad, sizeof(quad));
+		}
+
+		sprites.clear();
+		order.clear();
+
+		stats.frames++;
+		stats.sprites += count;
+		stats.batches += batches.size();
+		stats.buildMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		return count;
+	}
+
+	uint32_t SESpriteBatch::Flush(uint32_t slot){
+		currentSlot = slot;
+		return Build(mappedVertices + static_cast<size_t>(slot) * maxSprites * 4, maxSprites);
+	}
+
+	void SESpriteBatch::Record(VkCommandBuffer commandBuffer, SEPipelineCache* pipelineCache, VkPipelineLayout layout, VkShaderStageFlags pushStages,
+		SEDrawConstants drawConstants){
+
+		VkDeviceSize offset = static_cast<VkDeviceSize>(currentSlot) * maxSprites * 4 * sizeof(SESpriteVertex);
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+		vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+		// push constants outlive pipeline binds with the same layout, so each only changes when it has to
+		VkPipeline boundPipeline = VK_NULL_HANDLE;
+		uint32_t pushedTexture = ~0u;
+		for (const auto& batch : batches){
+			if (batch.pipeline >= pipelines.size() || !pipelineCache->IsReady(pipelines[batch.pipeline])){
+				continue;
+			}
+			VkPipeline pipeline = pipelineCache->Get(pipelines[batch.pipeline]);
+			if (pipeline != boundPipeline){
+				vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+				boundPipeline = pipeline;
+			}
+			if (batch.texture != pushedTexture){
+				drawConstants.materialIndex = batch.texture;
+				vkCmdPushConstants(commandBuffer, layout, pushStages, 0, sizeof(SEDrawConstants), &drawConstants);
+				pushedTexture = batch.texture;
+			}
+			vkCmdDrawIndexed(commandBuffer, batch.spriteCount * 6, 1, batch.firstSprite * 6, 0, 0);
+		}
+	}
+
+	// pixels from the top left, Vulkan clip space already has y going down
+	glm::mat4 SESpriteBatch::GetView(float width, float height){
+		if (customView){
+			return view;
+		}
+		glm::mat4 pixelView(1.0f);
+		pixelView[0][0] = 2.0f / width;
+		pixelView[1][1] = 2.0f / height;
+		pixelView[3][0] = -1.0f;
+		pixelView[3][1] = -1.0f;
+		return pixelView;
+	}
+
+	void SESpriteBatch::PrintStats(){
+		if (stats.frames == 0){
+			return;
+		}
+		std::cout << "---- Sprites ----" << std::endl;
+		std::cout << std::fixed << std::setprecision(2);
+		std::cout << "Sprites: " << static_cast<double>(stats.sprites) / stats.frames << " per frame in "
+			<< static_cast<double>(stats.batches) / stats.frames << " draws, " << stats.dropped << " dropped" << std::endl;
+		std::cout << "Build time: " << stats.buildMs * 1000.0 / stats.frames << " us per frame" << std::endl;
+		std::cout << std::defaultfloat;
+	}
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include "SEBuffer.h"
+#include "SEDrawData.h"
+#include "SEPipelineCache.h"
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace ScoobzEngine {
+
+	// the highest bindless image index a sprite can draw with, the sort key only has room for 16 bits of it
+	const uint32_t SE_SPRITE_MAX_TEXTURE = 0xffff;
+	// pipelines a batch can sort between, 8 bits of the sort key
+	const uint32_t SE_SPRITE_MAX_PIPELINES = 256;
+
+	// one corner of a sprite, 16 bytes. uv and colour are normalised integers the vertex input unpacks, matches sprite.vert
+	struct SESpriteVertex{
+
+		glm::vec2 pos;
+		uint16_t uv[2];
+		uint32_t color; // RGBA8, red in the low byte
+
+		static VkVertexInputBindingDescription getBindingDescription(){
+			VkVertexInputBindingDescription bindingDescription = {};
+			bindingDescription.binding = 0;
+			bindingDescription.stride = sizeof(SESpriteVertex);
+			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+			return bindingDescription;
+		}
+
+		static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions(){
+			std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions = {};
+			attributeDescriptions[0].binding = 0;
+			attributeDescriptions[0].location = 0;
+			attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+			attributeDescriptions[0].offset = offsetof(SESpriteVertex, pos);
+			attributeDescriptions[1].binding = 0;
+			attributeDescriptions[1].location = 1;
+			attributeDescriptions[1].format = VK_FORMAT_R16G16_UNORM;
+			attributeDescriptions[1].offset = offsetof(SESpriteVertex, uv);
+			attributeDescriptions[2].binding = 0;
+			attributeDescriptions[2].location = 2;
+			attributeDescriptions[2].format = VK_FORMAT_R8G8B8A8_UNORM;
+			attributeDescriptions[2].offset = offsetof(SESpriteVertex, color);
+
+			return attributeDescriptions;
+		}
+	};
+
+	struct SESprite{
+		glm::vec2 position; // of the centre, in the batches view space
+		glm::vec2 size;
+		float rotation = 0.0f; // radians about the centre
+		glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f); // min u, min v, max u, max v
+		uint32_t color = 0xffffffff; // RGBA8, red in the low byte
+		uint32_t texture = 0; // bindless image index
+		uint8_t layer = 0; // higher layers draw over lower ones
+		uint8_t pipeline = 0; // from AddPipeline, 0 is the first one added
+	};
+
+	struct SESpriteStats{
+		uint64_t frames;
+		uint64_t sprites; // summed over every frame
+		uint64_t batches;
+		uint64_t dropped; // drawn past the batches capacity in a frame
+		double buildMs; // sorting and writing the vertices
+	};
+
+	// immediate mode sprites. everything drawn between two frames is sorted by layer, then pipeline, then texture,
+	// and written into this frame slots part of one persistently mapped vertex buffer. each run of sprites sharing a
+	// pipeline and texture is a single indexed draw out of an index buffer of quads built once at startup, so a
+	// frame costs one draw per texture change rather than one per sprite.
+	// the sort is stable, sprites on the same layer with the same texture keep the order they were drawn in, but
+	// sprites with different textures on one layer dont. anything that has to go over something else goes on a higher layer
+	class SESpriteBatch : public SEBuffer{
+
+	public:
+		SESpriteBatch();~SESpriteBatch();
+
+		//FUNCTIONS :: PUBLIC
+		// the command pool and queue only upload the index buffer. most sprites a frame and frames in flight
+		void Create(const VkDevice*, const VkPhysicalDevice*, const VkSurfaceKHR*, const VkCommandPool*, const VkQueue*, uint32_t, uint32_t);
+		void Cleanup();
+		// pipelines have to take SESpriteVertex and the engines pipeline layout. returns what sprites set pipeline to
+		uint32_t AddPipeline(SEPipelineHandle);
+		// for when a pipeline is requested again, like on swapchain recreation
+		void SetPipeline(uint32_t, SEPipelineHandle);
+		// sprite space to clip space. without one sprites are in pixels from the top left of the window
+		void SetView(const glm::mat4& viewIn) { view = viewIn; customView = true; }
+		// main thread only, shows up in the next frame
+		void Draw(const SESprite&);
+		// sorts everything drawn since the last frame and writes it into this slots vertices, call right after waiting
+		// on the slots fence. returns how many sprites there are to record
+		uint32_t Flush(uint32_t);
+		// what Flush does, into any memory with room for 4 vertices a sprite. sprites past the capacity are dropped.
+		// write combined memory is only ever written in order, never read back
+		uint32_t Build(SESpriteVertex*, uint32_t);
+		// inside a render pass with the engines descriptor sets bound. the draw constants carry the views object index,
+		// each batch pushes them with its texture as the material. batches whose pipeline isnt ready are skipped, the
+		// caches fallback is built for the scenes vertices
+		void Record(VkCommandBuffer, SEPipelineCache*, VkPipelineLayout, VkShaderStageFlags, SEDrawConstants);
+		void PrintStats();
+
+		//Getters
+		glm::mat4 GetView(float, float);
+		uint32_t GetBatchCount() { return static_cast<uint32_t>(batches.size()); }
+		uint32_t GetMaxSprites() { return maxSprites; }
+		SESpriteStats GetStats() { return stats; }
+
+	private:
+		// a run of sorted sprites drawn together
+		struct Batch{
+			uint32_t pipeline;
+			uint32_t texture;
+			uint32_t firstSprite;
+			uint32_t spriteCount;
+		};
+
+		void Sort(uint32_t);
+
+		const VkDevice* device = nullptr;
+		VkBuffer vertexBuffer = VK_NULL_HANDLE; // a region per frame in flight
+		VkDeviceMemory vertexMemory = VK_NULL_HANDLE;
+		SESpriteVertex* mappedVertices = nullptr;
+		VkBuffer indexBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory indexMemory = VK_NULL_HANDLE;
+		uint32_t maxSprites = 0;
+		uint32_t currentSlot = 0;
+
+		std::vector<SEPipelineHandle> pipelines;
+		glm::mat4 view = glm::mat4(1.0f);
+		bool customView = false;
+
+		std::vector<SESprite> sprites; // this frames, in the order they were drawn
+		std::vector<uint64_t> order; // sort key in the high word, index into sprites in the low one
+		std::vector<uint64_t> scratch;
+		std::vector<Batch> batches; // from the last Build
+
+		SESpriteStats stats = {};
+	};
+}
@@ -1,5 +1,6 @@
 #include "SESwapChain.h"
 #include <algorithm>
+#include <limits>
 
 namespace ScoobzEngine {
 
@@ -53,6 +54,7 @@ namespace ScoobzEngine {
 		// stores data for chosen surface format and extent...
 		swapChainImageFormat = surfaceFormat.format;
 		swapChainExtent = extent;
+		depthFormat = FindDepthFormat(*physicalDevice);
 
 		CreateImageViews();
 	}
@@ -64,10 +66,16 @@ namespace ScoobzEngine {
 		vkDestroySwapchainKHR(*device, swapChain, VK_NULL_HANDLE);
 	}
 
-	void SESwapChain::CleanupFramebuffers(){
-		for (size_t i = 0; i < swapChainFramebuffers.size(); i++){
-			vkDestroyFramebuffer(*device, swapChainFramebuffers[i], VK_NULL_HANDLE);
+	VkFormat SESwapChain::FindDepthFormat(VkPhysicalDevice physicalDevice){
+		const VkFormat candidates[] = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT };
+		for (VkFormat format : candidates){
+			VkFormatProperties formatProperties;
+			vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &formatProperties);
+			if (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT){
+				return format;
+			}
 		}
+		throw std::runtime_error("Failed to find a supported depth format");
 	}
 
 	void SESwapChain::CreateImageViews(){
@@ -96,28 +104,6 @@ namespace ScoobzEngine {
 		std::cout << "Image views creation: SUCCESSFUL!" << std::endl;
 	}
 
-	void SESwapChain::CreateFramebuffers(VkRenderPass* renderPass){
-		swapChainFramebuffers.resize(swapChainImageViews.size());
-
-		for (size_t i = 0; i < swapChainImageViews.size(); i++){
-			VkImageView attachments[] = { swapChainImageViews[i] };
-
-			VkFramebufferCreateInfo framebufferInfo = {};
-			framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-			framebufferInfo.renderPass = *renderPass;
-			framebufferInfo.attachmentCount = 1;
-			framebufferInfo.pAttachments = attachments;
-			framebufferInfo.width = swapChainExtent.width;
-			framebufferInfo.height = swapChainExtent.height;
-			framebufferInfo.layers = 1;
-
-			if (vkCreateFramebuffer(*device, &framebufferInfo, nullptr, &swapChainFramebuffers[i]) != VK_SUCCESS){
-				throw std::runtime_error("Failed to create framebuffer");
-			}
-		}
-		std::cout << "Framebuffers creation: SUCCESSFUL!" << std::endl;
-	}
-
 	VkSurfaceFormatKHR SESwapChain::ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats){
 		// if surface has no preferred format...
 		if (availableFormats.size() == 1 && availableFormats[0].format == VK_FORMAT_UNDEFINED){
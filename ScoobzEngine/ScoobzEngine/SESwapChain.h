@@ -20,19 +20,21 @@ namespace ScoobzEngine {
 
 		void Create(const VkDevice*, VkPhysicalDevice*, const VkSurfaceKHR*, Window*, SwapChainSupportDetails);
 		void Cleanup();
-		void CleanupFramebuffers();
 		VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>&);
 		VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>);
 		VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR&, Window);
-		void CreateFramebuffers(VkRenderPass*);
 		void CreateImageViews();
+		// the first of D32, D32S8 and D24S8 the device can use as a depth attachment
+		VkFormat FindDepthFormat(VkPhysicalDevice);
 
 		//Getters
 		VkSwapchainKHR* GetSwapchain() { return &swapChain; }
 		VkFormat* GetImageFormat() { return &swapChainImageFormat; }
+		VkFormat GetDepthFormat() { return depthFormat; }
 		VkExtent2D* GetExtent() { return &swapChainExtent; }
-		size_t GetFramebufferSize() { return swapChainFramebuffers.size(); }
-		VkFramebuffer* GetFramebuffer(unsigned int index) { return &swapChainFramebuffers[index]; }
+		size_t GetImageCount() { return swapChainImages.size(); }
+		VkImage GetImage(unsigned int index) { return swapChainImages[index]; }
+		VkImageView GetImageView(unsigned int index) { return swapChainImageViews[index]; }
 
 
 	private:
@@ -40,11 +42,11 @@ namespace ScoobzEngine {
 		VkSwapchainKHR swapChain;
 		std::vector<VkImage> swapChainImages;
 		std::vector<VkImageView> swapChainImageViews;
-		std::vector<VkFramebuffer> swapChainFramebuffers;
 
 		// store swap chain details
 		VkFormat swapChainImageFormat;
 		VkExtent2D swapChainExtent;
+		VkFormat depthFormat = VK_FORMAT_UNDEFINED;
 
 		const VkDevice* device;
 	};
@@ -0,0 +1,164 @@
+#include "SETaskGraph.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace ScoobzEngine {
+
+	SETaskGraph::SETaskGraph(){}
+	SETaskGraph::~SETaskGraph(){}
+
+	SETaskGraph::TaskId SETaskGraph::AddTask(const std::string& name, std::function<void()> work,
+		std::initializer_list<TaskId> dependencies, bool mainThreadOnly){
+		TaskId id = tasks.size();
+
+		Task task = {};
+		task.name = name;
+		task.work = std::move(work);
+		task.mainThreadOnly = mainThreadOnly;
+		for (TaskId dependency : dependencies){
+			if (dependency >= id){
+				throw std::runtime_error("Task graph dependency added before its task: " + name);
+			}
+			task.dependencies.push_back(dependency);
+			tasks[dependency].dependents.push_back(id);
+		}
+		tasks.push_back(std::move(task));
+
+		return id;
+	}
+
+	void SETaskGraph::Execute(SEJobSystem* jobs){
+		jobSystem = jobs;
+		firstError = nullptr;
+		executeStart = Clock::now();
+
+		for (auto& task : tasks){
+			task.pendingDependencies = static_cast<int>(task.dependencies.size());
+		}
+		for (TaskId i = 0; i < tasks.size(); i++){
+			if (tasks[i].pendingDependencies == 0){
+				Schedule(i);
+			}
+		}
+
+		// helps run jobs (and the main thread tasks) until the graph drains.
+		// if a task threw nothing new gets scheduled, so this just waits for whatever was in flight
+		jobSystem->WaitForCounter(&taskCounter);
+
+		wallTime = std::chrono::duration<double, std::milli>(Clock::now() - executeStart).count();
+
+		if (firstError){
+			std::rethrow_exception(firstError);
+		}
+	}
+
+	void SETaskGraph::Schedule(TaskId id){
+		if (tasks[id].mainThreadOnly){
+			jobSystem->RunOnMainThread([this, id] { RunTask(id); }, &taskCounter);
+		}
+		else{
+			jobSystem->Run([this, id] { RunTask(id); }, &taskCounter);
+		}
+	}
+
+	void SETaskGraph::RunTask(TaskId id){
+		Task& task = tasks[id];
+
+		bool skip;
+		{
+			std::lock_guard<std::mutex> lock(graphMutex);
+			skip = firstError != nullptr;
+		}
+
+		task.threadIndex = SEJobSystem::GetCurrentWorkerIndex();
+		task.startTime = std::chrono::duration<double, std::milli>(Clock::now() - executeStart).count();
+		if (!skip){
+			try{
+				task.work();
+			}
+			catch (...){
+				std::lock_guard<std::mutex> lock(graphMutex);
+				if (!firstError){
+					firstError = std::current_exception();
+				}
+			}
+		}
+		task.endTime = std::chrono::duration<double, std::milli>(Clock::now() - executeStart).count();
+
+		// dependents are scheduled before this job finishes, so taskCounter cant hit zero early
+		std::vector<TaskId> ready;
+		{
+			std::lock_guard<std::mutex> lock(graphMutex);
+			if (!firstError){
+				for (TaskId dependent : task.dependents){
+					if (--tasks[dependent].pendingDependencies == 0){
+						ready.push_back(dependent);
+					}
+				}
+			}
+		}
+		for (TaskId dependent : ready){
+			Schedule(dependent);
+		}
+	}
+
+	void SETaskGraph::PrintTimeline(){
+		if (tasks.empty()){
+			return;
+		}
+
+		// longest chain of dependent work, ids are already in topological order
+		std::vector<double> chainTime(tasks.size(), 0.0);
+		std::vector<TaskId> chainParent(tasks.size(), tasks.size());
+		double serialTime = 0.0;
+		TaskId chainEnd = 0;
+
+		for (TaskId i = 0; i < tasks.size(); i++){
+			double duration = tasks[i].endTime - tasks[i].startTime;
+			serialTime += duration;
+
+			for (TaskId dependency : tasks[i].dependencies){
+				if (chainTime[dependency] > chainTime[i]){
+					chainTime[i] = chainTime[dependency];
+					chainParent[i] = dependency;
+				}
+			}
+			chainTime[i] += duration;
+
+			if (chainTime[i] > chainTime[chainEnd]){
+				chainEnd = i;
+			}
+		}
+
+		std::vector<bool> onCriticalPath(tasks.size(), false);
+		for (TaskId i = chainEnd; i < tasks.size(); i = chainParent[i]){
+			onCriticalPath[i] = true;
+		}
+
+		const int barWidth = 50;
+		double scale = wallTime > 0.0 ? barWidth / wallTime : 0.0;
+
+		std::cout << "---- Startup timeline ----" << std::endl;
+		std::cout << std::fixed << std::setprecision(2);
+		for (const auto& task : tasks){
+			int barStart = static_cast<int>(task.startTime * scale);
+			int barLength = std::max(1, static_cast<int>((task.endTime - task.startTime) * scale));
+			barStart = std::min(barStart, barWidth - 1);
+			barLength = std::min(barLength, barWidth - barStart);
+
+			std::string threadName = task.threadIndex == 0 ? "main" : "worker " + std::to_string(task.threadIndex);
+
+			std::cout << (onCriticalPath[&task - tasks.data()] ? "* " : "  ")
+				<< std::left << std::setw(24) << task.name << std::right
+				<< std::setw(9) << task.startTime << " -> " << std::setw(9) << task.endTime << " ms  "
+				<< std::left << std::setw(10) << threadName << std::right
+				<< "|" << std::string(barStart, ' ') << std::string(barLength, '#')
+				<< std::string(barWidth - barStart - barLength, ' ') << "|" << std::endl;
+		}
+		std::cout << "Wall time: " << wallTime << " ms, serial work: " << serialTime
+			<< " ms, critical path (*): " << chainTime[chainEnd] << " ms" << std::endl;
+		std::cout << std::defaultfloat;
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <chrono>
+#include <exception>
+#include <initializer_list>
+#include <string>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "SEJobSystem.h"
+
+namespace ScoobzEngine {
+
+	// a small dependency graph of tasks, independent tasks run concurrently as jobs.
+	// tasks flagged main thread only (anything that talks to GLFW windows) are run by the caller of Execute.
+	class SETaskGraph{
+
+	public:
+		typedef size_t TaskId;
+
+		SETaskGraph();~SETaskGraph();
+
+		//FUNCTIONS :: PUBLIC
+		// dependencies must already be in the graph, so ids are always in topological order
+		TaskId AddTask(const std::string&, std::function<void()>, std::initializer_list<TaskId> = {}, bool = false);
+		void Execute(SEJobSystem*);
+		void PrintTimeline();
+
+	private:
+		typedef std::chrono::high_resolution_clock Clock;
+
+		struct Task{
+			std::string name;
+			std::function<void()> work;
+			std::vector<TaskId> dependencies;
+			std::vector<TaskId> dependents;
+			bool mainThreadOnly;
+			int pendingDependencies;
+
+			// timeline, in ms from the start of Execute
+			double startTime;
+			double endTime;
+			unsigned int threadIndex;
+		};
+
+		void Schedule(TaskId);
+		void RunTask(TaskId);
+
+		std::vector<Task> tasks;
+		std::mutex graphMutex;
+		SEJobCounter taskCounter; // scheduled but not yet finished
+		std::exception_ptr firstError;
+
+		SEJobSystem* jobSystem = nullptr;
+		Clock::time_point executeStart;
+		double wallTime = 0.0;
+	};
+}
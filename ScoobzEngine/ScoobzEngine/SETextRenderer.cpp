@@ -0,0 +1,240 @@
+#include "SETextRenderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace ScoobzEngine {
+
+	// the next codepoint, advancing past it. anything malformed is one U+FFFD for its first byte
+	static uint32_t DecodeUtf8(const char* text, size_t size, size_t& i){
+		uint8_t lead = static_cast<uint8_t>(text[i++]);
+		if (lead < 0x80){
+			return lead;
+		}
+		uint32_t length = lead >= 0xf0 ? 3 : lead >= 0xe0 ? 2 : lead >= 0xc0 ? 1 : 0;
+		if (length == 0 || lead >= 0xf8 || i + length > size){
+			return 0xfffd;
+		}
+		uint32_t codepoint = lead & (0x3f >> length);
+		for (uint32_t j = 0; j < length; j++){
+			uint8_t next = static_cast<uint8_t>(text[i + j]);
+			if ((next & 0xc0) != 0x80){
+				return 0xfffd;
+			}
+			codepoint = codepoint << 6 | (next & 0x3f);
+		}
+		i += length;
+		return codepoint;
+	}
+
+	SETextRenderer::SETextRenderer(){}
+	SETextRenderer::~SETextRenderer(){}
+
+	void SETextRenderer::Load(const std::string& path, float pixelHeight){
+		font.Load(path);
+
+		std::vector<uint32_t> codepoints;
+		for (uint32_t codepoint = 0x20; codepoint < 0x7f; codepoint++){
+			codepoints.push_back(codepoint);
+		}
+		for (uint32_t codepoint = 0xa0; codepoint < 0x100; codepoint++){
+			codepoints.push_back(codepoint);
+		}
+		atlas.Build(&font, pixelHeight, codepoints);
+
+		pageImages.resize(atlas.GetPageCount());
+		for (uint32_t i = 0; i < pageImages.size(); i++){
+			pageImages[i] = i;
+		}
+		layouts.clear();
+	}
+
+	void SETextRenderer::Upload(const VkDevice* logicalDevice, const VkPhysicalDevice* physicalDevice, const VkSurfaceKHR* surface,
+		const VkCommandPool* commandPool, const VkQueue* queue, SEBindlessTable* bindlessTable){
+		uint32_t pageSize = atlas.GetPageSize();
+		for (uint32_t page = 0; page < atlas.GetPageCount(); page++){
+			// white with the coverage as alpha, so the sprite shaders texture times colour blend is all text needs.
+			// a single level, glyphs are drawn at the size they were rasterized and mips would bleed between them
+			const std::vector<uint8_t>& coverage = atlas.GetPage(page);
+			SEMipLevel level;
+			level.width = pageSize;
+			level.height = pageSize;
+			level.data.resize(coverage.size() * 4);
+			for (size_t i = 0; i < coverage.size(); i++){
+				level.data[i * 4 + 0] = 0xff;
+				level.data[i * 4 + 1] = 0xff;
+				level.data[i * 4 + 2] = 0xff;
+				level.data[i * 4 + 3] = coverage[i];
+			}
+
+			SETexture* texture = new SETexture();
+			texture->CreateStreamed(logicalDevice, physicalDevice, surface, commandPool, queue, VK_FORMAT_R8G8B8A8_UNORM, { level }, pageSize);
+			pageTextures.push_back(texture);
+			pageImages[page] = bindlessTable->AddImage(texture->GetView(), texture->GetSampler());
+		}
+
+		std::cout << "Text Renderer Creation: SUCCESSFUL! (" << atlas.GetGlyphCount() << " glyphs, " << atlas.GetPageCount() << " "
+			<< pageSize << "x" << pageSize << " atlas pages)" << std::endl;
+	}
+
+	void SETextRenderer::Cleanup(){
+		for (auto texture : pageTextures){
+			texture->Cleanup();
+			delete texture;
+		}
+		pageTextures.clear();
+	}
+
+	template<typename Emit> glm::vec2 SETextRenderer::LayOut(const char* text, size_t length, Emit emit){
+		// baselines and pens on whole pixels, the glyph bitmaps already start on them
+		float lineHeight = std::round(atlas.GetLineHeight());
+		float baseline = std::round(atlas.GetAscent());
+		float pageSize = static_cast<float>(atlas.GetPageSize());
+		const SEGlyph* space = atlas.GetGlyph(' ');
+		const SEGlyph* fallback = atlas.GetGlyph('?');
+
+		glm::vec2 pen(0.0f, baseline);
+		float width = 0.0f;
+		const SEGlyph* previous = nullptr;
+		for (size_t i = 0; i < length;){
+			uint32_t codepoint = DecodeUtf8(text, length, i);
+			if (codepoint == '\n'){
+				width = std::max(width, pen.x);
+				pen = glm::vec2(0.0f, pen.y + lineHeight);
+				previous = nullptr;
+				continue;
+			}
+			if (codepoint == '\t'){
+				pen.x += space ? space->advance * 4.0f : 0.0f;
+				previous = nullptr;
+				continue;
+			}
+
+			const SEGlyph* glyph = atlas.GetGlyph(codepoint);
+			glyph = glyph ? glyph : fallback;
+			if (!glyph){
+				continue;
+			}
+			if (previous){
+				pen.x += atlas.GetKerning(*previous, *glyph);
+			}
+			if (glyph->width > 0){
+				SETextQuad quad;
+				quad.offset = glm::vec2(std::round(pen.x) + glyph->left, pen.y + glyph->top);
+				quad.size = glm::vec2(glyph->width, glyph->height);
+				quad.uvRect = glm::vec4(glyph->x, glyph->y, glyph->x + glyph->width, glyph->y + glyph->height) / pageSize;
+				quad.page = glyph->page;
+				emit(quad);
+			}
+			pen.x += glyph->advance;
+			previous = glyph;
+		}
+		return glm::vec2(std::max(width, pen.x), pen.y - baseline + lineHeight);
+	}
+
+	const SETextLayout& SETextRenderer::GetLayout(const std::string& text){
+		auto found = layouts.find(text);
+		if (found != layouts.end()){
+			found->second.lastUsed = frameNumber;
+			return found->second.layout;
+		}
+
+		auto start = std::chrono::high_resolution_clock::now();
+		CachedLayout& cached = layouts[text];
+		cached.lastUsed = frameNumber;
+		cached.layout.quads.clear();
+		cached.layout.size = LayOut(text.data(), text.size(), [&cached](const SETextQuad& quad) { cached.layout.quads.push_back(quad); });
+		stats.layoutsBuilt++;
+		stats.layoutMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		return cached.layout;
+	}
+
+	void SETextRenderer::Draw(SESpriteBatch* batch, const std::string& text, const glm::vec2& position, uint32_t color, uint8_t layer){
+		const SETextLayout& layout = GetLayout(text);
+		glm::vec2 origin = glm::floor(position);
+		SESprite sprite;
+		sprite.color = color;
+		sprite.layer = layer;
+		for (const auto& quad : layout.quads){
+			sprite.position = origin + quad.offset + quad.size * 0.5f;
+			sprite.size = quad.size;
+			sprite.uvRect = quad.uvRect;
+			sprite.texture = pageImages[quad.page];
+			batch->Draw(sprite);
+		}
+		stats.strings++;
+		stats.glyphs += layout.quads.size();
+	}
+
+	void SETextRenderer::DrawImmediate(SESpriteBatch* batch, const char* text, const glm::vec2& position, uint32_t color, uint8_t layer){
+		glm::vec2 origin = glm::floor(position);
+		SESprite sprite;
+		sprite.color = color;
+		sprite.layer = layer;
+		uint64_t glyphs = 0;
+		LayOut(text, std::strlen(text), [&](const SETextQuad& quad) {
+			sprite.position = origin + quad.offset + quad.size * 0.5f;
+			sprite.size = quad.size;
+			sprite.uvRect = quad.uvRect;
+			sprite.texture = pageImages[quad.page];
+			batch->Draw(sprite);
+			glyphs++;
+		});
+		stats.strings++;
+		stats.glyphs += glyphs;
+	}
+
+	void SETextRenderer::DrawRect(SESpriteBatch* batch, const glm::vec2& position, const glm::vec2& size, uint32_t color, uint8_t layer){
+		SESprite sprite;
+		sprite.position = position + size * 0.5f;
+		sprite.size = size;
+		sprite.uvRect = atlas.GetSolidUvRect();
+		sprite.color = color;
+		sprite.texture = pageImages[0];
+		sprite.layer = layer;
+		batch->Draw(sprite);
+	}
+
+	glm::vec2 SETextRenderer::Measure(const char* text){
+		return LayOut(text, std::strlen(text), [](const SETextQuad&) {});
+	}
+
+	// strings that change every frame, like counters, would grow the cache forever. once its full everything
+	// that wasnt drawn in the frame just finished goes
+	void SETextRenderer::EndFrame(){
+		if (layouts.size() > SE_TEXT_LAYOUT_CACHE_SIZE){
+			for (auto it = layouts.begin(); it != layouts.end();){
+				if (it->second.lastUsed < frameNumber){
+					it = layouts.erase(it);
+					stats.layoutsEvicted++;
+				}
+				else{
+					++it;
+				}
+			}
+		}
+		frameNumber++;
+		stats.frames++;
+	}
+
+	void SETextRenderer::PrintStats(){
+		if (stats.frames == 0){
+			return;
+		}
+		float occupancy = 0.0f;
+		for (uint32_t page = 0; page < atlas.GetPageCount(); page++){
+			occupancy += atlas.GetPageOccupancy(page) / atlas.GetPageCount();
+		}
+		std::cout << "---- Text ----" << std::endl;
+		std::cout << std::fixed << std::setprecision(2);
+		std::cout << "Atlas: " << atlas.GetGlyphCount() << " glyphs in " << atlas.GetPageCount() << " pages, " << occupancy * 100.0f << "% packed" << std::endl;
+		std::cout << "Drawn: " << static_cast<double>(stats.strings) / stats.frames << " strings, "
+			<< static_cast<double>(stats.glyphs) / stats.frames << " glyphs per frame" << std::endl;
+		std::cout << "Layouts: " << stats.layoutsBuilt << " built, " << stats.layoutsEvicted << " evicted, " << layouts.size() << " cached, "
+			<< (stats.layoutsBuilt ? stats.layoutMs * 1000.0 / stats.layoutsBuilt : 0.0) << " us a build" << std::endl;
+		std::cout << std::defaultfloat;
+	}
+}
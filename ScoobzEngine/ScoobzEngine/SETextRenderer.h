@@ -0,0 +1,98 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "SEBindlessTable.h"
+#include "SEFont.h"
+#include "SEGlyphAtlas.h"
+#include "SESpriteBatch.h"
+#include "SETexture.h"
+
+namespace ScoobzEngine {
+
+	// the sprite layer text goes on unless told otherwise, over every other sprite
+	const uint8_t SE_TEXT_LAYER = 255;
+	// layouts kept before the ones that werent drawn last frame are dropped
+	const uint32_t SE_TEXT_LAYOUT_CACHE_SIZE = 1024;
+
+	// one glyph of a laid out string, relative to the top left of its first line
+	struct SETextQuad{
+		glm::vec2 offset;
+		glm::vec2 size;
+		glm::vec4 uvRect; // in the atlas page
+		uint32_t page;
+	};
+
+	struct SETextLayout{
+		std::vector<SETextQuad> quads;
+		glm::vec2 size; // widest line by every line
+	};
+
+	struct SETextStats{
+		uint64_t frames;
+		uint64_t strings; // summed over every frame
+		uint64_t glyphs;
+		uint64_t layoutsBuilt; // cache misses
+		uint64_t layoutsEvicted;
+		double layoutMs; // building the missed layouts
+	};
+
+	// draws text as sprites out of a glyph atlas. the font is rasterized once at load time and each atlas page is a
+	// bindless image, so text goes through the sprite batch like anything else and everything on one layer costs
+	// a draw per page. a string is laid out the first time its drawn and the glyph quads are cached under it, later
+	// draws of the same string only copy them into the batch. text that changes every frame can skip the cache and
+	// go straight into the batch, which allocates nothing
+	class SETextRenderer{
+
+	public:
+		SETextRenderer();~SETextRenderer();
+
+		//FUNCTIONS :: PUBLIC
+		// font file and pixels from ascent to descent. rasterizes printable ASCII and Latin-1, throws if the font
+		// cant be read. text can be laid out from here on
+		void Load(const std::string&, float);
+		// the atlas pages as bindless images, blocks until theyre uploaded. text can be drawn from here on
+		void Upload(const VkDevice*, const VkPhysicalDevice*, const VkSurfaceKHR*, const VkCommandPool*, const VkQueue*, SEBindlessTable*);
+		void Cleanup();
+		// UTF-8, a new line for each \n and tabs 4 spaces wide. codepoints missing from the atlas come out as ?
+		const SETextLayout& GetLayout(const std::string&);
+		// main thread only. the top left of the first line in the batches view and an RGBA8 colour, red in the low byte.
+		// the position is snapped to whole pixels so the glyphs sample the atlas exactly
+		void Draw(SESpriteBatch*, const std::string&, const glm::vec2&, uint32_t = 0xffffffff, uint8_t = SE_TEXT_LAYER);
+		// the same without the cache, laid out glyph by glyph into the batch every call
+		void DrawImmediate(SESpriteBatch*, const char*, const glm::vec2&, uint32_t = 0xffffffff, uint8_t = SE_TEXT_LAYER);
+		// a solid rectangle, top left and size, out of the atlas so it batches with the text on its layer
+		void DrawRect(SESpriteBatch*, const glm::vec2&, const glm::vec2&, uint32_t, uint8_t = SE_TEXT_LAYER);
+		// the size Draw would cover, without laying anything out into the cache
+		glm::vec2 Measure(const char*);
+		// once a frame, trims the layout cache when its full
+		void EndFrame();
+		void PrintStats();
+
+		//Getters
+		const SEGlyphAtlas& GetAtlas() { return atlas; }
+		float GetLineHeight() { return atlas.GetLineHeight(); }
+		uint32_t GetCachedLayoutCount() { return static_cast<uint32_t>(layouts.size()); }
+		SETextStats GetStats() { return stats; }
+
+	private:
+		struct CachedLayout{
+			SETextLayout layout;
+			uint64_t lastUsed; // frame number
+		};
+
+		// hands each glyph quad of the text to the callback in order, returns the size of the whole block
+		template<typename Emit> glm::vec2 LayOut(const char*, size_t, Emit);
+
+		SEFont font;
+		SEGlyphAtlas atlas;
+		std::vector<SETexture*> pageTextures;
+		std::vector<uint32_t> pageImages; // bindless index of each page, the page number until uploaded
+		std::unordered_map<std::string, CachedLayout> layouts;
+		uint64_t frameNumber = 0;
+
+		SETextStats stats = {};
+	};
+}
@@ -0,0 +1,442 @@
+#include "SETexture.h"
+#include <algorithm>
+#include <cstring>
+
+namespace ScoobzEngine{
+
+	uint32_t GetMipCount(uint32_t width, uint32_t height){
+		uint32_t count = 1;
+		uint32_t size = std::max(width, height);
+		while (size > 1){
+			size >>= 1;
+			count++;
+		}
+		return count;
+	}
+
+	std::vector<SEMipLevel> GenerateMipChain(const uint8_t* pixels, uint32_t width, uint32_t height){
+		std::vector<SEMipLevel> chain(GetMipCount(width, height));
+		chain[0].width = width;
+		chain[0].height = height;
+		chain[0].data.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+
+		for (size_t i = 1; i < chain.size(); i++){
+			const SEMipLevel& source = chain[i - 1];
+			SEMipLevel& level = chain[i];
+			level.width = std::max(source.width >> 1, 1u);
+			level.height = std::max(source.height >> 1, 1u);
+			level.data.resize(static_cast<size_t>(level.width) * level.height * 4);
+
+			for (uint32_t y = 0; y < level.height; y++){
+				// the last row or column picks up the odd one out
+				uint32_t y0 = std::min(y * 2, source.height - 1);
+				uint32_t y1 = (y == level.height - 1) ? source.height - 1 : y * 2 + 1;
+				for (uint32_t x = 0; x < level.width; x++){
+					uint32_t x0 = std::min(x * 2, source.width - 1);
+					uint32_t x1 = (x == level.width - 1) ? source.width - 1 : x * 2 + 1;
+
+					uint32_t sum[4] = { 0, 0, 0, 0 };
+					for (uint32_t sy = y0; sy <= y1; sy++){
+						const uint8_t* row = &source.data[(static_cast<size_t>(sy) * source.width) * 4];
+						for (uint32_t sx = x0; sx <= x1; sx++){
+							for (uint32_t c = 0; c < 4; c++){
+								sum[c] += row[sx * 4 + c];
+							}
+						}
+					}
+
+					uint32_t taps = (y1 - y0 + 1) * (x1 - x0 + 1);
+					uint8_t* texel = &level.data[(static_cast<size_t>(y) * level.width + x) * 4];
+					for (uint32_t c = 0; c < 4; c++){
+						texel[c] = static_cast<uint8_t>((sum[c] + taps / 2) / taps);
+					}
+				}
+			}
+		}
+		return chain;
+	}
+
+	SETexture::SETexture(){}
+	SETexture::~SETexture(){}
+
+	void SETexture::Init(const VkDevice* logicalDevice, const VkPhysicalDevice* physical, const VkSurfaceKHR* windowSurface,
+		const VkCommandPool* pool, const VkQueue* submitQueue, VkFormat imageFormat){
+		device = logicalDevice;
+		physicalDevice = physical;
+		surface = windowSurface;
+		commandPool = pool;
+		queue = submitQueue;
+		format = imageFormat;
+	}
+
+	void SETexture::Create(const VkDevice* logicalDevice, const VkPhysicalDevice* physical, const VkSurfaceKHR* windowSurface,
+		const VkCommandPool* pool, const VkQueue* submitQueue, uint32_t width, uint32_t height, const void* pixels, VkFormat imageFormat){
+		Init(logicalDevice, physical, windowSurface, pool, submitQueue, imageFormat);
+
+		bool blit = CanBlit();
+		if (blit){
+			// only the sizes are kept, the pixels never leave the GPU
+			levels.resize(ScoobzEngine::GetMipCount(width, height));
+			for (uint32_t i = 0; i < levels.size(); i++){
+				levels[i].width = std::max(width >> i, 1u);
+				levels[i].height = std::max(height >> i, 1u);
+			}
+			GenerateMipsByBlit(pixels, width, height);
+		}
+		else{
+			levels = GenerateMipChain(static_cast<const uint8_t*>(pixels), width, height);
+			UploadLevels(0);
+		}
+		CreateSampler(GetMipCount());
+
+		std::cout << "Texture Creation: SUCCESSFUL! (" << width << "x" << height << ", " << GetMipCount() << " mips"
+			<< (blit ? ", blitted)" : ", CPU mips)") << std::endl;
+	}
+
+	void SETexture::CreateStreamed(const VkDevice* logicalDevice, const VkPhysicalDevice* physical, const VkSurfaceKHR* windowSurface,
+		const VkCommandPool* pool, const VkQueue* submitQueue, VkFormat imageFormat, std::vector<SEMipLevel> chain, uint32_t initialSize){
+		if (chain.empty()){
+			throw std::runtime_error("Streamed texture has no mip levels");
+		}
+		Init(logicalDevice, physical, windowSurface, pool, submitQueue, imageFormat);
+		levels = std::move(chain);
+
+		uint32_t firstMip = static_cast<uint32_t>(levels.size()) - 1;
+		while (firstMip > 0 && levels[firstMip - 1].width <= initialSize && levels[firstMip - 1].height <= initialSize){
+			firstMip--;
+		}
+		UploadLevels(firstMip);
+		CreateSampler(GetMipCount());
+
+		std::cout << "Streamed Texture Creation: SUCCESSFUL! (" << levels[0].width << "x" << levels[0].height << ", "
+			<< GetResidentWidth() << "x" << GetResidentHeight() << " resident)" << std::endl;
+	}
+
+	void SETexture::Cleanup(){
+		DestroyResidency(resident);
+		vkDestroySampler(*device, sampler, VK_NULL_HANDLE);
+		sampler = VK_NULL_HANDLE;
+	}
+
+	bool SETexture::CanBlit(){
+		VkFormatProperties formatProperties;
+		vkGetPhysicalDeviceFormatProperties(*physicalDevice, format, &formatProperties);
+		const VkFormatFeatureFlags needed = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+		return (formatProperties.optimalTilingFeatures & needed) == needed;
+	}
+
+	SETexture::Residency SETexture::CreateResidency(uint32_t firstMip){
+		Residency residency;
+		residency.firstMip = firstMip;
+		uint32_t mipLevels = static_cast<uint32_t>(levels.size()) - firstMip;
+
+		// transfer source as well so the next, bigger image can copy these levels out of it
+		VkImageCreateInfo imageInfo = {};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = format;
+		imageInfo.extent.width = levels[firstMip].width;
+		imageInfo.extent.height = levels[firstMip].height;
+		imageInfo.extent.depth = 1;
+		imageInfo.mipLevels = mipLevels;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		if (vkCreateImage(*device, &imageInfo, nullptr, &residency.image) != VK_SUCCESS){
+			throw std::runtime_error("Failed to create texture image");
+		}
+
+		VkMemoryRequirements memRequirements;
+		vkGetImageMemoryRequirements(*device, residency.image, &memRequirements);
+
+		VkMemoryAllocateInfo allocateInfo = {};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocateInfo.allocationSize = memRequirements.size;
+		allocateInfo.memoryTypeIndex = findMemoryType(*physicalDevice, memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		if (AllocateMemory(*device, &allocateInfo, &residency.memory) != VK_SUCCESS){
+			throw std::runtime_error("Failed to allocate texture memory");
+		}
+		vkBindImageMemory(*device, residency.image, residency.memory, 0);
+
+		VkImageViewCreateInfo viewInfo = {};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = residency.image;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = format;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.baseMipLevel = 0;
+		viewInfo.subresourceRange.levelCount = mipLevels;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+
+		if (vkCreateImageView(*device, &viewInfo, nullptr, &residency.view) != VK_SUCCESS){
+			throw std::runtime_error("Failed to create texture image view");
+		}
+		return residency;
+	}
+
+	void SETexture::DestroyResidency(Residency& residency){
+		vkDestroyImageView(*device, residency.view, VK_NULL_HANDLE);
+		vkDestroyImage(*device, residency.image, VK_NULL_HANDLE);
+		FreeMemory(*device, residency.memory);
+		residency = Residency();
+	}
+
+	// lod is measured from whatever the view starts at, so one sampler works for every residency
+	void SETexture::CreateSampler(uint32_t mipCount){
+		VkSamplerCreateInfo samplerInfo = {};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_LINEAR;
+		samplerInfo.minFilter = VK_FILTER_LINEAR;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		samplerInfo.anisotropyEnable = VK_FALSE;
+		samplerInfo.maxAnisotropy = 1.0f;
+		samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+		samplerInfo.unnormalizedCoordinates = VK_FALSE;
+		samplerInfo.compareEnable = VK_FALSE;
+		samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = static_cast<float>(mipCount);
+		samplerInfo.mipLodBias = 0.0f;
+
+		if (vkCreateSampler(*device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS){
+			throw std::runtime_error("Failed to create texture sampler");
+		}
+	}
+
+	void SETexture::CreateStaging(const void* source, VkDeviceSize size, VkBuffer& stagingBuffer, VkDeviceMemory& stagingMemory){
+		CreateBuffer(device, physicalDevice, surface, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingMemory);
+
+		void* data;
+		vkMapMemory(*device, stagingMemory, 0, size, 0, &data);
+		memcpy(data, source, static_cast<size_t>(size));
+		vkUnmapMemory(*device, stagingMemory);
+	}
+
+	// every level from firstMip down in one staging buffer and one submit
+	void SETexture::UploadLevels(uint32_t firstMip){
+		// offsets stay a multiple of the largest block size so compressed levels can share the buffer
+		std::vector<VkDeviceSize> offsets;
+		VkDeviceSize size = 0;
+		for (uint32_t i = firstMip; i < levels.size(); i++){
+			size = (size + 15) & ~VkDeviceSize(15);
+			offsets.push_back(size);
+			size += levels[i].data.size();
+		}
+
+		std::vector<uint8_t> packed(static_cast<size_t>(size));
+		for (uint32_t i = firstMip; i < levels.size(); i++){
+			memcpy(packed.data() + offsets[i - firstMip], levels[i].data.data(), levels[i].data.size());
+		}
+
+		VkBuffer stagingBuffer;
+		VkDeviceMemory stagingMemory;
+		CreateStaging(packed.data(), size, stagingBuffer, stagingMemory);
+
+		resident = CreateResidency(firstMip);
+		residentMip = firstMip;
+		uint32_t mipLevels = static_cast<uint32_t>(levels.size()) - firstMip;
+
+		std::vector<VkBufferImageCopy> regions(mipLevels);
+		for (uint32_t i = 0; i < mipLevels; i++){
+			regions[i] = {};
+			regions[i].bufferOffset = offsets[i];
+			regions[i].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			regions[i].imageSubresource.mipLevel = i;
+			regions[i].imageSubresource.baseArrayLayer = 0;
+			regions[i].imageSubresource.layerCount = 1;
+			regions[i].imageExtent = { levels[firstMip + i].width, levels[firstMip + i].height, 1 };
+		}
+
+		VkCommandBuffer commandBuffer = BeginCommands();
+		Transition(commandBuffer, resident.image, 0, mipLevels, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+		vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, resident.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			mipLevels, regions.data());
+		Transition(commandBuffer, resident.image, 0, mipLevels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+		EndCommands(commandBuffer);
+
+		CleanupBuffer(device, stagingBuffer, stagingMemory);
+
+		// resident levels only live on the GPU from here, streaming copies them across image to image
+		for (uint32_t i = firstMip; i < levels.size(); i++){
+			std::vector<uint8_t>().swap(levels[i].data);
+		}
+	}
+
+	// each level is a linear blit of the one above, which is moved to shader read as soon as its been read from
+	void SETexture::GenerateMipsByBlit(const void* pixels, uint32_t width, uint32_t height){
+		VkBuffer stagingBuffer;
+		VkDeviceMemory stagingMemory;
+		CreateStaging(pixels, static_cast<VkDeviceSize>(width) * height * 4, stagingBuffer, stagingMemory);
+
+		resident = CreateResidency(0);
+		residentMip = 0;
+		uint32_t mipLevels = GetMipCount();
+
+		VkCommandBuffer commandBuffer = BeginCommands();
+		Transition(commandBuffer, resident.image, 0, mipLevels, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+		VkBufferImageCopy region = {};
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = 0;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent = { width, height, 1 };
+		vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, resident.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+		for (uint32_t i = 1; i < mipLevels; i++){
+			Transition(commandBuffer, resident.image, i - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+			VkImageBlit blit = {};
+			blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			blit.srcSubresource.mipLevel = i - 1;
+			blit.srcSubresource.baseArrayLayer = 0;
+			blit.srcSubresource.layerCount = 1;
+			blit.srcOffsets[1] = { static_cast<int32_t>(levels[i - 1].width), static_cast<int32_t>(levels[i - 1].height), 1 };
+			blit.dstSubresource = blit.srcSubresource;
+			blit.dstSubresource.mipLevel = i;
+			blit.dstOffsets[1] = { static_cast<int32_t>(levels[i].width), static_cast<int32_t>(levels[i].height), 1 };
+			vkCmdBlitImage(commandBuffer, resident.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, resident.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				1, &blit, VK_FILTER_LINEAR);
+
+			Transition(commandBuffer, resident.image, i - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+		}
+		Transition(commandBuffer, resident.image, mipLevels - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+		EndCommands(commandBuffer);
+
+		CleanupBuffer(device, stagingBuffer, stagingMemory);
+	}
+
+	bool SETexture::StreamNextMip(VkCommandBuffer commandBuffer, SEDeletionQueue* deletionQueue){
+		if (residentMip == 0){
+			return false;
+		}
+
+		uint32_t mip = residentMip - 1;
+		SEMipLevel& level = levels[mip];
+
+		VkBuffer stagingBuffer;
+		VkDeviceMemory stagingMemory;
+		CreateStaging(level.data.data(), level.data.size(), stagingBuffer, stagingMemory);
+
+		Residency next = CreateResidency(mip);
+		uint32_t nextLevels = static_cast<uint32_t>(levels.size()) - mip;
+		uint32_t oldLevels = nextLevels - 1;
+
+		// earlier frames may still be sampling the old image, the barrier waits on their shader reads
+		Transition(commandBuffer, next.image, 0, nextLevels, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+		Transition(commandBuffer, resident.image, 0, oldLevels, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+		// the old images level i is the new ones level i + 1
+		std::vector<VkImageCopy> copies(oldLevels);
+		for (uint32_t i = 0; i < oldLevels; i++){
+			copies[i] = {};
+			copies[i].srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			copies[i].srcSubresource.mipLevel = i;
+			copies[i].srcSubresource.baseArrayLayer = 0;
+			copies[i].srcSubresource.layerCount = 1;
+			copies[i].dstSubresource = copies[i].srcSubresource;
+			copies[i].dstSubresource.mipLevel = i + 1;
+			copies[i].extent = { levels[mip + 1 + i].width, levels[mip + 1 + i].height, 1 };
+		}
+		vkCmdCopyImage(commandBuffer, resident.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, next.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			oldLevels, copies.data());
+
+		VkBufferImageCopy region = {};
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = 0;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent = { level.width, level.height, 1 };
+		vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, next.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+		Transition(commandBuffer, next.image, 0, nextLevels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+		// descriptors for this frame and the next can still point at the old view, so it goes back to being sampleable
+		Transition(commandBuffer, resident.image, 0, oldLevels, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+		Residency retired = resident;
+		deletionQueue->Push([this, retired, stagingBuffer, stagingMemory]() mutable {
+			DestroyResidency(retired);
+			CleanupBuffer(device, stagingBuffer, stagingMemory);
+		});
+
+		resident = next;
+		residentMip = mip;
+		std::vector<uint8_t>().swap(level.data);
+		return true;
+	}
+
+	VkCommandBuffer SETexture::BeginCommands(){
+		VkCommandBufferAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = *commandPool;
+		allocInfo.commandBufferCount = 1;
+		VkCommandBuffer commandBuffer;
+		vkAllocateCommandBuffers(*device, &allocInfo, &commandBuffer);
+
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		return commandBuffer;
+	}
+
+	void SETexture::EndCommands(VkCommandBuffer commandBuffer){
+		vkEndCommandBuffer(commandBuffer);
+
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+		vkQueueSubmit(*queue, 1, &submitInfo, VK_NULL_HANDLE);
+		vkQueueWaitIdle(*queue);
+
+		vkFreeCommandBuffers(*device, *commandPool, 1, &commandBuffer);
+	}
+
+	void SETexture::Transition(VkCommandBuffer commandBuffer, VkImage image, uint32_t baseMip, uint32_t mipCount, VkImageLayout oldLayout,
+		VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage){
+		VkImageMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = baseMip;
+		barrier.subresourceRange.levelCount = mipCount;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstAccessMask = dstAccess;
+
+		vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "SEBuffer.h"
+#include "SEDeletionQueue.h"
+#include <cstdint>
+#include <vector>
+
+namespace ScoobzEngine{
+
+	// one level of a mip chain as it sits on the CPU. width and height are in texels, data is whatever the format
+	// packs them into, so block compressed levels work the same as plain ones
+	struct SEMipLevel{
+		uint32_t width;
+		uint32_t height;
+		std::vector<uint8_t> data;
+	};
+
+	// levels down to 1x1 for an image this size
+	uint32_t GetMipCount(uint32_t, uint32_t);
+	// a full chain from rgba8 pixels, finest first. each level is a 2x2 box filter of the one above, an odd edge
+	// folds its last texel into the previous one so nothing is dropped
+	std::vector<SEMipLevel> GenerateMipChain(const uint8_t*, uint32_t, uint32_t);
+
+	// a sampled image with its view and sampler.
+	// a streamed texture only ever holds the levels that are resident, from its residents mip down to 1x1. streaming
+	// the next finer level in allocates an image one level bigger, copies the resident levels across on the GPU,
+	// uploads the new one on top and retires the old image, so memory for levels that arent resident is never committed
+	class SETexture : public SEBuffer{
+
+	public:
+		SETexture();~SETexture();
+
+		//FUNCTIONS :: PUBLIC
+		// rgba8 pixels, uploaded whole. the mip chain is blitted on the GPU, or built on the CPU when the format cant be
+		// linearly blitted on this device. blocks until the upload is done
+		void Create(const VkDevice*, const VkPhysicalDevice*, const VkSurfaceKHR*, const VkCommandPool*, const VkQueue*,
+			uint32_t, uint32_t, const void*, VkFormat = VK_FORMAT_R8G8B8A8_UNORM);
+		// a prebuilt chain, finest first. only the levels no bigger than the last argument in either direction are
+		// uploaded now, always at least the 1x1 one, so the texture is usable straight away at low resolution
+		void CreateStreamed(const VkDevice*, const VkPhysicalDevice*, const VkSurfaceKHR*, const VkCommandPool*, const VkQueue*,
+			VkFormat, std::vector<SEMipLevel>, uint32_t);
+		// records bringing in the next finer level. the view changes, whoever points at the old one has to be moved
+		// over before the frames in flight are done with it. returns false once every level is resident
+		bool StreamNextMip(VkCommandBuffer, SEDeletionQueue*);
+		void Cleanup();
+
+		//Getters
+		VkImageView GetView() { return resident.view; }
+		VkSampler GetSampler() { return sampler; }
+		VkFormat GetFormat() { return format; }
+		uint32_t GetMipCount() { return static_cast<uint32_t>(levels.size()); }
+		// the finest level resident, 0 once fully streamed in
+		uint32_t GetResidentMip() { return residentMip; }
+		bool IsFullyResident() { return residentMip == 0; }
+		uint32_t GetResidentWidth() { return levels[residentMip].width; }
+		uint32_t GetResidentHeight() { return levels[residentMip].height; }
+		// bytes the next StreamNextMip uploads, 0 when theres nothing left to stream
+		VkDeviceSize GetNextMipSize() { return residentMip > 0 ? levels[residentMip - 1].data.size() : 0; }
+
+	private:
+		// an image holding levels firstMip down to 1x1, and the only memory this texture has committed
+		struct Residency{
+			VkImage image = VK_NULL_HANDLE;
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkImageView view = VK_NULL_HANDLE;
+			uint32_t firstMip = 0;
+		};
+
+		void Init(const VkDevice*, const VkPhysicalDevice*, const VkSurfaceKHR*, const VkCommandPool*, const VkQueue*, VkFormat);
+		Residency CreateResidency(uint32_t);
+		void DestroyResidency(Residency&);
+		void CreateSampler(uint32_t);
+		void CreateStaging(const void*, VkDeviceSize, VkBuffer&, VkDeviceMemory&);
+		void UploadLevels(uint32_t);
+		void GenerateMipsByBlit(const void*, uint32_t, uint32_t);
+		bool CanBlit();
+		VkCommandBuffer BeginCommands();
+		void EndCommands(VkCommandBuffer);
+		static void Transition(VkCommandBuffer, VkImage, uint32_t, uint32_t, VkImageLayout, VkImageLayout,
+			VkAccessFlags, VkAccessFlags, VkPipelineStageFlags, VkPipelineStageFlags);
+
+		const VkDevice* device = nullptr;
+		const VkPhysicalDevice* physicalDevice = nullptr;
+		const VkSurfaceKHR* surface = nullptr;
+		const VkCommandPool* commandPool = nullptr;
+		const VkQueue* queue = nullptr;
+
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		std::vector<SEMipLevel> levels; // the whole chain, levels finer than residentMip are waiting to be streamed
+		uint32_t residentMip = 0;
+		Residency resident;
+		VkSampler sampler = VK_NULL_HANDLE;
+	};
+}
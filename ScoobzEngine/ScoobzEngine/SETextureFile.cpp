@@ -0,0 +1,208 @@
+#include "SETextureFile.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace ScoobzEngine {
+
+	// DDS layout, see the DirectX docs for DDS_HEADER and DDS_HEADER_DXT10
+	static const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+	static const uint32_t DDS_FOURCC = 0x4;
+	static const uint32_t DDSD_FLAGS = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // caps, height, width, pixel format, mip count, linear size
+	static const uint32_t DDSCAPS_TEXTURE_MIPMAP = 0x1000 | 0x400000 | 0x8;
+	static const uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+	static uint32_t FourCC(char a, char b, char c, char d){
+		return static_cast<uint32_t>(a) | static_cast<uint32_t>(b) << 8 | static_cast<uint32_t>(c) << 16 | static_cast<uint32_t>(d) << 24;
+	}
+
+	struct DDSPixelFormat{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t fourCC;
+		uint32_t rgbBitCount;
+		uint32_t masks[4];
+	};
+
+	struct DDSHeader{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t height;
+		uint32_t width;
+		uint32_t pitchOrLinearSize;
+		uint32_t depth;
+		uint32_t mipMapCount;
+		uint32_t reserved1[11];
+		DDSPixelFormat pixelFormat;
+		uint32_t caps[4];
+		uint32_t reserved2;
+	};
+
+	struct DDSHeaderDX10{
+		uint32_t dxgiFormat;
+		uint32_t resourceDimension;
+		uint32_t miscFlag;
+		uint32_t arraySize;
+		uint32_t miscFlags2;
+	};
+
+	static_assert(sizeof(DDSHeader) == 124, "DDS header has to match the file layout");
+	static_assert(sizeof(DDSHeaderDX10) == 20, "DX10 header has to match the file layout");
+
+	// DXGI_FORMAT values, unorm then srgb
+	struct DXGIMapping{
+		SEBlockFormat format;
+		uint32_t unorm;
+		uint32_t srgb;
+	};
+
+	static const DXGIMapping dxgiFormats[] = {
+		{ SE_BLOCK_RGBA8, 28, 29 },
+		{ SE_BLOCK_BC1, 71, 72 },
+		{ SE_BLOCK_BC3, 77, 78 },
+		{ SE_BLOCK_BC5, 83, 0 },
+		{ SE_BLOCK_BC7, 98, 99 },
+	};
+
+	SETextureFile CompressTexture(const uint8_t* pixels, uint32_t width, uint32_t height, SEBlockFormat format, bool srgb, SEJobSystem* jobSystem){
+		SETextureFile file;
+		file.format = format;
+		file.srgb = srgb;
+		file.levels = GenerateMipChain(pixels, width, height);
+		for (auto& level : file.levels){
+			level.data = CompressImage(format, level.data.data(), level.width, level.height, jobSystem);
+		}
+		return file;
+	}
+
+	void SaveTextureFile(const std::string& path, const SETextureFile& file){
+		if (file.levels.empty()){
+			throw std::runtime_error("Texture has no levels to save");
+		}
+
+		uint32_t dxgiFormat = 0;
+		for (const auto& mapping : dxgiFormats){
+			if (mapping.format == file.format){
+				dxgiFormat = file.srgb ? mapping.srgb : mapping.unorm;
+			}
+		}
+		if (dxgiFormat == 0){
+			throw std::runtime_error(std::string(GetBlockFormatName(file.format)) + " has no srgb variant");
+		}
+
+		DDSHeader header = {};
+		header.size = sizeof(DDSHeader);
+		header.flags = DDSD_FLAGS;
+		header.width = file.levels[0].width;
+		header.height = file.levels[0].height;
+		header.pitchOrLinearSize = static_cast<uint32_t>(file.levels[0].data.size());
+		header.depth = 1;
+		header.mipMapCount = static_cast<uint32_t>(file.levels.size());
+		header.pixelFormat.size = sizeof(DDSPixelFormat);
+		header.pixelFormat.flags = DDS_FOURCC;
+		header.pixelFormat.fourCC = FourCC('D', 'X', '1', '0');
+		header.caps[0] = DDSCAPS_TEXTURE_MIPMAP;
+
+		DDSHeaderDX10 headerDX10 = {};
+		headerDX10.dxgiFormat = dxgiFormat;
+		headerDX10.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+		headerDX10.arraySize = 1;
+
+		std::ofstream stream(path, std::ios::binary);
+		if (!stream.is_open()){
+			throw std::runtime_error("Failed to open " + path + " for writing");
+		}
+		stream.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		stream.write(reinterpret_cast<const char*>(&headerDX10), sizeof(headerDX10));
+		for (const auto& level : file.levels){
+			stream.write(reinterpret_cast<const char*>(level.data.data()), level.data.size());
+		}
+		if (!stream){
+			throw std::runtime_error("Failed to write " + path);
+		}
+	}
+
+	SETextureFile LoadTextureFile(const std::string& path){
+		std::ifstream stream(path, std::ios::binary);
+		if (!stream.is_open()){
+			throw std::runtime_error("Failed to open " + path);
+		}
+
+		uint32_t magic = 0;
+		DDSHeader header = {};
+		stream.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+		stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+		if (!stream || magic != DDS_MAGIC || header.size != sizeof(DDSHeader)){
+			throw std::runtime_error(path + " isnt a DDS file");
+		}
+
+		SETextureFile file;
+		bool known = false;
+		if (header.pixelFormat.flags & DDS_FOURCC){
+			uint32_t fourCC = header.pixelFormat.fourCC;
+			if (fourCC == FourCC('D', 'X', '1', '0')){
+				DDSHeaderDX10 headerDX10 = {};
+				stream.read(reinterpret_cast<char*>(&headerDX10), sizeof(headerDX10));
+				if (headerDX10.resourceDimension != DDS_DIMENSION_TEXTURE2D || headerDX10.arraySize > 1){
+					throw std::runtime_error(path + " isnt a single 2D texture");
+				}
+				for (const auto& mapping : dxgiFormats){
+					if (headerDX10.dxgiFormat == mapping.unorm || (mapping.srgb != 0 && headerDX10.dxgiFormat == mapping.srgb)){
+						file.format = mapping.format;
+						file.srgb = headerDX10.dxgiFormat == mapping.srgb;
+						known = true;
+					}
+				}
+			}
+			else if (fourCC == FourCC('D', 'X', 'T', '1')){
+				file.format = SE_BLOCK_BC1;
+				known = true;
+			}
+			else if (fourCC == FourCC('D', 'X', 'T', '5')){
+				file.format = SE_BLOCK_BC3;
+				known = true;
+			}
+			else if (fourCC == FourCC('A', 'T', 'I', '2') || fourCC == FourCC('B', 'C', '5', 'U')){
+				file.format = SE_BLOCK_BC5;
+				known = true;
+			}
+		}
+		if (!known){
+			throw std::runtime_error(path + " is in a format the loader doesnt handle");
+		}
+
+		uint32_t mipCount = (header.flags & 0x20000) ? std::max(header.mipMapCount, 1u) : 1u;
+		mipCount = std::min(mipCount, GetMipCount(header.width, header.height));
+		file.levels.resize(mipCount);
+		for (uint32_t i = 0; i < mipCount; i++){
+			SEMipLevel& level = file.levels[i];
+			level.width = std::max(header.width >> i, 1u);
+			level.height = std::max(header.height >> i, 1u);
+			level.data.resize(GetLevelSize(file.format, level.width, level.height));
+			stream.read(reinterpret_cast<char*>(level.data.data()), level.data.size());
+		}
+		if (!stream){
+			throw std::runtime_error(path + " is truncated");
+		}
+
+		std::cout << "Loaded " << path << " (" << header.width << "x" << header.height << ", " << mipCount << " mips, "
+			<< GetBlockFormatName(file.format) << ")" << std::endl;
+		return file;
+	}
+
+	VkFormat PrepareTextureFile(VkPhysicalDevice physicalDevice, SETextureFile& file){
+		if (IsBlockFormatSupported(physicalDevice, file.format, file.srgb)){
+			return GetBlockVkFormat(file.format, file.srgb);
+		}
+
+		// everything samples rgba8, so thats the way out when the blocks cant be used as they are
+		std::cout << GetBlockFormatName(file.format) << " isnt supported on this device, decoding to RGBA8" << std::endl;
+		for (auto& level : file.levels){
+			level.data = DecompressImage(file.format, level.data.data(), level.width, level.height);
+		}
+		file.format = SE_BLOCK_RGBA8;
+		return GetBlockVkFormat(SE_BLOCK_RGBA8, file.srgb);
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "SEBlockCompress.h"
+#include "SETexture.h"
+#include <string>
+
+namespace ScoobzEngine {
+
+	// a texture as stored on disk, every level already in its final format. files are DDS with the DX10 header,
+	// which any DirectX tool can read and write. loading also takes the legacy DXT1, DXT5 and ATI2 headers
+	struct SETextureFile{
+		SEBlockFormat format = SE_BLOCK_RGBA8;
+		bool srgb = false;
+		std::vector<SEMipLevel> levels; // finest first
+	};
+
+	// import time: builds the full mip chain from rgba8 pixels and compresses every level
+	SETextureFile CompressTexture(const uint8_t*, uint32_t, uint32_t, SEBlockFormat, bool, SEJobSystem* = nullptr);
+	void SaveTextureFile(const std::string&, const SETextureFile&);
+	SETextureFile LoadTextureFile(const std::string&);
+	// gets the levels ready for the device. a format it cant sample is decoded to rgba8 on the CPU.
+	// returns the format to create the image with
+	VkFormat PrepareTextureFile(VkPhysicalDevice, SETextureFile&);
+}
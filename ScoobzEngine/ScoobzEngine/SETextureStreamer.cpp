@@ -0,0 +1,58 @@
+#include "SETextureStreamer.h"
+
+namespace ScoobzEngine{
+
+	SETextureStreamer::SETextureStreamer(){}
+	SETextureStreamer::~SETextureStreamer(){}
+
+	void SETextureStreamer::Create(SEBindlessTable* table, VkDeviceSize bytesPerFrame){
+		bindlessTable = table;
+		budget = bytesPerFrame;
+	}
+
+	uint32_t SETextureStreamer::Add(SETexture* texture){
+		uint32_t index = bindlessTable->AddImage(texture->GetView(), texture->GetSampler());
+		if (!texture->IsFullyResident()){
+			pending.push_back({ texture, index });
+		}
+		return index;
+	}
+
+	void SETextureStreamer::Record(VkCommandBuffer commandBuffer, SEDeletionQueue* deletionQueue){
+		VkDeviceSize used = 0;
+		while (!pending.empty()){
+			// the lowest resolution texture first
+			size_t next = 0;
+			for (size_t i = 1; i < pending.size(); i++){
+				SETexture* texture = pending[i].texture;
+				SETexture* best = pending[next].texture;
+				if (texture->GetResidentWidth() * texture->GetResidentHeight() < best->GetResidentWidth() * best->GetResidentHeight()){
+					next = i;
+				}
+			}
+
+			Entry entry = pending[next];
+			VkDeviceSize size = entry.texture->GetNextMipSize();
+			if (used > 0 && used + size > budget){
+				break;
+			}
+
+			entry.texture->StreamNextMip(commandBuffer, deletionQueue);
+			// the old view stays valid until the deletion queue gets to it, which is after every frame that
+			// could still read it has finished
+			bindlessTable->UpdateImage(entry.index, entry.texture->GetView(), entry.texture->GetSampler());
+			used += size;
+			levelsStreamed++;
+			bytesStreamed += size;
+
+			if (entry.texture->IsFullyResident()){
+				pending.erase(pending.begin() + next);
+			}
+		}
+	}
+
+	void SETextureStreamer::PrintStats(){
+		std::cout << "Texture Streamer: " << levelsStreamed << " levels streamed, " << bytesStreamed / 1024 << " KB, "
+			<< pending.size() << " textures still streaming" << std::endl;
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "SETexture.h"
+#include "SEBindlessTable.h"
+#include "SEDeletionQueue.h"
+
+namespace ScoobzEngine{
+
+	// brings streamed textures up to full resolution a level at a time, recorded into the frames own command buffer
+	// before its render pass. whichever texture is blurriest goes first, so every material climbs together instead of
+	// one finishing while the rest sit at their lowest level. textures are sampled through the bindless table and
+	// their slot is pointed at the new view as soon as a level lands
+	class SETextureStreamer{
+
+	public:
+		SETextureStreamer();~SETextureStreamer();
+
+		//FUNCTIONS :: PUBLIC
+		// upload budget per frame in bytes. a level bigger than the budget still goes through, on a frame of its own
+		void Create(SEBindlessTable*, VkDeviceSize);
+		// adds the texture to the bindless table and returns its index, which stays the same as it streams in
+		uint32_t Add(SETexture*);
+		// call while recording, outside a render pass
+		void Record(VkCommandBuffer, SEDeletionQueue*);
+		void PrintStats();
+
+		//Getters
+		bool IsDone() { return pending.empty(); }
+
+	private:
+		struct Entry{
+			SETexture* texture;
+			uint32_t index;
+		};
+
+		SEBindlessTable* bindlessTable = nullptr;
+		VkDeviceSize budget = 0;
+		std::vector<Entry> pending; // only textures with levels left to stream
+
+		uint32_t levelsStreamed = 0;
+		VkDeviceSize bytesStreamed = 0;
+	};
+}
@@ -0,0 +1,143 @@
+#include "SETilemap.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ScoobzEngine {
+
+	SETilemap::SETilemap(){}
+	SETilemap::~SETilemap(){}
+
+	void SETilemap::Create(uint32_t widthIn, uint32_t heightIn){
+		width = widthIn;
+		height = heightIn;
+		chunksX = (width + SE_TILEMAP_CHUNK_SIZE - 1) / SE_TILEMAP_CHUNK_SIZE;
+		chunksY = (height + SE_TILEMAP_CHUNK_SIZE - 1) / SE_TILEMAP_CHUNK_SIZE;
+		tiles.assign(static_cast<size_t>(chunksX) * chunksY * SE_TILEMAP_CHUNK_QUADS, SE_TILE_EMPTY);
+		chunkVersions.assign(chunksX * chunksY, 1);
+		colors.clear();
+	}
+
+	void SETilemap::SetTile(uint32_t x, uint32_t y, uint16_t tile){
+		if (x >= width || y >= height){
+			return;
+		}
+		uint16_t& current = tiles[TileIndex(x, y)];
+		if (current != tile){
+			current = tile;
+			chunkVersions[(y / SE_TILEMAP_CHUNK_SIZE) * chunksX + x / SE_TILEMAP_CHUNK_SIZE]++;
+		}
+	}
+
+	// a chunk at a time, so each one is only bumped once however much of it changed
+	void SETilemap::Fill(uint32_t x, uint32_t y, uint32_t fillWidth, uint32_t fillHeight, uint16_t tile){
+		uint32_t endX = static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(x) + fillWidth, width));
+		uint32_t endY = static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(y) + fillHeight, height));
+		if (x >= endX || y >= endY){
+			return;
+		}
+
+		for (uint32_t chunkY = y / SE_TILEMAP_CHUNK_SIZE; chunkY <= (endY - 1) / SE_TILEMAP_CHUNK_SIZE; chunkY++){
+			for (uint32_t chunkX = x / SE_TILEMAP_CHUNK_SIZE; chunkX <= (endX - 1) / SE_TILEMAP_CHUNK_SIZE; chunkX++){
+				uint32_t startX = std::max(x, chunkX * SE_TILEMAP_CHUNK_SIZE);
+				uint32_t startY = std::max(y, chunkY * SE_TILEMAP_CHUNK_SIZE);
+				uint32_t stopX = std::min(endX, (chunkX + 1) * SE_TILEMAP_CHUNK_SIZE);
+				uint32_t stopY = std::min(endY, (chunkY + 1) * SE_TILEMAP_CHUNK_SIZE);
+
+				bool changed = false;
+				for (uint32_t tileY = startY; tileY < stopY; tileY++){
+					uint16_t* row = &tiles[TileIndex(startX, tileY)];
+					for (uint32_t i = 0; i < stopX - startX; i++){
+						changed |= row[i] != tile;
+						row[i] = tile;
+					}
+				}
+				if (changed){
+					chunkVersions[chunkY * chunksX + chunkX]++;
+				}
+			}
+		}
+	}
+
+	uint16_t SETilemap::GetTile(uint32_t x, uint32_t y) const {
+		if (x >= width || y >= height){
+			return SE_TILE_EMPTY;
+		}
+		return tiles[TileIndex(x, y)];
+	}
+
+	void SETilemap::SetTileColor(uint16_t tile, const glm::vec3& color){
+		if (tile >= colors.size()){
+			colors.resize(tile + 1, glm::vec3(1.0f));
+		}
+		colors[tile] = color;
+		// any chunk could be using it, theres no index of which ones do
+		for (auto& version : chunkVersions){
+			version++;
+		}
+	}
+
+	uint32_t SETilemap::BuildChunk(uint32_t chunk, Vertex* vertices) const {
+		const uint16_t* chunkTiles = &tiles[static_cast<size_t>(chunk) * SE_TILEMAP_CHUNK_QUADS];
+		glm::vec2 origin(static_cast<float>((chunk % chunksX) * SE_TILEMAP_CHUNK_SIZE), static_cast<float>((chunk / chunksX) * SE_TILEMAP_CHUNK_SIZE));
+
+		// one bit per tile thats already in a quad
+		uint32_t covered[SE_TILEMAP_CHUNK_SIZE] = {};
+		uint32_t quadCount = 0;
+		for (uint32_t y = 0; y < SE_TILEMAP_CHUNK_SIZE; y++){
+			const uint16_t* row = chunkTiles + y * SE_TILEMAP_CHUNK_SIZE;
+			for (uint32_t x = 0; x < SE_TILEMAP_CHUNK_SIZE; x++){
+				uint16_t tile = row[x];
+				if (tile == SE_TILE_EMPTY || (covered[y] >> x) & 1){
+					continue;
+				}
+
+				uint32_t runWidth = 1;
+				while (x + runWidth < SE_TILEMAP_CHUNK_SIZE && row[x + runWidth] == tile && !((covered[y] >> (x + runWidth)) & 1)){
+					runWidth++;
+				}
+				// the rows below join while the whole run matches and none of it is taken
+				uint32_t runMask = (runWidth == 32 ? ~0u : ((1u << runWidth) - 1)) << x;
+				uint32_t runHeight = 1;
+				while (y + runHeight < SE_TILEMAP_CHUNK_SIZE && !(covered[y + runHeight] & runMask)){
+					const uint16_t* below = chunkTiles + (y + runHeight) * SE_TILEMAP_CHUNK_SIZE + x;
+					if (!std::all_of(below, below + runWidth, [tile](uint16_t t) { return t == tile; })){
+						break;
+					}
+					runHeight++;
+				}
+				for (uint32_t i = 0; i < runHeight; i++){
+					covered[y + i] |= runMask;
+				}
+
+				glm::vec3 color = tile < colors.size() ? colors[tile] : glm::vec3(1.0f);
+				glm::vec2 min = origin + glm::vec2(static_cast<float>(x), static_cast<float>(y));
+				glm::vec2 max = min + glm::vec2(static_cast<float>(runWidth), static_cast<float>(runHeight));
+				Vertex* quad = vertices + quadCount * 4;
+				quad[0] = { min, color };
+				quad[1] = { glm::vec2(max.x, min.y), color };
+				quad[2] = { max, color };
+				quad[3] = { glm::vec2(min.x, max.y), color };
+				quadCount++;
+				x += runWidth - 1;
+			}
+		}
+		return quadCount;
+	}
+
+	void SETilemap::GetChunksInRect(const glm::vec2& min, const glm::vec2& max, std::vector<uint32_t>& chunks) const {
+		chunks.clear();
+		if (max.x <= 0.0f || max.y <= 0.0f || min.x >= static_cast<float>(width) || min.y >= static_cast<float>(height) || min.x > max.x || min.y > max.y){
+			return;
+		}
+		float chunkSize = static_cast<float>(SE_TILEMAP_CHUNK_SIZE);
+		uint32_t firstX = static_cast<uint32_t>(std::max(min.x, 0.0f) / chunkSize);
+		uint32_t firstY = static_cast<uint32_t>(std::max(min.y, 0.0f) / chunkSize);
+		uint32_t lastX = std::min(static_cast<uint32_t>(std::ceil(max.x / chunkSize)), chunksX);
+		uint32_t lastY = std::min(static_cast<uint32_t>(std::ceil(max.y / chunkSize)), chunksY);
+		for (uint32_t chunkY = firstY; chunkY < lastY; chunkY++){
+			for (uint32_t chunkX = firstX; chunkX < lastX; chunkX++){
+				chunks.push_back(chunkY * chunksX + chunkX);
+			}
+		}
+	}
+}
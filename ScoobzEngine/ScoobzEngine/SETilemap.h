@@ -0,0 +1,63 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "SEVertex.h"
+
+namespace ScoobzEngine {
+
+	// tiles along each side of a chunk
+	const uint32_t SE_TILEMAP_CHUNK_SIZE = 32;
+	// the most quads a chunk can mesh to, one per tile when no two neighbours match
+	const uint32_t SE_TILEMAP_CHUNK_QUADS = SE_TILEMAP_CHUNK_SIZE * SE_TILEMAP_CHUNK_SIZE;
+	// tile 0 is nothing, it never makes geometry
+	const uint16_t SE_TILE_EMPTY = 0;
+
+	// a grid of tile ids split into square chunks, each meshed on its own. every chunk has a version that goes up
+	// whenever a tile in it or a colour it uses changes, so whatever keeps chunk geometry only rebuilds the ones
+	// whose version moved on. tiles are stored chunk by chunk so meshing one only touches its own 2 KB.
+	// tile x, y covers x to x + 1 and y to y + 1 in tile space, y going down the map
+	class SETilemap{
+
+	public:
+		SETilemap();~SETilemap();
+
+		//FUNCTIONS :: PUBLIC
+		// width and height in tiles, all empty. the chunks cover whole chunks past the edge, those tiles stay empty
+		void Create(uint32_t, uint32_t);
+		// out of range tiles are ignored. only bumps the chunks version if the tile actually changed
+		void SetTile(uint32_t, uint32_t, uint16_t);
+		// x, y, width, height, clipped to the map
+		void Fill(uint32_t, uint32_t, uint32_t, uint32_t, uint16_t);
+		uint16_t GetTile(uint32_t, uint32_t) const;
+		// the colour a tile id is drawn in, white until set. every chunk gets a new version
+		void SetTileColor(uint16_t, const glm::vec3&);
+		// greedy meshes a chunk, runs of the same tile grow right then down into one quad. 4 vertices a quad in
+		// the order 0, 1, 2, 2, 3, 0 draws them, at most SE_TILEMAP_CHUNK_QUADS. returns the quad count
+		uint32_t BuildChunk(uint32_t, Vertex*) const;
+		// writes the chunks touching a tile space rectangle, min and max, clipped to the map
+		void GetChunksInRect(const glm::vec2&, const glm::vec2&, std::vector<uint32_t>&) const;
+
+		//Getters
+		uint32_t GetWidth() const { return width; }
+		uint32_t GetHeight() const { return height; }
+		uint32_t GetChunksX() const { return chunksX; }
+		uint32_t GetChunksY() const { return chunksY; }
+		uint32_t GetChunkCount() const { return chunksX * chunksY; }
+		uint32_t GetChunkVersion(uint32_t chunk) const { return chunkVersions[chunk]; }
+
+	private:
+		size_t TileIndex(uint32_t x, uint32_t y) const {
+			uint32_t chunk = (y / SE_TILEMAP_CHUNK_SIZE) * chunksX + x / SE_TILEMAP_CHUNK_SIZE;
+			return static_cast<size_t>(chunk) * SE_TILEMAP_CHUNK_QUADS + (y % SE_TILEMAP_CHUNK_SIZE) * SE_TILEMAP_CHUNK_SIZE + x % SE_TILEMAP_CHUNK_SIZE;
+		}
+
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t chunksX = 0;
+		uint32_t chunksY = 0;
+		std::vector<uint16_t> tiles; // chunk by chunk, row by row inside each
+		std::vector<uint32_t> chunkVersions; // start at 1, so 0 can mean never built
+		std::vector<glm::vec3> colors; // by tile id, grown as colours are set
+	};
+}
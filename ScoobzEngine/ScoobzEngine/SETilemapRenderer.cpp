@@ -0,0 +1,237 @@
+#include "SETilemapRenderer.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <iomanip>
+
+namespace ScoobzEngine {
+
+	static const VkDeviceSize CHUNK_VERTEX_BYTES = SE_TILEMAP_CHUNK_QUADS * 4 * sizeof(Vertex);
+
+	SETilemapRenderer::SETilemapRenderer(){}
+	SETilemapRenderer::~SETilemapRenderer(){}
+
+	void SETilemapRenderer::Create(const VkDevice* logicalDevice, const VkPhysicalDevice* physicalDevice, const VkSurfaceKHR* surface,
+		const VkCommandPool* commandPool, const VkQueue* queue, const SETilemap* tilemapIn, uint32_t slotCount, VkDeviceSize stagingBytes,
+		uint32_t framesInFlight){
+
+		device = logicalDevice;
+		tilemap = tilemapIn;
+		stagingFrameBytes = std::max(stagingBytes, CHUNK_VERTEX_BYTES);
+		chunks.assign(tilemap->GetChunkCount(), Chunk());
+		slots.assign(slotCount, Slot());
+
+		CreateBuffer(logicalDevice, physicalDevice, surface, CHUNK_VERTEX_BYTES * slotCount, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexMemory);
+
+		// host coherent and mapped for its whole life, chunks are meshed straight into it
+		CreateBuffer(logicalDevice, physicalDevice, surface, stagingFrameBytes * framesInFlight, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingMemory);
+		void* data;
+		if (vkMapMemory(*device, stagingMemory, 0, stagingFrameBytes * framesInFlight, 0, &data) != VK_SUCCESS){
+			throw std::runtime_error("Failed to map tilemap staging buffer");
+		}
+		mappedStaging = static_cast<uint8_t*>(data);
+
+		// a chunk is at most 4096 vertices, so 16 bit indices reach all of it and the slot goes in the vertex offset
+		VkDeviceSize indexBytes = SE_TILEMAP_CHUNK_QUADS * 6 * sizeof(uint16_t);
+		VkBuffer indexStagingBuffer;
+		VkDeviceMemory indexStagingMemory;
+		CreateBuffer(logicalDevice, physicalDevice, surface, indexBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, indexStagingBuffer, indexStagingMemory);
+		if (vkMapMemory(*device, indexStagingMemory, 0, indexBytes, 0, &data) != VK_SUCCESS){
+			throw std::runtime_error("Failed to map tilemap index staging buffer");
+		}
+		uint16_t* indices = static_cast<uint16_t*>(data);
+		for (uint32_t i = 0; i < SE_TILEMAP_CHUNK_QUADS; i++){
+			uint16_t corner = static_cast<uint16_t>(i * 4);
+			uint16_t quad[6] = { corner, static_cast<uint16_t>(corner + 1), static_cast<uint16_t>(corner + 2),
+				static_cast<uint16_t>(corner + 2), static_cast<uint16_t>(corner + 3), corner };
+			std::copy(quad, quad + 6, indices + i * 6);
+		}
+		vkUnmapMemory(*device, indexStagingMemory);
+
+		CreateBuffer(logicalDevice, physicalDevice, surface, indexBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexMemory);
+		CopyBuffer(logicalDevice, commandPool, indexStagingBuffer, indexBuffer, indexBytes, queue);
+		CleanupBuffer(logicalDevice, indexStagingBuffer, indexStagingMemory);
+
+		std::cout << "Tilemap Renderer Creation: SUCCESSFUL! (" << tilemap->GetWidth() << " x " << tilemap->GetHeight() << " tiles, "
+			<< slotCount << " chunk slots, " << CHUNK_VERTEX_BYTES * slotCount / (1024 * 1024) << " MB)" << std::endl;
+	}
+
+	void SETilemapRenderer::Cleanup(){
+		vkUnmapMemory(*device, stagingMemory);
+		mappedStaging = nullptr;
+		CleanupBuffer(device, stagingBuffer, stagingMemory);
+		CleanupBuffer(device, vertexBuffer, vertexMemory);
+		CleanupBuffer(device, indexBuffer, indexMemory);
+	}
+
+	// a free slot, or the one drawn longest ago. never one drawn this frame, ~0u if thats all of them
+	uint32_t SETilemapRenderer::AllocateSlot(){
+		uint32_t best = ~0u;
+		for (uint32_t i = 0; i < slots.size(); i++){
+			if (slots[i].chunk == ~0u){
+				best = i;
+				break;
+			}
+			if (slots[i].lastDrawn < frameNumber && (best == ~0u || slots[i].lastDrawn < slots[best].lastDrawn)){
+				best = i;
+			}
+		}
+		if (best == ~0u){
+			return best;
+		}
+
+		// the GPU may still be drawing the old chunk from it, RecordUploads waits for that before copying over it
+		Slot& slot = slots[best];
+		if (slot.chunk != ~0u){
+			chunks[slot.chunk].slot = ~0u;
+			chunks[slot.chunk].builtVersion = 0;
+		}
+		slot.lastDrawn = frameNumber;
+		return best;
+	}
+
+	void SETilemapRenderer::Prepare(uint32_t frameSlot, const glm::mat4& viewMatrix){
+		auto start = std::chrono::high_resolution_clock::now();
+		currentSlot = frameSlot;
+		frameNumber++;
+		copies.clear();
+		draws.clear();
+		quadCount = 0;
+
+		// the views corners back in tile space, the map is flat so any depth does
+		glm::mat4 inverseView = glm::inverse(viewMatrix);
+		glm::vec2 viewMin(FLT_MAX);
+		glm::vec2 viewMax(-FLT_MAX);
+		for (int i = 0; i < 4; i++){
+			glm::vec4 corner = inverseView * glm::vec4(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, 0.0f, 1.0f);
+			glm::vec2 point = glm::vec2(corner) / corner.w;
+			viewMin = glm::min(viewMin, point);
+			viewMax = glm::max(viewMax, point);
+		}
+		tilemap->GetChunksInRect(viewMin, viewMax, visibleChunks);
+
+		// claimed up front, so a chunk in view never loses its slot to another one in view
+		for (uint32_t c : visibleChunks){
+			if (chunks[c].slot != ~0u){
+				slots[chunks[c].slot].lastDrawn = frameNumber;
+			}
+		}
+
+		VkDeviceSize stagingStart = stagingFrameBytes * currentSlot;
+		VkDeviceSize stagingUsed = 0;
+		for (uint32_t c : visibleChunks){
+			Chunk& chunk = chunks[c];
+			uint32_t version = tilemap->GetChunkVersion(c);
+			if (chunk.builtVersion != version){
+				// past the budget a chunk keeps drawing what it had, if anything
+				if (stagingUsed + CHUNK_VERTEX_BYTES > stagingFrameBytes){
+					stats.chunksDeferred++;
+				}
+				else{
+					Vertex* vertices = reinterpret_cast<Vertex*>(mappedStaging + stagingStart + stagingUsed);
+					uint32_t quadCount = tilemap->BuildChunk(c, vertices);
+					if (quadCount == 0 && chunk.slot != ~0u){
+						slots[chunk.slot].chunk = ~0u;
+						chunk.slot = ~0u;
+					}
+					if (quadCount > 0 && chunk.slot == ~0u){
+						chunk.slot = AllocateSlot();
+						if (chunk.slot != ~0u){
+							slots[chunk.slot].chunk = c;
+						}
+						else{
+							stats.chunksSkipped++;
+						}
+					}
+
+					if (quadCount == 0 || chunk.slot != ~0u){
+						if (quadCount > 0){
+							VkDeviceSize bytes = quadCount * 4 * sizeof(Vertex);
+							copies.push_back({ stagingStart + stagingUsed, chunk.slot * CHUNK_VERTEX_BYTES, bytes });
+							stagingUsed += bytes;
+							stats.bytesUploaded += bytes;
+						}
+						chunk.builtVersion = version;
+						chunk.quadCount = quadCount;
+						stats.chunksRebuilt++;
+					}
+				}
+			}
+
+			if (chunk.slot != ~0u && chunk.quadCount > 0){
+				draws.push_back({ chunk.slot, chunk.quadCount });
+				quadCount += chunk.quadCount;
+			}
+		}
+
+		stats.frames++;
+		stats.chunksVisible += visibleChunks.size();
+		stats.chunksDrawn += draws.size();
+		stats.quadsDrawn += quadCount;
+		stats.buildMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	void SETilemapRenderer::RecordUploads(VkCommandBuffer commandBuffer){
+		if (copies.empty()){
+			return;
+		}
+
+		// the slots being written may still be read by earlier frames draws, an execution dependency is enough for that
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+		vkCmdCopyBuffer(commandBuffer, stagingBuffer, vertexBuffer, static_cast<uint32_t>(copies.size()), copies.data());
+
+		VkMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+	}
+
+	void SETilemapRenderer::RecordDraws(VkCommandBuffer commandBuffer, VkPipelineLayout layout, VkShaderStageFlags pushStages, SEDrawConstants drawConstants){
+		if (draws.empty()){
+			return;
+		}
+
+		VkDeviceSize offset = 0;
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+		vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+		drawConstants.objectIndex = 0;
+		vkCmdPushConstants(commandBuffer, layout, pushStages, 0, sizeof(SEDrawConstants), &drawConstants);
+
+		for (const auto& draw : draws){
+			vkCmdDrawIndexed(commandBuffer, draw.quadCount * 6, 1, 0, static_cast<int32_t>(draw.slot * SE_TILEMAP_CHUNK_QUADS * 4), 0);
+		}
+	}
+
+	// pixels from the top left scaled up by the tile size, Vulkan clip space already has y going down
+	glm::mat4 SETilemapRenderer::GetView(float width, float height){
+		if (customView){
+			return view;
+		}
+		glm::mat4 pixelView(1.0f);
+		pixelView[0][0] = 2.0f * tilePixels / width;
+		pixelView[1][1] = 2.0f * tilePixels / height;
+		pixelView[3][0] = -1.0f;
+		pixelView[3][1] = -1.0f;
+		return pixelView;
+	}
+
+	void SETilemapRenderer::PrintStats(){
+		if (stats.frames == 0){
+			return;
+		}
+		std::cout << "---- Tilemap ----" << std::endl;
+		std::cout << std::fixed << std::setprecision(2);
+		std::cout << "Chunks: " << static_cast<double>(stats.chunksVisible) / stats.frames << " visible, "
+			<< static_cast<double>(stats.chunksDrawn) / stats.frames << " drawn per frame, "
+			<< static_cast<double>(stats.quadsDrawn) / stats.frames << " quads" << std::endl;
+		std::cout << "Rebuilds: " << stats.chunksRebuilt << " chunks, " << stats.bytesUploaded / 1024 << " KB uploaded, "
+			<< stats.chunksDeferred << " deferred, " << stats.chunksSkipped << " skipped without a slot" << std::endl;
+		std::cout << "Build time: " << stats.buildMs * 1000.0 / stats.frames << " us per frame" << std::endl;
+		std::cout << std::defaultfloat;
+	}
+}
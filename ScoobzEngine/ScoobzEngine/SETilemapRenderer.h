@@ -0,0 +1,104 @@
+#pragma once
+#include "SEBuffer.h"
+#include "SEDrawData.h"
+#include "SETilemap.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace ScoobzEngine {
+
+	struct SETilemapStats{
+		uint64_t frames;
+		uint64_t chunksVisible; // summed over every frame
+		uint64_t chunksDrawn; // visible and not empty
+		uint64_t chunksRebuilt;
+		uint64_t chunksDeferred; // changed but past the frames upload budget, drawn as they were until a later frame
+		uint64_t chunksSkipped; // visible with no slot free to put them in
+		uint64_t quadsDrawn;
+		uint64_t bytesUploaded;
+		double buildMs; // culling and meshing
+	};
+
+	// draws a tilemap with the scenes Vertex and pipeline layout. the geometry lives in a device local vertex buffer
+	// of fixed size slots, one chunk each, and only chunks in view get one. a chunk is remeshed when its version has
+	// moved on since it was last built, into this frame slots staging buffer, and copied into its slot before any
+	// pass runs. the least recently drawn slot goes to a chunk that needs one, so maps of any size cost the same
+	// memory and only what the view and the edits touch is ever rebuilt
+	class SETilemapRenderer : public SEBuffer{
+
+	public:
+		SETilemapRenderer();~SETilemapRenderer();
+
+		//FUNCTIONS :: PUBLIC
+		// the command pool and queue only upload the index buffer. the map, chunk slots, staging bytes a frame and
+		// frames in flight. the map has to outlive the renderer
+		void Create(const VkDevice*, const VkPhysicalDevice*, const VkSurfaceKHR*, const VkCommandPool*, const VkQueue*, const SETilemap*,
+			uint32_t, VkDeviceSize, uint32_t);
+		void Cleanup();
+		// tile space to clip space. without one tiles are this many pixels from the top left of the window
+		void SetView(const glm::mat4& viewIn) { view = viewIn; customView = true; }
+		void SetTilePixels(float pixels) { tilePixels = pixels; }
+		// call right after waiting on the slots fence. culls the chunks against the view, remeshes the ones in view that
+		// changed as far as the staging budget goes, and lists what to draw
+		void Prepare(uint32_t, const glm::mat4&);
+		// outside a render pass, copies what Prepare rebuilt into the slots
+		void RecordUploads(VkCommandBuffer);
+		// inside a render pass with a pipeline taking Vertex and the engines layout, with the view as object 0. works
+		// with the indirect draw permutation too since the object index also goes in as the instance
+		void RecordDraws(VkCommandBuffer, VkPipelineLayout, VkShaderStageFlags, SEDrawConstants);
+		void PrintStats();
+
+		//Getters
+		glm::mat4 GetView(float, float);
+		uint32_t GetDrawCount() { return static_cast<uint32_t>(draws.size()); }
+		// quads in the draws from the last Prepare
+		uint32_t GetQuadCount() { return quadCount; }
+		SETilemapStats GetStats() { return stats; }
+
+	private:
+		struct Chunk{
+			uint32_t slot = ~0u;
+			uint32_t builtVersion = 0; // 0 until built, empty chunks are built without a slot
+			uint32_t quadCount = 0;
+		};
+
+		struct Slot{
+			uint32_t chunk = ~0u;
+			uint64_t lastDrawn = 0; // frame number
+		};
+
+		struct Draw{
+			uint32_t slot;
+			uint32_t quadCount;
+		};
+
+		uint32_t AllocateSlot();
+
+		const VkDevice* device = nullptr;
+		const SETilemap* tilemap = nullptr;
+		VkBuffer vertexBuffer = VK_NULL_HANDLE; // a chunks worth of vertices per slot
+		VkDeviceMemory vertexMemory = VK_NULL_HANDLE;
+		VkBuffer indexBuffer = VK_NULL_HANDLE; // one chunks worth of quads, every slot draws from the start of it
+		VkDeviceMemory indexMemory = VK_NULL_HANDLE;
+		VkBuffer stagingBuffer = VK_NULL_HANDLE; // a region per frame in flight
+		VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+		uint8_t* mappedStaging = nullptr;
+		VkDeviceSize stagingFrameBytes = 0;
+		uint32_t currentSlot = 0;
+		uint64_t frameNumber = 0;
+
+		glm::mat4 view = glm::mat4(1.0f);
+		bool customView = false;
+		float tilePixels = 32.0f;
+
+		std::vector<Chunk> chunks;
+		std::vector<Slot> slots;
+		std::vector<uint32_t> visibleChunks;
+		std::vector<VkBufferCopy> copies; // from Prepare, for RecordUploads
+		std::vector<Draw> draws;
+		uint32_t quadCount = 0;
+
+		SETilemapStats stats = {};
+	};
+}
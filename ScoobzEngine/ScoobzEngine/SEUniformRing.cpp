@@ -0,0 +1,86 @@
+#include "SEUniformRing.h"
+#include <algorithm>
+#include <cstring>
+
+namespace ScoobzEngine{
+
+	SEUniformRing::SEUniformRing(){}
+	SEUniformRing::~SEUniformRing(){}
+
+	void SEUniformRing::Create(const VkDevice* logicalDevice, const VkPhysicalDevice* physicalDevice, const VkSurfaceKHR* surface,
+		VkDeviceSize bytesPerFrame, uint32_t framesInFlight){
+
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(*physicalDevice, &deviceProperties);
+		// the ring is bound both ways, offsets have to suit whichever is stricter
+		alignment = std::max(deviceProperties.limits.minUniformBufferOffsetAlignment, deviceProperties.limits.minStorageBufferOffsetAlignment);
+		if (alignment == 0){
+			alignment = 256;
+		}
+
+		// every region starts aligned so offsets within it only have to be aligned relative to its start
+		frameSize = GetStride(bytesPerFrame);
+
+		// host coherent, so writes need no flush and the buffer stays mapped for its whole life
+		CreateBuffer(logicalDevice, physicalDevice, surface, frameSize * framesInFlight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer, bufferMemory);
+
+		void* data;
+		if (vkMapMemory(*logicalDevice, bufferMemory, 0, frameSize * framesInFlight, 0, &data) != VK_SUCCESS){
+			throw std::runtime_error("Failed to map uniform ring");
+		}
+		mapped = static_cast<uint8_t*>(data);
+
+		std::cout << "Uniform Ring Creation: SUCCESSFUL! (" << framesInFlight << " x " << frameSize << " bytes, "
+			<< alignment << " byte alignment)" << std::endl;
+	}
+
+	void SEUniformRing::Cleanup(const VkDevice* logicalDevice){
+		vkUnmapMemory(*logicalDevice, bufferMemory);
+		mapped = nullptr;
+		CleanupBuffer(logicalDevice, buffer, bufferMemory);
+	}
+
+	void SEUniformRing::BeginFrame(uint32_t slot){
+		frameStart = frameSize * slot;
+		head = frameStart;
+	}
+
+	uint32_t SEUniformRing::Allocate(VkDeviceSize size, void** data){
+		VkDeviceSize offset = head;
+		VkDeviceSize stride = GetStride(size);
+		if (offset + stride > frameStart + frameSize){
+			throw std::runtime_error("Uniform ring is full for this frame");
+		}
+
+		head += stride;
+		*data = mapped + offset;
+		return static_cast<uint32_t>(offset);
+	}
+
+	uint32_t SEUniformRing::WritePacked(const void* source, VkDeviceSize size){
+		void* data;
+		uint32_t offset = Allocate(size, &data);
+		memcpy(data, source, static_cast<size_t>(size));
+		return offset;
+	}
+
+	uint32_t SEUniformRing::Write(const void* source, uint32_t count, VkDeviceSize elementSize){
+		VkDeviceSize stride = GetStride(elementSize);
+
+		void* data;
+		uint32_t offset = Allocate(stride * count, &data);
+
+		if (stride == elementSize){
+			memcpy(data, source, static_cast<size_t>(elementSize * count));
+		}
+		else{
+			const uint8_t* from = static_cast<const uint8_t*>(source);
+			uint8_t* to = static_cast<uint8_t*>(data);
+			for (uint32_t i = 0; i < count; i++){
+				memcpy(to + i * stride, from + i * elementSize, static_cast<size_t>(elementSize));
+			}
+		}
+		return offset;
+	}
+}
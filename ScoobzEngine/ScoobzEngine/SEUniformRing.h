@@ -0,0 +1,46 @@
+#pragma once
+#include "SEBuffer.h"
+
+namespace ScoobzEngine{
+
+	// one persistently mapped buffer split into a region per frame in flight, bindable as a uniform or storage buffer.
+	// per-draw data is written straight into the current frames region and the shader finds it through a dynamic
+	// offset, so a single descriptor layout serves every draw in every frame and nothing is mapped, flushed or
+	// updated per object
+	class SEUniformRing : public SEBuffer{
+
+	public:
+		SEUniformRing();~SEUniformRing();
+
+		//FUNCTIONS :: PUBLIC
+		// bytes per frame and frames in flight, the buffer holds one region per frame
+		void Create(const VkDevice*, const VkPhysicalDevice*, const VkSurfaceKHR*, VkDeviceSize, uint32_t);
+		void Cleanup(const VkDevice*);
+		// call right after waiting on the slots fence, everything written for that slot last time is free again
+		void BeginFrame(uint32_t);
+		// space for one block, returns its dynamic offset and where to write it. throws if the frame is full
+		uint32_t Allocate(VkDeviceSize, void**);
+		// an array of elements, each on its own dynamic offset GetStride apart. when the element size is already a
+		// multiple of the alignment (a mat4 on most desktop GPUs) its a single memcpy. returns the first ones offset
+		uint32_t Write(const void*, uint32_t, VkDeviceSize);
+		// a tightly packed block, for arrays the shader indexes itself out of a storage buffer. always one memcpy
+		uint32_t WritePacked(const void*, VkDeviceSize);
+
+		//Getters
+		VkBuffer* GetBuffer() { return &buffer; }
+		VkDeviceSize GetAlignment() { return alignment; }
+		VkDeviceSize GetStride(VkDeviceSize size) { return (size + alignment - 1) & ~(alignment - 1); }
+		VkDeviceSize GetFrameSize() { return frameSize; }
+		VkDeviceSize GetBytesUsed() { return head - frameStart; }
+
+	private:
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkDeviceMemory bufferMemory = VK_NULL_HANDLE;
+		uint8_t* mapped = nullptr;
+
+		VkDeviceSize alignment = 256; // the stricter of the uniform and storage offset alignments, always a power of two
+		VkDeviceSize frameSize = 0;
+		VkDeviceSize frameStart = 0;
+		VkDeviceSize head = 0;
+	};
+}
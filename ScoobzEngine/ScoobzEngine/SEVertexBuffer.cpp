@@ -4,62 +4,85 @@ namespace ScoobzEngine{
 
 	SEVertexBuffer::SEVertexBuffer(const VkDevice* logicalDevice, const VkPhysicalDevice* physicalDevice, const VkSurfaceKHR* surface,
 		const VkCommandPool* transferCommandPool, const VkQueue* transferQueue){
-		Create(logicalDevice, physicalDevice, surface, transferCommandPool, transferQueue);
-		CreateIndexBuffer(logicalDevice, physicalDevice, surface, transferCommandPool, transferQueue);
+		Stage(logicalDevice, physicalDevice, surface);
+		Upload(logicalDevice, physicalDevice, surface, transferCommandPool, transferQueue);
 	}
-	
-	SEVertexBuffer::~SEVertexBuffer(){}
-
-	void SEVertexBuffer::Create(const VkDevice* logicalDevice, const VkPhysicalDevice* physicalDevice, const VkSurfaceKHR* surface,
-		const VkCommandPool* transferCommandPool, const VkQueue* transferQueue){
-		VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMemory;
-
-		CreateBuffer(logicalDevice, physicalDevice, surface, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-		void* data;
-		vkMapMemory(*logicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, vertices.data(), (size_t)bufferSize);
-		vkUnmapMemory(*logicalDevice, stagingBufferMemory);
-
-		CreateBuffer(logicalDevice, physicalDevice, surface, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
 
-		CopyBuffer(logicalDevice, transferCommandPool, stagingBuffer, vertexBuffer, bufferSize, transferQueue);
+	SEVertexBuffer::SEVertexBuffer(){}
+	SEVertexBuffer::~SEVertexBuffer(){}
 
-		vkDestroyBuffer(*logicalDevice, stagingBuffer, nullptr);
-		vkFreeMemory(*logicalDevice, stagingBufferMemory, nullptr);
+	void SEVertexBuffer::SetMesh(const std::vector<Vertex>& meshVertices, const std::vector<uint32_t>& meshIndices, const SEMeshLodDesc& lodDesc){
+		if (meshVertices.empty() || meshIndices.empty()){
+			throw std::runtime_error("Mesh has no triangles");
+		}
+		vertices = meshVertices;
+
+		std::vector<glm::vec3> positions(vertices.size());
+		std::vector<float> colors(vertices.size() * 3);
+		boundsMin = glm::vec3(vertices[0].pos, 0.0f);
+		boundsMax = boundsMin;
+		for (size_t i = 0; i < vertices.size(); i++){
+			positions[i] = glm::vec3(vertices[i].pos, 0.0f);
+			colors[i * 3 + 0] = vertices[i].color.r;
+			colors[i * 3 + 1] = vertices[i].color.g;
+			colors[i * 3 + 2] = vertices[i].color.b;
+			boundsMin = glm::min(boundsMin, positions[i]);
+			boundsMax = glm::max(boundsMax, positions[i]);
+		}
+
+		// every level goes into the one index buffer, all of them drawing from the same vertices
+		GenerateLods(positions, colors.data(), 3, meshIndices, lodDesc, indices, lods);
+		// reorders the full meshes triangles so each meshlet is one run, the other levels dont move
+		BuildMeshlets(positions, indices, lods[0].firstIndex, lods[0].indexCount, meshlets);
+		std::cout << "Mesh LODs:";
+		for (const auto& lod : lods){
+			std::cout << " " << lod.indexCount / 3;
+		}
+		std::cout << " triangles, " << meshlets.size() << " meshlets" << std::endl;
 	}
 
-	void SEVertexBuffer::Cleanup(const VkDevice* logicalDevice){
-		CleanupBuffer(logicalDevice, vertexBuffer, vertexBufferMemory);
+	void SEVertexBuffer::Stage(const VkDevice* logicalDevice, const VkPhysicalDevice* physicalDevice, const VkSurfaceKHR* surface){
+		StageData(logicalDevice, physicalDevice, surface, vertices.data(), sizeof(vertices[0]) * vertices.size(),
+			vertexStagingBuffer, vertexStagingBufferMemory);
+		StageData(logicalDevice, physicalDevice, surface, indices.data(), sizeof(indices[0]) * indices.size(),
+			indexStagingBuffer, indexStagingBufferMemory);
 	}
 
-	void SEVertexBuffer::CreateIndexBuffer(const VkDevice* logicalDevice, const VkPhysicalDevice* physicalDevice, const VkSurfaceKHR* surface,
+	void SEVertexBuffer::Upload(const VkDevice* logicalDevice, const VkPhysicalDevice* physicalDevice, const VkSurfaceKHR* surface,
 		const VkCommandPool* transferCommandPool, const VkQueue* transferQueue){
-		VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
+		UploadData(logicalDevice, physicalDevice, surface, transferCommandPool, transferQueue, sizeof(vertices[0]) * vertices.size(),
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vertexStagingBuffer, vertexStagingBufferMemory, vertexBuffer, vertexBufferMemory);
+		UploadData(logicalDevice, physicalDevice, surface, transferCommandPool, transferQueue, sizeof(indices[0]) * indices.size(),
+			VK_BUFFER_USAGE_INDEX_BUFFER_BIT, indexStagingBuffer, indexStagingBufferMemory, indexBuffer, indexBufferMemory);
+	}
 
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMemory;
+	void SEVertexBuffer::StageData(const VkDevice* logicalDevice, const VkPhysicalDevice* physicalDevice, const VkSurfaceKHR* surface,
+		const void* source, VkDeviceSize bufferSize, VkBuffer& stagingBuffer, VkDeviceMemory& stagingBufferMemory){
 
 		CreateBuffer(logicalDevice, physicalDevice, surface, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
 			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
 
 		void* data;
 		vkMapMemory(*logicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, indices.data(), (size_t)bufferSize);
+		memcpy(data, source, (size_t)bufferSize);
 		vkUnmapMemory(*logicalDevice, stagingBufferMemory);
+	}
 
-		CreateBuffer(logicalDevice, physicalDevice, surface, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
+	void SEVertexBuffer::UploadData(const VkDevice* logicalDevice, const VkPhysicalDevice* physicalDevice, const VkSurfaceKHR* surface,
+		const VkCommandPool* transferCommandPool, const VkQueue* transferQueue, VkDeviceSize bufferSize, VkBufferUsageFlags usage,
+		VkBuffer& stagingBuffer, VkDeviceMemory& stagingBufferMemory, VkBuffer& buffer, VkDeviceMemory& bufferMemory){
 
-		CopyBuffer(logicalDevice, transferCommandPool, stagingBuffer, indexBuffer, bufferSize, transferQueue);
+		CreateBuffer(logicalDevice, physicalDevice, surface, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, bufferMemory);
+
+		CopyBuffer(logicalDevice, transferCommandPool, stagingBuffer, buffer, bufferSize, transferQueue);
 
 		vkDestroyBuffer(*logicalDevice, stagingBuffer, nullptr);
-		vkFreeMemory(*logicalDevice, stagingBufferMemory, nullptr);
+		FreeMemory(*logicalDevice, stagingBufferMemory);
+	}
+
+	void SEVertexBuffer::Cleanup(const VkDevice* logicalDevice){
+		CleanupBuffer(logicalDevice, vertexBuffer, vertexBufferMemory);
 	}
 
 	void SEVertexBuffer::CleanupIndexBuffer(const VkDevice* logicalDevice){
@@ -67,4 +90,4 @@ namespace ScoobzEngine{
 	}
 
 
-}
\ No newline at end of file
+}
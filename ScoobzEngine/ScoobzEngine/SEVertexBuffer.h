@@ -1,5 +1,7 @@
 #pragma once
 #include "SEBuffer.h"
+#include "SEMeshLod.h"
+#include "SEMeshlet.h"
 
 namespace ScoobzEngine{
 
@@ -7,6 +9,7 @@ namespace ScoobzEngine{
 
 	public:
 		SEVertexBuffer(const VkDevice*, const VkPhysicalDevice*, const VkSurfaceKHR*,const VkCommandPool*, const VkQueue*);
+		SEVertexBuffer();
 		~SEVertexBuffer();
 
 		//Getters
@@ -14,26 +17,54 @@ namespace ScoobzEngine{
 		uint32_t GetVerticesSize() { return vertices.size(); }
 
 		VkBuffer* GetIndexBuffer() { return &indexBuffer; }
+		// every level, one after another
 		uint32_t GetIndicesSize() { return indices.size(); }
 
-		void Create(const VkDevice*, const VkPhysicalDevice*, const VkSurfaceKHR*, const VkCommandPool*, const VkQueue*);
+		// the full mesh first, each one after it coarser. draws pick one by its index range
+		const std::vector<SEMeshLod>& GetLods() { return lods; }
+		// the full mesh split into meshlets, each a run of its index range. empty for the quad
+		const std::vector<SEMeshlet>& GetMeshlets() { return meshlets; }
+		const glm::vec3& GetBoundsMin() { return boundsMin; }
+		const glm::vec3& GetBoundsMax() { return boundsMax; }
+
+		// replaces the quad before Stage, simplifying the mesh into its LOD chain and splitting the full mesh into
+		// meshlets. the colours count as attributes, so seams between them are kept and flat colour simplifies furthest
+		void SetMesh(const std::vector<Vertex>&, const std::vector<uint32_t>&, const SEMeshLodDesc& = SEMeshLodDesc());
+
+		// staging only needs the device, so it can run before the command pools exist.
+		// Upload then copies the staged data over on the transfer queue and frees the staging buffers
+		void Stage(const VkDevice*, const VkPhysicalDevice*, const VkSurfaceKHR*);
+		void Upload(const VkDevice*, const VkPhysicalDevice*, const VkSurfaceKHR*, const VkCommandPool*, const VkQueue*);
 		void Cleanup(const VkDevice*);
-		void CreateIndexBuffer(const VkDevice*, const VkPhysicalDevice*, const VkSurfaceKHR*, const VkCommandPool*, const VkQueue*);
 		void CleanupIndexBuffer(const VkDevice*);
 
 	private:
 
-		const std::vector<Vertex> vertices = {
+		std::vector<Vertex> vertices = {
 			{ { -0.5f, -0.5f },{ 1.0f, 1.0f, 1.0f } },
 			{ {  0.5f, -0.5f },{ 1.0f, 0.0f, 0.0f } },
 			{ {  0.5f,  0.5f },{ 0.0f, 1.0f, 0.0f } },
 			{ { -0.5f,  0.5f },{ 0.0f, 0.0f, 1.0f } }
 		};
 
-		const std::vector<uint32_t> indices = {
+		std::vector<uint32_t> indices = {
 			0,1,2,2,3,0
 		};
+
+		std::vector<SEMeshLod> lods = { { 0, 6, 0.0f } };
+		std::vector<SEMeshlet> meshlets;
+		glm::vec3 boundsMin = glm::vec3(-0.5f, -0.5f, 0.0f);
+		glm::vec3 boundsMax = glm::vec3(0.5f, 0.5f, 0.0f);
 		
+		void StageData(const VkDevice*, const VkPhysicalDevice*, const VkSurfaceKHR*, const void*, VkDeviceSize, VkBuffer&, VkDeviceMemory&);
+		void UploadData(const VkDevice*, const VkPhysicalDevice*, const VkSurfaceKHR*, const VkCommandPool*, const VkQueue*,
+			VkDeviceSize, VkBufferUsageFlags, VkBuffer&, VkDeviceMemory&, VkBuffer&, VkDeviceMemory&);
+
+		VkBuffer vertexStagingBuffer;
+		VkDeviceMemory vertexStagingBufferMemory;
+		VkBuffer indexStagingBuffer;
+		VkDeviceMemory indexStagingBufferMemory;
+
 		VkBuffer vertexBuffer;
 		VkDeviceMemory vertexBufferMemory;
 		VkBuffer indexBuffer;
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace ScoobzEngine {
+
+	// fixed size Chase-Lev deque. the owning thread pushes and pops at the bottom,
+	// any other thread can steal from the top. Push fails when full so the caller can run the item inline
+	template <typename T, int64_t Capacity>
+	class SEWorkStealingDeque{
+		static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	public:
+		SEWorkStealingDeque(){}
+		~SEWorkStealingDeque(){}
+
+		// owner only
+		bool Push(T item){
+			int64_t b = bottom.load(std::memory_order_relaxed);
+			int64_t t = top.load(std::memory_order_acquire);
+			if (b - t >= Capacity){
+				return false;
+			}
+
+			buffer[b & (Capacity - 1)].store(item, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		// owner only
+		bool Pop(T& item){
+			int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t t = top.load(std::memory_order_relaxed);
+
+			if (t > b){
+				// empty, put bottom back
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return false;
+			}
+
+			item = buffer[b & (Capacity - 1)].load(std::memory_order_relaxed);
+			if (t != b){
+				return true;
+			}
+
+			// last item, race any thieves for it
+			bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return won;
+		}
+
+		// any thread
+		bool Steal(T& item){
+			int64_t t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t b = bottom.load(std::memory_order_acquire);
+
+			if (t >= b){
+				return false;
+			}
+
+			item = buffer[t & (Capacity - 1)].load(std::memory_order_relaxed);
+			return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		}
+
+		bool Empty(){
+			return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+		}
+
+	private:
+		// keep the thieves end and the owners end on separate cache lines
+		alignas(64) std::atomic<int64_t> top{ 0 };
+		alignas(64) std::atomic<int64_t> bottom{ 0 };
+		alignas(64) std::atomic<T> buffer[Capacity];
+	};
+}
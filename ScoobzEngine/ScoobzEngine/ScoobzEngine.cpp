@@ -9,39 +9,165 @@ namespace ScoobzEngine{
 		delete graphicsCommandPool;
 		delete transferCommandPool;
 		delete vertexBuffer;
+		delete uniformRing;
+		delete frameDescriptors;
+		delete bindlessTable;
+		delete defaultTexture;
+		delete checkerTexture;
+		delete textureStreamer;
+		delete objectStore;
+		delete occlusionBuffer;
+		delete sceneBvh;
+		delete gpuCulling;
+		delete spriteBatch;
+		delete tilemapRenderer;
+		delete tilemap;
+		delete textRenderer;
+		delete pipelineCache;
+		delete renderGraph;
+		delete layoutCache;
+		delete shaderLibrary;
+		delete shaderPermutations;
+		delete shaderWatcher;
+		delete deletionQueue;
+		delete jobSystem;
 	}
 	// public function to call private functions...
 	void ScoobzEngine::Initvulkan(){
-		InitWindow();
-		CreateInstance(); 
-		SetupDebugCallback();
-		CreateSurface();
-		GetPhysicalDevices();
-		CreateLogicalDevice();
-		swapchain = new SESwapChain(); // create instance of the swapchain so we can use it in the engine...
-		swapchain->Create(&logicalDevice, &physicalDevice, &surface, &windowObj, QuerySwapChainSupport(physicalDevice));//create the swapchain
-		CreateRenderPass();
-		CreateGraphicsPipeline();
-		swapchain->CreateFramebuffers(&renderPass); //create swapchain frame buffers, pass in renderpass information..
+		// GLFW has to be initialised on the main thread before any startup task touches it
+		if (!glfwInit()){
+			throw std::runtime_error("Failed to initialise GLFW");
+		}
 
-		QueueFamilyIndices indices = FindQueueFamilies(&physicalDevice, &surface);
-		graphicsCommandPool = new SECommandPool(&logicalDevice, indices.graphicsFamily);
-		transferCommandPool = new SECommandPool(&logicalDevice, indices.transferFamily, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+		jobSystem = new SEJobSystem();
+
+		// startup is a dependency graph, anything that doesnt depend on each other runs at the same time.
+		// window work stays on the main thread, everything else goes to the job workers
+		SETaskGraph startup;
+		auto windowTask = startup.AddTask("InitWindow", [this] { InitWindow(); }, {}, true);
+		auto instanceTask = startup.AddTask("CreateInstance", [this] { CreateInstance(); });
+		startup.AddTask("SetupDebugCallback", [this] { SetupDebugCallback(); }, { instanceTask });
+		auto surfaceTask = startup.AddTask("CreateSurface", [this] { CreateSurface(); }, { windowTask, instanceTask });
+		auto physicalDeviceTask = startup.AddTask("GetPhysicalDevices", [this] { GetPhysicalDevices(); }, { surfaceTask });
+		auto deviceTask = startup.AddTask("CreateLogicalDevice", [this] { CreateLogicalDevice(); }, { physicalDeviceTask });
+		auto shadersTask = startup.AddTask("LoadShaders", [this] { LoadShaders(); }, { deviceTask });
+		auto swapchainTask = startup.AddTask("CreateSwapChain", [this] {
+			swapchain = new SESwapChain(); // create instance of the swapchain so we can use it in the engine...
+			swapchain->Create(&logicalDevice, &physicalDevice, &surface, &windowObj, QuerySwapChainSupport(physicalDevice));//create the swapchain
+		}, { deviceTask });
+		auto renderGraphTask = startup.AddTask("CreateRenderGraph", [this] {
+			renderGraph = new SERenderGraph();
+			renderGraph->Create(&logicalDevice, &physicalDevice, MAX_FRAMES_IN_FLIGHT);
+		}, { deviceTask });
+		auto pipelineCacheTask = startup.AddTask("CreatePipelineCache", [this] {
+			pipelineCache = new SEPipelineCache();
+			pipelineCache->Create(&logicalDevice, jobSystem);
+		}, { deviceTask });
+		auto bindlessTask = startup.AddTask("CreateBindlessTable", [this] {
+			bindlessTable = new SEBindlessTable();
+			bindlessTable->Create(&logicalDevice, &physicalDevice, MAX_BINDLESS_IMAGES, MAX_BINDLESS_BUFFERS, MAX_FRAMES_IN_FLIGHT, descriptorIndexing);
+		}, { deviceTask });
+		auto pipelineLayoutTask = startup.AddTask("CreatePipelineLayout", [this] { CreatePipelineLayout(); }, { shadersTask, bindlessTask });
+		auto graphicsPipelineTask = startup.AddTask("CreateGraphicsPipeline", [this] { CreateGraphicsPipeline(); },
+			{ shadersTask, swapchainTask, renderGraphTask, pipelineCacheTask, pipelineLayoutTask });
+		startup.AddTask("CreateComputePipeline", [this] { CreateComputePipeline(); }, { shadersTask, pipelineCacheTask, pipelineLayoutTask });
+		auto commandPoolsTask = startup.AddTask("CreateCommandPools", [this] {
+			QueueFamilyIndices indices = FindQueueFamilies(&physicalDevice, &surface);
+			// command buffers are re-recorded every frame, so they need to be individually resettable
+			graphicsCommandPool = new SECommandPool(&logicalDevice, indices.graphicsFamily, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+			transferCommandPool = new SECommandPool(&logicalDevice, indices.transferFamily, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+		}, { deviceTask });
+		auto stageMeshTask = startup.AddTask("StageMeshData", [this] {
+			vertexBuffer = new SEVertexBuffer();
+			if (!meshVertices.empty()){
+				vertexBuffer->SetMesh(meshVertices, meshIndices);
+			}
+			vertexBuffer->Stage(&logicalDevice, &physicalDevice, &surface);
+		}, { deviceTask });
+		auto uploadMeshTask = startup.AddTask("UploadMeshData", [this] {
+			vertexBuffer->Upload(&logicalDevice, &physicalDevice, &surface, transferCommandPool->GetCommandPool(), &transferQueue);
+		}, { stageMeshTask, commandPoolsTask });
+		auto commandBuffersTask = startup.AddTask("CreateCommandBuffers", [this] { CreateCommandBuffers(); }, { commandPoolsTask });
+		// shares the graphics pool with the command buffers and, when theres no separate transfer family, the queue with the mesh upload
+		auto texturesTask = startup.AddTask("CreateTextures", [this] { CreateTextures(); }, { bindlessTask, commandBuffersTask, uploadMeshTask });
+		auto sceneTask = startup.AddTask("CreateScene", [this] { CreateScene(); }, { texturesTask });
+		// after the textures so nothing else is using the graphics pool and queue for its index upload
+		auto spriteBatchTask = startup.AddTask("CreateSpriteBatch", [this] { CreateSpriteBatch(); }, { texturesTask, graphicsPipelineTask });
+		auto tilemapTask = startup.AddTask("CreateTilemap", [this] { CreateTilemap(); }, { spriteBatchTask });
+		startup.AddTask("CreateTextRenderer", [this] { CreateTextRenderer(); }, { spriteBatchTask, tilemapTask });
+		startup.AddTask("CreateSyncObjects", [this] { CreateSyncObjects(); }, { deviceTask });
+		startup.AddTask("CreateFrameTimers", [this] { CreateFrameTimers(); }, { deviceTask });
+		auto drawResourcesTask = startup.AddTask("CreateDrawResources", [this] { CreateDrawResources(); }, { pipelineLayoutTask, stageMeshTask });
+		if (overdrawTest){
+			startup.AddTask("CreateOverdrawTest", [this] { CreateOverdrawTest(); }, { drawResourcesTask, sceneTask });
+		}
 
-		vertexBuffer = new SEVertexBuffer(&logicalDevice, &physicalDevice, &surface, transferCommandPool->GetCommandPool(), &transferQueue);
-		CreateCommandBuffers();
-		CreateSemaphores();
+		startup.Execute(jobSystem);
+		startup.PrintTimeline();
 	}
 
 	void ScoobzEngine::CleanupVulkan(){
+		// the device is idle, anything retired by a hot reload can go now
+		deletionQueue->Flush();
+		shaderWatcher->Cleanup();
+
 		CleanupSwapChain();
 
 		vertexBuffer->Cleanup(&logicalDevice);
 
-		vertexBuffer->Cleanup(&logicalDevice);
+		vertexBuffer->CleanupIndexBuffer(&logicalDevice);
+
+		pipelineCache->Cleanup();
+		renderGraph->Cleanup();
+		layoutCache->Cleanup();
+
+		frameDescriptors->Cleanup();
+		textureStreamer->PrintStats();
+		defaultTexture->Cleanup();
+		checkerTexture->Cleanup();
+		bindlessTable->Cleanup();
+		uniformRing->Cleanup(&logicalDevice);
+		if (gpuCulling){
+			gpuCulling->PrintStats();
+			gpuCulling->Cleanup();
+		}
+		if (spriteBatch){
+			spriteBatch->PrintStats();
+			spriteBatch->Cleanup();
+		}
+		if (tilemapRenderer){
+			tilemapRenderer->PrintStats();
+			tilemapRenderer->Cleanup();
+		}
+		if (textRenderer){
+			textRenderer->PrintStats();
+			textRenderer->Cleanup();
+		}
+		if (overdrawQueryPool != VK_NULL_HANDLE){
+			vkDestroyQueryPool(logicalDevice, overdrawQueryPool, VK_NULL_HANDLE);
+		}
+		if (timestampQueryPool != VK_NULL_HANDLE){
+			vkDestroyQueryPool(logicalDevice, timestampQueryPool, VK_NULL_HANDLE);
+		}
+
+		shaderLibrary->Release(vertShader);
+		shaderLibrary->Release(fragShader);
+		if (cullShader){
+			shaderLibrary->Release(cullShader);
+		}
+		if (spriteVertShader){
+			shaderLibrary->Release(spriteVertShader);
+			shaderLibrary->Release(spriteFragShader);
+		}
+		shaderLibrary->Cleanup();
 
-		vkDestroySemaphore(logicalDevice, renderFinishedSemaphore, VK_NULL_HANDLE);
-		vkDestroySemaphore(logicalDevice, imageAvailableSemaphore, VK_NULL_HANDLE);
+		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++){
+			vkDestroySemaphore(logicalDevice, renderFinishedSemaphores[i], VK_NULL_HANDLE);
+			vkDestroySemaphore(logicalDevice, imageAvailableSemaphores[i], VK_NULL_HANDLE);
+			vkDestroyFence(logicalDevice, inFlightFences[i], VK_NULL_HANDLE);
+		}
+
+		vkFreeCommandBuffers(logicalDevice, *graphicsCommandPool->GetCommandPool(), static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
 
 		graphicsCommandPool->Cleanup(&logicalDevice);
 		transferCommandPool->Cleanup(&logicalDevice);
@@ -54,26 +180,33 @@ namespace ScoobzEngine{
 		glfwTerminate();
 	}
 
+	// render passes and pipelines survive a resize, only the graphs images and framebuffers are window sized
 	void ScoobzEngine::CleanupSwapChain(){
-		swapchain->CleanupFramebuffers();
-
-		vkFreeCommandBuffers(logicalDevice, *graphicsCommandPool->GetCommandPool(), static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
-
-		vkDestroyPipeline(logicalDevice, graphicsPipeline, VK_NULL_HANDLE);
-		vkDestroyPipelineLayout(logicalDevice, pipelineLayout, VK_NULL_HANDLE);
-		vkDestroyRenderPass(logicalDevice, renderPass, VK_NULL_HANDLE);
-
+		renderGraph->ReleaseResources();
 		swapchain->Cleanup();
 	}
 
 	void ScoobzEngine::GameLoop(){
+		// the first frame is timed from here, not from whenever startup began
+		lastFrameStart = std::chrono::high_resolution_clock::now();
 		while (!glfwWindowShouldClose(windowObj.window)){
 			glfwPollEvents();
+			jobSystem->PumpMainThread();
 
+			ReloadChangedShaders();
 			DrawFrame();
 		}
 
 		vkDeviceWaitIdle(logicalDevice);
+		pipelineCache->PrintStats();
+		shaderLibrary->PrintStats();
+		frameDescriptors->PrintStats();
+		renderGraph->PrintStats();
+		perfHud.PrintStats();
+		PrintCullStats();
+		if (overdrawTest){
+			PrintOverdrawStats();
+		}
 		CleanupVulkan();
 	}
 
@@ -81,6 +214,7 @@ namespace ScoobzEngine{
 		windowObj.Create();
 		glfwSetWindowUserPointer(windowObj.window, this);
 		glfwSetWindowSizeCallback(windowObj.window, ScoobzEngine::OnWindowResized);
+		glfwSetKeyCallback(windowObj.window, ScoobzEngine::OnKey);
 	}
 
 	void ScoobzEngine::RecreateSwapChain(){
@@ -88,10 +222,7 @@ namespace ScoobzEngine{
 		CleanupSwapChain();
 
 		swapchain->Create(&logicalDevice, &physicalDevice, &surface, &windowObj, QuerySwapChainSupport(physicalDevice));
-		CreateRenderPass();
 		CreateGraphicsPipeline();
-		swapchain->CreateFramebuffers(&renderPass);
-		CreateCommandBuffers();
 	}
 
 	void ScoobzEngine::CreateInstance(){
@@ -230,6 +361,9 @@ namespace ScoobzEngine{
 		if (rankedDevices.rbegin()->first > 0){
 			physicalDevice = rankedDevices.rbegin()->second;
 			std::cout << "Physical Device found: SUCCESSFUL!" << std::endl;
+
+			colorTextureFormat = SelectBlockFormat(physicalDevice, SE_TEXTURE_COLOR, false);
+			std::cout << "Texture format: " << GetBlockFormatName(colorTextureFormat) << std::endl;
 		}
 		else{
 			throw std::runtime_error("No physical devices meet necessary criteria");
@@ -314,13 +448,45 @@ namespace ScoobzEngine{
 			queueCreateInfos.push_back(queueCreateInfo);
 		}
 
+		// bindless tables index their arrays with values from push constants
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
 		VkPhysicalDeviceFeatures deviceFeatures = {};
+		deviceFeatures.shaderSampledImageArrayDynamicIndexing = supportedFeatures.shaderSampledImageArrayDynamicIndexing;
+		deviceFeatures.shaderStorageBufferArrayDynamicIndexing = supportedFeatures.shaderStorageBufferArrayDynamicIndexing;
+		// SelectBlockFormat only picks BC formats when this is there
+		deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+		// only the overdraw test counts fragment shader invocations
+		deviceFeatures.pipelineStatisticsQuery = overdrawTest ? supportedFeatures.pipelineStatisticsQuery : VK_FALSE;
+		pipelineStatistics = deviceFeatures.pipelineStatisticsQuery == VK_TRUE;
+		// GPU culling writes one draw per object and puts the object index in firstInstance. the culling runs in
+		// the same command buffer as the draws, so the graphics family has to run compute too
+		if (indices.computeFamily == indices.graphicsFamily && supportedFeatures.multiDrawIndirect && supportedFeatures.drawIndirectFirstInstance){
+			deviceFeatures.multiDrawIndirect = VK_TRUE;
+			deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+			indirectDraws = true;
+		}
+
+		std::vector<const char*> enabledExtensions = deviceExtensions;
+		// lets the GPU say how many draws it culled down to instead of walking every object. not in the 1.0 headers
+		const char* drawIndirectCountExtension = nullptr;
+		if (indirectDraws){
+			if (HasDeviceExtension(physicalDevice, "VK_KHR_draw_indirect_count")){
+				drawIndirectCountExtension = "VK_KHR_draw_indirect_count";
+			}
+			else if (HasDeviceExtension(physicalDevice, "VK_AMD_draw_indirect_count")){
+				drawIndirectCountExtension = "VK_AMD_draw_indirect_count";
+			}
+			if (drawIndirectCountExtension){
+				enabledExtensions.push_back(drawIndirectCountExtension);
+			}
+		}
 
 		VkDeviceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 		createInfo.pNext = nullptr;
 		createInfo.flags = 0;
-		createInfo.queueCreateInfoCount = 1;
+		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 		if (enableValidationLayers){
 			createInfo.enabledLayerCount = validationLayers.size();
@@ -330,10 +496,25 @@ namespace ScoobzEngine{
 			createInfo.enabledLayerCount = 0;
 			createInfo.ppEnabledLayerNames = nullptr;
 		}
-		createInfo.enabledExtensionCount = deviceExtensions.size();
-		createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 		createInfo.pEnabledFeatures = &deviceFeatures;
 
+#ifdef VK_EXT_descriptor_indexing
+		// lets the bindless table leave slots empty. every feature used here is required by the extension
+		VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures = {};
+		indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+		indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+		indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+		indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+		indexingFeatures.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+		if (HasDeviceExtension(physicalDevice, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)){
+			enabledExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+			createInfo.pNext = &indexingFeatures;
+			descriptorIndexing = true;
+		}
+#endif
+		createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+		createInfo.ppEnabledExtensionNames = enabledExtensions.data();
+
 		if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &logicalDevice) != VK_SUCCESS){
 			throw std::runtime_error("Failed to create logical device");
 		}
@@ -343,201 +524,500 @@ namespace ScoobzEngine{
 
 		vkGetDeviceQueue(logicalDevice, indices.graphicsFamily, 0, &graphicsQueue);
 		vkGetDeviceQueue(logicalDevice, indices.transferFamily, 0, &transferQueue);
+
+		if (drawIndirectCountExtension){
+			bool khr = strcmp(drawIndirectCountExtension, "VK_KHR_draw_indirect_count") == 0;
+			drawIndexedIndirectCount = (SEDrawIndexedIndirectCount)vkGetDeviceProcAddr(logicalDevice,
+				khr ? "vkCmdDrawIndexedIndirectCountKHR" : "vkCmdDrawIndexedIndirectCountAMD");
+		}
 	}
 
-	void ScoobzEngine::CreateRenderPass(){
-		VkAttachmentDescription colorAttachment = {};
-		colorAttachment.format = *swapchain->GetImageFormat();
-		colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-		VkAttachmentReference colorAttachmentRef = {};
-		colorAttachmentRef.attachment = 0;
-		colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-		VkSubpassDescription subpass = {};
-		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpass.colorAttachmentCount = 1;
-		subpass.pColorAttachments = &colorAttachmentRef;
-
-		VkSubpassDependency dependency = {};
-		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependency.dstSubpass = 0;
-		dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependency.srcAccessMask = 0;
-		dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-		VkRenderPassCreateInfo renderPassInfo = {};
-		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		renderPassInfo.attachmentCount = 1;
-		renderPassInfo.pAttachments = &colorAttachment;
-		renderPassInfo.subpassCount = 1;
-		renderPassInfo.pSubpasses = &subpass;
-		renderPassInfo.dependencyCount = 1;
-		renderPassInfo.pDependencies = &dependency;
-
-		if (vkCreateRenderPass(logicalDevice, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS){
-			throw std::runtime_error("Failed to create Render pass");
+	// the library keeps the modules until CleanupVulkan, so swapchain recreation never goes back to the disk
+	void ScoobzEngine::LoadShaders(){
+		shaderLibrary = new SEShaderLibrary();
+		shaderLibrary->Create(&logicalDevice);
+
+		vertShader = shaderLibrary->Load("Shaders/vert.spv");
+		fragShader = shaderLibrary->Load("Shaders/frag.spv");
+		// optional, without it the scene is culled on the CPU
+		try{
+			cullShader = shaderLibrary->Load("Shaders/cull.spv");
 		}
-		else{
-			std::cout << "Render Pass Creation: SUCCESSFUL!" << std::endl;
+		catch (const std::exception& e){
+			std::cerr << "Culling shader not loaded, culling on the CPU: " << e.what() << std::endl;
+		}
+		// optional too, without them theres no sprite batch
+		try{
+			spriteVertShader = shaderLibrary->Load("Shaders/spritevert.spv");
+			spriteFragShader = shaderLibrary->Load("Shaders/spritefrag.spv");
+		}
+		catch (const std::exception& e){
+			std::cerr << "Sprite shaders not loaded, sprites are disabled: " << e.what() << std::endl;
+			if (spriteVertShader){
+				shaderLibrary->Release(spriteVertShader);
+				spriteVertShader = nullptr;
+			}
 		}
+
+		// recompiling a .spv while the game runs swaps it in without a restart
+		shaderWatcher = new SEFileWatcher();
+		shaderWatcher->Create("Shaders", ".spv");
 	}
 
-	void ScoobzEngine::CreateGraphicsPipeline(){
-		auto vertShaderCode = ReadFile("Shaders/vert.spv");
-		auto fragShaderCode = ReadFile("Shaders/frag.spv");
-
-		VkShaderModule vertShaderModule;
-		VkShaderModule fragShaderModule;
-
-		vertShaderModule = CreateShaderModule(vertShaderCode);
-		fragShaderModule = CreateShaderModule(fragShaderCode);
-
-		VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
-		vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-		vertShaderStageInfo.module = vertShaderModule;
-		vertShaderStageInfo.pName = "main";
-
-		VkPipelineShaderStageCreateInfo fragShaderStageInfo = {};
-		fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		fragShaderStageInfo.module = fragShaderModule;
-		fragShaderStageInfo.pName = "main";
-
-		VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
-
-		VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
-		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		auto bindingDescription = Vertex::getBindingDescription();
-		auto attributeDescriptions = Vertex::getAttributeDescriptions();
-		vertexInputInfo.vertexBindingDescriptionCount = 1;
-		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-		vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-		vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-		VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
-		inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-		inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-		inputAssembly.primitiveRestartEnable = false;
+	// a changed shader only rebuilds the pipelines that use it, in the background. they swap in at the start of
+	// a later frame and the pipelines they replace are destroyed once no frame in flight can be using them,
+	// so nothing here waits on the GPU
+	void ScoobzEngine::ReloadChangedShaders(){
+		for (const std::string& path : shaderWatcher->Poll()){
+			SEShader* shader;
+			VkShaderModule oldModule;
+			try{
+				shader = shaderLibrary->Reload(path, &oldModule, [this, &path](const SEShader* current, const SEShaderReflection& reflection){
+					return ReloadKeepsLayout(path, current, reflection);
+				});
+			}
+			catch (const std::exception& e){
+				std::cerr << "Shader reload failed, keeping the old one: " << e.what() << std::endl;
+				continue;
+			}
+			if (!shader){
+				continue;
+			}
+			if (oldModule == VK_NULL_HANDLE){
+				// the pipelines are keyed by module, so they cant tell which of the paths sharing it they were built for
+				std::cerr << "Shader reload: " << path << " had the same code as another shader, restart to pick it up" << std::endl;
+				continue;
+			}
 
-		VkViewport viewport = {};
-		viewport.x = 0.0f;
-		viewport.y = 0.0f;
-		viewport.width = (float)swapchain->GetExtent()->width;
-		viewport.height = (float)swapchain->GetExtent()->height;
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
+			uint32_t rebuilt = pipelineCache->ReplaceShader(oldModule, shader->module);
+			shaderLibrary->DestroyRetiredModule(oldModule);
 
-		VkRect2D scissor = {};
-		scissor.offset = { 0,0 };
-		scissor.extent = *swapchain->GetExtent();
+			std::cout << "Shader reload: " << path << ", rebuilding " << rebuilt << " pipelines" << std::endl;
+		}
+	}
 
-		VkPipelineViewportStateCreateInfo viewportState = {};
-		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-		viewportState.viewportCount = 1;
-		viewportState.pViewports = &viewport;
-		viewportState.scissorCount = 1;
-		viewportState.pScissors = &scissor;
-
-		VkPipelineRasterizationStateCreateInfo rasterizer = {};
-		rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-		rasterizer.depthClampEnable = VK_FALSE;
-		rasterizer.rasterizerDiscardEnable = VK_FALSE;
-		rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-		rasterizer.lineWidth = 1.0f;
-		rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-		rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-		rasterizer.depthBiasEnable = VK_FALSE;
-
-		VkPipelineMultisampleStateCreateInfo multisampling = {};
-		multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-		multisampling.sampleShadingEnable = VK_FALSE;
-		multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-		VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
-		colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-		colorBlendAttachment.blendEnable = VK_FALSE;
-
-		VkPipelineColorBlendStateCreateInfo colorBlending = {};
-		colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-		colorBlending.logicOpEnable = VK_FALSE;
-		colorBlending.attachmentCount = 1;
-		colorBlending.pAttachments = &colorBlendAttachment;
-
-		VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_LINE_WIDTH };
-
-		VkPipelineDynamicStateCreateInfo dynamicState = {};
-		dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-		dynamicState.dynamicStateCount = 2;
-		dynamicState.pDynamicStates = dynamicStates;
-
-		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-
-		if (vkCreatePipelineLayout(logicalDevice, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS){
-			throw std::runtime_error("Failed to create pipeline layout");
+	// the layout and vertex input are fixed at startup, and a pipeline built with a shader that doesnt match its
+	// layout is invalid, so a shader that changes its descriptor sets or push constants keeps the old one
+	bool ScoobzEngine::ReloadKeepsLayout(const std::string& path, const SEShader* current, const SEShaderReflection& reflection){
+		std::vector<const SEShaderReflection*> stages;
+		std::map<uint32_t, VkDescriptorSetLayout> fixedSets = { { SE_BINDLESS_SET, bindlessTable->GetLayout() } };
+		VkPipelineLayout layout = pipelineLayout;
+		if (current == vertShader || current == fragShader){
+			stages = { current == vertShader ? &reflection : &vertShader->reflection, current == fragShader ? &reflection : &fragShader->reflection, &GetDrawInterface() };
+		}
+		else if (spriteVertShader && (current == spriteVertShader || current == spriteFragShader)){
+			stages = { current == spriteVertShader ? &reflection : &spriteVertShader->reflection,
+				current == spriteFragShader ? &reflection : &spriteFragShader->reflection, &GetDrawInterface() };
+		}
+		else if (current == cullShader && cullLayoutInfo.layout != VK_NULL_HANDLE){
+			stages = { &reflection };
+			fixedSets.clear();
+			layout = cullLayoutInfo.layout;
 		}
 		else{
-			std::cout << "Pipeline Layout Creation: SUCCESSFUL!" << std::endl;
+			return true; // no pipeline is built from it
 		}
 
-		VkGraphicsPipelineCreateInfo pipelineInfo = {};
-		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		pipelineInfo.stageCount = 2;
-		pipelineInfo.pStages = shaderStages;
-		pipelineInfo.pVertexInputState = &vertexInputInfo;
-		pipelineInfo.pInputAssemblyState = &inputAssembly;
-		pipelineInfo.pViewportState = &viewportState;
-		pipelineInfo.pRasterizationState = &rasterizer;
-		pipelineInfo.pMultisampleState = &multisampling;
-		pipelineInfo.pColorBlendState = &colorBlending;
-		pipelineInfo.layout = pipelineLayout;
-		pipelineInfo.renderPass = renderPass;
-		pipelineInfo.subpass = 0;
+		SEPipelineLayoutInfo reloadedLayout = layoutCache->GetPipelineLayout(stages, fixedSets);
+		if (reloadedLayout.layout == layout){
+			return true;
+		}
+		layoutCache->Discard(reloadedLayout);
+		std::cerr << "Shader reload: " << path << " changed its descriptor sets or push constants, restart to pick them up" << std::endl;
+		return false;
+	}
+
+	// built from what the shaders declare plus the per-draw interface the engine always binds, so adding a
+	// uniform or texture to a shader needs no C++ changes here
+	void ScoobzEngine::CreatePipelineLayout(){
+		layoutCache = new SEDescriptorLayoutCache();
+		layoutCache->Create(&logicalDevice);
 
+		pipelineLayoutInfo = layoutCache->GetPipelineLayout({ &vertShader->reflection, &fragShader->reflection, &GetDrawInterface() },
+				{ { SE_BINDLESS_SET, bindlessTable->GetLayout() } });
+		pipelineLayout = pipelineLayoutInfo.layout;
 
-		if (vkCreateGraphicsPipelines(logicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS){
-			throw std::runtime_error("Failed to create Graphics pipeline");
+		std::cout << "Pipeline Layout Creation: SUCCESSFUL! (" << pipelineLayoutInfo.setLayouts.size() << " descriptor sets, "
+			<< (pipelineLayoutInfo.pushConstantRanges.empty() ? 0 : pipelineLayoutInfo.pushConstantRanges[0].size) << " bytes of push constants)" << std::endl;
+
+		// the draw interface keeps the layout right even when vert.spv is older than shader.vert, so a stale
+		// binary would only show up as every object drawn without its transform
+		bool readsObjects = false;
+		for (const SEShaderBinding& binding : vertShader->reflection.bindings){
+			readsObjects |= binding.set == 0 && binding.binding == 0;
+		}
+		if (!readsObjects || vertShader->reflection.pushConstantSize < sizeof(SEDrawConstants)){
+			std::cerr << "Shaders/vert.spv doesnt read the object array or the draw constants, recompile it from shader.vert" << std::endl;
+		}
+
+		// shader features are bool specialization constants, each pipeline picks its own set of them
+		shaderPermutations = new SEShaderPermutations();
+		shaderPermutations->Create({ &vertShader->reflection, &fragShader->reflection });
+		for (uint32_t i = 0; i < shaderPermutations->GetFeatureCount(); i++){
+			std::cout << "Shader feature " << i << ": " << shaderPermutations->GetFeatureName(i) << std::endl;
+		}
+
+		// every graphics pipeline takes the object index from the instance once culling is on the GPU, the CPU
+		// path still works with them by drawing each object as its own instance
+		uint32_t indirectFeature = shaderPermutations->GetFeatureBit("INDIRECT_DRAWS");
+		if (!indirectDraws){
+			std::cout << "GPU culling: the device cant draw indirectly from the graphics queue, culling on the CPU" << std::endl;
+		}
+		else if (!cullShader || indirectFeature == 0){
+			std::cout << "GPU culling: the shaders dont support it, culling on the CPU" << std::endl;
+			indirectDraws = false;
 		}
 		else{
-			std::cout << "Graphics Pipeline Creation: SUCCESSFUL!" << std::endl;
+			opaqueFeatures |= indirectFeature;
+			cullLayoutInfo = layoutCache->GetPipelineLayout({ &cullShader->reflection });
+		}
+
+		// sprites share the engines layout so the frames descriptor sets and push constants work for them as they are
+		if (spriteVertShader){
+			SEPipelineLayoutInfo spriteLayout = layoutCache->GetPipelineLayout({ &spriteVertShader->reflection, &spriteFragShader->reflection, &GetDrawInterface() },
+				{ { SE_BINDLESS_SET, bindlessTable->GetLayout() } });
+			if (spriteLayout.layout != pipelineLayout){
+				std::cerr << "Sprite shaders dont match the engines pipeline layout, sprites are disabled" << std::endl;
+				shaderLibrary->Release(spriteVertShader);
+				shaderLibrary->Release(spriteFragShader);
+				spriteVertShader = nullptr;
+				spriteFragShader = nullptr;
+			}
+		}
+	}
+
+	// per-object data lives in one uniform ring, each frames objects are one array the shaders index per draw
+	void ScoobzEngine::CreateDrawResources(){
+		uniformRing = new SEUniformRing();
+		// room for the sprite and tilemap views on top of the objects, 256 is the most an offset alignment can be
+		uniformRing->Create(&logicalDevice, &physicalDevice, &surface, MAX_DRAW_OBJECTS * sizeof(SEObjectUniforms) + 512, MAX_FRAMES_IN_FLIGHT);
+
+		frameDescriptors = new SEDescriptorAllocator();
+		frameDescriptors->Create(&logicalDevice, MAX_FRAMES_IN_FLIGHT);
+
+		// without descriptor indexing empty bindless slots still need something valid behind them
+		bindlessTable->SetDefaultBuffer(*uniformRing->GetBuffer(), 0, sizeof(SEObjectUniforms));
+
+		if (indirectDraws){
+			gpuCulling = new SEGpuCulling();
+			// the pyramid is about a third bigger than the buffer itself
+			uint32_t occlusionTexels = OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT * 4 / 3 + 16;
+			gpuCulling->Create(&logicalDevice, &physicalDevice, &surface, MAX_FRAMES_IN_FLIGHT, occlusionTexels, drawIndexedIndirectCount);
+			gpuCulling->SetMeshlets(vertexBuffer->GetMeshlets());
+		}
+
+		std::cout << "Draw Resources Creation: SUCCESSFUL!" << std::endl;
+	}
+
+	// textures are created on the graphics queue since building mips by blitting needs it
+	void ScoobzEngine::CreateTextures(){
+		const uint32_t white = 0xffffffff;
+		defaultTexture = new SETexture();
+		defaultTexture->Create(&logicalDevice, &physicalDevice, &surface, graphicsCommandPool->GetCommandPool(), &graphicsQueue, 1, 1, &white);
+		bindlessTable->SetDefaultImage(defaultTexture->GetView(), defaultTexture->GetSampler());
+
+		// a procedural checker, compressed to whatever the device samples best. only its smallest levels are
+		// uploaded here, the rest stream in over the first frames. real textures come through LoadTextureFile
+		const uint32_t size = 1024;
+		const uint32_t cell = 64;
+		std::vector<uint32_t> pixels(size * size);
+		for (uint32_t y = 0; y < size; y++){
+			for (uint32_t x = 0; x < size; x++){
+				pixels[y * size + x] = ((x / cell + y / cell) & 1) ? 0xffffffff : 0xff404040;
+			}
+		}
+		SETextureFile checkerFile = CompressTexture(reinterpret_cast<const uint8_t*>(pixels.data()), size, size, colorTextureFormat, false, jobSystem);
+		VkFormat checkerFormat = PrepareTextureFile(physicalDevice, checkerFile);
+		checkerTexture = new SETexture();
+		checkerTexture->CreateStreamed(&logicalDevice, &physicalDevice, &surface, graphicsCommandPool->GetCommandPool(), &graphicsQueue,
+			checkerFormat, std::move(checkerFile.levels), TEXTURE_STREAM_INITIAL_SIZE);
+
+		textureStreamer = new SETextureStreamer();
+		textureStreamer->Create(bindlessTable, TEXTURE_STREAM_BYTES_PER_FRAME);
+		checkerMaterial = textureStreamer->Add(checkerTexture);
+		std::cout << "Textures Creation: SUCCESSFUL!" << std::endl;
+	}
+
+	// the scene starts as one quad with the checker on it, materials are only known once the textures exist
+	void ScoobzEngine::CreateScene(){
+		objectStore = new SEObjectStore();
+		objectStore->Add(glm::mat4(1.0f), vertexBuffer->GetBoundsMin(), vertexBuffer->GetBoundsMax(), checkerMaterial);
+
+		sceneBvh = new SEBvh();
+		sceneBvh->Build(*objectStore);
+
+		occlusionBuffer = new SEOcclusionBuffer();
+		occlusionBuffer->Create(OCCLUSION_BUFFER_WIDTH, OCCLUSION_BUFFER_HEIGHT);
+
+		cullPath = GetBestCullPath();
+		std::cout << "Scene Creation: SUCCESSFUL! (" << GetCullPathName(cullPath) << " frustum culling)" << std::endl;
+	}
+
+	// only the occluders are drawn, so this costs next to nothing without any. both the CPU and the GPU culling
+	// test against the same pyramid
+	void ScoobzEngine::DrawOccluders(){
+		auto start = std::chrono::high_resolution_clock::now();
+
+		occlusionBuffer->Begin(viewProjection);
+		occlusionBuffer->DrawOccluders(*objectStore);
+		if (!occlusionBuffer->IsEmpty()){
+			occlusionBuffer->BuildHiZ();
+		}
+
+		occlusionMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// the frustum first, then whatever is left against the occluders. visible objects keep the order they were
+	// added in, and only their blocks go into the ring
+	void ScoobzEngine::CullScene(){
+		auto start = std::chrono::high_resolution_clock::now();
+
+		SEFrustum frustum = ExtractFrustum(viewProjection);
+		uint32_t visibleCount = CullObjects(*objectStore, frustum, cullPath, visibleObjects, jobSystem);
+		visibleCount = CullOccluded(*objectStore, *occlusionBuffer, visibleObjects, visibleCount);
+		cullObjectsOccluded += occlusionBuffer->GetStats().objectsOccluded;
+		// the ring only has room for so many blocks a frame, anything past that isnt drawn
+		visibleCount = std::min(visibleCount, MAX_DRAW_OBJECTS);
+		visibleObjects.resize(visibleCount);
+
+		// each object draws the coarsest level its size on screen allows. objects close enough for the full mesh
+		// are culled meshlet by meshlet, neighbouring meshlets that survive go out as one draw
+		const std::vector<SEMeshLod>& lods = vertexBuffer->GetLods();
+		const std::vector<SEMeshlet>& meshlets = vertexBuffer->GetMeshlets();
+		SELodView lodView = MakeLodView(viewProjection, static_cast<float>(swapchain->GetExtent()->height), LOD_PIXEL_ERROR);
+		glm::vec4 viewpoint = GetViewpoint(viewProjection);
+		objectUniforms.resize(visibleCount);
+		meshDraws.clear();
+		for (uint32_t i = 0; i < visibleCount; i++){
+			uint32_t index = visibleObjects[i];
+			objectUniforms[i].model = objectStore->GetTransform(index);
+			glm::vec3 center(objectStore->GetCenterX()[index], objectStore->GetCenterY()[index], objectStore->GetCenterZ()[index]);
+			uint32_t lod = SelectLod(lods, lodView, center, objectStore->GetRadius()[index]);
+			cullTrianglesFull += lods[0].indexCount / 3;
+
+			if (lod > 0 || meshlets.size() < 2){
+				meshDraws.push_back({ i, lods[lod].firstIndex, lods[lod].indexCount });
+				cullTriangles += lods[lod].indexCount / 3;
+				continue;
+			}
+
+			uint32_t meshletCount = CullMeshlets(meshlets, objectUniforms[i].model, frustum, viewpoint, visibleMeshlets);
+			cullMeshletsTested += meshlets.size();
+			cullMeshletsVisible += meshletCount;
+			for (uint32_t m = 0; m < meshletCount; m++){
+				const SEMeshlet& meshlet = meshlets[visibleMeshlets[m]];
+				SEMeshDraw* last = meshDraws.empty() ? nullptr : &meshDraws.back();
+				if (last && last->object == i && last->firstIndex + last->indexCount == meshlet.firstIndex){
+					last->indexCount += meshlet.indexCount;
+				}
+				else{
+					meshDraws.push_back({ i, meshlet.firstIndex, meshlet.indexCount });
+				}
+				cullTriangles += meshlet.indexCount / 3;
+			}
 		}
 
-		vkDestroyShaderModule(logicalDevice, vertShaderModule, VK_NULL_HANDLE);
-		vkDestroyShaderModule(logicalDevice, fragShaderModule, VK_NULL_HANDLE);
+		cullFrames++;
+		cullObjectsTested += objectStore->GetCount();
+		cullObjectsVisible += visibleCount;
+		cullMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
 	}
 
-	VkShaderModule ScoobzEngine::CreateShaderModule(const std::vector<char>& code){
+	void ScoobzEngine::PrintCullStats(){
+		if (cullFrames == 0){
+			return;
+		}
+		std::cout << "---- Frustum culling (" << GetCullPathName(cullPath) << ") ----" << std::endl;
+		std::cout << std::fixed << std::setprecision(2);
+		std::cout << "Objects: " << static_cast<double>(cullObjectsTested) / cullFrames << " tested, "
+			<< static_cast<double>(cullObjectsOccluded) / cullFrames << " occluded, "
+			<< static_cast<double>(cullObjectsVisible) / cullFrames << " visible per frame" << std::endl;
+		std::cout << "Triangles: " << static_cast<double>(cullTriangles) / cullFrames << " per frame, "
+			<< static_cast<double>(cullTrianglesFull) / cullFrames << " without LODs or meshlet culling" << std::endl;
+		if (cullMeshletsTested > 0){
+			std::cout << "Meshlets: " << static_cast<double>(cullMeshletsVisible) / cullFrames << " of "
+				<< static_cast<double>(cullMeshletsTested) / cullFrames << " drawn per frame" << std::endl;
+		}
+		std::cout << "Cull time: " << cullMs * 1000.0 / cullFrames << " us per frame, "
+			<< occlusionMs * 1000.0 / cullFrames << " us drawing occluders" << std::endl;
+		std::cout << std::defaultfloat;
+	}
 
-		VkShaderModuleCreateInfo createInfo = {};
-		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		createInfo.codeSize = code.size();
+	// the range is this frames object array, the dynamic offset is where it starts in the buffer. thats the
+	// uniform ring when culling on the CPU and the GPU cullings transforms otherwise
+	VkDescriptorSet ScoobzEngine::AllocateDrawDescriptorSet(VkBuffer objectBuffer, VkDeviceSize objectBytes){
+		VkDescriptorSet drawDescriptorSet = frameDescriptors->Allocate(pipelineLayoutInfo.setLayouts[0]);
+
+		VkDescriptorBufferInfo bufferInfo = {};
+		bufferInfo.buffer = objectBuffer;
+		bufferInfo.offset = 0;
+		bufferInfo.range = objectBytes;
+
+		VkWriteDescriptorSet descriptorWrite = {};
+		descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrite.dstSet = drawDescriptorSet;
+		descriptorWrite.dstBinding = 0;
+		descriptorWrite.dstArrayElement = 0;
+		descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.pBufferInfo = &bufferInfo;
+		vkUpdateDescriptorSets(logicalDevice, 1, &descriptorWrite, 0, nullptr);
+
+		return drawDescriptorSet;
+	}
 
-		std::vector<uint32_t> codeAligned(code.size() / sizeof(uint32_t) + 1);
-		memcpy(codeAligned.data(), code.data(), code.size());
-		createInfo.pCode = codeAligned.data();
+	// requested again on every swapchain recreation, the cache hands back the existing pipelines as long as
+	// the new render pass is compatible with the old one
+	void ScoobzEngine::CreateGraphicsPipeline(){
+		VkVertexInputBindingDescription bindingDescription;
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+		vertShader->reflection.GetPackedVertexInput(0, bindingDescription, attributeDescriptions);
+		if (bindingDescription.stride != sizeof(Vertex)){
+			throw std::runtime_error("Vertex shader inputs dont match the Vertex layout");
+		}
 
-		VkShaderModule shaderModule;
-		if (vkCreateShaderModule(logicalDevice, &createInfo, nullptr, &shaderModule) != VK_SUCCESS){
-			throw std::runtime_error("Failed to create shader module");
+		SEPipelineDesc pipelineDesc;
+		pipelineDesc.name = "Opaque";
+		pipelineDesc.vertShader = vertShader->module;
+		pipelineDesc.fragShader = fragShader->module;
+		pipelineDesc.specialization = shaderPermutations->Specialize(opaqueFeatures);
+		pipelineDesc.layout = pipelineLayout;
+		pipelineDesc.renderPass = renderGraph->GetCompatibleRenderPass({ *swapchain->GetImageFormat() }, swapchain->GetDepthFormat(),
+			&pipelineDesc.renderPassCompatibility);
+		pipelineDesc.vertexBindings = { bindingDescription };
+		pipelineDesc.vertexAttributes = attributeDescriptions;
+		pipelineDesc.depthTest = VK_TRUE;
+		pipelineDesc.depthCompare = VK_COMPARE_OP_LESS_OR_EQUAL;
+
+		// shading after the pre-pass only passes the depth already laid down, so theres nothing left to write
+		SEPipelineDesc noPrepassDesc = pipelineDesc;
+		noPrepassDesc.name = "OpaqueNoPrepass";
+		noPrepassDesc.depthWrite = VK_TRUE;
+
+		// same vertex stage as the opaque pipeline so both land on exactly the same depth
+		SEPipelineDesc depthDesc = noPrepassDesc;
+		depthDesc.name = "DepthPrepass";
+		depthDesc.fragShader = VK_NULL_HANDLE;
+		depthDesc.renderPass = renderGraph->GetCompatibleRenderPass({}, swapchain->GetDepthFormat(), &depthDesc.renderPassCompatibility);
+
+		// the fallback has no culling so anything drawn with it still shows up, its the only pipeline we block on.
+		// it writes depth, so shading is right whether or not the pre-pass ran
+		SEPipelineDesc fallbackDesc = noPrepassDesc;
+		fallbackDesc.name = "Fallback";
+		fallbackDesc.cullMode = VK_CULL_MODE_NONE;
+
+		fallbackPipeline = pipelineCache->Request(fallbackDesc);
+		pipelineCache->SetFallback(fallbackPipeline);
+		graphicsPipeline = pipelineCache->Request(pipelineDesc);
+		graphicsNoPrepassPipeline = pipelineCache->Request(noPrepassDesc);
+		depthPipeline = pipelineCache->Request(depthDesc);
+
+		// the tilemap is laid down before the scene, without depth so nothing has to sort against it
+		if (tilemapWidth > 0){
+			SEPipelineDesc tilemapDesc = pipelineDesc;
+			tilemapDesc.name = "Tilemap";
+			tilemapDesc.renderPass = renderGraph->GetCompatibleRenderPass({ *swapchain->GetImageFormat() }, VK_FORMAT_UNDEFINED,
+				&tilemapDesc.renderPassCompatibility);
+			tilemapDesc.cullMode = VK_CULL_MODE_NONE;
+			tilemapDesc.depthTest = VK_FALSE;
+			tilemapPipeline = pipelineCache->Request(tilemapDesc);
+		}
+
+		// sprites blend straight over the backbuffer after the scene, without depth
+		if (spriteVertShader){
+			auto spriteBinding = SESpriteVertex::getBindingDescription();
+			auto spriteAttributes = SESpriteVertex::getAttributeDescriptions();
+			SEPipelineDesc spriteDesc;
+			spriteDesc.name = "Sprite";
+			spriteDesc.vertShader = spriteVertShader->module;
+			spriteDesc.fragShader = spriteFragShader->module;
+			spriteDesc.specialization.Set(0, bindlessTable->GetImageCapacity());
+			spriteDesc.layout = pipelineLayout;
+			spriteDesc.renderPass = renderGraph->GetCompatibleRenderPass({ *swapchain->GetImageFormat() }, VK_FORMAT_UNDEFINED,
+				&spriteDesc.renderPassCompatibility);
+			spriteDesc.vertexBindings = { spriteBinding };
+			spriteDesc.vertexAttributes.assign(spriteAttributes.begin(), spriteAttributes.end());
+			spriteDesc.cullMode = VK_CULL_MODE_NONE;
+			spriteDesc.blendEnable = VK_TRUE;
+			spritePipeline = pipelineCache->Request(spriteDesc);
+			if (spriteBatch){
+				spriteBatch->SetPipeline(0, spritePipeline);
+			}
+		}
+
+		pipelineCache->Wait(fallbackPipeline);
+		if (!pipelineCache->IsReady(fallbackPipeline)){
+			throw std::runtime_error("Failed to create fallback pipeline");
 		}
 		else{
-			std::cout << "Shader Module Creation: SUCCESSFUL!" << std::endl;
+			std::cout << "Fallback Pipeline Creation: SUCCESSFUL!" << std::endl;
+		}
+	}
+
+	// only needed for GPU culling, until its compiled the scene is culled on the CPU
+	void ScoobzEngine::CreateComputePipeline(){
+		if (!indirectDraws){
+			return;
+		}
+
+		SEPipelineDesc cullDesc;
+		cullDesc.name = "Cull";
+		cullDesc.compShader = cullShader->module;
+		cullDesc.layout = cullLayoutInfo.layout;
+		cullPipeline = pipelineCache->Request(cullDesc);
+	}
+
+	void ScoobzEngine::CreateSpriteBatch(){
+		if (!spriteVertShader){
+			return;
+		}
+
+		spriteBatch = new SESpriteBatch();
+		spriteBatch->Create(&logicalDevice, &physicalDevice, &surface, graphicsCommandPool->GetCommandPool(), &graphicsQueue, MAX_SPRITES, MAX_FRAMES_IN_FLIGHT);
+		spriteBatch->AddPipeline(spritePipeline);
+	}
+
+	// after the sprite batch, which uses the same pool and queue for its own index upload
+	void ScoobzEngine::CreateTilemap(){
+		if (tilemapWidth == 0 || tilemapHeight == 0){
+			return;
+		}
+
+		tilemap = new SETilemap();
+		tilemap->Create(tilemapWidth, tilemapHeight);
+		tilemapRenderer = new SETilemapRenderer();
+		tilemapRenderer->Create(&logicalDevice, &physicalDevice, &surface, graphicsCommandPool->GetCommandPool(), &graphicsQueue, tilemap,
+			TILEMAP_CHUNK_SLOTS, TILEMAP_UPLOAD_BYTES_PER_FRAME, MAX_FRAMES_IN_FLIGHT);
+	}
+
+	// text is drawn as sprites, so theres none without the sprite batch. after the tilemap for the same reason it comes
+	// after the sprite batch, the atlas pages upload through the graphics pool and queue
+	void ScoobzEngine::CreateTextRenderer(){
+		if (fontPath.empty() || !spriteBatch){
+			return;
 		}
 
-		return shaderModule;
+		textRenderer = new SETextRenderer();
+		try{
+			textRenderer->Load(fontPath, fontPixelHeight);
+		}
+		catch (const std::runtime_error& e){
+			std::cerr << "Font not loaded, text is disabled: " << e.what() << std::endl;
+			delete textRenderer;
+			textRenderer = nullptr;
+			return;
+		}
+		textRenderer->Upload(&logicalDevice, &physicalDevice, &surface, graphicsCommandPool->GetCommandPool(), &graphicsQueue, bindlessTable);
+	}
+
+	void ScoobzEngine::DrawString(const std::string& text, const glm::vec2& position, uint32_t color){
+		if (textRenderer){
+			textRenderer->Draw(spriteBatch, text, position, color);
+		}
 	}
 
 	void ScoobzEngine::CreateCommandBuffers(){
-		commandBuffers.resize(swapchain->GetFramebufferSize());
+		commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
 
 		VkCommandBufferAllocateInfo allocInfo = {};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -551,79 +1031,452 @@ namespace ScoobzEngine{
 		else{
 			std::cout << "Command Buffers Creation: SUCCESSFUL!" << std::endl;
 		}
+	}
+
+	// recorded fresh every frame so draws pick up pipelines as soon as they finish compiling
+	void ScoobzEngine::RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex){
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-		for (size_t i = 0; i < commandBuffers.size(); i++){
-			VkCommandBufferBeginInfo beginInfo = {};
-			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT; //qeues command
+		vkBeginCommandBuffer(commandBuffer, &beginInfo);
 
-			vkBeginCommandBuffer(commandBuffers[i], &beginInfo);
+		// the frames GPU time runs from here to the end of the command buffer
+		frameDrawCalls = 0;
+		frameTriangles = 0;
+		if (timestampQueryPool != VK_NULL_HANDLE){
+			vkCmdResetQueryPool(commandBuffer, timestampQueryPool, static_cast<uint32_t>(currentFrame) * 2, 2);
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool, static_cast<uint32_t>(currentFrame) * 2);
+		}
+
+		// texture uploads cant happen inside a render pass, nor can remeshed tilemap chunks
+		textureStreamer->Record(commandBuffer, deletionQueue);
+		VkExtent2D extent = *swapchain->GetExtent();
+		if (tilemapRenderer){
+			tilemapRenderer->Prepare(static_cast<uint32_t>(currentFrame),
+				tilemapRenderer->GetView(static_cast<float>(extent.width), static_cast<float>(extent.height)));
+			tilemapRenderer->RecordUploads(commandBuffer);
+		}
 
-			VkRenderPassBeginInfo renderPassInfo = {};
-			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-			renderPassInfo.renderPass = renderPass;
-			renderPassInfo.framebuffer = *swapchain->GetFramebuffer(i);
-			renderPassInfo.renderArea.offset = { 0,0 };
-			renderPassInfo.renderArea.extent = *swapchain->GetExtent();
-			VkClearValue clearColor = { 0.0f, 0.0f, 0.0f, 1.0f };
-			renderPassInfo.clearValueCount = 1;
-			renderPassInfo.pClearValues = &clearColor;
+		DrawOccluders();
+
+		// the GPU culls as soon as its shader is compiled. it writes the draws before the graph starts any pass
+		bool gpuCull = gpuCulling && pipelineCache->IsReady(cullPipeline);
+		if (gpuCull){
+			SEFrustum frustum = ExtractFrustum(viewProjection);
+			gpuCulling->UploadOcclusion(*occlusionBuffer);
+			VkDescriptorSet cullDescriptorSet = frameDescriptors->Allocate(cullLayoutInfo.setLayouts[0]);
+			gpuCulling->WriteDescriptorSet(cullDescriptorSet);
+			SELodView lodView = MakeLodView(viewProjection, static_cast<float>(swapchain->GetExtent()->height), LOD_PIXEL_ERROR);
+			gpuCulling->RecordCull(commandBuffer, pipelineCache->Get(cullPipeline), cullLayoutInfo.layout, cullDescriptorSet,
+				frustum, lodView, vertexBuffer->GetLods(), GetViewpoint(viewProjection));
+		}
+		else{
+			CullScene();
+		}
+		bool anythingToDraw = gpuCull ? gpuCulling->GetObjectCount() > 0 : !objectUniforms.empty();
 
-			vkCmdBeginRenderPass(commandBuffers[i], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		if (overdrawQueryPool != VK_NULL_HANDLE){
+			vkCmdResetQueryPool(commandBuffer, overdrawQueryPool, static_cast<uint32_t>(currentFrame), 1);
+		}
 
-			vkCmdBindPipeline(commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+		// state set out here carries into every pass the graph begins
+		VkViewport viewport = {};
+		viewport.x = 0.0f;
+		viewport.y = 0.0f;
+		viewport.width = (float)swapchain->GetExtent()->width;
+		viewport.height = (float)swapchain->GetExtent()->height;
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
+		VkRect2D scissor = {};
+		scissor.offset = { 0,0 };
+		scissor.extent = *swapchain->GetExtent();
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+		// the pre-pass waits until both its pipeline and the one shading against it are ready, until then shading
+		// writes depth itself. falls back while the real pipeline is compiling, skips the draws if theres nothing to draw with
+		// or nothing in view. with nothing bound theres no pre-pass either, shading clears depth and the graph culls it
+		bool prepass = anythingToDraw && depthPrepass && pipelineCache->IsReady(depthPipeline) && pipelineCache->IsReady(graphicsPipeline);
+		VkPipeline pipeline = anythingToDraw ? pipelineCache->Get(prepass ? graphicsPipeline : graphicsNoPrepassPipeline) : VK_NULL_HANDLE;
+		VkDescriptorSet drawDescriptorSet = VK_NULL_HANDLE;
+		uint32_t firstObject = 0;
+		if (pipeline != VK_NULL_HANDLE){
 			VkBuffer vertexBuffers[] = { *vertexBuffer->GetBuffer() };
 			VkDeviceSize offsets[] = { 0 };
-			vkCmdBindVertexBuffers(commandBuffers[i], 0, 1, vertexBuffers, offsets);
+			vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
 
 			VkBuffer indexBuffer = *vertexBuffer->GetIndexBuffer();
-			vkCmdBindIndexBuffer(commandBuffers[i], indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+			vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+			// every objects block goes into the ring in one copy, and both sets are bound once for the whole frame,
+			// every pass included. draws only push their object and material index. GPU culling keeps every
+			// objects transform in its own buffer already, indexed by the instance
+			if (gpuCull){
+				drawDescriptorSet = AllocateDrawDescriptorSet(gpuCulling->GetTransformBuffer(), gpuCulling->GetTransformBytes());
+			}
+			else{
+				VkDeviceSize objectBytes = objectUniforms.size() * sizeof(SEObjectUniforms);
+				firstObject = uniformRing->WritePacked(objectUniforms.data(), objectBytes);
+				drawDescriptorSet = AllocateDrawDescriptorSet(*uniformRing->GetBuffer(), objectBytes);
+			}
 
-			vkCmdDrawIndexed(commandBuffers[i], static_cast<uint32_t>(vertexBuffer->GetIndicesSize()), 1, 0, 0, 0);
+			VkDescriptorSet descriptorSets[] = { drawDescriptorSet, bindlessTable->GetSet(static_cast<uint32_t>(currentFrame)) };
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 2, descriptorSets, 1, &firstObject);
+		}
 
-			vkCmdEndRenderPass(commandBuffers[i]);
+		// the pre-pass is always declared. when shading clears depth itself nothing reads what it wrote and the graph culls it
+		renderGraph->BeginFrame(static_cast<uint32_t>(currentFrame));
+		SEGraphResource backbuffer = renderGraph->ImportImage("Backbuffer", swapchain->GetImage(imageIndex), swapchain->GetImageView(imageIndex),
+			*swapchain->GetImageFormat(), extent, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		SEGraphResource depth = renderGraph->CreateImage("Depth", swapchain->GetDepthFormat(), extent);
+
+		VkClearValue clearColor = {};
+		clearColor.color = { 0.0f, 0.0f, 0.0f, 1.0f };
+		VkClearValue clearDepth = {};
+		clearDepth.depthStencil = { 1.0f, 0 };
+
+		SEGraphPass depthPass = renderGraph->AddPass("DepthPrepass", [this, gpuCull](VkCommandBuffer passCommandBuffer){
+			vkCmdBindPipeline(passCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCache->Get(depthPipeline));
+			RecordDraws(passCommandBuffer, gpuCull);
+		});
+		renderGraph->Write(depthPass, depth, SE_GRAPH_DEPTH_WRITE, &clearDepth);
+
+		// the tilemap goes down first and the scene over it. its view is one more object in the ring, in a set of its
+		// own, and the scenes sets go back once its drawn
+		bool tilemapDrawn = tilemapRenderer && tilemapRenderer->GetDrawCount() > 0 && pipelineCache->IsReady(tilemapPipeline);
+		if (tilemapDrawn){
+			SEObjectUniforms tilemapView = { tilemapRenderer->GetView(static_cast<float>(extent.width), static_cast<float>(extent.height)) };
+			uint32_t tilemapViewOffset = uniformRing->WritePacked(&tilemapView, sizeof(tilemapView));
+			VkDescriptorSet tilemapDescriptorSet = AllocateDrawDescriptorSet(*uniformRing->GetBuffer(), sizeof(SEObjectUniforms));
+
+			SEGraphPass tilemapPass = renderGraph->AddPass("Tilemap", [this, tilemapDescriptorSet, tilemapViewOffset, drawDescriptorSet, firstObject](VkCommandBuffer passCommandBuffer){
+				VkDescriptorSet descriptorSets[] = { tilemapDescriptorSet, bindlessTable->GetSet(static_cast<uint32_t>(currentFrame)) };
+				vkCmdBindDescriptorSets(passCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 2, descriptorSets, 1, &tilemapViewOffset);
+				vkCmdBindPipeline(passCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineCache->Get(tilemapPipeline));
+
+				SEDrawConstants drawConstants = {};
+				drawConstants.tint = glm::vec4(1.0f);
+				tilemapRenderer->RecordDraws(passCommandBuffer, pipelineLayout, pipelineLayoutInfo.pushConstantRanges[0].stageFlags, drawConstants);
+
+				// the scenes vertex and index buffers have to go back as well
+				if (drawDescriptorSet != VK_NULL_HANDLE){
+					vkCmdBindDescriptorSets(passCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &drawDescriptorSet, 1, &firstObject);
+					VkBuffer vertexBuffers[] = { *vertexBuffer->GetBuffer() };
+					VkDeviceSize offsets[] = { 0 };
+					vkCmdBindVertexBuffers(passCommandBuffer, 0, 1, vertexBuffers, offsets);
+					vkCmdBindIndexBuffer(passCommandBuffer, *vertexBuffer->GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+				}
+			});
+			renderGraph->Write(tilemapPass, backbuffer, SE_GRAPH_COLOR_WRITE, &clearColor);
+		}
 
-			if (vkEndCommandBuffer(commandBuffers[i]) != VK_SUCCESS){
-				throw std::runtime_error("Failed to record command buffer");
+		SEGraphPass opaquePass = renderGraph->AddPass("Opaque", [this, pipeline, prepass, gpuCull](VkCommandBuffer passCommandBuffer){
+			if (overdrawQueryPool != VK_NULL_HANDLE){
+				vkCmdBeginQuery(passCommandBuffer, overdrawQueryPool, static_cast<uint32_t>(currentFrame), 0);
+			}
+			if (pipeline != VK_NULL_HANDLE){
+				vkCmdBindPipeline(passCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+				RecordDraws(passCommandBuffer, gpuCull);
 			}
+			if (overdrawQueryPool != VK_NULL_HANDLE){
+				vkCmdEndQuery(passCommandBuffer, overdrawQueryPool, static_cast<uint32_t>(currentFrame));
+				overdrawQueryPending[currentFrame] = true;
+				overdrawQueryPrepass[currentFrame] = prepass;
+			}
+		});
+		renderGraph->Write(opaquePass, backbuffer, SE_GRAPH_COLOR_WRITE, tilemapDrawn ? nullptr : &clearColor);
+		if (prepass){
+			renderGraph->Read(opaquePass, depth, SE_GRAPH_DEPTH_READ);
+		}
+		else{
+			renderGraph->Write(opaquePass, depth, SE_GRAPH_DEPTH_WRITE, &clearDepth);
+		}
+
+		// everything drawn since the last frame goes over the scene, the HUD last so it sorts over the rest of its layer.
+		// the view is one more object in the ring, bound in its own set so the scenes draws are left alone
+		if (textRenderer && spriteBatch){
+			perfHud.Draw(spriteBatch, textRenderer, glm::vec2(8.0f));
+		}
+		uint32_t spriteCount = spriteBatch ? spriteBatch->Flush(static_cast<uint32_t>(currentFrame)) : 0;
+		if (textRenderer){
+			textRenderer->EndFrame();
+		}
+		if (spriteCount > 0){
+			SEObjectUniforms spriteView = { spriteBatch->GetView(static_cast<float>(extent.width), static_cast<float>(extent.height)) };
+			uint32_t spriteViewOffset = uniformRing->WritePacked(&spriteView, sizeof(spriteView));
+			VkDescriptorSet spriteDescriptorSet = AllocateDrawDescriptorSet(*uniformRing->GetBuffer(), sizeof(SEObjectUniforms));
+
+			SEGraphPass spritePass = renderGraph->AddPass("Sprites", [this, spriteDescriptorSet, spriteViewOffset](VkCommandBuffer passCommandBuffer){
+				VkDescriptorSet descriptorSets[] = { spriteDescriptorSet, bindlessTable->GetSet(static_cast<uint32_t>(currentFrame)) };
+				vkCmdBindDescriptorSets(passCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 2, descriptorSets, 1, &spriteViewOffset);
+
+				SEDrawConstants drawConstants = {};
+				drawConstants.tint = glm::vec4(1.0f);
+				spriteBatch->Record(passCommandBuffer, pipelineCache, pipelineLayout, pipelineLayoutInfo.pushConstantRanges[0].stageFlags, drawConstants);
+			});
+			renderGraph->Write(spritePass, backbuffer, SE_GRAPH_COLOR_WRITE);
+		}
+
+		renderGraph->Compile();
+		renderGraph->Execute(commandBuffer);
+
+		// the passes record as the graph executes, so this is where the frames counts are known
+		if (tilemapDrawn){
+			frameDrawCalls += tilemapRenderer->GetDrawCount();
+			frameTriangles += static_cast<uint64_t>(tilemapRenderer->GetQuadCount()) * 2;
+		}
+		if (spriteCount > 0){
+			frameDrawCalls += spriteBatch->GetBatchCount();
+			frameTriangles += static_cast<uint64_t>(spriteCount) * 2;
+		}
+		if (timestampQueryPool != VK_NULL_HANDLE){
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampQueryPool, static_cast<uint32_t>(currentFrame) * 2 + 1);
+			timestampPending[currentFrame] = true;
+		}
+
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS){
+			throw std::runtime_error("Failed to record command buffer");
 		}
 	}
 
-	void ScoobzEngine::CreateSemaphores(){
+	// the same draws go into the pre-pass and shading. the object index goes in firstInstance as well as the push
+	// constants, so these draws work with pipelines built for GPU culling too
+	void ScoobzEngine::RecordDraws(VkCommandBuffer commandBuffer, bool gpuCull){
+		SEDrawConstants drawConstants = {};
+		drawConstants.tint = glm::vec4(1.0f);
+
+		// indirect draws all share one push, the fragment shader doesnt read the material yet
+		if (gpuCull){
+			vkCmdPushConstants(commandBuffer, pipelineLayout, pipelineLayoutInfo.pushConstantRanges[0].stageFlags, 0, sizeof(SEDrawConstants), &drawConstants);
+			gpuCulling->RecordDraws(commandBuffer);
+			frameDrawCalls++;
+			// this frames draws arent known until its fence signals, the slots last count stands in for them
+			frameTriangles += gpuCulling->GetLastTriangleCount();
+			return;
+		}
+
+		// an object culled by meshlets can have several draws in a row, they share one push
+		uint32_t pushedObject = ~0u;
+		for (const auto& draw : meshDraws){
+			if (draw.object != pushedObject){
+				drawConstants.objectIndex = draw.object;
+				drawConstants.materialIndex = objectStore->GetMaterial(visibleObjects[draw.object]);
+				vkCmdPushConstants(commandBuffer, pipelineLayout, pipelineLayoutInfo.pushConstantRanges[0].stageFlags, 0, sizeof(SEDrawConstants), &drawConstants);
+				pushedObject = draw.object;
+			}
+			vkCmdDrawIndexed(commandBuffer, draw.indexCount, 1, draw.firstIndex, 0, draw.object);
+			frameTriangles += draw.indexCount / 3;
+		}
+		frameDrawCalls += static_cast<uint32_t>(meshDraws.size());
+	}
+
+	// full screen quads drawn back to front, the worst case for overdraw. without the pre-pass every layer
+	// passes the depth test and gets shaded, with it only the nearest one does
+	void ScoobzEngine::CreateOverdrawTest(){
+		objectStore->Clear();
+		for (uint32_t i = 0; i < OVERDRAW_TEST_LAYERS; i++){
+			// scale the quad over the whole screen and push it back
+			glm::mat4 model(1.0f);
+			model[0][0] = 2.0f;
+			model[1][1] = 2.0f;
+			model[3][2] = 1.0f - static_cast<float>(i + 1) / (OVERDRAW_TEST_LAYERS + 1);
+			objectStore->Add(model, QUAD_BOUNDS_MIN, QUAD_BOUNDS_MAX, checkerMaterial);
+		}
+
+		if (!pipelineStatistics){
+			std::cout << "Overdraw test: pipeline statistics queries arent supported, nothing will be measured" << std::endl;
+			return;
+		}
+
+		VkQueryPoolCreateInfo queryPoolInfo = {};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+		queryPoolInfo.queryCount = MAX_FRAMES_IN_FLIGHT;
+		queryPoolInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+		if (vkCreateQueryPool(logicalDevice, &queryPoolInfo, nullptr, &overdrawQueryPool) != VK_SUCCESS){
+			throw std::runtime_error("Failed to create overdraw query pool");
+		}
+		else{
+			std::cout << "Overdraw Test Creation: SUCCESSFUL! (" << OVERDRAW_TEST_LAYERS << " layers)" << std::endl;
+		}
+	}
+
+	// called once this frames fence has signalled, so its query from last time round is finished
+	void ScoobzEngine::UpdateOverdrawTest(){
+		if (overdrawQueryPool != VK_NULL_HANDLE && overdrawQueryPending[currentFrame]){
+			uint64_t invocations = 0;
+			if (vkGetQueryPoolResults(logicalDevice, overdrawQueryPool, static_cast<uint32_t>(currentFrame), 1,
+				sizeof(invocations), &invocations, sizeof(invocations), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS){
+				int mode = overdrawQueryPrepass[currentFrame] ? 1 : 0;
+				overdrawInvocations[mode] += invocations;
+				overdrawPixels[mode] += static_cast<uint64_t>(swapchain->GetExtent()->width) * swapchain->GetExtent()->height;
+			}
+			overdrawQueryPending[currentFrame] = false;
+		}
+
+		if (++overdrawFrames % OVERDRAW_TEST_FRAMES == 0){
+			PrintOverdrawStats();
+			depthPrepass = !depthPrepass;
+		}
+	}
+
+	void ScoobzEngine::PrintOverdrawStats(){
+		const char* modeNames[] = { "without depth pre-pass", "with depth pre-pass" };
+		for (int mode = 0; mode < 2; mode++){
+			if (overdrawPixels[mode] == 0){
+				continue;
+			}
+			double overdraw = static_cast<double>(overdrawInvocations[mode]) / overdrawPixels[mode];
+			std::cout << "Overdraw " << modeNames[mode] << ": " << overdraw << " fragments shaded per pixel" << std::endl;
+		}
+	}
+
+	void ScoobzEngine::CreateSyncObjects(){
+		imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+		renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+		inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
 
 		VkSemaphoreCreateInfo semaphoreInfo = {};
 		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-		if (vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &imageAvailableSemaphore) != VK_SUCCESS
-			|| vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &renderFinishedSemaphore) != VK_SUCCESS){
-			throw std::runtime_error("Failed to Create Semaphores");
+		// start signaled so the first wait on each frame doesnt block forever
+		VkFenceCreateInfo fenceInfo = {};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++){
+			if (vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS
+				|| vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS
+				|| vkCreateFence(logicalDevice, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS){
+				throw std::runtime_error("Failed to Create Sync Objects");
+			}
+		}
+
+		// same slots as the fences, so a retired object lives until its slots fence comes round again
+		deletionQueue = new SEDeletionQueue();
+		deletionQueue->Create(MAX_FRAMES_IN_FLIGHT);
+		std::cout << "Sync Objects Creation: SUCCESSFUL!" << std::endl;
+	}
+
+	// timestamps need the graphics queue to write them. without that the HUD and stats leave GPU time out
+	void ScoobzEngine::CreateFrameTimers(){
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		QueueFamilyIndices indices = FindQueueFamilies(&physicalDevice, &surface);
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+		uint32_t validBits = queueFamilies[indices.graphicsFamily].timestampValidBits;
+		if (validBits == 0 || properties.limits.timestampPeriod <= 0.0f){
+			std::cout << "Frame timers: the graphics queue cant write timestamps, GPU time wont be measured" << std::endl;
+			return;
+		}
+		timestampPeriod = properties.limits.timestampPeriod;
+		timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+		VkQueryPoolCreateInfo queryPoolInfo = {};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = MAX_FRAMES_IN_FLIGHT * 2;
+
+		if (vkCreateQueryPool(logicalDevice, &queryPoolInfo, nullptr, &timestampQueryPool) != VK_SUCCESS){
+			throw std::runtime_error("Failed to create timestamp query pool");
 		}
 		else{
-			std::cout << "Semaphores Creation: SUCCESSFUL!" << std::endl;
+			std::cout << "Frame Timers Creation: SUCCESSFUL!" << std::endl;
 		}
 	}
 
+	// called once this frames fence has signalled, so the timestamps it wrote last time round are there
+	void ScoobzEngine::ReadFrameTimestamps(){
+		if (timestampQueryPool == VK_NULL_HANDLE || !timestampPending[currentFrame]){
+			return;
+		}
+		uint64_t timestamps[2] = {};
+		if (vkGetQueryPoolResults(logicalDevice, timestampQueryPool, static_cast<uint32_t>(currentFrame) * 2, 2,
+			sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS){
+			uint64_t ticks = ((timestamps[1] & timestampMask) - (timestamps[0] & timestampMask)) & timestampMask;
+			gpuFrameMs = static_cast<float>(ticks * static_cast<double>(timestampPeriod) / 1e6);
+		}
+		timestampPending[currentFrame] = false;
+	}
+
 	void ScoobzEngine::DrawFrame(){
+		auto frameStart = std::chrono::high_resolution_clock::now();
+		// wait until the GPU is done with this frames command buffer before recording over it
+		vkWaitForFences(logicalDevice, 1, &inFlightFences[currentFrame], VK_TRUE, std::numeric_limits<uint64_t>::max());
+		auto waitEnd = std::chrono::high_resolution_clock::now();
+		ReadFrameTimestamps();
+		if (overdrawTest){
+			UpdateOverdrawTest();
+		}
+		deletionQueue->BeginFrame(static_cast<uint32_t>(currentFrame));
+		uniformRing->BeginFrame(static_cast<uint32_t>(currentFrame));
+		frameDescriptors->BeginFrame(static_cast<uint32_t>(currentFrame));
+		bindlessTable->BeginFrame(static_cast<uint32_t>(currentFrame));
+		pipelineCache->SwapRebuilt(deletionQueue);
+		// everything that keeps its own copy of the scene catches up on what changed since the last frame
+		sceneBvh->Update(*objectStore);
+		if (gpuCulling){
+			gpuCulling->BeginFrame(static_cast<uint32_t>(currentFrame), *objectStore, deletionQueue);
+		}
+		objectStore->ClearChanges();
+
 		uint32_t imageIndex;
-		vkAcquireNextImageKHR(logicalDevice, *swapchain->GetSwapchain(), std::numeric_limits<uint64_t>::max(), imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
+		auto acquireStart = std::chrono::high_resolution_clock::now();
+		vkAcquireNextImageKHR(logicalDevice, *swapchain->GetSwapchain(), std::numeric_limits<uint64_t>::max(), imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+		auto acquireEnd = std::chrono::high_resolution_clock::now();
+
+		vkResetFences(logicalDevice, 1, &inFlightFences[currentFrame]);
+		vkResetCommandBuffer(commandBuffers[currentFrame], 0);
+		RecordCommandBuffer(commandBuffers[currentFrame], imageIndex);
 
 		VkSubmitInfo submitInfo = {};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		VkSemaphore waitSemaphores[] = { imageAvailableSemaphore };
+		VkSemaphore waitSemaphores[] = { imageAvailableSemaphores[currentFrame] };
 		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 		submitInfo.waitSemaphoreCount = 1;
 		submitInfo.pWaitSemaphores = waitSemaphores;
 		submitInfo.pWaitDstStageMask = waitStages;
-		VkSemaphore signalSemaphores[] = { renderFinishedSemaphore };
+		VkSemaphore signalSemaphores[] = { renderFinishedSemaphores[currentFrame] };
 		submitInfo.signalSemaphoreCount = 1;
 		submitInfo.pSignalSemaphores = signalSemaphores;
 		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffers[imageIndex];
+		submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
 
-		if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS){
+		if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS){
 			throw std::runtime_error("Failed to submit draw command buffer");
 		}
+		auto submitEnd = std::chrono::high_resolution_clock::now();
+
+		// the GPU time is from the newest frame it finished, everything else is this one
+		SEMemoryStats memoryStats = SEBuffer::GetMemoryStats();
+		SEFrameSample sample = {};
+		sample.frameMs = std::chrono::duration<float, std::milli>(frameStart - lastFrameStart).count();
+		sample.cpuMs = std::chrono::duration<float, std::milli>((submitEnd - waitEnd) - (acquireEnd - acquireStart)).count();
+		sample.gpuMs = gpuFrameMs;
+		sample.fenceWaitMs = std::chrono::duration<float, std::milli>(waitEnd - frameStart).count();
+		sample.drawCalls = frameDrawCalls;
+		sample.triangles = frameTriangles;
+		sample.allocations = memoryStats.liveAllocations;
+		sample.newAllocations = memoryStats.totalAllocations - lastTotalAllocations;
+		for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++){
+			if (memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT){
+				sample.deviceBytes += memoryStats.bytesByType[i];
+			}
+			else{
+				sample.hostBytes += memoryStats.bytesByType[i];
+			}
+		}
+		perfHud.AddSample(sample);
+		lastTotalAllocations = memoryStats.totalAllocations;
+		lastFrameStart = frameStart;
 
 		VkPresentInfoKHR presentInfo = {};
 		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -636,29 +1489,33 @@ namespace ScoobzEngine{
 		presentInfo.pImageIndices = &imageIndex;
 
 		vkQueuePresentKHR(graphicsQueue, &presentInfo);
+
+		currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 	}
 
 	bool ScoobzEngine::CheckDeviceExtensionSupport(VkPhysicalDevice device){
+		for (const char* currentExtension : deviceExtensions){
+			if (!HasDeviceExtension(device, currentExtension)){
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool ScoobzEngine::HasDeviceExtension(VkPhysicalDevice device, const char* extensionName){
 		uint32_t extensionCount;
 		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
 
 		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
 		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
-		for (const char* currentExtension : deviceExtensions){
-			bool extensionFound = false;
-			for (const auto& extension : availableExtensions){
-				if (strcmp(currentExtension, extension.extensionName) == 0){
-					extensionFound = true;
-					break;
-				}
-			}
-			if (!extensionFound){
-				return false;
+		for (const auto& extension : availableExtensions){
+			if (strcmp(extensionName, extension.extensionName) == 0){
+				return true;
 			}
 		}
-
-		return true;
+		return false;
 	}
 
 	void ScoobzEngine::OnWindowResized(GLFWwindow* window, int width, int height) {
@@ -669,6 +1526,13 @@ namespace ScoobzEngine{
 		engine->RecreateSwapChain();
 	}
 
+	void ScoobzEngine::OnKey(GLFWwindow* window, int key, int scancode, int action, int mods){
+		if (key == GLFW_KEY_F3 && action == GLFW_PRESS){
+			ScoobzEngine* engine = reinterpret_cast<ScoobzEngine*>(glfwGetWindowUserPointer(window));
+			engine->ToggleHud();
+		}
+	}
+
 	VkResult ScoobzEngine::CreateDebugReportCallbackEXT(
 		VkInstance instance, 
 		const VkDebugReportCallbackCreateInfoEXT* pCreateInfo,
@@ -2,7 +2,9 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 #include <vulkan/vulkan.h>
+#include <chrono>
 #include <fstream>
+#include <iomanip>
 #include <map>
 #include <set>
 
@@ -12,9 +14,62 @@
 #include "SEVertexBuffer.h"
 #include "SEQueueFamily.h"
 #include "SECommandPool.h"
+#include "SEJobSystem.h"
+#include "SETaskGraph.h"
+#include "SEPipelineCache.h"
+#include "SERenderGraph.h"
+#include "SEFrustumCull.h"
+#include "SEGpuCulling.h"
+#include "SEOcclusionCull.h"
+#include "SEBvh.h"
+#include "SESpriteBatch.h"
+#include "SETilemap.h"
+#include "SETilemapRenderer.h"
+#include "SETextRenderer.h"
+#include "SEPerfHud.h"
+#include "SESpirvReflect.h"
+#include "SEShaderLibrary.h"
+#include "SEShaderPermutations.h"
+#include "SEUniformRing.h"
+#include "SEDrawData.h"
+#include "SEDescriptorLayoutCache.h"
+#include "SEDescriptorAllocator.h"
+#include "SEBindlessTable.h"
+#include "SETexture.h"
+#include "SETextureStreamer.h"
+#include "SETextureFile.h"
+#include "SEDeletionQueue.h"
+#include "SEFileWatcher.h"
 
 namespace ScoobzEngine{
 
+	// how many frames the CPU can record ahead of the GPU
+	const int MAX_FRAMES_IN_FLIGHT = 2;
+	// objects one frame can draw, their blocks are packed into the uniform ring
+	const uint32_t MAX_DRAW_OBJECTS = 65536;
+	// bindless table capacity, clamped to what the device allows
+	const uint32_t MAX_BINDLESS_IMAGES = 4096;
+	const uint32_t MAX_BINDLESS_BUFFERS = 1024;
+	// streamed textures start with every level up to this size resident, then upload at most this much a frame
+	const uint32_t TEXTURE_STREAM_INITIAL_SIZE = 32;
+	const VkDeviceSize TEXTURE_STREAM_BYTES_PER_FRAME = 1 << 20;
+	// the overdraw test draws this many full screen layers back to front, and flips the pre-pass this often
+	const uint32_t OVERDRAW_TEST_LAYERS = 16;
+	const uint32_t OVERDRAW_TEST_FRAMES = 240;
+	// the CPU occlusion buffer occluders are drawn into, powers of two. it covers the whole view whatever its shape
+	const uint32_t OCCLUSION_BUFFER_WIDTH = 256;
+	const uint32_t OCCLUSION_BUFFER_HEIGHT = 128;
+	// objects draw the coarsest level of the mesh that moves its surface by no more than this many pixels
+	const float LOD_PIXEL_ERROR = 1.0f;
+	// sprites one frame can draw, each frame in flight has room for 4 vertices of 16 bytes a sprite
+	const uint32_t MAX_SPRITES = 262144;
+	// tilemap chunks that can have geometry at once, about 80 KB each, and how much remeshed geometry uploads a frame
+	const uint32_t TILEMAP_CHUNK_SLOTS = 256;
+	const VkDeviceSize TILEMAP_UPLOAD_BYTES_PER_FRAME = 4 << 20;
+	// local bounds of the quad in SEVertexBuffer, a unit square at z 0
+	const glm::vec3 QUAD_BOUNDS_MIN(-0.5f, -0.5f, 0.0f);
+	const glm::vec3 QUAD_BOUNDS_MAX(0.5f, 0.5f, 0.0f);
+
 	static std::vector<char> ReadFile(const std::string& filename){
 		std::ifstream file(filename, std::ios::ate | std::ios::binary);
 
@@ -42,12 +97,55 @@ namespace ScoobzEngine{
 		void CleanupVulkan(); 
 		void GameLoop();
 
+		// lays depth down before shading so each pixel is only shaded once, worth it when theres a lot of overdraw
+		void SetDepthPrepass(bool enabled) { depthPrepass = enabled; }
+		// call before Initvulkan. replaces the scene with stacked full screen quads and reports fragment shader
+		// invocations per pixel with and without the pre-pass, flipping between them every OVERDRAW_TEST_FRAMES
+		void SetOverdrawTest(bool enabled) { overdrawTest = enabled; }
+		// call before Initvulkan. the mesh every object draws in place of the quad, its LOD chain is generated
+		// while the engine starts up
+		void SetMesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) { meshVertices = vertices; meshIndices = indices; }
+		// call before Initvulkan. a tilemap this many tiles across and down, drawn under everything else
+		void SetTilemap(uint32_t width, uint32_t height) { tilemapWidth = width; tilemapHeight = height; }
+		// call before Initvulkan. a TrueType font for in-engine text, pixels from ascent to descent
+		void SetFont(const std::string& path, float pixelHeight) { fontPath = path; fontPixelHeight = pixelHeight; }
+		// text in pixels from the top left of the window, shows up in the next frame like any sprite. does nothing
+		// without a font or sprite batch
+		void DrawString(const std::string&, const glm::vec2&, uint32_t = 0xffffffff);
+		// frame timings, draws and memory over a frame time graph in the top left corner, F3 flips it. needs a font
+		// from SetFont and the sprite batch, hidden until shown
+		void SetHudVisible(bool visible) { perfHud.SetVisible(visible); }
+		void ToggleHud() { perfHud.Toggle(); }
+
+		//Getters
+		// shared job system for engine and game code, valid after Initvulkan
+		SEJobSystem* GetJobSystem() { return jobSystem; }
+		// the scene, valid after Initvulkan. objects are culled against the view every frame and only the visible
+		// ones are drawn, anything added or moved between frames shows up in the next one. culling runs on the GPU
+		// when the device can draw indirectly, on the CPU otherwise
+		SEObjectStore* GetObjectStore() { return objectStore; }
+		// a BVH over every objects world bounds for picking, ray and area queries, ids are store indices. kept up
+		// to date at the start of every frame, refit when objects only moved and rebuilt when any were added or removed
+		const SEBvh* GetSceneBvh() { return sceneBvh; }
+		// 2D sprites drawn over the scene, valid after Initvulkan. whatever is drawn between two frames shows up in the
+		// next one, in pixels from the top left of the window unless the batch is given its own view. null when
+		// Shaders/spritevert.spv or spritefrag.spv is missing
+		SESpriteBatch* GetSpriteBatch() { return spriteBatch; }
+		// the tiles from SetTilemap, valid after Initvulkan and null without it. edits show up in the next frame, only
+		// the chunks they touch are remeshed and only once theyre in view
+		SETilemap* GetTilemap() { return tilemap; }
+		// where the tilemap is viewed from, 32 pixels a tile from the top left of the window unless given a view
+		SETilemapRenderer* GetTilemapRenderer() { return tilemapRenderer; }
+		// the font from SetFont, valid after Initvulkan. null without one, or when it couldnt be loaded
+		SETextRenderer* GetTextRenderer() { return textRenderer; }
+
 		//HANDLES :: PUBLIC
 		Window windowObj;
 
 	private:
 		//FUNCTIONS :: PRIVATE
 		static void OnWindowResized(GLFWwindow*, int, int);
+		static void OnKey(GLFWwindow*, int, int, int, int);
 		void InitWindow();
 		void CreateInstance();
 		void CleanupSwapChain();
@@ -60,13 +158,34 @@ namespace ScoobzEngine{
 		int RateDeviceSuitability(VkPhysicalDevice);
 		void CreateLogicalDevice();
 		void RecreateSwapChain();
-		void CreateRenderPass();
+		void LoadShaders();
+		void CreatePipelineLayout();
+		void CreateDrawResources();
+		VkDescriptorSet AllocateDrawDescriptorSet(VkBuffer, VkDeviceSize);
+		void CreateTextures();
+		void CreateScene();
+		void DrawOccluders();
+		void CullScene();
+		void PrintCullStats();
 		void CreateGraphicsPipeline();
-		VkShaderModule CreateShaderModule(const std::vector<char>&);
+		void CreateComputePipeline();
+		void CreateSpriteBatch();
+		void CreateTilemap();
+		void CreateTextRenderer();
 		void CreateCommandBuffers();
-		void CreateSemaphores();
+		void RecordCommandBuffer(VkCommandBuffer, uint32_t);
+		void RecordDraws(VkCommandBuffer, bool);
+		void CreateOverdrawTest();
+		void UpdateOverdrawTest();
+		void PrintOverdrawStats();
+		void CreateSyncObjects();
+		void CreateFrameTimers();
+		void ReadFrameTimestamps();
 		void DrawFrame();
+		void ReloadChangedShaders();
+		bool ReloadKeepsLayout(const std::string&, const SEShader*, const SEShaderReflection&);
 		bool CheckDeviceExtensionSupport(VkPhysicalDevice);
+		bool HasDeviceExtension(VkPhysicalDevice, const char*);
 
 		VkResult CreateDebugReportCallbackEXT(VkInstance, const VkDebugReportCallbackCreateInfoEXT*, const VkAllocationCallbacks*, VkDebugReportCallbackEXT*);
 		static void DestroyDebugReportCallbackEXT(VkInstance, VkDebugReportCallbackEXT, const VkAllocationCallbacks*);
@@ -76,6 +195,7 @@ namespace ScoobzEngine{
 		const std::vector<const char*> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
 		//HANDLES :: PRIVATE
+		SEJobSystem* jobSystem = nullptr;
 		VkInstance instance;
 		VkDebugReportCallbackEXT callback;
 		VkSurfaceKHR surface;
@@ -83,16 +203,99 @@ namespace ScoobzEngine{
 		VkDevice logicalDevice;
 		VkQueue graphicsQueue;
 		VkQueue transferQueue;
-		SESwapChain* swapchain;
-		VkRenderPass renderPass;
+		SESwapChain* swapchain = nullptr;
+		SERenderGraph* renderGraph = nullptr; // builds the frames render passes, barriers and attachments
+		SEDescriptorLayoutCache* layoutCache = nullptr;
+		SEPipelineLayoutInfo pipelineLayoutInfo;
 		VkPipelineLayout pipelineLayout;
-		VkPipeline graphicsPipeline;
-		SECommandPool* graphicsCommandPool;
-		SECommandPool* transferCommandPool;
-		SEVertexBuffer* vertexBuffer;
-		std::vector<VkCommandBuffer> commandBuffers;
-		VkSemaphore imageAvailableSemaphore;
-		VkSemaphore renderFinishedSemaphore;
+		SEPipelineCache* pipelineCache = nullptr;
+		SEPipelineHandle graphicsPipeline = SE_INVALID_PIPELINE; // shades against the pre-pass depth without writing it
+		SEPipelineHandle graphicsNoPrepassPipeline = SE_INVALID_PIPELINE; // tests and writes depth itself
+		SEPipelineHandle depthPipeline = SE_INVALID_PIPELINE;
+		bool depthPrepass = true;
+		SEPipelineHandle fallbackPipeline = SE_INVALID_PIPELINE;
+		SEPipelineLayoutInfo cullLayoutInfo = {};
+		SEPipelineHandle cullPipeline = SE_INVALID_PIPELINE;
+		SEPipelineHandle spritePipeline = SE_INVALID_PIPELINE; // alpha blended over the scene, the sprite batches pipeline 0
+		SEPipelineHandle tilemapPipeline = SE_INVALID_PIPELINE; // the opaque shaders without depth, under the scene
+		SECommandPool* graphicsCommandPool = nullptr;
+		SECommandPool* transferCommandPool = nullptr;
+		SEVertexBuffer* vertexBuffer = nullptr;
+		std::vector<Vertex> meshVertices; // from SetMesh, empty keeps the quad
+		std::vector<uint32_t> meshIndices;
+		SEUniformRing* uniformRing = nullptr;
+		SEDescriptorAllocator* frameDescriptors = nullptr; // sets that only live for the frame theyre recorded in
+		SEBindlessTable* bindlessTable = nullptr;
+		bool descriptorIndexing = false; // VK_EXT_descriptor_indexing enabled on the device
+		SEBlockFormat colorTextureFormat = SE_BLOCK_RGBA8; // best colour format the physical device can sample
+		SETexture* defaultTexture = nullptr; // what empty bindless image slots point at
+		SETexture* checkerTexture = nullptr;
+		uint32_t checkerMaterial = 0; // bindless index of checkerTexture
+		SETextureStreamer* textureStreamer = nullptr;
+		SEObjectStore* objectStore = nullptr;
+		SECullPath cullPath = SE_CULL_SCALAR; // widest the cpu can run, picked once at startup
+		glm::mat4 viewProjection = glm::mat4(1.0f); // theres no camera yet, model matrices go straight to clip space
+		SEBvh* sceneBvh = nullptr;
+		SEOcclusionBuffer* occlusionBuffer = nullptr; // the objects flagged as occluders, drawn again every frame
+		std::vector<uint32_t> visibleObjects; // indices into objectStore that survived culling this frame
+		std::vector<SEMeshDraw> meshDraws; // the visible objects at the level they picked, or the meshlets that survived
+		std::vector<uint32_t> visibleMeshlets;
+		std::vector<SEObjectUniforms> objectUniforms; // one per visible object, written into the ring each frame
+		uint64_t cullFrames = 0;
+		uint64_t cullObjectsTested = 0;
+		uint64_t cullObjectsVisible = 0;
+		uint64_t cullObjectsOccluded = 0;
+		uint64_t cullTriangles = 0;
+		uint64_t cullTrianglesFull = 0; // what the same objects would have drawn without LODs or meshlet culling
+		uint64_t cullMeshletsTested = 0;
+		uint64_t cullMeshletsVisible = 0;
+		double cullMs = 0.0;
+		double occlusionMs = 0.0; // drawing the occluders and building the pyramid, whichever way the scene is culled
+		bool indirectDraws = false; // multiDrawIndirect and drawIndirectFirstInstance enabled on the device
+		SEDrawIndexedIndirectCount drawIndexedIndirectCount = nullptr; // from VK_KHR_draw_indirect_count or the AMD one
+		SEGpuCulling* gpuCulling = nullptr; // only when the device and shaders can cull on the GPU
+		SESpriteBatch* spriteBatch = nullptr; // only when the sprite shaders loaded
+		uint32_t tilemapWidth = 0; // from SetTilemap, 0 for no tilemap
+		uint32_t tilemapHeight = 0;
+		SETilemap* tilemap = nullptr;
+		SETilemapRenderer* tilemapRenderer = nullptr;
+		std::string fontPath; // from SetFont, empty for no text
+		float fontPixelHeight = 16.0f;
+		SETextRenderer* textRenderer = nullptr; // draws into spriteBatch
+		SEShaderLibrary* shaderLibrary = nullptr;
+		SEShader* vertShader = nullptr;
+		SEShader* fragShader = nullptr;
+		SEShader* cullShader = nullptr; // null when Shaders/cull.spv is missing
+		SEShader* spriteVertShader = nullptr; // both null when either sprite shader is missing
+		SEShader* spriteFragShader = nullptr;
+		SEShaderPermutations* shaderPermutations = nullptr;
+		uint32_t opaqueFeatures = 0; // feature bits from shaderPermutations for the opaque pipeline
+		SEFileWatcher* shaderWatcher = nullptr;
+		SEDeletionQueue* deletionQueue = nullptr;
+		std::vector<VkCommandBuffer> commandBuffers; // one per frame in flight
+		std::vector<VkSemaphore> imageAvailableSemaphores;
+		std::vector<VkSemaphore> renderFinishedSemaphores;
+		std::vector<VkFence> inFlightFences;
+		size_t currentFrame = 0;
+		bool overdrawTest = false;
+		bool pipelineStatistics = false; // pipelineStatisticsQuery enabled on the device
+		VkQueryPool overdrawQueryPool = VK_NULL_HANDLE; // one fragment invocation query per frame in flight
+		bool overdrawQueryPending[MAX_FRAMES_IN_FLIGHT] = {};
+		bool overdrawQueryPrepass[MAX_FRAMES_IN_FLIGHT] = {}; // whether the frame with that query used the pre-pass
+		uint64_t overdrawInvocations[2] = {}; // without, with the pre-pass
+		uint64_t overdrawPixels[2] = {};
+		uint32_t overdrawFrames = 0;
+		SEPerfHud perfHud;
+		VkPhysicalDeviceMemoryProperties memoryProperties = {}; // to split the live allocations into device and host
+		VkQueryPool timestampQueryPool = VK_NULL_HANDLE; // a start and an end timestamp per frame in flight, null when the queue cant time
+		bool timestampPending[MAX_FRAMES_IN_FLIGHT] = {};
+		float timestampPeriod = 0.0f; // nanoseconds a tick
+		uint64_t timestampMask = 0; // the bits the graphics queue writes
+		float gpuFrameMs = -1.0f; // the newest frame the GPU finished, negative until there is one
+		std::chrono::high_resolution_clock::time_point lastFrameStart;
+		uint32_t frameDrawCalls = 0; // counted while the frame records
+		uint64_t frameTriangles = 0;
+		uint64_t lastTotalAllocations = 0;
 
 		
 #ifdef NDEBUG
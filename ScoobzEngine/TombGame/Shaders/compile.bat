@@ -1,3 +1,6 @@
 C:\VulkanSDK\1.0.68.0\Bin32\glslangValidator.exe -V shader.vert
 C:\VulkanSDK\1.0.68.0\Bin32\glslangValidator.exe -V shader.frag
+C:\VulkanSDK\1.0.68.0\Bin32\glslangValidator.exe -V cull.comp -o cull.spv
+C:\VulkanSDK\1.0.68.0\Bin32\glslangValidator.exe -V sprite.vert -o spritevert.spv
+C:\VulkanSDK\1.0.68.0\Bin32\glslangValidator.exe -V sprite.frag -o spritefrag.spv
 pause
\ No newline at end of file
@@ -11,7 +11,24 @@ out gl_PerVertex
 
 layout(location = 0) out vec3 fragColor;
 
+// every object this frame, bound once with a dynamic offset into the engines uniform ring
+layout(set = 0, binding = 0) readonly buffer Objects{
+	mat4 model[];
+} objects;
+
+// indirect draws cant push constants per draw, the culling shader puts the object index in firstInstance instead
+layout(constant_id = 0) const bool INDIRECT_DRAWS = false;
+
+// per draw, the only thing that changes between draws
+layout(push_constant) uniform Draw{
+	uint objectIndex;
+	uint materialIndex; // into the bindless tables in set 1
+	uvec2 padding;
+	vec4 tint;
+} draw;
+
 void main(){
-	gl_Position = vec4(inPosition,0.0,1.0);
-	fragColor = inColor;
+	uint objectIndex = INDIRECT_DRAWS ? uint(gl_InstanceIndex) : draw.objectIndex;
+	gl_Position = objects.model[objectIndex] * vec4(inPosition,0.0,1.0);
+	fragColor = inColor * draw.tint.rgb;
 }
\ No newline at end of file
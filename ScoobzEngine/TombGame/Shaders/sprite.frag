@@ -0,0 +1,22 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) in vec2 fragTexCoord;
+layout(location = 1) in vec4 fragColor;
+
+layout(location = 0) out vec4 outColor;
+
+// the bindless image array, the engine specializes its size to the tables capacity
+layout(constant_id = 0) const uint IMAGE_COUNT = 1;
+layout(set = 1, binding = 0) uniform sampler2D images[IMAGE_COUNT];
+
+layout(push_constant) uniform Draw{
+	uint objectIndex;
+	uint materialIndex;
+	uvec2 padding;
+	vec4 tint;
+} draw;
+
+void main(){
+	outColor = texture(images[draw.materialIndex], fragTexCoord) * fragColor;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 2) in vec4 inColor;
+
+out gl_PerVertex
+{
+	vec4 gl_Position;
+};
+
+layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) out vec4 fragColor;
+
+// the sprite batches view is the one object, its model matrix takes sprite space straight to clip space
+layout(set = 0, binding = 0) readonly buffer Objects{
+	mat4 model[];
+} objects;
+
+// pushed once per batch, the material is the batches texture
+layout(push_constant) uniform Draw{
+	uint objectIndex;
+	uint materialIndex; // into the bindless tables in set 1
+	uvec2 padding;
+	vec4 tint;
+} draw;
+
+void main(){
+	gl_Position = objects.model[draw.objectIndex] * vec4(inPosition,0.0,1.0);
+	fragTexCoord = inTexCoord;
+	fragColor = inColor * draw.tint;
+}
\ No newline at end of file
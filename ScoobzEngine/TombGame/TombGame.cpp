@@ -8,8 +8,26 @@ TombGame::~TombGame(){}
 void TombGame::Run() {
 	InitSystems();
 }
+//same as Run, but the engine draws its overdraw test scene
+void TombGame::RunOverdrawTest() {
+	mEngine.SetOverdrawTest(true);
+	InitSystems();
+}
+//the first of these that exists is the HUD font, the game ships the first one next to its shaders
+static const char* hudFonts[] = {
+	"Fonts/DejaVuSansMono.ttf",
+	"C:/Windows/Fonts/consola.ttf",
+	"/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf",
+};
+
 //Initialize the systems, and start the gameloop
 void TombGame::InitSystems() {
+	for (const char* path : hudFonts) {
+		if (std::ifstream(path, std::ios::binary).good()) {
+			mEngine.SetFont(path, 16.0f);
+			break;
+		}
+	}
 	mEngine.Initvulkan();
 	mEngine.GameLoop();
 }
@@ -8,6 +8,8 @@ public:
 	~TombGame();
 	//start everything up..
 	void Run();
+	//run the depth pre-pass overdraw test scene instead of the game
+	void RunOverdrawTest();
 
 private:
 	//FUNCTIONS
@@ -1,14 +1,29 @@
 #include "stdafx.h"
 #include "TombGame.h"
+#include <ScoobzEngine/SEBenchmark.h>
 #include <stdexcept>
 #include <iostream>
+#include <string>
 
 int main(int argc, char** argv) {
+
+	// --bench [name] runs the engine benchmarks instead of the game
+	if (argc > 1 && std::string(argv[1]) == "--bench") {
+		return ScoobzEngine::RunBenchmarks(argc > 2 ? argv[2] : "");
+	}
 	
+	// --overdraw measures fragment shading with and without the depth pre-pass
+	bool overdrawTest = argc > 1 && std::string(argv[1]) == "--overdraw";
+
 	TombGame tombGame; // create the game object...
 
 	try {
-		tombGame.Run(); // try to call the Run function
+		if (overdrawTest) {
+			tombGame.RunOverdrawTest();
+		}
+		else {
+			tombGame.Run(); // try to call the Run function
+		}
 	}
 	catch (const std::runtime_error& e) { // if it fails lets log a runtime error e
 		std::cerr << e.what() << std::endl; // tell me about that error...